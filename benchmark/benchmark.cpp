@@ -0,0 +1,162 @@
+#include <iostream>
+#include <fstream>
+#include <chrono>
+
+#include <boost/program_options.hpp>
+
+#include "modelgenerator.h"
+#include "binarymodel.h"
+#include "helpers.h"
+
+using namespace mht;
+using namespace helpers;
+
+// phases of the telemetry that are reported for each run, see Model::getTelemetry()
+static const std::vector<std::string> reportedPhases = {
+	"parse", "buildAdjacency", "initializeOpenGMModel", "solverSetup", "solve", "export"
+};
+
+// counters of the telemetry that are reported for each run
+static const std::vector<std::string> reportedCounters = {
+	"opengm.variables", "opengm.unaries", "opengm.constraints", "solver.solves", "solver.maxGap"
+};
+
+int main(int argc, char** argv) {
+	namespace po = boost::program_options;
+
+	std::string outputPrefix;
+	std::string workingDirectory;
+	std::vector<size_t> sizes;
+	size_t repetitions;
+	ModelGenerator::Parameters parameters;
+
+	// Declare the supported options.
+	po::options_description description("Allowed options");
+	description.add_options()
+	    ("help", "produce help message")
+	    ("output,o", po::value<std::string>(&outputPrefix)->default_value("benchmark"), "results are stored in <output>.csv and <output>.json")
+	    ("directory,d", po::value<std::string>(&workingDirectory)->default_value("."), "directory for the generated models and tracking results")
+	    ("sizes", po::value< std::vector<size_t> >(&sizes)->multitoken(), "numbers of detections per frame to sweep over (default: 100 1000 10000)")
+	    ("repetitions", po::value<size_t>(&repetitions)->default_value(1), "number of runs per size, each with its own seed")
+	    ("binary", "convert each model to the binary format and measure parsing that instead of the JSON file")
+	    ("frames", po::value<size_t>(&parameters.numFrames)->default_value(parameters.numFrames), "number of frames")
+	    ("fan-out", po::value<size_t>(&parameters.linkFanOut)->default_value(parameters.linkFanOut), "number of outgoing links per detection")
+	    ("max-objects", po::value<size_t>(&parameters.maxNumObjects)->default_value(parameters.maxNumObjects), "maximal number of objects per detection, > 1 creates mergers")
+	    ("merger-rate", po::value<double>(&parameters.mergerRate)->default_value(parameters.mergerRate), "fraction of detections that contain several objects")
+	    ("division-rate", po::value<double>(&parameters.divisionRate)->default_value(parameters.divisionRate), "fraction of detections that may divide")
+	    ("external-divisions", "store divisions as separate division hypotheses instead of division features")
+	    ("exclusion-rate", po::value<double>(&parameters.exclusionRate)->default_value(parameters.exclusionRate), "fraction of detections that are excluded with their nearest neighbor")
+	    ("false-positive-rate", po::value<double>(&parameters.falsePositiveRate)->default_value(parameters.falsePositiveRate), "fraction of detections that are false positives")
+	    ("features", po::value<size_t>(&parameters.numFeatures)->default_value(parameters.numFeatures), "number of features per state")
+	    ("seed", po::value<unsigned int>(&parameters.seed)->default_value(parameters.seed), "seed of the first run, incremented for every repetition")
+	;
+
+	po::variables_map variableMap;
+	po::store(po::parse_command_line(argc, argv, description), variableMap);
+	po::notify(variableMap);
+
+	if (variableMap.count("help"))
+	{
+	    std::cout << description << std::endl;
+	    return 1;
+	}
+
+	if(sizes.empty())
+		sizes = {100, 1000, 10000};
+	parameters.externalDivisions = variableMap.count("external-divisions") > 0;
+	bool useBinary = variableMap.count("binary") > 0;
+	unsigned int firstSeed = parameters.seed;
+
+	std::ofstream csv((outputPrefix + ".csv").c_str());
+	if(!csv.good())
+		throw std::runtime_error("Could not open benchmark result file " + outputPrefix + ".csv");
+
+	csv << "detectionsPerFrame,frames,repetition,segmentations,links,divisions,exclusions,modelBytes,generateWall";
+	for(const std::string& phase : reportedPhases)
+		csv << "," << phase << "Wall," << phase << "Cpu";
+	for(const std::string& counter : reportedCounters)
+		csv << "," << counter;
+	csv << ",energy" << std::endl;
+
+	Json::Value root;
+	Json::Value& runs = root["runs"];
+	runs = Json::Value(Json::arrayValue);
+
+	for(size_t size : sizes)
+	{
+		for(size_t repetition = 0; repetition < repetitions; ++repetition)
+		{
+			parameters.detectionsPerFrame = size;
+			parameters.seed = firstSeed + repetition;
+			std::string name = workingDirectory + "/benchmark-" + std::to_string(size) + "-" + std::to_string(repetition);
+			std::cout << "Benchmarking " << size << " detections per frame in " << parameters.numFrames
+					  << " frames, repetition " << repetition << std::endl;
+
+			auto generateStart = std::chrono::steady_clock::now();
+			ModelGenerator generator(parameters);
+			generator.saveModelToJson(name + ".json");
+			std::chrono::duration<double> generateTime = std::chrono::steady_clock::now() - generateStart;
+
+			std::string modelFilename = name + ".json";
+			if(useBinary)
+			{
+				JsonModel jsonModel;
+				jsonModel.readFromJson(modelFilename);
+				modelFilename = name + ".mhtb";
+				jsonModel.saveToBinary(modelFilename);
+			}
+			std::ifstream modelFile(modelFilename.c_str(), std::ios::binary | std::ios::ate);
+			size_t modelBytes = modelFile.tellg();
+
+			BinaryModel model;
+			model.read(modelFilename);
+			Solution solution = model.infer(generator.getWeights());
+			model.saveResultToJson(name + "-result.json", solution);
+
+			const Telemetry& telemetry = model.getTelemetry();
+			Json::Value run;
+			run["detectionsPerFrame"] = (Json::UInt64)size;
+			run["frames"] = (Json::UInt64)parameters.numFrames;
+			run["repetition"] = (Json::UInt64)repetition;
+			run["seed"] = parameters.seed;
+			run["modelBytes"] = (Json::UInt64)modelBytes;
+			run["generateWall"] = generateTime.count();
+			run["energy"] = model.getLastSolutionValue();
+			telemetry.toJson(run[JsonTypeNames[JsonTypes::Telemetry]]);
+			runs.append(run);
+
+			csv << size << "," << parameters.numFrames << "," << repetition << ","
+				<< generator.getNumSegmentations() << "," << generator.getNumLinks() << ","
+				<< generator.getNumDivisions() << "," << generator.getNumExclusions() << ","
+				<< modelBytes << "," << generateTime.count();
+			for(const std::string& phaseName : reportedPhases)
+			{
+				Telemetry::Phase phase = telemetry.getPhase(phaseName);
+				csv << "," << phase.wallTime << "," << phase.cpuTime;
+			}
+			for(const std::string& counter : reportedCounters)
+				csv << "," << telemetry.getCounter(counter);
+			csv << "," << run["energy"].asDouble() << std::endl;
+		}
+	}
+
+	// store the parameters of the sweep with the results
+	Json::Value& generatorJson = root["generator"];
+	generatorJson["frames"] = (Json::UInt64)parameters.numFrames;
+	generatorJson["fanOut"] = (Json::UInt64)parameters.linkFanOut;
+	generatorJson["maxNumObjects"] = (Json::UInt64)parameters.maxNumObjects;
+	generatorJson["mergerRate"] = parameters.mergerRate;
+	generatorJson["divisionRate"] = parameters.divisionRate;
+	generatorJson["externalDivisions"] = parameters.externalDivisions;
+	generatorJson["exclusionRate"] = parameters.exclusionRate;
+	generatorJson["falsePositiveRate"] = parameters.falsePositiveRate;
+	generatorJson["features"] = (Json::UInt64)parameters.numFeatures;
+	root["binary"] = useBinary;
+
+	std::ofstream json((outputPrefix + ".json").c_str());
+	if(!json.good())
+		throw std::runtime_error("Could not open benchmark result file " + outputPrefix + ".json");
+	json << root << std::endl;
+
+	std::cout << "Stored benchmark results in " << outputPrefix << ".csv and " << outputPrefix << ".json" << std::endl;
+}
@@ -0,0 +1,64 @@
+#include <iostream>
+
+#include <boost/program_options.hpp>
+
+#include "modelgenerator.h"
+#include "helpers.h"
+
+using namespace mht;
+using namespace helpers;
+
+int main(int argc, char** argv) {
+	namespace po = boost::program_options;
+
+	std::string modelFilename;
+	std::string weightsFilename;
+	ModelGenerator::Parameters parameters;
+
+	// Declare the supported options.
+	po::options_description description("Allowed options");
+	description.add_options()
+	    ("help", "produce help message")
+	    ("model,m", po::value<std::string>(&modelFilename), "filename where the generated model will be stored as Json file")
+	    ("weights,w", po::value<std::string>(&weightsFilename), "filename where weights that fit the model will be stored as Json file")
+	    ("frames", po::value<size_t>(&parameters.numFrames)->default_value(parameters.numFrames), "number of frames")
+	    ("detections", po::value<size_t>(&parameters.detectionsPerFrame)->default_value(parameters.detectionsPerFrame), "number of detections per frame")
+	    ("fan-out", po::value<size_t>(&parameters.linkFanOut)->default_value(parameters.linkFanOut), "number of outgoing links per detection")
+	    ("max-objects", po::value<size_t>(&parameters.maxNumObjects)->default_value(parameters.maxNumObjects), "maximal number of objects per detection, > 1 creates mergers")
+	    ("merger-rate", po::value<double>(&parameters.mergerRate)->default_value(parameters.mergerRate), "fraction of detections that contain several objects")
+	    ("division-rate", po::value<double>(&parameters.divisionRate)->default_value(parameters.divisionRate), "fraction of detections that may divide")
+	    ("external-divisions", "store divisions as separate division hypotheses instead of division features")
+	    ("exclusion-rate", po::value<double>(&parameters.exclusionRate)->default_value(parameters.exclusionRate), "fraction of detections that are excluded with their nearest neighbor")
+	    ("false-positive-rate", po::value<double>(&parameters.falsePositiveRate)->default_value(parameters.falsePositiveRate), "fraction of detections that are false positives")
+	    ("features", po::value<size_t>(&parameters.numFeatures)->default_value(parameters.numFeatures), "number of features per state")
+	    ("seed", po::value<unsigned int>(&parameters.seed)->default_value(parameters.seed), "seed of the random number generator")
+	;
+
+	po::variables_map variableMap;
+	po::store(po::parse_command_line(argc, argv, description), variableMap);
+	po::notify(variableMap);
+
+	if (variableMap.count("help"))
+	{
+	    std::cout << description << std::endl;
+	    return 1;
+	}
+
+	if (!variableMap.count("model"))
+	{
+	    std::cout << "Model filename has to be specified!" << std::endl;
+	    std::cout << description << std::endl;
+	}
+	else
+	{
+		parameters.externalDivisions = variableMap.count("external-divisions") > 0;
+		ModelGenerator generator(parameters);
+		generator.saveModelToJson(modelFilename);
+		std::cout << "Generated " << generator.getNumSegmentations() << " segmentation hypotheses, "
+				  << generator.getNumLinks() << " links, " << generator.getNumDivisions() << " divisions and "
+				  << generator.getNumExclusions() << " exclusions" << std::endl;
+
+		if(variableMap.count("weights"))
+			saveWeightsToJson(generator.getWeights(), weightsFilename);
+	}
+}
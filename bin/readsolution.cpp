@@ -0,0 +1,54 @@
+#include <iostream>
+
+#include <boost/program_options.hpp>
+
+#include "binarymodel.h"
+#include "helpers.h"
+
+using namespace mht;
+using namespace helpers;
+
+int main(int argc, char** argv) {
+	namespace po = boost::program_options;
+
+	std::string modelFilename;
+	std::string outputFilename;
+	std::string weightsFilename;
+	std::string solutionFilename;
+
+	// Declare the supported options.
+	po::options_description description("Read the solution of an ILP that was written by track --export-lp and solved offline.\nAllowed options");
+	description.add_options()
+	    ("help", "produce help message")
+	    ("model,m", po::value<std::string>(&modelFilename), "filename of model stored as Json or binary file")
+	    ("weights,w", po::value<std::string>(&weightsFilename), "filename of the weights stored as Json file, the same as for exporting the ILP")
+	    ("solution,s", po::value<std::string>(&solutionFilename), "filename of the solution written by the solver")
+	    ("output,o", po::value<std::string>(&outputFilename), "filename where the resulting tracking (as links) will be stored as Json file")
+	;
+
+	po::variables_map variableMap;
+	po::store(po::parse_command_line(argc, argv, description), variableMap);
+	po::notify(variableMap);
+
+	if (variableMap.count("help")) 
+	{
+	    std::cout << description << std::endl;
+	    return 1;
+	}
+
+	if (!variableMap.count("model") || !variableMap.count("weights") || !variableMap.count("solution") || !variableMap.count("output")) 
+	{
+	    std::cout << "Model, Weights, Solution and Output filenames have to be specified!" << std::endl;
+	    std::cout << description << std::endl;
+	    return 1;
+	} 
+
+    BinaryModel model;
+	model.read(modelFilename);
+	std::vector<double> weights = readWeightsFromJson(weightsFilename);
+	Solution solution = model.readLinearProgramSolution(weights, solutionFilename);
+	if(!model.verifySolution(solution))
+		std::cout << "Warning: the solution violates constraints of the model" << std::endl;
+	model.saveResultToJson(outputFilename, solution);
+	return 0;
+}
@@ -2,7 +2,7 @@
 
 #include <boost/program_options.hpp>
 
-#include "jsonmodel.h"
+#include "binarymodel.h"
 #include "helpers.h"
 
 using namespace mht;
@@ -14,15 +14,33 @@ int main(int argc, char** argv) {
 	std::string modelFilename;
 	std::string outputFilename;
 	std::string weightsFilename;
+	std::string startFilename;
+	std::string lpFilename;
+	std::string cacheDirectory;
+	size_t cacheSize = 0;
+	size_t windowSize = 0;
+	size_t windowStep = 1;
+	std::string frameResultsPrefix;
 
 	// Declare the supported options.
 	po::options_description description("Allowed options");
 	description.add_options()
 	    ("help", "produce help message")
-	    ("model,m", po::value<std::string>(&modelFilename), "filename of model stored as Json file")
+	    ("model,m", po::value<std::string>(&modelFilename), "filename of model stored as Json or binary file")
 	    ("weights,w", po::value<std::string>(&weightsFilename), "filename of the weights stored as Json file")
 	    ("output,o", po::value<std::string>(&outputFilename), "filename where the resulting tracking (as links) will be stored as Json file")
+		("start,s", po::value<std::string>(&startFilename), "filename of a previous tracking result stored as Json file, which the ILP starts from")
 		("lp-relax", "run LP relaxation")
+		("round", "with --lp-relax, round the relaxation to a valid tracking instead of writing the largest state of every variable")
+		("approx", "track approximately without an ILP, which is much faster but not optimal")
+		("lower-bound", "with --approx, also solve the LP relaxation to report how far from optimal the result may be")
+		("export-lp", po::value<std::string>(&lpFilename), "instead of tracking, write the ILP to the given .lp or .mps file, see the readsolution tool")
+		("cache", po::value<std::string>(&cacheDirectory), "directory of solutions found before, which are returned again for the same model, settings and weights")
+		("cache-size", po::value<size_t>(&cacheSize), "with --cache, the number of solutions that are kept (default 0, unlimited)")
+		("window", po::value<size_t>(&windowSize), "track in a sliding window of this many timesteps instead of solving all of them at once")
+		("window-step", po::value<size_t>(&windowStep), "with --window, the number of timesteps that are committed before the window moves on (default 1)")
+		("frame-results", po::value<std::string>(&frameResultsPrefix), "with --window, write the result to <prefix><timestep>.json whenever a timestep is committed, "
+			"all detections up to that timestep are final")
 	;
 
 	po::variables_map variableMap;
@@ -35,7 +53,7 @@ int main(int argc, char** argv) {
 	    return 1;
 	}
 
-	if (!variableMap.count("model") || !variableMap.count("output") || !variableMap.count("weights")) 
+	if (!variableMap.count("model") || !variableMap.count("weights") || (!variableMap.count("output") && !variableMap.count("export-lp"))) 
 	{
 	    std::cout << "Model, Weights and Output filenames have to be specified!" << std::endl;
 	    std::cout << description << std::endl;
@@ -43,10 +61,62 @@ int main(int argc, char** argv) {
 	else 
 	{
 		bool withIntegerConstraints = variableMap.count("lp-relax") == 0;
-	    JsonModel model;
-		model.readFromJson(modelFilename);
+	    BinaryModel model;
+		model.read(modelFilename);
 		std::vector<double> weights = readWeightsFromJson(weightsFilename);
-		Solution solution = model.infer(weights, withIntegerConstraints);
+		if(variableMap.count("cache"))
+			model.setSolutionCache(cacheDirectory, cacheSize);
+		if(variableMap.count("export-lp"))
+		{
+			model.exportLinearProgram(weights, lpFilename);
+			return 0;
+		}
+
+		if(variableMap.count("frame-results") && !variableMap.count("window"))
+		{
+			std::cout << "Frame results can only be written when tracking in a sliding window!" << std::endl;
+			return 1;
+		}
+
+		Solution solution;
+		if(variableMap.count("window"))
+		{
+			// every window is solved from scratch, a start would be ignored
+			if(variableMap.count("start") || !withIntegerConstraints)
+			{
+				std::cout << "A sliding window cannot be combined with a start solution or the LP relaxation!" << std::endl;
+				return 1;
+			}
+			Model::FrameCallback frameCallback;
+			if(variableMap.count("frame-results"))
+			{
+				frameCallback = [&](int timestep, const Solution& frameSolution)
+				{
+					model.saveResultToJson(frameResultsPrefix + std::to_string(timestep) + ".json", frameSolution);
+				};
+			}
+			solution = model.inferSlidingWindow(weights, windowSize, windowStep, frameCallback);
+		}
+		else if(variableMap.count("approx"))
+			solution = model.inferApproximate(weights, variableMap.count("lower-bound") > 0);
+		else if(variableMap.count("start") && withIntegerConstraints)
+		{
+			// read the start from the JSON file even if the binary model has an embedded ground truth
+			model.setJsonGtFile(startFilename);
+			solution = model.infer(weights, model.JsonModel::getGroundTruth());
+		}
+		else if(!withIntegerConstraints && variableMap.count("round"))
+		{
+			Relaxation relaxation = model.inferRelaxation(weights);
+			if(relaxation.rounded_.empty())
+			{
+				std::cout << "Could not round the LP relaxation to a valid tracking" << std::endl;
+				return 1;
+			}
+			solution = relaxation.rounded_;
+		}
+		else
+			solution = model.infer(weights, withIntegerConstraints);
 		model.saveResultToJson(outputFilename, solution);
 	}
 }
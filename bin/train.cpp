@@ -1,9 +1,11 @@
 #include <iostream>
+#include <memory>
 
 #include <boost/program_options.hpp>
 
-#include "jsonmodel.h"
+#include "binarymodel.h"
 #include "helpers.h"
+#include "parallel.h"
 
 using namespace mht;
 using namespace helpers;
@@ -11,16 +13,16 @@ using namespace helpers;
 int main(int argc, char** argv) {
 	namespace po = boost::program_options;
 
-	std::string modelFilename;
-	std::string groundtruthFilename;
+	std::vector<std::string> modelFilenames;
+	std::vector<std::string> groundtruthFilenames;
 	std::string weightsFilename("weights.json");
 
 	// Declare the supported options.
 	po::options_description description("Allowed options");
 	description.add_options()
 	    ("help", "produce help message")
-	    ("model,m", po::value<std::string>(&modelFilename), "filename of model stored as Json file")
-	    ("groundtruth,g", po::value<std::string>(&groundtruthFilename), "filename of ground truth stored as Json file")
+	    ("model,m", po::value< std::vector<std::string> >(&modelFilenames)->composing(), "filename of model stored as Json or binary file, repeat to learn from several annotated models")
+	    ("groundtruth,g", po::value< std::vector<std::string> >(&groundtruthFilenames)->composing(), "filename of ground truth stored as Json file, not needed for binary models with embedded ground truth. If given, once per model in the same order, and it is used instead of an embedded ground truth")
 	    ("weights,w", po::value<std::string>(&weightsFilename), "filename where the resulting weights will be stored as Json file")
 	;
 
@@ -34,17 +36,44 @@ int main(int argc, char** argv) {
 	    return 1;
 	}
 
-	if (!variableMap.count("model") || !variableMap.count("groundtruth")) 
+	if (!variableMap.count("model")) 
 	{
-	    std::cout << "Model and Groundtruth filenames have to be specified!" << std::endl;
+	    std::cout << "Model filename has to be specified!" << std::endl;
 	    std::cout << description << std::endl;
 	} 
 	else 
 	{
-	    JsonModel model;
-		model.readFromJson(modelFilename);
-		model.setJsonGtFile(groundtruthFilename);
-		std::vector<double> weights = model.learn();
+		if(!groundtruthFilenames.empty() && groundtruthFilenames.size() != modelFilenames.size())
+		{
+			std::cout << "Either no ground truth or one per model has to be specified!" << std::endl;
+			std::cout << description << std::endl;
+			return 1;
+		}
+
+		// every model+GT pair becomes one instance of the learning dataset, they are parsed concurrently
+		std::vector< std::unique_ptr<BinaryModel> > models(modelFilenames.size());
+		parallelFor(modelFilenames.size(), 0, [&](size_t m)
+		{
+			models[m].reset(new BinaryModel());
+			models[m]->read(modelFilenames[m]);
+			if(!groundtruthFilenames.empty())
+				models[m]->setJsonGtFile(groundtruthFilenames[m]);
+		});
+
+		std::vector<Model*> instances;
+		for(size_t m = 0; m < models.size(); ++m)
+		{
+			if(groundtruthFilenames.empty() && !models[m]->hasEmbeddedGroundTruth())
+			{
+				std::cout << "Groundtruth filename has to be specified if the model " << modelFilenames[m] << " does not contain a ground truth!" << std::endl;
+				std::cout << description << std::endl;
+				return 1;
+			}
+			instances.push_back(models[m].get());
+		}
+
+		BinaryModel& model = *models.front();
+		std::vector<double> weights = Model::learnFromInstances(instances, std::vector<double>(model.computeNumWeights(), 0));
 		std::vector<std::string> weightDescriptions = model.getWeightDescriptions();
 		saveWeightsToJson(weights, weightsFilename, weightDescriptions);
 	}
@@ -0,0 +1,76 @@
+#ifndef BINARY_MODEL_H
+#define BINARY_MODEL_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "jsonmodel.h"
+
+namespace mht
+{
+
+/**
+ * @brief Model that is loaded from a compact binary container instead of a JSON file.
+ * @details The container is memory mapped and holds all ids, the link/division/exclusion adjacency
+ *          and the features in contiguous columns, so no JSON DOM has to be built while loading.
+ *          Such files are written by Model::saveToBinary() (see the convertmodel tool).
+ *          A ground truth can be embedded in the file, otherwise it is read from a JSON file as in JsonModel.
+ *          Results are saved as JSON, exactly as for a JsonModel.
+ *
+ *          Layout (all values little endian, every array is preceded by its uint64 length and padded to 8 bytes):
+ *          - header: magic "MHTBIN", format version, flags, number of segmentations, links, divisions and exclusions
+ *          - settings as JSON string
+ *          - segmentation ids, their timesteps if any are known (flag 2), 
+ *            followed by feature blocks for detection, division, appearance and disappearance
+ *          - links: CSR offsets by source segmentation, destination segmentation indices, feature block
+ *          - divisions: CSR offsets by parent segmentation, two children segmentation indices each, feature block
+ *          - exclusions: CSR offsets, member segmentation indices
+ *          - optional ground truth (flag 1): values of detections, internal divisions, links and external divisions
+ *
+ *          A feature block stores the number of states of each variable as offsets into a per-state list of
+ *          offsets into one array of feature values.
+ */
+class BinaryModel : public JsonModel
+{
+public:
+    /**
+     * @brief Read a model from a binary container file
+     * @param filename
+     */
+    void readFromBinary(const std::string& filename);
+
+    /**
+     * @brief Read a model from a binary container or a JSON file, depending on the content of the file
+     * @param filename
+     */
+    void read(const std::string& filename);
+
+    /**
+     * @return whether the given file starts like a binary model container
+     */
+    static bool isBinaryModelFile(const std::string& filename);
+
+    /**
+     * @return whether the binary file contained a ground truth
+     */
+    bool hasEmbeddedGroundTruth() const { return hasGroundTruth_; }
+
+    /**
+     * @brief get the ground truth for learning from the JSON file set with setJsonGtFile() if there is one,
+     *        or from the binary file otherwise
+     * @return the solution vector that fits the OpenGM model
+     */
+    virtual helpers::Solution getGroundTruth();
+
+private:
+    bool hasGroundTruth_ = false;
+    std::vector<uint32_t> gtDetectionValues_;
+    std::vector<uint32_t> gtDivisionValues_;
+    std::vector<uint32_t> gtLinkValues_;
+    std::vector<uint32_t> gtExternalDivisionValues_;
+};
+
+} // end namespace mht
+
+#endif // BINARY_MODEL_H
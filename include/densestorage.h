@@ -0,0 +1,218 @@
+#ifndef DENSE_STORAGE_H
+#define DENSE_STORAGE_H
+
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <unordered_map>
+#include <functional>
+#include <stdexcept>
+#include <cstddef>
+
+namespace helpers
+{
+
+/**
+ * @brief Hash for hypothesis ids, which also supports the pairs and tuples of ids that identify links and divisions
+ */
+struct IdHash
+{
+	template<class T>
+	size_t operator()(const T& value) const
+	{
+		return std::hash<T>()(value);
+	}
+
+	template<class A, class B>
+	size_t operator()(const std::pair<A, B>& value) const
+	{
+		return combine((*this)(value.first), (*this)(value.second));
+	}
+
+	template<class A, class B, class C>
+	size_t operator()(const std::tuple<A, B, C>& value) const
+	{
+		return combine(combine((*this)(std::get<0>(value)), (*this)(std::get<1>(value))), (*this)(std::get<2>(value)));
+	}
+
+private:
+	static size_t combine(size_t seed, size_t hash)
+	{
+		return seed ^ (hash + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+	}
+};
+
+/**
+ * @brief A map that stores its entries contiguously in insertion order, with a hash index from key to position
+ * @details Iterating is a linear walk over one array and lookups are O(1),
+ *          which is what the hypothesis containers of a model need when they hold millions of entries.
+ *          The interface follows std::map as far as the models use it, so iterators point to std::pair<Key, Value>.
+ *          Inserting may move all values when the storage grows, see capacity(), so pointers and iterators to values 
+ *          are only stable while no entries are added. Erasing is O(1): the last entry is moved into the place of the erased one,
+ *          which changes the order of the remaining entries and invalidates pointers to the last entry.
+ */
+template<class Key, class Value, class Hash = IdHash>
+class DenseMap
+{
+public:
+	typedef std::pair<Key, Value> EntryType;
+	typedef typename std::vector<EntryType>::iterator iterator;
+	typedef typename std::vector<EntryType>::const_iterator const_iterator;
+
+	static const size_t npos = (size_t)-1;
+
+	iterator begin() { return entries_.begin(); }
+	iterator end() { return entries_.end(); }
+	const_iterator begin() const { return entries_.begin(); }
+	const_iterator end() const { return entries_.end(); }
+
+	size_t size() const { return entries_.size(); }
+	bool empty() const { return entries_.empty(); }
+	/// number of entries that can be stored before inserting moves all of them
+	size_t capacity() const { return entries_.capacity(); }
+
+	void reserve(size_t size)
+	{
+		entries_.reserve(size);
+		indices_.reserve(size);
+	}
+
+	void clear()
+	{
+		entries_.clear();
+		indices_.clear();
+	}
+
+	/**
+	 * @return the position of the given key in iteration order, or npos
+	 */
+	size_t indexOf(const Key& key) const
+	{
+		auto it = indices_.find(key);
+		return it == indices_.end() ? npos : it->second;
+	}
+
+	iterator find(const Key& key)
+	{
+		size_t index = indexOf(key);
+		return index == npos ? end() : begin() + index;
+	}
+
+	const_iterator find(const Key& key) const
+	{
+		size_t index = indexOf(key);
+		return index == npos ? end() : begin() + index;
+	}
+
+	size_t count(const Key& key) const { return indices_.count(key); }
+
+	Value& at(const Key& key)
+	{
+		size_t index = indexOf(key);
+		if(index == npos)
+			throw std::out_of_range("DenseMap::at: key not found");
+		return entries_[index].second;
+	}
+
+	const Value& at(const Key& key) const
+	{
+		size_t index = indexOf(key);
+		if(index == npos)
+			throw std::out_of_range("DenseMap::at: key not found");
+		return entries_[index].second;
+	}
+
+	/**
+	 * @brief Insert a new entry if the key is not present yet
+	 * @return iterator to the entry with that key, and whether it was inserted
+	 */
+	template<class... Args>
+	std::pair<iterator, bool> emplace(const Key& key, Args&&... args)
+	{
+		auto inserted = indices_.emplace(key, entries_.size());
+		if(!inserted.second)
+			return std::make_pair(begin() + inserted.first->second, false);
+		entries_.emplace_back(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+		return std::make_pair(end() - 1, true);
+	}
+
+	Value& operator[](const Key& key)
+	{
+		return emplace(key).first->second;
+	}
+
+	/**
+	 * @brief Remove the entry with the given key, if there is one, by moving the last entry into its place
+	 * @return the number of removed entries
+	 */
+	size_t erase(const Key& key)
+	{
+		size_t index = indexOf(key);
+		if(index == npos)
+			return 0;
+		indices_.erase(key);
+		if(index + 1 < entries_.size())
+		{
+			entries_[index] = std::move(entries_.back());
+			indices_[entries_[index].first] = index;
+		}
+		entries_.pop_back();
+		return 1;
+	}
+
+private:
+	std::vector<EntryType> entries_;
+	std::unordered_map<Key, size_t, Hash> indices_;
+};
+
+template<class Key, class Value, class Hash>
+const size_t DenseMap<Key, Value, Hash>::npos;
+
+/**
+ * @brief A non-owning view of a contiguous range of pointers, as stored in a compressed adjacency array
+ */
+template<class T>
+class PointerRange
+{
+public:
+	PointerRange(): begin_(nullptr), end_(nullptr) {}
+	PointerRange(T** begin, T** end): begin_(begin), end_(end) {}
+
+	T** begin() const { return begin_; }
+	T** end() const { return end_; }
+	size_t size() const { return end_ - begin_; }
+	bool empty() const { return begin_ == end_; }
+	T* operator[](size_t i) const { return begin_[i]; }
+
+private:
+	T** begin_;
+	T** end_;
+};
+
+/**
+ * @brief Group edges by their segmentation in compressed sparse row layout
+ * @details Counting sort that keeps the order of edges that belong to the same segmentation.
+ *
+ * @param edges pairs of segmentation index and edge
+ * @param numSegmentations number of segmentations
+ * @param storage where the grouped edges are written, must hold edges.size() entries
+ * @return offsets into storage, where the edges of segmentation i are [offsets[i], offsets[i+1])
+ */
+template<class T>
+std::vector<size_t> fillAdjacency(const std::vector< std::pair<size_t, T*> >& edges, size_t numSegmentations, T** storage)
+{
+	std::vector<size_t> offsets(numSegmentations + 1, 0);
+	for(const auto& edge : edges)
+		offsets[edge.first + 1]++;
+	for(size_t i = 0; i < numSegmentations; ++i)
+		offsets[i + 1] += offsets[i];
+
+	std::vector<size_t> positions(offsets.begin(), offsets.end() - 1);
+	for(const auto& edge : edges)
+		storage[positions[edge.first]++] = edge.second;
+	return offsets;
+}
+
+} // end namespace helpers
+
+#endif // DENSE_STORAGE_H
@@ -18,7 +18,7 @@ namespace mht
  * @details It can be read from Json, be added to an opengm model 
  * (with unary composed of several features that are learnable).
  */
-class DivisionHypothesis : public std::enable_shared_from_this<DivisionHypothesis>
+class DivisionHypothesis
 {
 public:
 	typedef std::tuple<helpers::IdLabelType, helpers::IdLabelType, helpers::IdLabelType> IdType;
@@ -28,33 +28,41 @@ public:
 
 	/**
 	 * @brief Construct this hypothesis manually - mainly needed for testing
+	 * @details The children are stored sorted, in whichever order they are given.
 	 */
-	DivisionHypothesis(helpers::IdLabelType parent, const std::vector<helpers::IdLabelType>& children, const helpers::StateFeatureVector& features);
+	DivisionHypothesis(helpers::IdLabelType parent, const std::vector<helpers::IdLabelType>& children, helpers::StateFeatureVector features);
 
 	const helpers::IdLabelType getParentId() const { return parentId_; }
 	const std::vector<helpers::IdLabelType>& getChildrenIds() const { return childrenIds_; }
 
 	/**
-	 * @brief Add this hypothesis to the OpenGM model
-	 * @details also adds the unary factor
+	 * @brief Add the variable of this hypothesis to the OpenGM model
+	 * @details its unary factor is added by addFactorsToOpenGMModel()
 	 * 
 	 * @param model OpenGM model
+	 */
+	void addToOpenGMModel(helpers::GraphicalModelType& model);
+
+	/**
+	 * @brief Add the unary factor of this hypothesis
+	 * 
+	 * @param buffer factor buffer of the OpenGM model that this hypothesis was added to
 	 * @param weights OpenGM weight object (if you are running learning this must be a reference to the weight object of the dataset)
 	 * @param statesShareWeights whether there is one weight per feature for all states, or a separate weight for each feature and state
 	 * @param weightIds indices of the weights that are meant to be used together with the features (size must match 2*numFeatures)
 	 */
-	void addToOpenGMModel(
-		helpers::GraphicalModelType& model, 
+	void addFactorsToOpenGMModel(
+		helpers::FactorBuffer& buffer, 
 		helpers::WeightsType& weights, 
 		bool statesShareWeights,
-		const std::vector<size_t>& weightIds);
+		const std::vector<size_t>& weightIds) const;
 
 	/**
-	 * @brief notify the three connected segmentation hypotheses about their new incoming/outgoing division link
+	 * @brief Number the opengm variable of this hypothesis as addToOpenGMModel() would, without adding it to a model
 	 * 
-	 * @param segmentationHypotheses the map of all segmentation hypotheses
+	 * @param nextId the next free opengm variable id, is incremented accordingly
 	 */
-	void registerWithSegmentations(std::map<helpers::IdLabelType, SegmentationHypothesis>& segmentationHypotheses);
+	void assignOpenGMVariableIds(int& nextId);
 
 	/**
 	 * @brief Save this node to an open ostream in the graphviz dot format
@@ -65,6 +73,7 @@ public:
 	 * @return opengm variable
 	 */
 	const Variable& getVariable() const { return variable_; }
+	Variable& getVariable() { return variable_; }
 
 private:
 	helpers::IdLabelType parentId_;
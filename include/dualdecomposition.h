@@ -0,0 +1,75 @@
+#ifndef DUAL_DECOMPOSITION_H
+#define DUAL_DECOMPOSITION_H
+
+#include <vector>
+#include <string>
+#include <functional>
+
+#include "solverbackend.h"
+#include "telemetry.h"
+
+namespace mht
+{
+
+/**
+ * @brief Lagrangian decomposition of a linear program into subproblems whose rows are disjoint or repeated, but whose columns may be shared
+ * @details Every subproblem holds a subset of the rows and all columns appearing in them. A column that appears in several subproblems
+ *          is copied into each of them, and every copy gets an equal share of its cost plus a Lagrange multiplier. The multipliers
+ *          of a column sum up to zero, so for any multipliers the sum of the subproblem optima is a lower bound of the optimum
+ *          of the whole program. The subproblems are solved concurrently, and the multipliers are moved along the disagreement
+ *          of the copies (a projected subgradient of the bound) with Polyak's step size towards the best known primal energy.
+ *          When all copies agree, their values are an optimal solution of the whole program up to the gaps of the subproblem solves.
+ */
+class DualDecomposition
+{
+public:
+	struct Parameter
+	{
+		std::vector<SolverBackend*> backends_; // solve the subproblems, one per worker thread (see helpers::parallelForWorkers())
+		SolverParameters solverParameters_; // of every subproblem solve
+		size_t numThreads_ = 0; // number of subproblems that are solved concurrently, 0 for all CPU cores
+		size_t maxIterations_ = 50;
+		double relativeGap_ = 0.01; // stop once the primal and dual bound are this close
+		bool verbose_ = true; // print the bounds of every iteration
+	};
+
+	/**
+	 * @brief Called in every iteration with the mean value of every column over its copies, returns the energy of
+	 *        a solution of the whole program that it derived from them, or infinity if it found none
+	 */
+	typedef std::function<double(const std::vector<double>& columnValues)> PrimalHeuristic;
+
+	/**
+	 * @param program the whole linear program
+	 * @param subproblemRows the rows of every subproblem. A row may be part of several subproblems.
+	 *        Columns that appear in no row are added to the first subproblem, and rows that are part of no subproblem
+	 *        are added to every subproblem that holds one of their columns.
+	 */
+	DualDecomposition(const LinearProgram& program, const std::vector< std::vector<size_t> >& subproblemRows);
+
+	/**
+	 * @brief Update the multipliers until the copies agree, the bounds meet or the iterations are used up
+	 * @param parameter backend, threads and stopping criteria
+	 * @param primalHeuristic turns the column values of every iteration into an upper bound
+	 * @param telemetry receives the number of iterations, solves and the bounds
+	 * @return the best lower bound, including the objective offset of the program
+	 */
+	double run(const Parameter& parameter, const PrimalHeuristic& primalHeuristic, helpers::Telemetry& telemetry);
+
+	size_t getNumSubproblems() const { return subproblems_.size(); }
+	size_t getNumSharedColumns() const { return numSharedColumns_; }
+	/// best upper bound that the primal heuristic returned in the last run()
+	double getUpperBound() const { return upperBound_; }
+
+private:
+	const LinearProgram& program_;
+	std::vector<LinearProgram> subproblems_;
+	std::vector< std::vector<size_t> > subproblemColumns_; // column of the whole program for every column of each subproblem
+	std::vector<size_t> numCopies_; // of every column of the whole program
+	size_t numSharedColumns_ = 0;
+	double upperBound_;
+};
+
+} // end namespace mht
+
+#endif // DUAL_DECOMPOSITION_H
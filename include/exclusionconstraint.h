@@ -22,10 +22,10 @@ public:
 	/**
 	 * @brief Add this constraint to the OpenGM model
 	 * 
-	 * @param model OpenGM model
+	 * @param buffer factor buffer of the OpenGM model that the segmentation hypotheses were added to
 	 * @param segmentationHypotheses the map of all segmentation hypotheses by id
 	 */
-	void addToOpenGMModel(helpers::GraphicalModelType& model, std::map<helpers::IdLabelType, SegmentationHypothesis>& segmentationHypotheses);
+	void addToOpenGMModel(helpers::FactorBuffer& buffer, const SegmentationHypothesisMap& segmentationHypotheses);
 
 	/**
 	 * @brief Check that the given solution vector obeys this exclusion constraint
@@ -33,13 +33,18 @@ public:
 	 * @param sol the opengm solution vector
 	 * @param segmentationHypotheses the map or all segmentation hypotheses by id
 	 */
-	bool verifySolution(const helpers::Solution& sol, const std::map<helpers::IdLabelType, SegmentationHypothesis>& segmentationHypotheses) const;
+	bool verifySolution(const helpers::Solution& sol, const SegmentationHypothesisMap& segmentationHypotheses) const;
 
 	/**
 	 * @brief Save this constraint as red edges in a graphviz dot graph
 	 */
 	void toDot(std::ostream& stream) const;
 
+	/**
+	 * @return the ids of the segmentation hypotheses that exclude each other
+	 */
+	const std::vector<helpers::IdLabelType>& getIds() const { return ids_; }
+
 private:
 	std::vector<helpers::IdLabelType> ids_;
 };
@@ -81,6 +81,51 @@ std::ostream& operator<<(std::ostream& stream, const std::vector<T>& feats)
 	return stream;
 }
 
+/**
+ * @brief Collects the functions and factors of some hypotheses before they are added to an OpenGM model
+ * @details The variables must have been added to the model already. Buffers of disjoint sets of hypotheses 
+ *          can be filled concurrently, as long as the model is not modified meanwhile.
+ *          Adding them to the model in a fixed order yields the same model regardless of how many threads filled them.
+ */
+class FactorBuffer
+{
+public:
+	explicit FactorBuffer(const GraphicalModelType& model):
+		model_(model)
+	{}
+
+	/// number of labels of a variable of the model the factors are meant for
+	size_t numberOfLabels(size_t variable) const { return model_.numberOfLabels(variable); }
+
+	/// add a unary factor on the given variable
+	void addFactor(LearnableUnaryFuncType function, size_t variable);
+	void addFactor(LearnableWeightedSumOfFuncType function, size_t variable);
+
+	/// add a constraint factor on the given variables, which must be sorted by id
+	void addFactor(LinearConstraintFunctionType function, const std::vector<LabelType>& variables);
+
+	/**
+	 * @brief Add all functions and factors to the model in the order they were collected, and empty the buffer
+	 */
+	void addToModel(GraphicalModelType& model);
+
+private:
+	enum FunctionKind { Unary, WeightedSum, Constraint };
+	struct Factor
+	{
+		FunctionKind kind;
+		size_t function; // index into the vector of functions of its kind
+		size_t variablesEnd; // end of its variables in variables_, they start at the end of the previous factor's
+	};
+
+	const GraphicalModelType& model_;
+	std::vector<LearnableUnaryFuncType> unaries_;
+	std::vector<LearnableWeightedSumOfFuncType> weightedSums_;
+	std::vector<LinearConstraintFunctionType> constraints_;
+	std::vector<Factor> factors_;
+	std::vector<IndexType> variables_;
+};
+
 /**
  * @brief create an indicator variable and add it to the constraint. 
  * 		  Assumes the function argument index to be the next number
@@ -91,7 +136,7 @@ std::ostream& operator<<(std::ostream& stream, const std::vector<T>& feats)
  * @param coefficient by what coefficient is the indicator variable to be multiplied
  * @param constraintShape a vector containing the number of labels of all previous variables of the constraint
  * @param factorVariables list of opengm variables that this constraint should reason about
- * @param model the opengm model
+ * @param buffer the factor buffer of the opengm model
  */
 void addOpenGMVariableToConstraint(
 	LinearConstraintFunctionType::LinearConstraintType& constraint, 
@@ -100,7 +145,7 @@ void addOpenGMVariableToConstraint(
 	double coefficient,
 	std::vector<LabelType>& constraintShape,
 	std::vector<LabelType>& factorVariables,
-	GraphicalModelType& model);
+	const FactorBuffer& buffer);
 
 /**
  * @brief add the variable's value to the constraint, not just an indicator variable
@@ -110,7 +155,7 @@ void addOpenGMVariableToConstraint(
  * @param coefficient by what coefficient is the indicator variable to be multiplied
  * @param constraintShape a vector containing the number of labels of all previous variables of the constraint
  * @param factorVariables list of opengm variables that this constraint should reason about
- * @param model the opengm model
+ * @param buffer the factor buffer of the opengm model
  */
 void addOpenGMVariableStateToConstraint(
 	LinearConstraintFunctionType::LinearConstraintType& constraint, 
@@ -118,7 +163,7 @@ void addOpenGMVariableStateToConstraint(
 	double coefficient,
 	std::vector<LabelType>& constraintShape,
 	std::vector<LabelType>& factorVariables,
-	GraphicalModelType& model);
+	const FactorBuffer& buffer);
 
 /**
  * @brief add the variable's value to the constraint, not just an indicator variable
@@ -126,13 +171,13 @@ void addOpenGMVariableStateToConstraint(
  * @param constraint the constraint function to add to the model
  * @param constraintShape a vector containing the number of labels of all variables of the constraint
  * @param factorVariables list of opengm variables that this constraint should reason about
- * @param model the opengm model
+ * @param buffer the factor buffer of the opengm model
  */
 void addConstraintToOpenGMModel(
 	LinearConstraintFunctionType::LinearConstraintType& constraint, 
 	std::vector<LabelType>& constraintShape,
 	std::vector<LabelType>& factorVariables,
-	GraphicalModelType& model);
+	FactorBuffer& buffer);
 
 // --------------------------------------------------------------
 // json type definitions
@@ -154,12 +199,16 @@ enum class JsonTypes {Segmentations,
 	Id, 
 	Children,
 	Parent,
+	Offsets,
+	Indices,
 	Features, 
 	DivisionFeatures,
 	AppearanceFeatures,
 	DisappearanceFeatures,
+	Timestep,
 	Weights,
 	ResultEnergy,
+	Telemetry,
 	// settings-related
 	Settings,
 	StatesShareWeights,
@@ -170,6 +219,20 @@ enum class JsonTypes {Segmentations,
 	AllowLengthOneTracks,
 	RequireSeparateChildrenOfDivision,
 	NonNegativeWeightsOnly,
+	DecomposeIntoComponents,
+	ComponentNumThreads,
+	UseFlowSolver,
+	SlidingWindowSize,
+	SlidingWindowStep,
+	SolverBackend,
+	GreedyWarmStart,
+	Presolve,
+	BuildNumThreads,
+	SolutionCacheDirectory,
+	SolutionCacheSize,
+	DualDecompositionChunkSize,
+	DualDecompositionOverlap,
+	DualDecompositionIterations,
 };
 
 /// mapping from JsonTypes to strings which are used in the Json files
@@ -205,6 +268,18 @@ std::vector<ValueType> readWeightsFromJson(const std::string& filename);
  */
 StateFeatureVector extractFeatures(const Json::Value& entry, JsonTypes type);
 
+class JsonStreamReader;
+
+/**
+ * @brief Read a list of detection/division/disapperance/appearance features for each state from a JSON stream
+ * 
+ * @param reader the reader, positioned at the value of the features member
+ * @param type the type of feature to extract (only used for error messages)
+ * 
+ * @return a vector of FeatureVectors, one for each state the variable can take
+ */
+StateFeatureVector extractFeatures(JsonStreamReader& reader, JsonTypes type);
+
 }
 
 #endif
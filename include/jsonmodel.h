@@ -8,14 +8,13 @@
 
 #include <json/json.h>
 #include "model.h"
+#include "jsonstreamreader.h"
 
 namespace mht
 {
 
 /**
  * @brief Model specialized for Json loading and writing
- * @detail WARNING: at the moment you can only run either learn or infer once on the model. 
- *         Build a new one if you need it multiple times
  */
 class JsonModel : public Model
 {
@@ -42,6 +41,11 @@ public:
      */
     void setJsonGtFile(const std::string& filename);
 
+    /**
+     * @return whether a ground truth file has been set with setJsonGtFile()
+     */
+    bool hasJsonGtFile() const { return !groundTruthFilename_.empty(); }
+
     /**
      * @brief get the ground truth for learning from a JSON file
      * @return the solution vector that fits the initialized OpenGM model
@@ -54,9 +58,9 @@ private:
      * @details expects the json value to contain attributes "src"(helpers::IdLabelType), 
      *  "dest"(helpers::IdLabelType), and "features"(list of double)
      * 
-     * @param entry json object for this hypothesis
+     * @param reader positioned at the json object for this hypothesis, which will be consumed
      */
-    void readLinkingHypothesis(const Json::Value& entry);
+    void readLinkingHypothesis(helpers::JsonStreamReader& reader);
 
     /**
      * @brief read segmentation hypothesis from Json and adds it to segmentationHypotheses_
@@ -65,24 +69,24 @@ private:
      *          the presence of the latter two toggles the presence of an appearance or disappearance node.
      *          Hypotheses which do not have these, are not allowed to appear/disappear!
      * 
-     * @param entry json object for this hypothesis
+     * @param reader positioned at the json object for this hypothesis, which will be consumed
      */
-    void readSegmentationHypothesis(const Json::Value& entry);
+    void readSegmentationHypothesis(helpers::JsonStreamReader& reader);
 
     /**
      * @brief read division hypothesis from Json
      *
-     * @param entry json object for this hypothesis
+     * @param reader positioned at the json object for this hypothesis, which will be consumed
      */
-    void readDivisionHypothesis(const Json::Value& entry);
+    void readDivisionHypothesis(helpers::JsonStreamReader& reader);
 
     /**
      * @brief read exclusion constraint from Json
      * @details expects the json array to be a list of ints representing ids
      * 
-     * @param entry json object for this hypothesis
+     * @param reader positioned at the json array of this constraint, which will be consumed
      */
-    void readExclusionConstraints(const Json::Value& entry);
+    void readExclusionConstraints(helpers::JsonStreamReader& reader);
 
     /**
      * @brief Create a json string describing this link with its value (for result saving)
@@ -90,7 +94,7 @@ private:
      * @param state the state that this link has (will be saved as "value" in JSON)
      * @return the Json value to put in an array into the result file
      */
-    const Json::Value linkToJson(const std::shared_ptr<LinkingHypothesis>& link, size_t state) const;
+    const Json::Value linkToJson(const LinkingHypothesis& link, size_t state) const;
 
     /**
      * @brief Create a json string describing this division with its value (for result saving)
@@ -98,7 +102,7 @@ private:
      * @param state the state that this division has (will be saved as "value" in JSON)
      * @return the Json value to put in an array into the result file
      */
-    const Json::Value divisionToJson(const std::shared_ptr<DivisionHypothesis>& division, size_t state) const;
+    const Json::Value divisionToJson(const DivisionHypothesis& division, size_t state) const;
 
     /**
      * @brief Create json value containing the state of this division, linked to this detection's id
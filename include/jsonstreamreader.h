@@ -0,0 +1,123 @@
+#ifndef JSON_STREAM_READER_H
+#define JSON_STREAM_READER_H
+
+#include <istream>
+#include <string>
+#include <vector>
+
+#include <json/json.h>
+#include "helpers.h"
+
+namespace helpers
+{
+
+/**
+ * @brief Pull parser that reads a JSON document token by token from a stream.
+ * @details In contrast to parsing with jsoncpp, no document tree is built. Objects and arrays are walked
+ *          with beginObject()/nextMember() and beginArray()/nextElement(), and values are read as they stream past,
+ *          so the memory needed is independent of the size of the file.
+ *          Comments (// and C-style) are skipped like jsoncpp does.
+ *          Scalar conversions follow jsoncpp's asDouble()/asUInt()/asBool(), so files that worked before still do.
+ *
+ *          Example:
+ *          reader.beginObject();
+ *          while(reader.nextMember(key))
+ *              if(key == "weights") ... else reader.skipValue();
+ */
+class JsonStreamReader
+{
+public:
+	enum class TokenType {Object, Array, String, Number, Bool, Null, EndOfInput};
+
+	/**
+	 * @brief Read from the given stream, which must stay valid as long as this reader is used
+	 */
+	JsonStreamReader(std::istream& input);
+
+	/**
+	 * @return the type of the next value, without consuming it
+	 */
+	TokenType peek();
+
+	/**
+	 * @brief Consume the opening brace of an object
+	 */
+	void beginObject();
+
+	/**
+	 * @brief Advance to the next member of the current object
+	 *
+	 * @param key will be set to the name of the member, whose value has to be read or skipped next
+	 * @return false if the object is finished, in which case the closing brace has been consumed
+	 */
+	bool nextMember(std::string& key);
+
+	/**
+	 * @brief Consume the opening bracket of an array
+	 */
+	void beginArray();
+
+	/**
+	 * @brief Advance to the next element of the current array, which has to be read or skipped next
+	 * @return false if the array is finished, in which case the closing bracket has been consumed
+	 */
+	bool nextElement();
+
+	std::string readString();
+	double readDouble();
+	unsigned int readUInt();
+	bool readBool();
+
+	/**
+	 * @brief Read an id of a segmentation hypothesis, which is a string or an unsigned number depending on USE_STRING_IDS
+	 */
+	IdLabelType readId();
+
+	/**
+	 * @brief Skip the next value, including all nested objects and arrays
+	 */
+	void skipValue();
+
+	/**
+	 * @brief Read the next value into a jsoncpp tree, only meant for small parts of the document like the settings
+	 */
+	Json::Value readValue();
+
+	/**
+	 * @brief Throw a std::runtime_error that mentions the current line
+	 */
+	void error(const std::string& message) const;
+
+private:
+	/**
+	 * @return next character that is not whitespace or part of a comment, without consuming it, or -1 at the end
+	 */
+	int peekChar();
+
+	/**
+	 * @return next raw character, consuming it, or -1 at the end
+	 */
+	int getRawChar();
+	int peekRawChar();
+
+	void expect(char c);
+	void expectLiteral(const char* literal);
+	void skipComment();
+	void appendUtf8(std::string& result, unsigned int codePoint);
+	unsigned int readHexQuad();
+	std::string readNumberToken();
+
+private:
+	std::istream& input_;
+	std::vector<char> buffer_;
+	size_t bufferPosition_;
+	size_t bufferSize_;
+	size_t line_;
+
+	// for each open object or array whether its first member/element is still to come
+	std::vector<bool> isFirstStack_;
+};
+
+} // end namespace helpers
+
+#endif // JSON_STREAM_READER_H
@@ -0,0 +1,53 @@
+#ifndef LOSS_AUGMENTED_ORACLE_H
+#define LOSS_AUGMENTED_ORACLE_H
+
+#include <vector>
+#include <memory>
+
+#include "helpers.h"
+#include "mipinference.h"
+#include "telemetry.h"
+
+namespace mht
+{
+
+/**
+ * @brief Oracle of the bundle method in structured learning, which runs the loss augmented inference of all instances concurrently
+ * @details Computes the same value and gradient as the oracle of OpenGM's StructMaxMargin,
+ *          max_y E(y',w) - E(y,w) + loss(y',y) summed over all instances of the dataset with ground truths y'.
+ *          Every instance is solved by its own MipInference on a pool of numThreads workers. Each worker has its own
+ *          solver backend (and thus e.g. Gurobi environment), which is created once and reused by all calls. The value and gradient of each instance are kept apart and summed up
+ *          in the order of the instances, so the result does not depend on the number of threads.
+ *          The most violated labeling of an instance is the starting point of its next solve.
+ */
+class LossAugmentedOracle
+{
+public:
+	/**
+	 * @param dataset the learning dataset, whose weights are set to the weights of every call
+	 * @param parameter parameter of the MipInference that solves each instance
+	 * @param numThreads number of instances that are solved concurrently, 0 for all CPU cores
+	 * @param telemetry receives the number of oracle calls and solves
+	 */
+	LossAugmentedOracle(helpers::DatasetType& dataset,
+						const MipInference::Parameter& parameter,
+						size_t numThreads,
+						helpers::Telemetry& telemetry);
+
+	/**
+	 * @brief Evaluate the structured loss and its gradient at the given weights, as called by OpenGM's BundleOptimizer
+	 */
+	void operator()(const helpers::WeightsType& weights, double& value, helpers::WeightsType& gradient);
+
+private:
+	helpers::DatasetType& dataset_;
+	MipInference::Parameter parameter_;
+	size_t numThreads_;
+	helpers::Telemetry& telemetry_;
+	std::vector<helpers::Solution> mostViolated_; // of the previous call, per instance
+	std::vector< std::unique_ptr<SolverBackend> > backends_; // per worker, see helpers::parallelForWorkers()
+};
+
+} // end namespace mht
+
+#endif // LOSS_AUGMENTED_ORACLE_H
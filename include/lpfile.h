@@ -0,0 +1,38 @@
+#ifndef LP_FILE_H
+#define LP_FILE_H
+
+#include <string>
+#include <vector>
+
+#include "solverbackend.h"
+
+namespace mht
+{
+
+/**
+ * @brief Write a linear program with binary columns to a file that external solvers can read
+ * @details The format is chosen by the extension: ".mps" writes free MPS, anything else CPLEX LP format.
+ *          Columns and rows are written with their names if the program has them, otherwise as x<column> and c<row>.
+ *          The objective offset is only written as a comment, because not all solvers accept a constant in the objective.
+ *
+ * @param program linear program whose columns are all binary
+ * @param filename output filename
+ */
+void writeLinearProgram(const LinearProgram& program, const std::string& filename);
+
+/**
+ * @brief Read the column values of a solution file written by an external solver
+ * @details The reader does not depend on one solver's format: every token that is the name of a column
+ *          and is followed by a number sets that column. This covers the solution files of Gurobi (.sol), HiGHS,
+ *          SCIP and CBC, and the name/value attributes of CPLEX's XML solutions.
+ *          Columns that are not mentioned are zero, as some solvers only write nonzero values.
+ *
+ * @param program the program that was written with writeLinearProgram()
+ * @param filename solution file
+ * @return one value per column, throws if the file does not mention any column of the program
+ */
+std::vector<double> readLinearProgramSolution(const LinearProgram& program, const std::string& filename);
+
+} // end namespace mht
+
+#endif // LP_FILE_H
@@ -0,0 +1,102 @@
+#ifndef MIN_COST_FLOW_H
+#define MIN_COST_FLOW_H
+
+#include <vector>
+#include <cstddef>
+
+namespace mht
+{
+
+/**
+ * @brief A min-cost-flow solver on a directed graph where every arc has capacity one.
+ * @details Uses successive shortest paths: initial node potentials are found with Bellman-Ford
+ *          (arc costs may be negative), afterwards every augmenting path is found with Dijkstra on the reduced costs.
+ *          The amount of flow is not fixed, paths from source to target are augmented as long as they decrease the cost.
+ *          This solves tracking models that are pure flow problems without an ILP solver.
+ */
+class MinCostFlow
+{
+public:
+	/**
+	 * @brief Create a graph with the given number of nodes and no arcs
+	 */
+	MinCostFlow(size_t numNodes);
+
+	/**
+	 * @brief Add an arc with capacity one
+	 *
+	 * @param from source node of the arc
+	 * @param to target node of the arc
+	 * @param cost the cost of sending one unit of flow along this arc
+	 * @return the index of the arc
+	 */
+	size_t addArc(size_t from, size_t to, double cost);
+
+	/**
+	 * @brief Find the flow of minimal cost from source to target
+	 *
+	 * @param source node where the flow starts
+	 * @param target node where the flow ends
+	 * @return false if the graph contains a cycle of negative cost, which successive shortest paths cannot handle
+	 */
+	bool solve(size_t source, size_t target);
+
+	/**
+	 * @return whether the arc with the given index carries flow after solve()
+	 */
+	bool hasFlow(size_t arc) const { return flow_.at(arc); }
+
+	/**
+	 * @return the total cost of the found flow
+	 */
+	double getCost() const { return cost_; }
+
+	/**
+	 * @return the number of paths that were augmented by solve()
+	 */
+	size_t getNumPaths() const { return numPaths_; }
+
+private:
+	/**
+	 * @brief Compute shortest path distances from the source with Bellman-Ford to initialize the potentials
+	 * @return false if a negative cycle is reachable from the source
+	 */
+	bool initializePotentials(size_t source);
+
+	/**
+	 * @brief Find a shortest path in the residual graph using Dijkstra on reduced costs
+	 * @return false if the target is not reachable
+	 */
+	bool findShortestPath(size_t source, size_t target);
+
+	/**
+	 * @return cost of a residual arc: arcs are stored at 2*arc, their reverse arcs at 2*arc+1
+	 */
+	double getResidualCost(size_t residualArc) const;
+
+	/**
+	 * @return whether the residual arc can take flow
+	 */
+	bool hasResidualCapacity(size_t residualArc) const;
+
+private:
+	size_t numNodes_;
+	std::vector<size_t> arcSources_;
+	std::vector<size_t> arcTargets_;
+	std::vector<double> arcCosts_;
+	std::vector<bool> flow_;
+
+	// residual arcs leaving each node
+	std::vector< std::vector<size_t> > outgoingResidualArcs_;
+
+	std::vector<double> potentials_;
+	std::vector<double> distances_;
+	std::vector<size_t> predecessorArcs_;
+
+	double cost_;
+	size_t numPaths_;
+};
+
+} // end namespace mht
+
+#endif // MIN_COST_FLOW_H
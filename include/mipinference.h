@@ -0,0 +1,88 @@
+#ifndef MIP_INFERENCE_H
+#define MIP_INFERENCE_H
+
+#include <memory>
+
+#include <opengm/inference/inference.hxx>
+
+#include "helpers.h"
+#include "solverbackend.h"
+
+namespace mht
+{
+
+/**
+ * @brief OpenGM inference that solves a tracking model as (integer) linear program with a SolverBackend
+ * @details Every OpenGM variable gets one indicator column per label, and each variable must take exactly one label.
+ *          Unary factors become the costs of the indicator columns, linear constraint factors become rows.
+ *          This is the same formulation as OpenGM's LPGurobi2 with a tight polytope, restricted to the factors
+ *          that the tracking models consist of, which lets the learner use any backend for loss augmented inference as well.
+ */
+class MipInference : public opengm::Inference<helpers::GraphicalModelType, opengm::Minimizer>
+{
+public:
+	typedef helpers::GraphicalModelType GraphicalModelType;
+	typedef helpers::LabelType LabelType;
+	typedef helpers::ValueType ValueType;
+
+	struct Parameter
+	{
+		std::string backend_; // name of the SolverBackend, see helpers::Settings::solverBackend_, if none is given to the constructor
+		double epGap_ = 0.01;
+		size_t numberOfThreads_ = 1;
+		bool verbose_ = false;
+		bool integerConstraints_ = true;
+	};
+
+	/**
+	 * @brief Build the linear program of the given model, throws for factors that cannot be expressed linearly
+	 * @details Creates a solver backend of the given name, which only lives as long as this object
+	 */
+	MipInference(const GraphicalModelType& model, const Parameter& parameter);
+
+	/**
+	 * @brief Build the linear program of the given model, which is solved by the given backend
+	 * @details Creating a backend can be expensive (e.g. a Gurobi environment checks the license), 
+	 *          so repeated solves should share one that outlives this object. It must not solve anything else meanwhile.
+	 */
+	MipInference(const GraphicalModelType& model, const Parameter& parameter, SolverBackend& backend);
+
+	virtual std::string name() const;
+	virtual const GraphicalModelType& graphicalModel() const;
+	virtual opengm::InferenceTermination infer();
+	virtual opengm::InferenceTermination arg(std::vector<LabelType>& labeling, const size_t n = 1) const;
+	virtual ValueType value() const;
+	virtual ValueType bound() const;
+
+	/**
+	 * @brief Pass a labeling of all variables to the solver as starting point of the next infer()
+	 */
+	virtual void setStartingPoint(std::vector<LabelType>::const_iterator begin);
+
+	/**
+	 * @brief Values of the indicator columns of a variable, which may be fractional if integerConstraints_ is off
+	 */
+	std::vector<double> getIndicatorValues(size_t variable) const;
+
+	const LinearProgram& getLinearProgram() const { return program_; }
+
+	/// column values and statistics of the last infer()
+	const SolverResult& getSolverResult() const { return result_; }
+
+private:
+	void buildLinearProgram();
+
+	const GraphicalModelType& model_;
+	Parameter parameter_;
+	std::unique_ptr<SolverBackend> ownedBackend_; // only if no backend was given to the constructor
+	SolverBackend& backend_;
+	LinearProgram program_;
+	std::vector<size_t> variableOffsets_; // first column of every OpenGM variable
+	std::vector<double> start_;
+	SolverResult result_;
+	bool solved_;
+};
+
+} // end namespace mht
+
+#endif // MIP_INFERENCE_H
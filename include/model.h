@@ -4,25 +4,67 @@
 #include <memory>
 #include <vector>
 #include <map>
+#include <functional>
+#include <limits>
+#include <unordered_set>
+#include <unordered_map>
 
 #include "segmentationhypothesis.h"
 #include "linkinghypothesis.h"
 #include "exclusionconstraint.h"
 #include "divisionhypothesis.h"
 #include "helpers.h"
+#include "densestorage.h"
 #include "settings.h"
+#include "telemetry.h"
+#include "mipinference.h"
 
 namespace mht
 {
 
+/**
+ * @brief A subset of the hypotheses of a model that can be turned into an OpenGM model of its own, 
+ *        e.g. a connected component of the tracking graph
+ * @details Hypotheses are referenced by pointers into the containers of the model, 
+ *          so a subgraph is only valid as long as the model's hypotheses are not modified.
+ */
+struct Subgraph
+{
+	std::vector<SegmentationHypothesis*> segmentations_;
+	std::vector<LinkingHypothesis*> links_;
+	std::vector<DivisionHypothesis*> divisions_;
+	std::vector<ExclusionConstraint*> exclusions_;
+};
+
+/**
+ * @brief Solution of the LP relaxation of the tracking ILP, see Model::inferRelaxation()
+ * @details Variables are indexed by their OpenGM variable id in the layout of the full model.
+ */
+struct Relaxation
+{
+	std::vector< std::vector<double> > stateValues_; // fractional value of every state of every variable, they sum up to one
+	std::vector<double> values_; // expected state of every variable, e.g. the fractional number of objects in a detection
+	helpers::Solution largestStates_; // state of the largest value of every variable, not necessarily a valid tracking
+	double lowerBound_ = -std::numeric_limits<double>::infinity(); // energy of the relaxation, no tracking has a lower one
+	size_t numFractional_ = 0; // number of variables with a state value that is neither 0 nor 1
+	double maxFractionality_ = 0.0; // largest distance of a state value from 0 or 1, 0 if the relaxation is integral
+	helpers::Solution rounded_; // a valid tracking found by rounding and repair, empty if not requested
+	double roundedEnergy_ = std::numeric_limits<double>::infinity();
+};
+
 /**
  * @brief The model holds all detections and their links, as well as exclusion constraints between detections
- * @detail WARNING: at the moment you can only run either learn or infer once on the model. 
- * 		   Build a new one if you need it multiple times
+ * @detail infer() can be called repeatedly with different weights, the OpenGM model is only built once for that.
+ * 		   learn() builds its own OpenGM model, after which infer() builds a new one.
+ * 		   Hypotheses are stored by value in flat arrays, and segmentations refer to their links and divisions
+ * 		   by pointers into them, so a model must not be copied.
  */
 class Model
 {
 public:	
+	/// called for every timestep that has been committed by inferSlidingWindow()
+	typedef std::function<void(int timestep, const helpers::Solution& solution)> FrameCallback;
+
 	/**
 	 * @return the number of weights which is estimated by checking how many features are given for detections, links and divisions
 	 */
@@ -30,12 +72,226 @@ public:
 	
 	/**
 	 * @brief Find the minimal-energy configuration using an ILP
+	 * @details If the settings ask to decompose the model into components, every connected component 
+	 *          is built and solved as its own ILP (see findConnectedComponents()).
+	 *          If a sliding window size is set in the settings, inferSlidingWindow() is used,
+	 *          and if a dual decomposition chunk size is set, inferDualDecomposition().
+	 *          Models that are pure flow problems (see isFlowProblem()) are solved as min-cost-flow without an ILP,
+	 *          unless disabled in the settings. Otherwise, if presolve is enabled in the settings, 
+	 *          inferPresolved() leaves the hypotheses that cannot be active out of the ILP.
+	 *          If a solution cache is configured (see setSolutionCache()), a solution that was found before 
+	 *          for the same hypotheses, settings and weights is returned without solving anything.
 	 * @param weights a vector of weights to use
-	 * @param withIntegerConstraints set to false if you just want the LP relaxation. Don't expect the solution to work in the rest of the code!
+	 * @param withIntegerConstraints set to false if you just want the LP relaxation, whose largest state per variable is returned. 
+	 *        Don't expect the solution to work in the rest of the code, inferRelaxation() also finds a valid tracking!
 	 * @return the vector of per-variable labels, can be used with the detection/linking hypotheses to query their state
 	 */
 	helpers::Solution infer(const std::vector<helpers::ValueType>& weights, bool withIntegerConstraints = true);
 
+	/**
+	 * @brief Keep the solutions of infer() in the given directory, to return them again when the same model 
+	 *        is solved with the same weights, also by other processes
+	 * @details This sets the solutionCacheDirectory and solutionCacheSize settings. The cache key is a hash of
+	 *          the hypotheses with their features in the order they were read, the exclusions, the settings that 
+	 *          influence the result and the weights. LP relaxations are never cached.
+	 * @param directory directory of the cache, which is created if necessary, or empty to disable the cache
+	 * @param maxEntries the least recently used solutions beyond this number are removed, 0 for unlimited
+	 */
+	void setSolutionCache(const std::string& directory, size_t maxEntries = 0);
+
+	/**
+	 * @brief Limit the threads of this model, e.g. when several models are solved at the same time
+	 * @details Caps the buildNumThreads and componentNumThreads settings at numThreads, and optimizerNumThreads 
+	 *          such that the concurrently solved components do not use more than numThreads solver threads together.
+	 * @param numThreads maximal number of threads, at least 1
+	 */
+	void limitNumThreads(size_t numThreads);
+
+	/**
+	 * @brief Find the minimal-energy configuration using an ILP that starts from the given labeling
+	 * @details The start replaces the solution of the previous call as MIP start, for the full model 
+	 *          as well as for the components if the model is decomposed. It is ignored if it does not have
+	 *          a state for every variable or if verifySolution() rejects it, and by the min-cost-flow solver.
+	 *          Ignored starts are counted by the start.ignored telemetry counter, and solves that got a starting point by solver.startingPoints.
+	 *          Throws if a sliding window size is set in the settings, as the windows are solved from scratch.
+	 * @param weights a vector of weights to use
+	 * @param start labeling in the layout of the full model, e.g. a previous result read by getGroundTruth() or constructGreedySolution()
+	 * @return the vector of per-variable labels
+	 */
+	helpers::Solution infer(const std::vector<helpers::ValueType>& weights, const helpers::Solution& start);
+
+	/**
+	 * @brief Build a valid labeling quickly, to be used as starting point of the ILP
+	 * @details Links are accepted greedily by how much they save compared to ending a track at their source 
+	 *          and starting a new one at their target, as long as every detection keeps at most one predecessor and successor.
+	 *          Of each of the resulting chains, the contiguous part of lowest energy that can appear at its start and 
+	 *          disappear at its end becomes a track of one object, if it lowers the energy. These tracks are activated 
+	 *          from the cheapest on, skipping those that contain a detection excluded by an active one. 
+	 *          Divisions and mergers are never used. Runs in O(L log L) for L links, the OpenGM model does not need to be built.
+	 *          The "greedyWarmStart" setting lets infer() use this whenever there is no previous solution to start from.
+	 * @param weights the weight vector
+	 * @return the labeling in the layout of the full model
+	 */
+	helpers::Solution constructGreedySolution(const std::vector<helpers::ValueType>& weights);
+
+	/**
+	 * @brief Find a good configuration quickly without an ILP, e.g. for previews
+	 * @details Repeatedly finds the cheapest paths from an appearance over links to a disappearance by dynamic programming 
+	 *          over the detections in topological order, and adds them as long as they lower the energy. Paths may also begin 
+	 *          at the end of a track found before and end at the start of one, which joins tracks. Tracks may share 
+	 *          detections and links that can take more than one object, but never use a detection excluded by an active one, 
+	 *          and obey the same flow, length-one-track and transition constraints as verifySolution(). Afterwards, active detections 
+	 *          divide if taking over tracks that appear right after them lowers the energy. The links must not form cycles.
+	 *          The energy is available from getLastSolutionValue() and equals evaluateSolution() of the returned labeling.
+	 * @param weights the weight vector
+	 * @param computeLowerBound whether to solve the LP relaxation as well, whose energy is a lower bound of the optimum
+	 *        and available from getLastLowerBound(). This builds the OpenGM model and needs a solver backend.
+	 * @return the labeling in the layout of the full model
+	 */
+	helpers::Solution inferApproximate(const std::vector<helpers::ValueType>& weights, bool computeLowerBound = false);
+
+	/**
+	 * @brief Solve the LP relaxation of the tracking ILP, which is much faster than the ILP, and optionally round it to a valid tracking
+	 * @details The relaxation reports its energy, which is a lower bound of the optimum, and how far it is from integral.
+	 *          Tracking models are often integral or nearly so. Rounding takes the largest state of every variable if that 
+	 *          is a valid tracking, and repairs it otherwise: the paths of inferApproximate() are searched with the energies 
+	 *          lowered by the fractional values times more than any energy difference, so that the tracks supported by 
+	 *          the relaxation are taken first and conflicts between them are resolved greedily. The better valid labeling is kept,
+	 *          its energy is available from getLastSolutionValue() and the bound from getLastLowerBound().
+	 *          The repair needs links without cycles, like inferApproximate().
+	 * @param weights the weight vector
+	 * @param round whether to find a valid tracking as well
+	 */
+	Relaxation inferRelaxation(const std::vector<helpers::ValueType>& weights, bool round = true);
+
+	/**
+	 * @brief Find the minimal-energy configuration for each of a sequence of weight vectors
+	 * @details The OpenGM model (or the component models) is built once and refers to a weights object
+	 *          that is updated in place, so only the solver has to run again for each weight vector.
+	 *          Every solve is warm-started from the solution found for the previous weights.
+	 * @param weightSequence list of weight vectors, each as expected by infer()
+	 * @param energies will be filled with the energy of each solution
+	 * @return one solution per weight vector
+	 */
+	std::vector<helpers::Solution> inferWithWeightSequence(const std::vector< std::vector<helpers::ValueType> >& weightSequence, 
+														   std::vector<double>& energies);
+
+	/**
+	 * @brief Track in a window of timesteps that slides over the sequence, instead of solving the whole model at once
+	 * @details Only the hypotheses of windowSize consecutive timesteps are built into an OpenGM model and solved.
+	 *          Then the oldest stepSize timesteps are committed: the states of their detection, division, appearance
+	 *          and disappearance variables and of their incoming links are fixed, and the window moves on.
+	 *          Links and divisions that leave committed timesteps stay free in the next window,
+	 *          but have to carry exactly the flow that the committed hypotheses still need to send or receive.
+	 *          All segmentation hypotheses need a timestep, links and divisions must point forward in time, 
+	 *          and exclusion constraints may only connect hypotheses of the same timestep.
+	 * 
+	 * @param weights the weight vector
+	 * @param windowSize number of timesteps that are solved together
+	 * @param stepSize number of timesteps that are committed before the window moves on, between 1 and windowSize
+	 * @param frameCallback if set, it is called for every committed timestep in order. The given solution 
+	 *        (in the layout of the full model) holds the final states of all hypotheses of that and earlier timesteps,
+	 *        only links and divisions leaving these timesteps may still change.
+	 * @return the solution in the layout of the full model
+	 */
+	helpers::Solution inferSlidingWindow(const std::vector<helpers::ValueType>& weights, 
+										 size_t windowSize, 
+										 size_t stepSize = 1, 
+										 FrameCallback frameCallback = FrameCallback());
+
+	/**
+	 * @brief Track by dual decomposition of the ILP along the time axis, where chunks of timesteps are solved concurrently
+	 * @details The rows of buildLinearProgram() are split into chunks of chunkSize consecutive timesteps, the rows of the 
+	 *          first overlap timesteps of every chunk are part of the previous chunk as well. Links, divisions and exclusions 
+	 *          between chunks are shared: each chunk solves its own copy of their variables, and Lagrange multipliers on 
+	 *          the copies are updated by DualDecomposition until all copies agree, the bounds meet within the optimizer gap,
+	 *          or the dualDecompositionIterations setting is used up. The chunks are solved by the selected solver backend
+	 *          on componentNumThreads workers, each chunk is only as large as its timesteps, so the work per iteration grows 
+	 *          linearly with the length of the movie. In every iteration, the mean values of the copies are rounded and 
+	 *          repaired as in inferRelaxation(), and the best valid labeling is returned.
+	 *          The sum of the chunk optima is a lower bound of the optimum, available from getLastLowerBound(),
+	 *          and the energy of the returned labeling from getLastSolutionValue().
+	 *          All segmentation hypotheses need a timestep, and the links must not form cycles for the repair.
+	 *
+	 * @param weights the weight vector
+	 * @param chunkSize number of timesteps per chunk
+	 * @param overlap number of timesteps that two consecutive chunks have in common
+	 * @return the best valid labeling that was found, in the layout of the full model
+	 */
+	helpers::Solution inferDualDecomposition(const std::vector<helpers::ValueType>& weights, 
+											 size_t chunkSize, 
+											 size_t overlap = 0);
+
+	/**
+	 * @brief Add a segmentation hypothesis to a model that has been read already, e.g. while proofreading
+	 * @details Like all edits, this only updates the hypotheses and the adjacency of those it touches. The next infer() 
+	 *          starts from the previous solution, whose states stay with the hypotheses that were not removed, and new 
+	 *          hypotheses start in state 0. If that start violates constraints after the edits, it is repaired as in inferRelaxation().
+	 *          Added hypotheses come last, so they get the last variable ids and come last in the results.
+	 *          Only the hypotheses are edited incrementally: without decomposeIntoComponents, the next infer() builds and 
+	 *          solves the whole OpenGM model again. With decomposeIntoComponents, only the components that contain 
+	 *          an edited hypothesis are rebuilt and solved again, the others keep their models and solutions.
+	 *          Throws if a hypothesis with that id exists already.
+	 */
+	void addSegmentationHypothesis(const SegmentationHypothesis& segmentation);
+
+	/**
+	 * @brief Add a link between two existing segmentation hypotheses, see addSegmentationHypothesis()
+	 */
+	void addLinkingHypothesis(const LinkingHypothesis& link);
+
+	/**
+	 * @brief Add a division of an existing parent into two existing children, see addSegmentationHypothesis()
+	 */
+	void addDivisionHypothesis(const DivisionHypothesis& division);
+
+	/**
+	 * @brief Let the given segmentation hypotheses exclude each other, see addSegmentationHypothesis()
+	 */
+	void addExclusionConstraint(const std::vector<helpers::IdLabelType>& ids);
+
+	/**
+	 * @brief Remove a segmentation hypothesis together with its links and divisions, and from all exclusion constraints
+	 * @details Every removed hypothesis is replaced by the last one of its kind, which takes its place in the storage, 
+	 *          so a removal takes time in the number of adjacent hypotheses and exclusion constraints, not of all hypotheses.
+	 *          Removals thus reorder the remaining hypotheses: the variable ids of the moved ones change, and so does 
+	 *          the order of the results. See addSegmentationHypothesis().
+	 */
+	void removeSegmentationHypothesis(const helpers::IdLabelType& id);
+
+	/**
+	 * @brief Remove a link, which is replaced by the last link as in removeSegmentationHypothesis()
+	 */
+	void removeLinkingHypothesis(const helpers::IdLabelType& srcId, const helpers::IdLabelType& destId);
+
+	/**
+	 * @brief Remove a division, which is replaced by the last division as in removeSegmentationHypothesis()
+	 */
+	void removeDivisionHypothesis(const helpers::IdLabelType& parentId, const std::vector<helpers::IdLabelType>& childrenIds);
+
+	/**
+	 * @brief Allow every pair of the given segmentation hypotheses to be active at the same time, 
+	 *        splitting the exclusion constraints that contain more than one of them
+	 */
+	void removeExclusionConstraint(const std::vector<helpers::IdLabelType>& ids);
+
+	/**
+	 * @brief Force the detection variable of a segmentation hypothesis into the given state in all following solves,
+	 *        or release it again with a negative state, see addSegmentationHypothesis()
+	 * @details Fixed states are constraints of the OpenGM models and the linear program. The flow solver and presolve 
+	 *          are not used while any variable is fixed. Throws if the variable is not part of the model or lacks the state.
+	 */
+	void fixDetection(const helpers::IdLabelType& id, int state);
+
+	/**
+	 * @brief Fix the division variable of a segmentation hypothesis, see fixDetection()
+	 */
+	void fixDivision(const helpers::IdLabelType& id, int state);
+
+	void fixLink(const helpers::IdLabelType& srcId, const helpers::IdLabelType& destId, int state);
+
+	void fixExternalDivision(const helpers::IdLabelType& parentId, const std::vector<helpers::IdLabelType>& childrenIds, int state);
+
 	/**
 	 * @brief Run learning using a given ground truth file and initial weights
 	 * @details Loads the ground truth using getGroundTruth() and learns the best weights using Structured Bundled Risk Minimization
@@ -52,6 +308,24 @@ public:
 	 */
 	std::vector<helpers::ValueType> learn();
 
+	/**
+	 * @brief Run learning on several annotated models at once, e.g. one per movie or crop
+	 * @details Every model becomes its own instance of the learning dataset and all of them share one weight vector,
+	 *          so learning scales with the number of annotated models instead of the size of one merged graph.
+	 *          The OpenGM models are built and the ground truths loaded concurrently, by as many threads as
+	 *          componentNumThreads of the first model's settings, which also provides the learning and solver settings.
+	 *          Models with decomposeIntoComponents enabled add one instance per connected component, 
+	 *          and build only the component models, not the full one. The models built for learning are discarded afterwards.
+	 *          In every iteration of the learner, the loss augmented inference of all instances runs concurrently 
+	 *          on componentNumThreads threads as well, see LossAugmentedOracle.
+	 *          All models must have the same number of weights.
+	 *
+	 * @param models the models, each able to provide its ground truth by getGroundTruth()
+	 * @param weights initial weights
+	 * @return the vector of learned weights
+	 */
+	static std::vector<helpers::ValueType> learnFromInstances(const std::vector<Model*>& models, const std::vector<helpers::ValueType>& weights);
+
 	/**
 	 * @brief check that the solution does not violate any constraints
 	 * @detail WARNING: may only be used after calling initializeOpenGMModel(), learn() or infer() because it needs an initialized opengm model!
@@ -63,8 +337,9 @@ public:
 
 	/**
 	 * @brief Return the energy of the given solution vector
-	 * @detail WARNING: may only be used after calling initializeOpenGMModel(), because it needs an initialized opengm model!
-	 * @detail WARNING: the weights object that the model refers to must still be available, as well!
+	 * @details Sums the state energies of all variables with the weights of the last call to infer() or initializeOpenGMModel(),
+	 *          so it does not depend on which inference path built which OpenGM model. Constraints are not checked, see verifySolution().
+	 * @detail WARNING: the weights object given to initializeOpenGMModel() must still be available!
 	 * 
 	 * @param sol solution vector
 	 * @return energy of the system in this solution
@@ -76,6 +351,18 @@ public:
 	 */
 	double getLastSolutionValue() const;
 
+	/**
+	 * @brief Return the lower bound computed by the last call to inferApproximate(), inferRelaxation() or inferDualDecomposition(), -infinity if none was requested
+	 */
+	double getLastLowerBound() const;
+
+	/**
+	 * @brief Wall and CPU time of the phases parse, buildAdjacency, initializeOpenGMModel, greedyStart, approximate, presolve, cache, solverSetup, solve, rounding, learn and export,
+	 *        together with counters of variables and constraints by type, and solver statistics
+	 * @details Everything accumulates over the lifetime of the model, call getTelemetry().clear() to start over
+	 */
+	helpers::Telemetry& getTelemetry() const { return telemetry_; }
+
 	/**
 	 * @brief Create a graphviz dot output of the full graph, showing used nodes/links in blue and exclusion constraints in red
 	 * 
@@ -84,14 +371,63 @@ public:
 	 */
 	void toDot(const std::string& filename, const helpers::Solution* sol = nullptr) const;
 
+	/**
+	 * @brief Save all hypotheses, features and settings into a binary container that can be loaded by a BinaryModel
+	 * @details Only numeric ids are supported. The format is described in binarymodel.h
+	 *
+	 * @param filename output filename
+	 * @param groundTruth pointer to a ground truth solution that should be embedded in the file, if nullptr it will be ignored
+	 */
+	void saveToBinary(const std::string& filename, const helpers::Solution* groundTruth = nullptr);
+
+	/**
+	 * @brief Build the ILP of the tracking directly from the hypotheses, without the indicator expansion of the OpenGM model
+	 * @details Every variable gets one binary column per state > 0, costing the energy difference to state 0,
+	 *          and the energies of state 0 form the objective offset. Variables with more than two states take at most one of them.
+	 *          The rows are the constraints of the OpenGM model, so both have the same optimum.
+	 *          If presolve is enabled in the settings, the pruned variables are left out and contribute their state 0 energy.
+	 *          Columns and rows are named after the hypotheses, e.g. det_<id>_<state>, link_<src>_<dest>_<state> or in_<id>.
+	 *
+	 * @param weights the full weight vector
+	 * @param columnStates if not nullptr, filled with the OpenGM variable id (in the layout of the full model) and state of every column
+	 * @param rowTimesteps if not nullptr, filled with the timestep of the segmentation hypothesis that every row belongs to,
+	 *        exclusions belong to their first hypothesis, and the rows limiting the states of a variable get -1
+	 */
+	LinearProgram buildLinearProgram(
+		const std::vector<helpers::ValueType>& weights,
+		std::vector< std::pair<size_t, helpers::LabelType> >* columnStates = nullptr,
+		std::vector<int>* rowTimesteps = nullptr);
+
+	/**
+	 * @brief Write the ILP of buildLinearProgram() to a .lp or .mps file, so it can be solved offline by any solver
+	 */
+	void exportLinearProgram(const std::vector<helpers::ValueType>& weights, const std::string& filename);
+
+	/**
+	 * @brief Read a solution file of the program written by exportLinearProgram() with the same weights
+	 * @details The energy of the solution is available through getLastSolutionValue() afterwards.
+	 *
+	 * @return the solution vector in the layout of the full model
+	 */
+	helpers::Solution readLinearProgramSolution(const std::vector<helpers::ValueType>& weights, const std::string& filename);
+
 	/**
 	 * @brief Initialize the OpenGM model by adding variables, factors and constraints.
-	 * @detail This is called by learn() or infer()
+	 * @detail This is called by learn() or infer(). An OpenGM model that was built before is discarded.
 	 * 
 	 * @param weights a reference to the weights object that will be used in all 
 	 */
 	void initializeOpenGMModel(helpers::WeightsType& weights);
 
+	/**
+	 * @brief Split the tracking graph into independent parts.
+	 * @details Two segmentation hypotheses end up in the same component if they are connected by a link, 
+	 *          a division or an exclusion constraint. Components are ordered by their first segmentation hypothesis.
+	 * 
+	 * @return a list of subgraphs that do not share any variables or constraints
+	 */
+	std::vector<Subgraph> findConnectedComponents();
+
 	/**
 	 * @return a vector of strings describing each entry in the weight vector
 	 */
@@ -109,23 +445,395 @@ protected:
 	 */
 	void deduceAppearanceDisappearanceStates(helpers::Solution& solution);
 
+	/**
+	 * @brief Add all variables, factors and constraints of the hypotheses in the given subgraph to an OpenGM model.
+	 * @details The variables of the subgraph are numbered starting at the next free variable of the given model.
+	 *          They are added sequentially, then the factors of the hypotheses are built in parallel and 
+	 *          added in a fixed order, so variable ids and factor order do not depend on the number of threads.
+	 * @param numThreads number of threads that build factors, 0 for all CPU cores
+	 */
+	void addSubgraphToOpenGMModel(helpers::GraphicalModelType& model, helpers::WeightsType& weights, Subgraph& subgraph, size_t numThreads);
+
+	/**
+	 * @brief Build one OpenGM model per connected component, e.g. to learn from the components as separate instances
+	 * @details The variables keep their ids in the full model afterwards.
+	 *
+	 * @param weights the weights object the component models refer to
+	 * @param solution a solution of the full model, which is cut into the components
+	 * @param models filled with the model of every component, ordered as by findConnectedComponents()
+	 * @param solutions filled with the part of the solution of every component
+	 */
+	void buildComponentInstances(helpers::WeightsType& weights, 
+								 const helpers::Solution& solution, 
+								 std::vector<helpers::GraphicalModelType>& models, 
+								 std::vector<helpers::Solution>& solutions);
+
+	/**
+	 * @return a subgraph that holds all hypotheses and exclusion constraints of the model
+	 */
+	Subgraph getFullGraph();
+
+	/**
+	 * @brief Collect the variables of a subgraph that has been added to an OpenGM model
+	 * 
+	 * @param subgraph the subgraph
+	 * @param numVariables number of variables in the OpenGM model the subgraph was added to
+	 * @return a vector that holds for every opengm variable id the corresponding variable
+	 */
+	std::vector<const Variable*> getSubgraphVariables(const Subgraph& subgraph, size_t numVariables) const;
+
+	/**
+	 * @brief Store the sizes of the given OpenGM models and the number of variables by type in the telemetry counters
+	 */
+	void recordModelStatistics(const std::vector<const helpers::GraphicalModelType*>& models);
+
+	/**
+	 * @brief Let every segmentation hypothesis know its incoming and outgoing links and divisions
+	 * @details Groups links and divisions by segmentation into the compressed adjacency arrays 
+	 *          linkAdjacency_ and divisionAdjacency_, which the segmentation hypotheses point into.
+	 *          Must be called by the readers after all hypotheses have been added.
+	 *          Edits update the adjacency of the hypotheses they touch instead, see updateAdjacency(), 
+	 *          and only call this again when adding a hypothesis moves all of them in memory.
+	 *          It also discards the merged exclusion constraints, see getMergedExclusionConstraints().
+	 */
+	void buildAdjacency();
+
+	/**
+	 * @brief Merge the exclusion constraints into maximal cliques of the detections that exclude each other
+	 * @details Two detections exclude each other if any exclusion constraint contains both. 
+	 *          Starting with the largest, every constraint that still contains a pair not covered by a previous clique
+	 *          is extended by detections that exclude all of its members. Constraints whose pairs are all covered are dropped.
+	 *          This allows the same solutions with fewer constraints, and each clique constraint is at least as tight 
+	 *          in the LP relaxation as the constraints it replaces.
+	 * @return the cliques, which replace the exclusion constraints in the OpenGM models and linear programs
+	 */
+	std::vector<ExclusionConstraint> mergeExclusionConstraints() const;
+
+	/**
+	 * @brief The merged exclusion constraints, see mergeExclusionConstraints()
+	 * @details Merged once when the first OpenGM model or linear program is built after buildAdjacency() or an edit of the exclusions. 
+	 *          The exclusion constraints themselves stay as they were given, so edits and removals refer to them.
+	 */
+	std::vector<ExclusionConstraint>& getMergedExclusionConstraints();
+
+	/**
+	 * @brief Give all variables the id they would get in initializeOpenGMModel(), without building the model.
+	 * @details Used to map solutions of subgraph models back to the layout of the full model
+	 * @return the number of variables of the full model
+	 */
+	size_t assignOpenGMVariableIds();
+
+	/**
+	 * @brief Parameters of the MipInference with the solver backend, gap and threads of the settings, solving with integer constraints
+	 * @param verbose whether the solver should print its progress (only if enabled in the settings as well)
+	 */
+	MipInference::Parameter getMipInferenceParameter(bool verbose) const;
+
+	/**
+	 * @brief Solver backends of the kind selected in the settings, one for each worker thread that solves concurrently
+	 * @details The backends are created on first use and kept for all later solves of this model, 
+	 *          so e.g. a Gurobi environment and its license check are set up once per worker instead of once per solve.
+	 *          Not thread safe, call it before the solves are distributed to the workers.
+	 * 
+	 * @param numWorkers number of worker threads, see helpers::parallelForWorkers()
+	 */
+	std::vector<SolverBackend*> getSolverBackends(size_t numWorkers) const;
+
+	/**
+	 * @brief Solve the given OpenGM model with the solver backend selected in the settings
+	 * 
+	 * @param model OpenGM model
+	 * @param solution will be resized and filled with the found labeling
+	 * @param verbose whether to print the optimizer's progress (only if enabled in the settings as well)
+	 * @param backend one of getSolverBackends(), which solves nothing else meanwhile
+	 * @param start pointer to a labeling of the model that is handed to the optimizer as starting point, ignored if nullptr
+	 * @return the energy of the found solution
+	 */
+	double optimizeOpenGMModel(const helpers::GraphicalModelType& model, helpers::Solution& solution, bool verbose, 
+							   SolverBackend& backend, const helpers::Solution* start = nullptr) const;
+
+	/**
+	 * @brief Check whether the model can be solved as min-cost-flow
+	 * @details This is the case if all variables are binary, there are no divisions and no exclusion constraints,
+	 *          and no constraint forbids tracks of length one.
+	 */
+	bool isFlowProblem();
+
+	/**
+	 * @brief Find the minimal-energy configuration of a model that is a pure flow problem by successive shortest paths
+	 * @details Every detection is split into an arc with the detection's cost, appearances and disappearances
+	 *          connect it to a global source and sink, links connect the detections.
+	 *          The cost of each arc is the energy difference between state 1 and state 0 of its variable.
+	 * 
+	 * @param weights the weight vector
+	 * @param solution will be filled with the found labeling, in the layout of the full model
+	 * @return false if the flow graph contains cycles of negative cost and the solution could not be found
+	 */
+	bool inferMinCostFlow(const std::vector<helpers::ValueType>& weights, helpers::Solution& solution);
+
+	/**
+	 * @brief Decide where the next ILP starts: from the given start if there is one (which is moved into lastSolution_), 
+	 *        otherwise from the previous solution, or from constructGreedySolution() if enabled in the settings
+	 */
+	void prepareStartSolution(const std::vector<helpers::ValueType>& weights, helpers::Solution& start);
+
+	/**
+	 * @brief Build and solve each connected component of the graph separately and in parallel
+	 * @details The component models are kept and reused by subsequent calls, 
+	 *          which are warm-started from the previous component solutions.
+	 *          After edits, only the components that contain a segmentation in editedSegmentations_ are built again,
+	 *          the number of rebuilt models is the counter opengm.rebuiltModels. A component whose model was kept keeps 
+	 *          its solution as well, it is only solved again if the weights changed. The number of components that 
+	 *          were solved is the counter opengm.solvedComponents.
+	 * 
+	 * @return the solution of all components, in the layout of the full model
+	 */
+	helpers::Solution inferComponentwise();
+
+	/**
+	 * @brief Indices of the segmentation hypotheses in topological order of the links between them
+	 * @return the order, which misses the detections on and behind cycles if the links are not acyclic
+	 */
+	std::vector<size_t> getTopologicalOrder() const;
+
+	/**
+	 * @brief Energies of all states of every variable, by OpenGM variable id in the layout of the full model
+	 */
+	std::vector< std::vector<helpers::ValueType> > computeStateEnergies(const std::vector<helpers::ValueType>& weights);
+
+	/**
+	 * @brief Sum of the energies of the states that the given solution assigns to every variable with an OpenGM variable id
+	 */
+	double computeSolutionEnergy(const helpers::Solution& sol, const std::vector<helpers::ValueType>& weights) const;
+
+	/**
+	 * @brief Starting from no active variable, add paths and divisions as long as they lower the given energies, see inferApproximate()
+	 * @param stateEnergies energies of all states of every variable, as by computeStateEnergies()
+	 * @param numPaths, numPasses, numDivisions receive the number of added paths, passes over the detections and added divisions
+	 * @return the labeling in the layout of the full model
+	 */
+	helpers::Solution addPathsApproximately(const std::vector< std::vector<helpers::ValueType> >& stateEnergies, 
+											size_t& numPaths, 
+											size_t& numPasses, 
+											size_t& numDivisions);
+
+	/**
+	 * @brief Find a valid labeling that takes the states of large values, see inferRelaxation()
+	 * @details The largest state of every variable is kept if verifySolution() accepts it. If any value is fractional or it is rejected, 
+	 *          addPathsApproximately() repairs it with energies lowered by the values, and the better of both is returned.
+	 * @param stateEnergies energies of all states of every variable, as by computeStateEnergies()
+	 * @param stateValues value in [0,1] of every state of every variable, e.g. of the LP relaxation
+	 * @param energy receives the energy of the returned labeling, infinity if none was found
+	 * @return the labeling in the layout of the full model, empty if none was found
+	 */
+	helpers::Solution roundStateValues(const std::vector< std::vector<helpers::ValueType> >& stateEnergies,
+									   const std::vector< std::vector<double> >& stateValues,
+									   double& energy);
+
+	/**
+	 * @brief Solve the LP relaxation of the full OpenGM model, which is built if necessary, without rounding it
+	 */
+	Relaxation solveRelaxation(bool verbose);
+
+	/**
+	 * @brief Mark the variables that must be in state 0 in every optimal solution as pruned, so they are not added to OpenGM models
+	 * @details Every object in a solution takes a path from an appearance over links to a disappearance. The cheapest such paths
+	 *          through every detection and link are found by dynamic programming over the detections in topological order,
+	 *          where each variable costs the smallest energy difference between two neighboring states. Removing an object
+	 *          from a path whose cost is positive lowers the energy, so detections, links, appearances and disappearances that 
+	 *          are only found on such paths, or on no path at all, are pruned, together with all hypotheses of pruned detections.
+	 *          Paths through detections that can divide are never ruled out. Nothing is pruned if the links form cycles.
+	 *
+	 * @param weights the weight vector
+	 * @param fixedEnergy will be set to the sum of the state 0 energies of the pruned variables
+	 * @return the number of pruned variables
+	 */
+	size_t presolve(const std::vector<helpers::ValueType>& weights, double& fixedEnergy);
+
+	/**
+	 * @brief Undo presolve(), so that all variables are added to OpenGM models again
+	 */
+	void clearPresolve();
+
+	/**
+	 * @brief Run presolve(), then build and solve the reduced model (or its components) without the pruned variables
+	 * @details The reduced models are built for this call only, model_ is not touched.
+	 * @return the solution in the layout of the full model, in which all pruned variables are in state 0
+	 */
+	helpers::Solution inferPresolved(const std::vector<helpers::ValueType>& weights);
+
+	/**
+	 * @brief Add the constraints that committed segmentation hypotheses impose on the free links and divisions of a window
+	 * @details A committed hypothesis must still send (receive) the flow given by its fixed states, 
+	 *          minus what its committed links and divisions already carry. The free links and divisions must have been 
+	 *          added to the model, the variables of the committed hypotheses must have their ids of the full model.
+	 *
+	 * @param model the OpenGM model of the window
+	 * @param segmentation a committed segmentation hypothesis
+	 * @param isFree whether a link or division is part of the window and not committed yet
+	 * @param solution the solution in the layout of the full model, which holds the committed states
+	 */
+	void addCommittedFlowConstraintsToOpenGMModel(
+		helpers::GraphicalModelType& model,
+		const SegmentationHypothesis& segmentation,
+		const std::function<bool(const Variable&)>& isFree,
+		const helpers::Solution& solution);
+
+	/**
+	 * @brief Copy the given weights into inferenceWeights_, which the OpenGM models built by infer() refer to
+	 */
+	void setInferenceWeights(const std::vector<helpers::ValueType>& weights);
+
+	/**
+	 * @brief Call the given function on every variable of the given model, whose variables are const if the model is
+	 */
+	template<class MODEL, class FUNCTION>
+	static void forEachVariable(MODEL& model, const FUNCTION& function)
+	{
+		for(auto iter = model.segmentationHypotheses_.begin(); iter != model.segmentationHypotheses_.end() ; ++iter)
+		{
+			function(iter->second.getDetectionVariable());
+			function(iter->second.getDivisionVariable());
+			function(iter->second.getAppearanceVariable());
+			function(iter->second.getDisappearanceVariable());
+		}
+		for(auto iter = model.linkingHypotheses_.begin(); iter != model.linkingHypotheses_.end() ; ++iter)
+			function(iter->second.getVariable());
+		for(auto iter = model.divisionHypotheses_.begin(); iter != model.divisionHypotheses_.end() ; ++iter)
+			function(iter->second.getVariable());
+	}
+
+	/**
+	 * @return whether any variable is fixed to a state, see fixDetection()
+	 */
+	bool hasFixedStates() const;
+
+	/**
+	 * @brief Prepare an edit of the hypotheses: the first edit after a solve stores the states of the last solution 
+	 *        in the variables, and every edit discards everything that depends on the layout of the full model
+	 * @param touchedIds the segmentation hypotheses whose components change, see inferComponentwise()
+	 */
+	void beginEdit(const std::vector<helpers::IdLabelType>& touchedIds);
+
+	/**
+	 * @brief Links and divisions of one segmentation hypothesis as lists that an edit can change, see updateAdjacency()
+	 */
+	struct AdjacencyLists
+	{
+		std::vector<LinkingHypothesis*> incomingLinks_;
+		std::vector<LinkingHypothesis*> outgoingLinks_;
+		std::vector<DivisionHypothesis*> incomingDivisions_;
+		std::vector<DivisionHypothesis*> outgoingDivisions_;
+	};
+
+	/**
+	 * @brief Change the links and divisions of one segmentation hypothesis without building all adjacency again
+	 * @details The changed lists are stored in editedAdjacency_, which the segmentation hypothesis then points into,
+	 *          until the next buildAdjacency(). The segmentation is marked as edited, see inferComponentwise().
+	 * @param id the segmentation hypothesis
+	 * @param change called with the current lists, which it modifies
+	 */
+	void updateAdjacency(const helpers::IdLabelType& id, const std::function<void(AdjacencyLists&)>& change);
+
+	/**
+	 * @brief Replace a pointer to the link in the adjacency of its source and destination
+	 * @param oldPointer the pointer to replace, or nullptr to add newPointer
+	 * @param newPointer the new pointer, or nullptr to remove oldPointer
+	 */
+	void replaceInAdjacency(const LinkingHypothesis& link, LinkingHypothesis* oldPointer, LinkingHypothesis* newPointer);
+
+	/**
+	 * @brief Replace a pointer to the division in the adjacency of its parent and children, like for links
+	 */
+	void replaceInAdjacency(const DivisionHypothesis& division, DivisionHypothesis* oldPointer, DivisionHypothesis* newPointer);
+
+	/**
+	 * @brief Erase a hypothesis and update the adjacency, also of the hypothesis that DenseMap::erase() moves into its place
+	 */
+	void eraseLinkingHypothesis(const std::pair<helpers::IdLabelType, helpers::IdLabelType>& key);
+	void eraseDivisionHypothesis(const DivisionHypothesis::IdType& key);
+
+	/**
+	 * @brief Start of the first solve after edits, from the states stored by beginEdit() and the fixed states, 
+	 *        repaired by roundStateValues() if it violates constraints
+	 * @return the start in the layout of the full model, empty if there was no previous solution or no valid start was found
+	 */
+	helpers::Solution getStartAfterEdits(const std::vector<helpers::ValueType>& weights);
+
+	/**
+	 * @brief Fix a variable of the model for fixDetection() and its siblings
+	 */
+	void fixVariable(Variable& variable, int state, const std::vector<helpers::IdLabelType>& touchedIds);
+
+	/**
+	 * @brief The work of infer() when the solution is not taken from the cache
+	 */
+	helpers::Solution inferUncached(const std::vector<helpers::ValueType>& weights, bool withIntegerConstraints);
+
+	/**
+	 * @brief Hash of everything that determines the result of infer(), used as key of the solution cache
+	 */
+	std::string computeSolutionCacheKey(const std::vector<helpers::ValueType>& weights) const;
+
 protected:
-	// segmentation hypotheses
-	std::map<helpers::IdLabelType, SegmentationHypothesis> segmentationHypotheses_;
-	// linking hypotheses are stored as shared pointer so it is easier to pass them around
-	std::map<std::pair<helpers::IdLabelType, helpers::IdLabelType>, std::shared_ptr<LinkingHypothesis> > linkingHypotheses_;
-	// division hypotheses as shared pointers
-	std::map<DivisionHypothesis::IdType, std::shared_ptr<DivisionHypothesis> > divisionHypotheses_;
-	// exclusion constraints
+	// segmentation hypotheses, stored contiguously in the order they were read
+	SegmentationHypothesisMap segmentationHypotheses_;
+	// linking hypotheses by source and destination id
+	helpers::DenseMap<std::pair<helpers::IdLabelType, helpers::IdLabelType>, LinkingHypothesis> linkingHypotheses_;
+	// external division hypotheses by parent and children ids
+	helpers::DenseMap<DivisionHypothesis::IdType, DivisionHypothesis> divisionHypotheses_;
+	// per segmentation the incoming, then outgoing links (and divisions), see buildAdjacency()
+	std::vector<LinkingHypothesis*> linkAdjacency_;
+	std::vector<DivisionHypothesis*> divisionAdjacency_;
+	// adjacency of the segmentations that were edited since the last buildAdjacency(), see updateAdjacency()
+	std::unordered_map<helpers::IdLabelType, AdjacencyLists, helpers::IdHash> editedAdjacency_;
+	// exclusion constraints as they were given
 	std::vector<ExclusionConstraint> exclusionConstraints_;
+	// cliques that the models are built from, see getMergedExclusionConstraints()
+	std::vector<ExclusionConstraint> mergedExclusionConstraints_;
+	bool hasMergedExclusionConstraints_ = false;
 
 	// OpenGM stuff
 	helpers::GraphicalModelType model_;
 	double foundSolutionValue_;
+	// LP relaxation energy found by inferApproximate()
+	double lastLowerBound_ = -std::numeric_limits<double>::infinity();
+
+	// weights object the OpenGM model refers to, nullptr if it has not been built yet
+	const helpers::WeightsType* openGMModelWeights_ = nullptr;
+	// weights of the last call to infer() or initializeOpenGMModel(), used by evaluateSolution()
+	const helpers::WeightsType* evaluationWeights_ = nullptr;
+	// weights used by infer(), which are overwritten on every call so that its OpenGM models can be reused
+	helpers::WeightsType inferenceWeights_;
+	// last solution found on model_ by infer(), used as starting point for the next call
+	helpers::Solution lastSolution_;
+	// validated start given to infer(weights, start), for the call of infer() that follows
+	helpers::Solution startSolution_;
+
+	// per worker thread, see getSolverBackends()
+	mutable std::vector< std::unique_ptr<SolverBackend> > solverBackends_;
+
+	// component models built by inferComponentwise(), with their variables, first segmentation, last solutions and their energies
+	std::vector< std::unique_ptr<helpers::GraphicalModelType> > componentModels_;
+	std::vector< std::vector<const Variable*> > componentVariables_;
+	std::vector<helpers::IdLabelType> componentFirstIds_;
+	std::vector<helpers::Solution> componentSolutions_;
+	std::vector<double> componentEnergies_;
+	// weights that the component solutions were found with
+	std::vector<helpers::ValueType> componentSolutionWeights_;
+
+	// segmentation hypotheses whose components changed by edits since the component models were built
+	std::unordered_set<helpers::IdLabelType, helpers::IdHash> editedSegmentations_;
+	// whether the model was edited since the last solve, and if the states of a solution were stored before
+	bool hasPendingEdits_ = false;
+	bool hasPreviousStates_ = false;
 
 	// model settings
 	std::shared_ptr<helpers::Settings> settings_;
 
+	// timing of all phases and model/solver statistics, also recorded by const methods
+	mutable helpers::Telemetry telemetry_;
+
 	// numbers of weights
 	size_t numDetWeights_ = 0;
 	size_t numDivWeights_ = 0;
@@ -133,6 +841,14 @@ protected:
 	size_t numDisWeights_ = 0;
 	size_t numExternalDivWeights_ = 0;
 	size_t numLinkWeights_ = 0;
+
+	// indices into the weight vector for the features of each type of variable
+	std::vector<size_t> linkWeightIds_;
+	std::vector<size_t> detWeightIds_;
+	std::vector<size_t> divWeightIds_;
+	std::vector<size_t> appWeightIds_;
+	std::vector<size_t> disWeightIds_;
+	std::vector<size_t> externalDivWeightIds_;
 };
 
 } // end namespace mht
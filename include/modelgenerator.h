@@ -0,0 +1,115 @@
+#ifndef MODEL_GENERATOR_H
+#define MODEL_GENERATOR_H
+
+#include <vector>
+#include <string>
+#include <random>
+#include <ostream>
+
+#include "helpers.h"
+
+namespace mht
+{
+
+/**
+ * @brief Creates synthetic tracking models of arbitrary size, in the JSON format that JsonModel reads
+ * @details Objects are scattered over a plane whose area grows with the number of detections per frame,
+ *          so the density of objects (and thereby the ambiguity of links) stays the same for all sizes.
+ *          From frame to frame objects move by a random offset, some of them are replaced by false positives
+ *          at random positions. Every detection is linked to its nearest neighbours in the next frame.
+ *          Features are negative log likelihoods derived from the simulated counts and distances,
+ *          extended by uniform noise features up to the requested dimension, so the models have non-trivial solutions.
+ *          All random choices depend on the seed only, so the same parameters always create the same model.
+ */
+class ModelGenerator
+{
+public:
+	/**
+	 * @brief Configures the size and structure of the generated model
+	 */
+	struct Parameters
+	{
+		size_t numFrames = 10;
+		size_t detectionsPerFrame = 100;
+		size_t linkFanOut = 3; // number of outgoing links per detection, to the nearest detections of the next frame
+		size_t maxNumObjects = 1; // detections and links get maxNumObjects + 1 states, values > 1 create merger hypotheses
+		double mergerRate = 0.05; // fraction of detections that contain more than one object, if maxNumObjects > 1
+		double divisionRate = 0.05; // fraction of detections that get a division variable
+		bool externalDivisions = false; // create division hypotheses in the "divisions" list instead of divisionFeatures
+		double exclusionRate = 0.0; // fraction of detections that are excluded with their nearest neighbor in the same frame
+		double falsePositiveRate = 0.1; // fraction of detections per frame that are placed at random positions
+		size_t numFeatures = 1; // length of each feature vector, features beyond the first are noise
+		unsigned int seed = 42;
+	};
+
+	ModelGenerator(const Parameters& parameters);
+
+	/**
+	 * @brief Generate the model and write it to a JSON file
+	 */
+	void saveModelToJson(const std::string& filename);
+
+	/**
+	 * @brief Generate the model and write it to the given stream in the JSON model format
+	 */
+	void writeModel(std::ostream& stream);
+
+	/**
+	 * @brief Weights that fit the last generated model, the first feature of every variable gets weight 1 and the noise features 0.1
+	 * @details The generated models let all states share their weights, so there are numFeatures weights
+	 *          for links, detections, divisions (if any were created), appearances and disappearances, in this order.
+	 */
+	std::vector<helpers::ValueType> getWeights() const;
+
+	/// @return the numbers of hypotheses in the last generated model
+	size_t getNumSegmentations() const { return detections_.size(); }
+	size_t getNumLinks() const { return links_.size(); }
+	size_t getNumDivisions() const { return numDivisions_; }
+	size_t getNumExclusions() const { return exclusions_.size(); }
+
+private:
+	struct Detection
+	{
+		double x;
+		double y;
+		size_t count; // number of objects in this detection, zero for false positives
+		bool canDivide;
+	};
+
+	struct Link
+	{
+		size_t src; // index into detections_
+		size_t dest;
+		double distance;
+	};
+
+	/// simulate positions, links, divisions and exclusions
+	void generate();
+
+	/// indices of the up to k detections of a frame that are closest to the given position, sorted by distance
+	std::vector<size_t> findNearest(size_t frame, double x, double y, size_t k, size_t except);
+
+	/// write a feature list with one vector per state, where the first feature of each state is given
+	void writeFeatures(std::ostream& stream, const std::vector<double>& firstFeatures);
+
+	void writeId(std::ostream& stream, size_t index) const;
+
+	Parameters parameters_;
+	std::mt19937 randomGenerator_;
+	double fieldSize_;
+	double motionSigma_;
+
+	std::vector<Detection> detections_; // ordered by frame, detectionsPerFrame per frame
+	std::vector<Link> links_; // ordered by source detection
+	std::vector< std::pair<size_t, size_t> > exclusions_;
+	size_t numDivisions_;
+
+	// uniform grid over the detections of each frame for neighbor queries
+	size_t gridSize_;
+	std::vector< std::vector<size_t> > gridOffsets_; // per frame, offsets into gridEntries_ of each cell
+	std::vector< std::vector<size_t> > gridEntries_; // per frame, detection indices sorted by grid cell
+};
+
+} // end namespace mht
+
+#endif // MODEL_GENERATOR_H
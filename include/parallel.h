@@ -0,0 +1,99 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <algorithm>
+
+namespace helpers
+{
+
+/**
+ * @brief Resolve a requested number of threads, where 0 means "use all CPU cores"
+ *
+ * @param numThreads requested number of threads
+ * @param numItems there is no use in spawning more threads than work items
+ * @return the number of worker threads to use, at least 1
+ */
+inline size_t getNumWorkerThreads(size_t numThreads, size_t numItems)
+{
+	if(numThreads == 0)
+		numThreads = std::thread::hardware_concurrency();
+	return std::max((size_t)1, std::min(numThreads, numItems));
+}
+
+/**
+ * @brief Call func(i, worker) for every i in [0, numItems) on a pool of worker threads
+ * @details Items are handed out one by one, so long running items do not block the others.
+ *          If numThreads resolves to one worker, everything runs on the calling thread.
+ *          The first exception thrown by any item is rethrown after all workers have finished.
+ *          Every worker has an index in [0, getNumWorkerThreads(numThreads, numItems)) and runs one item at a time,
+ *          so state that is indexed by the worker (e.g. a solver backend) is never used concurrently.
+ *
+ * @param numItems number of work items
+ * @param numThreads number of worker threads, 0 for all CPU cores
+ * @param func functor that takes the index of the work item and of the worker
+ */
+template<class FUNCTOR>
+void parallelForWorkers(size_t numItems, size_t numThreads, FUNCTOR func)
+{
+	numThreads = getNumWorkerThreads(numThreads, numItems);
+	if(numThreads == 1)
+	{
+		for(size_t i = 0; i < numItems; ++i)
+			func(i, 0);
+		return;
+	}
+
+	std::atomic<size_t> nextItem(0);
+	std::exception_ptr firstException;
+	std::mutex exceptionMutex;
+
+	auto worker = [&](size_t workerIndex)
+	{
+		for(size_t i = nextItem++; i < numItems; i = nextItem++)
+		{
+			try
+			{
+				func(i, workerIndex);
+			}
+			catch(...)
+			{
+				std::lock_guard<std::mutex> lock(exceptionMutex);
+				if(!firstException)
+					firstException = std::current_exception();
+				// stop handing out new items
+				nextItem = numItems;
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for(size_t t = 0; t < numThreads; ++t)
+		workers.push_back(std::thread(worker, t));
+	for(auto& w : workers)
+		w.join();
+
+	if(firstException)
+		std::rethrow_exception(firstException);
+}
+
+/**
+ * @brief Call func(i) for every i in [0, numItems) on a pool of worker threads, see parallelForWorkers()
+ *
+ * @param numItems number of work items
+ * @param numThreads number of worker threads, 0 for all CPU cores
+ * @param func functor that takes the index of the work item
+ */
+template<class FUNCTOR>
+void parallelFor(size_t numItems, size_t numThreads, FUNCTOR func)
+{
+	parallelForWorkers(numItems, numThreads, [&](size_t i, size_t) { func(i); });
+}
+
+} // end namespace helpers
+
+#endif // PARALLEL_H
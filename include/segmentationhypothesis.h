@@ -5,6 +5,7 @@
 
 #include <json/json.h>
 #include "helpers.h"
+#include "densestorage.h"
 #include "variable.h"
 
 // settings forward declaration
@@ -34,85 +35,105 @@ public: // API
 	 */
 	SegmentationHypothesis(
 		helpers::IdLabelType id, 
-		const helpers::StateFeatureVector& detectionFeatures, 
-		const helpers::StateFeatureVector& divisionFeatures = {},
-		const helpers::StateFeatureVector& appearanceFeatures = {},
-		const helpers::StateFeatureVector& disappearanceFeatures = {});
+		helpers::StateFeatureVector detectionFeatures, 
+		helpers::StateFeatureVector divisionFeatures = {},
+		helpers::StateFeatureVector appearanceFeatures = {},
+		helpers::StateFeatureVector disappearanceFeatures = {});
 
 	const helpers::IdLabelType getId() const { return id_; }
 
+	/**
+	 * @return the timestep (frame) of this hypothesis, or -1 if it is unknown
+	 */
+	int getTimestep() const { return timestep_; }
+	void setTimestep(int timestep) { timestep_ = timestep; }
+
 	/**
 	 * @return detection variable
 	 */
 	const Variable& getDetectionVariable() const { return detection_; }
+	Variable& getDetectionVariable() { return detection_; }
 
 	/**
 	 * @return division variable
 	 */
 	const Variable& getDivisionVariable() const { return division_; }
+	Variable& getDivisionVariable() { return division_; }
 
 	/**
 	 * @return appearance variable
 	 */
 	const Variable& getAppearanceVariable() const { return appearance_; }
+	Variable& getAppearanceVariable() { return appearance_; }
 
 	/**
 	 * @return disappearance variable
 	 */
 	const Variable& getDisappearanceVariable() const { return disappearance_; }
+	Variable& getDisappearanceVariable() { return disappearance_; }
 
 
 	/**
-	 * @brief Add this hypothesis to the OpenGM model
-	 * @details also adds the unary factor
+	 * @brief Add the variables of this hypothesis to the OpenGM model
+	 * @details their unary factors and the constraints are added by addFactorsToOpenGMModel()
 	 * 
 	 * @param model OpenGM model
+	 */
+	void addToOpenGMModel(helpers::GraphicalModelType& model);
+
+	/**
+	 * @brief Add the unary factors of this hypothesis and its constraints on the links and divisions
+	 * @details The variables of this hypothesis, its links and divisions must have been added to the model before.
+	 *          Only touches this hypothesis, so the factors of different hypotheses can be built concurrently.
+	 * 
+	 * @param buffer factor buffer of the OpenGM model that this hypothesis was added to
 	 * @param weights OpenGM weight object (if you are running learning this must be a reference to the weight object of the dataset)
-	 * @param statesShareWeights whether there is one weight per feature for all states, or a separate weight for each feature and state
+	 * @param settings the model settings
 	 * @param detectionWeightIds indices of the weights that are meant to be used together with the detection features
 	 * @param divisionWeightIds indices of the weights that are meant to be used together with the division features
 	 * @param appearanceWeightIds indices of the weights that are meant to be used together with the division features
 	 * @param disappearanceWeightIds indices of the weights that are meant to be used together with the division features
 	 */
-	void addToOpenGMModel(
-		helpers::GraphicalModelType& model, 
+	void addFactorsToOpenGMModel(
+		helpers::FactorBuffer& buffer, 
 		helpers::WeightsType& weights,
-		std::shared_ptr<helpers::Settings> settings,
+		const std::shared_ptr<helpers::Settings>& settings,
 		const std::vector<size_t>& detectionWeightIds,
 		const std::vector<size_t>& divisionWeightIds = {},
 		const std::vector<size_t>& appearanceWeightIds = {},
 		const std::vector<size_t>& disappearanceWeightIds = {});
 
 	/**
-	 * @brief Add an incoming link to this node as hypothesis. Will be considered in conservation constraints
-	 * @details Links must be added before calling addToOpenGMModel for this segmentation hypothesis!
+	 * @brief Number the opengm variables of this hypothesis in the same order as addToOpenGMModel() would, 
+	 *        but without adding anything to a model
 	 * 
-	 * @param link the linking hypothesis
-	 */
-	void addIncomingLink(std::shared_ptr<LinkingHypothesis> link);
-
-	/**
-	 * @brief Add an outgoing link to this node as hypothesis. Will be considered in conservation constraints
-	 * @details Links must be added before calling addToOpenGMModel for this segmentation hypothesis!
-	 * @param link the linking hypothesis
+	 * @param nextId the next free opengm variable id, is incremented for each variable that gets an id
 	 */
-	void addOutgoingLink(std::shared_ptr<LinkingHypothesis> link);
+	void assignOpenGMVariableIds(int& nextId);
 
 	/**
-	 * @brief Add an incoming division, which will be handled the same as incoming links
-	 * @details must be added before calling addToOpenGMModel
+	 * @brief Set the links and divisions that are considered in the conservation constraints of this node
+	 * @details The ranges point into the compressed adjacency arrays of the model, see Model::buildAdjacency().
+	 *          They must be set before calling addToOpenGMModel for this segmentation hypothesis!
 	 * 
-	 * @param division the division hypothesis
+	 * @param incomingLinks links that end at this hypothesis
+	 * @param outgoingLinks links that start at this hypothesis
+	 * @param incomingDivisions external divisions in which this hypothesis is a child, handled the same as incoming links
+	 * @param outgoingDivisions external divisions of this hypothesis - of which always only one may be active
 	 */
-	void addIncomingDivision(std::shared_ptr<DivisionHypothesis> division);
+	void setAdjacency(
+		helpers::PointerRange<LinkingHypothesis> incomingLinks,
+		helpers::PointerRange<LinkingHypothesis> outgoingLinks,
+		helpers::PointerRange<DivisionHypothesis> incomingDivisions,
+		helpers::PointerRange<DivisionHypothesis> outgoingDivisions);
 
 	/**
-	 * @brief Add an outgoing division - of which always only one may be active
-	 * @details must be added before calling addToOpenGMModel
-	 * 
-	 * @param division the division hypothesis
+	 * @return links and divisions that were registered with this hypothesis
 	 */
-	void addOutgoingDivision(std::shared_ptr<DivisionHypothesis> division);
+	const helpers::PointerRange<LinkingHypothesis>& getIncomingLinks() const { return incomingLinks_; }
+	const helpers::PointerRange<LinkingHypothesis>& getOutgoingLinks() const { return outgoingLinks_; }
+	const helpers::PointerRange<DivisionHypothesis>& getIncomingDivisions() const { return incomingDivisions_; }
+	const helpers::PointerRange<DivisionHypothesis>& getOutgoingDivisions() const { return outgoingDivisions_; }
 
 	/**
 	 * @brief Save this node to an open ostream in the graphviz dot format
@@ -141,36 +162,48 @@ private:
 	/**
 	 * @brief Add incoming constraints to OpenGM
 	 */
-	void addIncomingConstraintToOpenGM(helpers::GraphicalModelType& model);
+	void addIncomingConstraintToOpenGM(helpers::FactorBuffer& buffer);
 
 	/**
 	 * @brief Add outgoing constraints to OpenGM
 	 */
-	void addOutgoingConstraintToOpenGM(helpers::GraphicalModelType& model);
+	void addOutgoingConstraintToOpenGM(helpers::FactorBuffer& buffer);
 
 	/**
 	 * @brief Add division constraints to OpenGM
 	 */
-	void addDivisionConstraintToOpenGM(helpers::GraphicalModelType& model, bool requireSeparateChildren);
+	void addDivisionConstraintToOpenGM(helpers::FactorBuffer& buffer, bool requireSeparateChildren);
 
 	/**
 	 * @brief Add constraints of external division nodes (division hypotheses) to OpenGM
 	 */
-	void addExternalDivisionConstraintToOpenGM(helpers::GraphicalModelType& model);
+	void addExternalDivisionConstraintToOpenGM(helpers::FactorBuffer& buffer);
 
 	/**
 	 * @brief Add constraint that ensures that at most one of the two given opengm variables takes a state > 0
 	 */
 	void addExclusionConstraintToOpenGM(
-		helpers::GraphicalModelType& model, 
+		helpers::FactorBuffer& buffer, 
 		int openGmVarA, 
 		int openGmVarB);
 
+	/**
+	 * @brief Add a constraint that lets the given appearance (disappearance) variable only take a state > 0 
+	 *        if none of the incoming (outgoing) links is active
+	 * 
+	 * @param maxObjects the largest sum of the states of the links
+	 */
+	void addTransitionExclusionConstraintToOpenGM(
+		helpers::FactorBuffer& buffer, 
+		const Variable& variable, 
+		const helpers::PointerRange<LinkingHypothesis>& links, 
+		size_t maxObjects);
+
 	/**
 	 * Add a constraint between two variables and constraints with given bound and operator
 	 */
 	void addConstraintToOpenGM(
-		helpers::GraphicalModelType& model, 
+		helpers::FactorBuffer& buffer, 
 		int openGMVarA, 
 		int openGMVarB, 
 		size_t stateA, 
@@ -182,30 +215,37 @@ private:
 	 * @brief Sort the linking hypotheses by their opengm variable ids
 	 */
 	template<class T>
-	void sortByOpenGMVariableId(std::vector< std::shared_ptr<T> >& links);
+	void sortByOpenGMVariableId(helpers::PointerRange<T>& links);
 
 private:
 	helpers::IdLabelType id_;
+	int timestep_;
 	
 	Variable detection_;
 	Variable division_;
 	Variable appearance_;
 	Variable disappearance_;
 
-	std::vector< std::shared_ptr<LinkingHypothesis> > incomingLinks_;
-	std::vector< std::shared_ptr<LinkingHypothesis> > outgoingLinks_;
-	std::vector< std::shared_ptr<DivisionHypothesis> > incomingDivisions_;
-	std::vector< std::shared_ptr<DivisionHypothesis> > outgoingDivisions_;
+	// non-owning views into the adjacency arrays of the model
+	helpers::PointerRange<LinkingHypothesis> incomingLinks_;
+	helpers::PointerRange<LinkingHypothesis> outgoingLinks_;
+	helpers::PointerRange<DivisionHypothesis> incomingDivisions_;
+	helpers::PointerRange<DivisionHypothesis> outgoingDivisions_;
 };
 
 template<class T>
-void SegmentationHypothesis::sortByOpenGMVariableId(std::vector< std::shared_ptr<T> >& links)
+void SegmentationHypothesis::sortByOpenGMVariableId(helpers::PointerRange<T>& links)
 {
-	std::sort(links.begin(), links.end(), [](const std::shared_ptr<T>& a, const std::shared_ptr<T>& b){
+	std::sort(links.begin(), links.end(), [](const T* a, const T* b){
 		return b->getVariable().getOpenGMVariableId() > a->getVariable().getOpenGMVariableId();
 	});
 }
 
+/**
+ * @brief All segmentation hypotheses of a model, stored contiguously and indexed by id
+ */
+typedef helpers::DenseMap<helpers::IdLabelType, SegmentationHypothesis> SegmentationHypothesisMap;
+
 } // end namespace mht
 
 #endif // SEGMENTATION_HYPOTHESIS_H
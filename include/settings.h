@@ -41,6 +41,20 @@ public: // settings object makes these parameters public instead of writing tons
 	bool optimizerVerbose_; // default = true
 	size_t optimizerNumThreads_; // default = 1, use 0 for all CPU cores
 	bool nonNegativeWeightsOnly_; // default = false
+	bool decomposeIntoComponents_; // default = false, solve each connected component of the graph as separate ILP
+	size_t componentNumThreads_; // default = 0 (all CPU cores), number of components that are solved concurrently
+	bool useFlowSolver_; // default = true, solve models without divisions, exclusions and mergers as min-cost-flow instead of ILP
+	size_t slidingWindowSize_; // default = 0 (off), number of timesteps that are solved together when tracking in a sliding window
+	size_t slidingWindowStep_; // default = 1, number of timesteps that are committed before the sliding window moves on
+	size_t dualDecompositionChunkSize_; // default = 0 (off), number of timesteps per chunk when tracking by dual decomposition, see Model::inferDualDecomposition()
+	size_t dualDecompositionOverlap_; // default = 0, number of timesteps that consecutive chunks of the dual decomposition have in common
+	size_t dualDecompositionIterations_; // default = 50, maximal number of multiplier updates of the dual decomposition
+	bool greedyWarmStart_; // default = false, start the ILP from constructGreedySolution() if there is no previous solution
+	bool presolve_; // default = false, leave hypotheses that cannot be active in an optimal solution out of the ILP, see Model::presolve()
+	size_t buildNumThreads_; // default = 0 (all CPU cores), number of threads that build the factors of an OpenGM model
+	std::string solverBackend_; // default = "gurobi" if compiled with it, "highs" otherwise, see mht::SolverBackend
+	std::string solutionCacheDirectory_; // default = "" (off), directory where infer() stores solutions to return them again for the same model and weights
+	size_t solutionCacheSize_; // default = 0 (unlimited), number of cached solutions that are kept, the least recently used ones are removed
 };
 
 } // end namespace helpers
@@ -0,0 +1,91 @@
+#ifndef SOLUTION_CACHE_H
+#define SOLUTION_CACHE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+
+#include "helpers.h"
+
+namespace mht
+{
+
+/**
+ * @brief 128 bit hash of a stream of values, used as key of the SolutionCache
+ * @details Two independent 64 bit lanes consume the data 8 bytes at a time and are mixed once more at the end.
+ *          This is not a cryptographic hash, it only has to tell different models apart.
+ */
+class ContentHash
+{
+public:
+	void add(const void* data, size_t size);
+
+	/// strings are prefixed with their length, so that concatenations cannot collide
+	void add(const std::string& value);
+
+	template<class T>
+	void add(const T& value)
+	{
+		static_assert(std::is_arithmetic<T>::value, "ContentHash can only add numbers and strings directly");
+		add(&value, sizeof(T));
+	}
+
+	template<class T>
+	void add(const std::vector<T>& values)
+	{
+		add(values.size());
+		for(const T& value : values)
+			add(value);
+	}
+
+	/**
+	 * @return the hash as 32 hexadecimal characters
+	 */
+	std::string hexDigest() const;
+
+private:
+	void addWord(uint64_t word);
+
+	uint64_t lanes_[2] = {0xcbf29ce484222325ULL, 0x6a09e667f3bcc909ULL};
+	uint64_t length_ = 0;
+};
+
+/**
+ * @brief Directory of solutions by key, so that solving the same model with the same weights again is not necessary
+ * @details Every solution is a small text file named after its key. Files are written under a temporary name and renamed,
+ *          so several processes can share a cache directory. Reading a solution marks it as recently used by touching the file,
+ *          and storing one removes the least recently used files beyond the maximum number of entries.
+ */
+class SolutionCache
+{
+public:
+	/**
+	 * @param directory where the solutions are stored, it is created if it does not exist
+	 * @param maxEntries number of solutions that are kept, 0 for unlimited
+	 */
+	SolutionCache(const std::string& directory, size_t maxEntries);
+
+	/**
+	 * @brief Look up the solution of the given key
+	 * @return whether the cache holds a solution for the key, which is then written to solution and energy
+	 */
+	bool load(const std::string& key, helpers::Solution& solution, double& energy) const;
+
+	/**
+	 * @brief Store a solution, failures to write are reported but not fatal
+	 */
+	void store(const std::string& key, const helpers::Solution& solution, double energy) const;
+
+private:
+	std::string getFilename(const std::string& key) const;
+	/// remove the least recently used files beyond maxEntries_, but never the given one
+	void evict(const std::string& keptFilename) const;
+
+	std::string directory_;
+	size_t maxEntries_;
+};
+
+} // end namespace mht
+
+#endif // SOLUTION_CACHE_H
@@ -0,0 +1,110 @@
+#ifndef SOLVER_BACKEND_H
+#define SOLVER_BACKEND_H
+
+#include <vector>
+#include <string>
+#include <memory>
+
+namespace helpers
+{
+class Telemetry;
+}
+
+namespace mht
+{
+
+/**
+ * @brief A linear program over columns in [0,1], with the constraint matrix stored row by row in compressed form
+ * @details Rows are two-sided: rowLower_[r] <= sum of coefficients_ * x[columns_] <= rowUpper_[r],
+ *          where an infinite bound means the row is unbounded in that direction.
+ *          Names of columns and rows are optional, they are only used when writing the program to a file (see lpfile.h).
+ */
+struct LinearProgram
+{
+	std::vector<double> objective_; // one cost per column, the objective is minimized
+	double objectiveOffset_ = 0.0; // constant part of the objective
+	std::vector<size_t> rowOffsets_ = {0}; // entries of row r are in [rowOffsets_[r], rowOffsets_[r+1])
+	std::vector<size_t> columns_;
+	std::vector<double> coefficients_;
+	std::vector<double> rowLower_;
+	std::vector<double> rowUpper_;
+	std::vector<std::string> columnNames_; // either empty or one per column
+	std::vector<std::string> rowNames_; // either empty or one per row
+
+	size_t numColumns() const { return objective_.size(); }
+	size_t numRows() const { return rowLower_.size(); }
+
+	/**
+	 * @brief Finish the row whose entries were appended to columns_ and coefficients_ since the last call
+	 * @param name name of the row, give one for all rows or for none
+	 */
+	void closeRow(double lower, double upper, const std::string& name = std::string());
+};
+
+/**
+ * @brief Parameters that every solver backend understands, mirroring the optimizer entries of helpers::Settings
+ */
+struct SolverParameters
+{
+	double epGap = 0.01; // relative MIP gap at which the solver may stop
+	size_t numThreads = 1; // 0 lets the solver use all CPU cores
+	bool verbose = false;
+	bool integer = true; // false solves the LP relaxation
+};
+
+/**
+ * @brief Column values and objective of a solved linear program, with statistics of the solver run
+ */
+struct SolverResult
+{
+	std::vector<double> columnValues;
+	double value; // objective of the returned column values, including the offset
+	double bound; // best lower bound the solver has proven, equals value for LP relaxations
+	size_t numNodes = 0; // branch-and-bound nodes the solver explored, 0 for LP relaxations
+	size_t presolveRemovedRows = 0; // rows that the presolve of the solver removed before solving, only reported by Gurobi
+	size_t presolveRemovedColumns = 0; // columns that the presolve of the solver removed before solving, only reported by Gurobi
+
+	/**
+	 * @brief Add the node count and presolve reductions to the solver.nodes, solver.presolveRemovedRows 
+	 *        and solver.presolveRemovedColumns counters, which sum up over all solves
+	 */
+	void addToTelemetry(helpers::Telemetry& telemetry) const;
+};
+
+/**
+ * @brief Interface of the (mixed integer) linear program solvers that can run the tracking ILP
+ * @details Backends are selected by name through the "solverBackend" setting. Which ones exist depends on
+ *          the solvers that were found at configure time, see availableNames().
+ *          A backend may keep state between solves (e.g. the Gurobi environment), so reusing one instance for 
+ *          many programs is cheaper than creating one per solve. One instance must not solve several programs at once.
+ */
+class SolverBackend
+{
+public:
+	virtual ~SolverBackend() {}
+
+	virtual std::string name() const = 0;
+
+	/**
+	 * @brief Solve the given program
+	 * @param program the linear program, all columns are binary if parameters.integer is set
+	 * @param parameters gap, threads and verbosity
+	 * @param start either empty or a feasible value for every column, which is passed to the solver as MIP start
+	 * @return the best solution found, throws if the solver found none
+	 */
+	virtual SolverResult solve(const LinearProgram& program,
+							   const SolverParameters& parameters,
+							   const std::vector<double>& start) = 0;
+
+	/**
+	 * @brief Create the backend with the given name, throws if it is unknown or was not compiled in
+	 */
+	static std::unique_ptr<SolverBackend> create(const std::string& name);
+
+	/// names of all backends this library was compiled with, the preferred one first
+	static std::vector<std::string> availableNames();
+};
+
+} // end namespace mht
+
+#endif // SOLVER_BACKEND_H
@@ -0,0 +1,162 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <map>
+#include <string>
+#include <mutex>
+#include <chrono>
+
+#include <json/json.h>
+
+namespace helpers
+{
+
+/**
+ * @brief Records the time spent in the phases of a tracking run, together with named counters
+ * @details Phase times accumulate over all calls of a phase, so a model that is built and solved several times
+ *          reports the sum, and the number of calls. CPU time is that of the whole process, so it includes 
+ *          the helper threads that a phase starts (e.g. to build factors or inside the solver).
+ *          Calls of a phase that overlap in time with another call of the same phase (e.g. the components of a 
+ *          decomposed model, which are solved on several threads) are reported separately as concurrent phases: 
+ *          their wall time only counts the time during which any of them was running, their busy time is the 
+ *          sum over all calls, and their CPU time is the sum of the CPU times of the threads that ran them.
+ *          All methods may be called concurrently.
+ */
+class Telemetry
+{
+public:
+	/**
+	 * @brief Accumulated time of one phase
+	 */
+	struct Phase
+	{
+		double wallTime = 0.0;
+		double cpuTime = 0.0;
+		double busyTime = 0.0; // only for concurrent phases, the sum of the wall times of all calls
+		size_t calls = 0;
+	};
+
+	/**
+	 * @brief Measures the time from its construction until stop() is called or it goes out of scope
+	 */
+	class ScopedPhase
+	{
+	public:
+		ScopedPhase(Telemetry& telemetry, const std::string& name);
+		~ScopedPhase();
+
+		/**
+		 * @brief Record the phase now instead of at the end of the scope
+		 */
+		void stop();
+
+	private:
+		Telemetry& telemetry_;
+		std::string name_;
+		std::chrono::steady_clock::time_point wallStart_;
+		double processCpuStart_;
+		double threadCpuStart_;
+		bool overlappedAtStart_;
+		size_t overlapsAtStart_;
+		bool running_;
+	};
+
+	/**
+	 * @brief Add the given time to a phase and increase its number of calls
+	 */
+	void addPhaseTime(const std::string& name, double wallTime, double cpuTime);
+
+	/**
+	 * @brief Set a counter to the given value
+	 */
+	void setCounter(const std::string& name, double value);
+
+	/**
+	 * @brief Add the given value to a counter, which starts at zero
+	 */
+	void addToCounter(const std::string& name, double value);
+
+	/**
+	 * @brief Set a counter to the given value if it is larger than the current one
+	 */
+	void setCounterToMax(const std::string& name, double value);
+
+	/**
+	 * @return the accumulated time of the calls of a phase that did not overlap, all zero if there were none
+	 */
+	Phase getPhase(const std::string& name) const;
+
+	/**
+	 * @return the accumulated time of the calls of a phase that overlapped with each other, all zero if there were none
+	 */
+	Phase getConcurrentPhase(const std::string& name) const;
+
+	/**
+	 * @return the value of a counter, or zero if it was never set
+	 */
+	double getCounter(const std::string& name) const;
+
+	/**
+	 * @brief Forget all phases and counters
+	 */
+	void clear();
+
+	/**
+	 * @brief Store all phases and counters in the given JSON object,
+	 *        as "phases": {name: {"wallTime", "cpuTime", "calls"}}, "concurrentPhases": {name: {"wallTime", "busyTime", "cpuTime", "calls"}}
+	 *        and "counters": {name: value}
+	 */
+	void toJson(Json::Value& root) const;
+
+	/**
+	 * @brief Print all phases and counters to std::cout
+	 */
+	void print() const;
+
+	/**
+	 * @return the CPU time used by the calling thread so far, in seconds
+	 */
+	static double getThreadCpuTime();
+
+	/**
+	 * @return the CPU time used by all threads of the process so far, in seconds
+	 */
+	static double getProcessCpuTime();
+
+	/**
+	 * @return copies of all phases, concurrent phases and counters by name
+	 */
+	std::map<std::string, Phase> getPhases() const;
+	std::map<std::string, Phase> getConcurrentPhases() const;
+	std::map<std::string, double> getCounters() const;
+
+private:
+	/// calls of a phase that are running at the moment, to find out which of them overlap
+	struct RunningPhase
+	{
+		size_t calls = 0;
+		size_t overlaps = 0; // number of calls that started while another one was running
+		std::chrono::steady_clock::time_point start; // when the first of the running calls started
+		bool overlapped = false; // whether any of the running calls overlapped
+	};
+
+	/// register the start of a call, returns whether another call of the phase is running and the number of overlaps so far
+	bool startPhase(const std::string& name, size_t& overlaps);
+	/// record a call that started at wallStart, as concurrent if it overlapped with another call at its start or later
+	void stopPhase(const std::string& name, 
+				   std::chrono::steady_clock::time_point wallStart, 
+				   bool overlappedAtStart, 
+				   size_t overlapsAtStart, 
+				   double processCpuTime, 
+				   double threadCpuTime);
+
+	mutable std::mutex mutex_;
+	std::map<std::string, Phase> phases_;
+	std::map<std::string, Phase> concurrentPhases_;
+	std::map<std::string, RunningPhase> runningPhases_;
+	std::map<std::string, double> counters_;
+};
+
+} // end namespace helpers
+
+#endif // TELEMETRY_H
@@ -15,25 +15,62 @@ public:
 	/**
 	 * @brief Construct with the given feature vector
 	 */
-	Variable(const helpers::StateFeatureVector& features = {}):
-		features_(features),
-		openGMVariableId_(-1)
+	Variable(helpers::StateFeatureVector features = {}):
+		features_(std::move(features)),
+		openGMVariableId_(-1),
+		pruned_(false),
+		fixedState_(-1),
+		previousState_(0)
 	{}
 
 	/**
-	 * @brief Add this variable with given unary features and corresponding weights to opengm
+	 * @brief Add this variable to opengm, its unary factor is added by addUnaryToOpenGM()
+	 * @details Variables without features or that are pruned are not added, their id becomes -1
 	 * 
 	 * @param model OpenGM Model
+	 */
+	void addToOpenGM(helpers::GraphicalModelType& model);
+
+	/**
+	 * @brief Add the unary factor with given features and corresponding weights of this variable, if it has been added to opengm,
+	 *        and the constraint that keeps it in its fixed state if it has one
+	 * 
+	 * @param buffer factor buffer of the OpenGM model that this variable was added to
 	 * @param statesShareWeights if this is true it means that the features of each state are multiplied by the same weight
 	 * @param weights opengm dataset weight object
 	 * @param weightIds ids into the weight vector that correspond to features
-	 * @return the new opengm variable id
 	 */
-	void addToOpenGM(
-		helpers::GraphicalModelType& model, 
+	void addUnaryToOpenGM(
+		helpers::FactorBuffer& buffer, 
 		bool statesShareWeights,
 		helpers::WeightsType& weights, 
-		const std::vector<size_t>& weightIds);
+		const std::vector<size_t>& weightIds) const;
+
+	/**
+	 * @brief Give this variable the next id of an opengm variable numbering without adding it to a model.
+	 * @details Variables without features are skipped, exactly as in addToOpenGM()
+	 * 
+	 * @param nextId the next free id, will be incremented if this variable takes it
+	 */
+	void assignOpenGMVariableId(int& nextId);
+
+	/**
+	 * @brief Compute the energy of every state of this variable as it would be given by its unary factor in opengm
+	 * 
+	 * @param statesShareWeights if this is true it means that the features of each state are multiplied by the same weight
+	 * @param weights the full weight vector
+	 * @param weightIds ids into the weight vector that correspond to features
+	 * @return a vector with one energy per state, empty if this variable has no features
+	 */
+	std::vector<helpers::ValueType> getStateEnergies(
+		bool statesShareWeights, 
+		const std::vector<helpers::ValueType>& weights, 
+		const std::vector<size_t>& weightIds) const;
+
+	/**
+	 * @return whether there are any features, variables without features are not added to opengm
+	 */
+	const bool hasFeatures() const { return features_.size() > 0 && features_[0].size() > 0; }
 
 	/**
 	 * @brief Get the number of weights needed for this variable
@@ -65,14 +102,57 @@ public:
 	 */
 	const size_t getNumStates() const { return features_.size(); }
 
+	/**
+	 * @return the features of all states of this variable
+	 */
+	const helpers::StateFeatureVector& getFeatures() const { return features_; }
+
 	/**
 	 * @return the opengm variable id of this variable
 	 */
 	int getOpenGMVariableId() const { return openGMVariableId_; }
 
+	/**
+	 * @brief Forget the opengm variable id, for variables that are left out of a model although they have features
+	 */
+	void resetOpenGMVariableId() { openGMVariableId_ = -1; }
+
+	/**
+	 * @brief Mark this variable as fixed to state 0, see Model::presolve()
+	 */
+	void setPruned(bool pruned) { pruned_ = pruned; }
+
+	/**
+	 * @return whether this variable is fixed to state 0 and left out of opengm models
+	 */
+	bool isPruned() const { return pruned_; }
+
+	/**
+	 * @brief Force this variable into the given state in all models, or release it with a negative state, see Model::fixDetection()
+	 */
+	void setFixedState(int state) { fixedState_ = state; }
+
+	/**
+	 * @return the state this variable is fixed to, negative if it is free
+	 */
+	int getFixedState() const { return fixedState_; }
+
+	bool isFixed() const { return fixedState_ >= 0; }
+
+	/**
+	 * @brief Remember the state of the last solution before the model was edited, which stays with the variable 
+	 *        while hypotheses are added and removed, see Model::getStartAfterEdits()
+	 */
+	void setPreviousState(size_t state) { previousState_ = state; }
+
+	size_t getPreviousState() const { return previousState_; }
+
 private:
 	helpers::StateFeatureVector features_;
 	int openGMVariableId_;
+	bool pruned_;
+	int fixedState_;
+	size_t previousState_;
 };
 
 }
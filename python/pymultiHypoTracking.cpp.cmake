@@ -1,9 +1,13 @@
 #include <boost/python/suite/indexing/map_indexing_suite.hpp>
 #include <boost/python/suite/indexing/vector_indexing_suite.hpp>
 #include <boost/python.hpp>
+#include <memory>
+#include <thread>
+#include <algorithm>
 
 #include "pythonmodel.h"
 #include "helpers.h"
+#include "parallel.h"
 
 using namespace mht;
 using namespace boost::python;
@@ -24,7 +28,18 @@ private:
     PyThreadState* threadState_;
 };
 
-object track(object& graphDict, object& weightsDict)
+/**
+ * @brief Helper class to lock the Python GIL again within a ScopedGILRelease, e.g. to call back into Python
+ */
+class ScopedGILAcquire {
+public:
+    inline ScopedGILAcquire() { gilState_ = PyGILState_Ensure(); }
+    inline ~ScopedGILAcquire() { PyGILState_Release(gilState_); }
+private:
+    PyGILState_STATE gilState_;
+};
+
+object track(object& graphDict, object& weightsDict, const std::string& cacheDirectory, size_t cacheSize, bool arrays)
 {
 	dict pyGraph = extract<dict>(graphDict);
 	dict pyWeights = extract<dict>(weightsDict);
@@ -32,6 +47,8 @@ object track(object& graphDict, object& weightsDict)
 	PythonModel model;
 	model.readFromPython(pyGraph);
 	FeatureVector weights = readWeightsFromPython(pyWeights);
+	if(!cacheDirectory.empty())
+		model.setSolutionCache(cacheDirectory, cacheSize);
 	Solution solution;
 
 	{
@@ -39,10 +56,157 @@ object track(object& graphDict, object& weightsDict)
 		solution = model.infer(weights);
 	}
     
-	object result = model.saveResultToPython(solution);
+	object result = arrays ? model.saveResultToArrays(solution) : model.saveResultToPython(solution);
+	return result;
+}
+
+object trackMany(object& graphDictList, object& weights, size_t numWorkers, size_t maxThreads, bool arrays)
+{
+	list pyGraphs = extract<list>(graphDictList);
+	const size_t numGraphs = len(pyGraphs);
+
+	// all python objects are converted up front, while holding the GIL
+	std::vector< std::unique_ptr<PythonModel> > models;
+	std::vector<FeatureVector> weightVectors;
+	extract<list> weightsList(weights);
+	if(weightsList.check() && (size_t)len(weightsList()) != numGraphs)
+		throw std::runtime_error("trackMany needs either one weights dict or one per graph");
+	for(size_t i = 0; i < numGraphs; ++i)
+	{
+		dict pyGraph = extract<dict>(pyGraphs[i]);
+		models.push_back(std::unique_ptr<PythonModel>(new PythonModel()));
+		models.back()->readFromPython(pyGraph);
+		if(weightsList.check() || i == 0)
+		{
+			dict pyWeights = extract<dict>(weightsList.check() ? weightsList()[i] : weights);
+			weightVectors.push_back(readWeightsFromPython(pyWeights));
+		}
+		else
+			weightVectors.push_back(weightVectors.front());
+	}
+
+	// the workers share the threads, so that all solves together do not use more than maxThreads.
+	// Every worker needs at least one thread, so there are no more workers than threads
+	if(maxThreads == 0)
+		maxThreads = std::max(1u, std::thread::hardware_concurrency());
+	numWorkers = std::min(getNumWorkerThreads(numWorkers, numGraphs), maxThreads);
+	for(auto& model : models)
+		model->limitNumThreads(maxThreads / numWorkers);
+
+	std::vector<Solution> solutions(numGraphs);
+	{
+		ScopedGILRelease gilLock;
+		parallelFor(numGraphs, numWorkers, [&](size_t i)
+		{
+			solutions[i] = models[i]->infer(weightVectors[i]);
+		});
+	}
+
+	list results;
+	for(size_t i = 0; i < numGraphs; ++i)
+		results.append(arrays ? models[i]->saveResultToArrays(solutions[i]) : models[i]->saveResultToPython(solutions[i]));
+	return results;
+}
+
+object trackSlidingWindow(object& graphDict, object& weightsDict, size_t windowSize, size_t stepSize, object frameCallback, bool arrays)
+{
+	dict pyGraph = extract<dict>(graphDict);
+	dict pyWeights = extract<dict>(weightsDict);
+	
+	PythonModel model;
+	model.readFromPython(pyGraph);
+	FeatureVector weights = readWeightsFromPython(pyWeights);
+	Model::FrameCallback callback;
+	if(!frameCallback.is_none())
+	{
+		callback = [&](int timestep, const Solution& solution)
+		{
+			ScopedGILAcquire gilLock;
+			frameCallback(timestep, arrays ? model.saveResultToArrays(solution) : model.saveResultToPython(solution));
+		};
+	}
+	Solution solution;
+
+	{
+		ScopedGILRelease gilLock;
+		solution = model.inferSlidingWindow(weights, windowSize, stepSize, callback);
+	}
+
+	object result = arrays ? model.saveResultToArrays(solution) : model.saveResultToPython(solution);
+	return result;
+}
+
+object trackApproximate(object& graphDict, object& weightsDict, bool computeLowerBound)
+{
+	dict pyGraph = extract<dict>(graphDict);
+	dict pyWeights = extract<dict>(weightsDict);
+	
+	PythonModel model;
+	model.readFromPython(pyGraph);
+	FeatureVector weights = readWeightsFromPython(pyWeights);
+	Solution solution;
+
+	{
+		ScopedGILRelease gilLock;
+		solution = model.inferApproximate(weights, computeLowerBound);
+	}
+
+	dict result = model.saveResultToPython(solution);
+	result["energy"] = model.getLastSolutionValue();
+	if(computeLowerBound)
+		result["lowerBound"] = model.getLastLowerBound();
 	return result;
 }
 
+object trackRelaxed(object& graphDict, object& weightsDict, bool round, bool arrays)
+{
+	dict pyGraph = extract<dict>(graphDict);
+	dict pyWeights = extract<dict>(weightsDict);
+	
+	PythonModel model;
+	model.readFromPython(pyGraph);
+	FeatureVector weights = readWeightsFromPython(pyWeights);
+	Relaxation relaxation;
+
+	{
+		ScopedGILRelease gilLock;
+		relaxation = model.inferRelaxation(weights, round);
+	}
+
+	return model.saveRelaxationToPython(relaxation, arrays);
+}
+
+object trackWithWeightSequence(object& graphDict, object& weightsDictList)
+{
+	dict pyGraph = extract<dict>(graphDict);
+	list pyWeightsList = extract<list>(weightsDictList);
+
+	PythonModel model;
+	model.readFromPython(pyGraph);
+	std::vector<FeatureVector> weightSequence;
+	for(int i = 0; i < len(pyWeightsList); ++i)
+	{
+		dict pyWeights = extract<dict>(pyWeightsList[i]);
+		weightSequence.push_back(readWeightsFromPython(pyWeights));
+	}
+	std::vector<Solution> solutions;
+	std::vector<double> energies;
+
+	{
+		ScopedGILRelease gilLock;
+		solutions = model.inferWithWeightSequence(weightSequence, energies);
+	}
+
+	list results;
+	list resultEnergies;
+	for(size_t i = 0; i < solutions.size(); ++i)
+	{
+		results.append(model.saveResultToPython(solutions[i]));
+		resultEnergies.append(energies[i]);
+	}
+	return make_tuple(results, resultEnergies);
+}
+
 object train(object& graphDict, object& gtDict)
 {
 	dict pyGraph = extract<dict>(graphDict);
@@ -88,6 +252,44 @@ object trainWithWeightInitialization(object& graphDict, object& gtDict, object&
 	return result;
 }
 
+object trainMany(object& graphDictList, object& gtDictList, object& weightsDict)
+{
+	list pyGraphs = extract<list>(graphDictList);
+	list pyGts = extract<list>(gtDictList);
+	if(len(pyGraphs) != len(pyGts))
+		throw std::runtime_error("trainMany needs one ground truth per graph");
+
+	// reading needs the GIL, only learning runs without it
+	std::vector< std::unique_ptr<PythonModel> > models;
+	std::vector<Model*> instances;
+	for(int i = 0; i < len(pyGraphs); ++i)
+	{
+		dict pyGraph = extract<dict>(pyGraphs[i]);
+		dict pyGt = extract<dict>(pyGts[i]);
+		models.push_back(std::unique_ptr<PythonModel>(new PythonModel()));
+		models.back()->readFromPython(pyGraph);
+		models.back()->setPythonGt(pyGt);
+		instances.push_back(models.back().get());
+	}
+	if(models.empty())
+		throw std::runtime_error("trainMany needs at least one graph");
+
+	std::vector<double> weightInitialization(models.front()->computeNumWeights(), 0);
+	if(!weightsDict.is_none())
+	{
+		dict pyWeights = extract<dict>(weightsDict);
+		weightInitialization = readWeightsFromPython(pyWeights);
+	}
+	std::vector<double> weights;
+
+	{
+		ScopedGILRelease gilLock;
+		weights = Model::learnFromInstances(instances, weightInitialization);
+	}
+
+	return models.front()->saveWeightsToPython(weights);
+}
+
 bool validate(object& graphDict, object& gtDict)
 {
 	dict pyGraph = extract<dict>(graphDict);
@@ -106,15 +308,119 @@ bool validate(object& graphDict, object& gtDict)
 	return valid;
 }
 
+/**
+ * @brief A model that stays in memory between solves, so that it can be edited and solved again, e.g. while proofreading
+ */
+class TrackingSession
+{
+public:
+	TrackingSession(object& graphDict, object& weightsDict)
+	{
+		dict pyGraph = extract<dict>(graphDict);
+		model_.readFromPython(pyGraph);
+		setWeights(weightsDict);
+	}
+
+	void setWeights(object& weightsDict)
+	{
+		dict pyWeights = extract<dict>(weightsDict);
+		weights_ = readWeightsFromPython(pyWeights);
+	}
+
+	object track(bool arrays)
+	{
+		Solution solution;
+		{
+			ScopedGILRelease gilLock;
+			solution = model_.infer(weights_);
+		}
+		return arrays ? model_.saveResultToArrays(solution) : model_.saveResultToPython(solution);
+	}
+
+	void addSegmentationHypothesis(object& entry)
+	{
+		dict pyEntry = extract<dict>(entry);
+		model_.addSegmentationHypothesisFromPython(pyEntry);
+	}
+
+	void addLinkingHypothesis(object& entry)
+	{
+		dict pyEntry = extract<dict>(entry);
+		model_.addLinkingHypothesisFromPython(pyEntry);
+	}
+
+	void addDivisionHypothesis(object& entry)
+	{
+		dict pyEntry = extract<dict>(entry);
+		model_.addDivisionHypothesisFromPython(pyEntry);
+	}
+
+	void addExclusionConstraint(object& ids) { model_.addExclusionConstraint(extractIds(ids)); }
+	void removeSegmentationHypothesis(object& id) { model_.removeSegmentationHypothesis(extract<IdLabelType>(id)); }
+	void removeLinkingHypothesis(object& src, object& dest) { model_.removeLinkingHypothesis(extract<IdLabelType>(src), extract<IdLabelType>(dest)); }
+	void removeDivisionHypothesis(object& parent, object& children) { model_.removeDivisionHypothesis(extract<IdLabelType>(parent), extractIds(children)); }
+	void removeExclusionConstraint(object& ids) { model_.removeExclusionConstraint(extractIds(ids)); }
+	void fixDetection(object& id, int value) { model_.fixDetection(extract<IdLabelType>(id), value); }
+	void fixDivision(object& id, int value) { model_.fixDivision(extract<IdLabelType>(id), value); }
+	void fixLink(object& src, object& dest, int value) { model_.fixLink(extract<IdLabelType>(src), extract<IdLabelType>(dest), value); }
+	void fixExternalDivision(object& parent, object& children, int value) { model_.fixExternalDivision(extract<IdLabelType>(parent), extractIds(children), value); }
+	dict telemetry() const { return model_.telemetryToPython(); }
+
+private:
+	static std::vector<IdLabelType> extractIds(object& ids)
+	{
+		std::vector<IdLabelType> result;
+		for(int i = 0; i < len(ids); ++i)
+			result.push_back(extract<IdLabelType>(ids[i]));
+		return result;
+	}
+
+	PythonModel model_;
+	FeatureVector weights_;
+};
+
 /**
  * @brief Python interface of 'mht' module
  */
 BOOST_PYTHON_MODULE( multiHypoTracking@SUFFIX@ )
 {
-	def("track", track, args("graph", "weights"),
+	def("track", track, (arg("graph"), arg("weights"), arg("cacheDirectory") = std::string(), arg("cacheSize") = 0, arg("arrays") = false),
 		"Use an ILP solver on a graph specified as a dictionary,"
-		"in the same structure as the supported JSON format. Similarly, the weights are also given as dict.\n\n"
-		"Returns a python dictionary similar to the result.json file");
+		"in the same structure as the supported JSON format. Similarly, the weights are also given as dict.\n"
+		"Instead of lists of dicts, the hypotheses can be given as dicts of NumPy arrays with one row per hypothesis, "
+		"which is much faster for large graphs (see PythonModel::readFromArrays).\n"
+		"If cacheDirectory is given, solutions are stored there and returned again for the same graph and weights, "
+		"keeping at most cacheSize of them (0 for unlimited, see Model::setSolutionCache).\n\n"
+		"Returns a python dictionary similar to the result.json file. With arrays=True, the detection, link and division results "
+		"are dicts of NumPy arrays with one row per active hypothesis instead of lists of dicts (see PythonModel::saveResultToArrays)");
+	def("trackMany", trackMany, (arg("graphs"), arg("weights"), arg("numWorkers") = 0, arg("maxThreads") = 0, arg("arrays") = false),
+		"Like track, but for a list of graphs, e.g. one per lineage or crop. The weights are either one dict for all graphs "
+		"or a list with one dict per graph. All graphs are converted first, then numWorkers of them (0 for all CPU cores) are solved "
+		"at the same time without holding the GIL, but never more than maxThreads (0 for all CPU cores). "
+		"Every graph gets an equal share of maxThreads, which bounds the threads of all solves together (see Model::limitNumThreads).\n\n"
+		"Returns a list of python dictionaries like track, in the order of the graphs, with NumPy arrays if arrays is set");
+	def("trackSlidingWindow", trackSlidingWindow, 
+		(arg("graph"), arg("weights"), arg("windowSize"), arg("stepSize") = 1, arg("frameCallback") = object(), arg("arrays") = false),
+		"Like track, but solves windowSize timesteps at a time and commits the first stepSize of them before the window moves on, "
+		"which needs much less memory for long movies but is not optimal (see Model::inferSlidingWindow). "
+		"If frameCallback is given, it is called with every committed timestep in order and a result dictionary like track "
+		"(with arrays if arrays is set), in which the detections of that and all earlier timesteps are final.\n\n"
+		"Returns a python dictionary like track");
+	def("trackApproximate", trackApproximate, (arg("graph"), arg("weights"), arg("computeLowerBound") = false),
+		"Like track, but finds a good solution quickly without an ILP by greedily adding the cheapest tracks, "
+		"e.g. for previews (see Model::inferApproximate).\n\n"
+		"Returns a python dictionary like track, with the additional entries energy and, if computeLowerBound is set, "
+		"lowerBound, the energy of the LP relaxation which no solution can undercut");
+	def("trackRelaxed", trackRelaxed, (arg("graph"), arg("weights"), arg("round") = true, arg("arrays") = false),
+		"Solve only the LP relaxation of the tracking ILP, which is much faster, and round it to a valid tracking if round is set "
+		"(see Model::inferRelaxation).\n\n"
+		"Returns a python dictionary with NumPy arrays of the fractional values of the detections, links and divisions, "
+		"the energy of the relaxation as lowerBound, its numFractional variables and maxFractionality, "
+		"and the rounded tracking as rounded, like the result of track (with arrays if arrays is set)");
+	def("trackWithWeightSequence", trackWithWeightSequence, args("graph", "weightsList"),
+		"Like track, but solves the graph for each weights dict in the given list, "
+		"building the model only once and warm-starting each solve from the previous solution.\n\n"
+		"Returns a tuple of a list of result dictionaries and a list of the corresponding energies");
 	def("train", train, args("graph", "groundTruth"),
 		"Run Structured Learning with an ILP solver on a graph specified as a dictionary,"
 		"in the same structure as the supported JSON format." 
@@ -125,9 +431,50 @@ BOOST_PYTHON_MODULE( multiHypoTracking@SUFFIX@ )
 		"in the same structure as the supported JSON format. Similarly, the weights are also given as dict." 
 		"Similarly, the ground truth are also given as dict as in a result.json file .\n\n"
 		"Returns a python dictionary containing a weights entry");
+	def("trainMany", trainMany, (arg("graphs"), arg("groundTruths"), arg("initialWeights") = object()),
+		"Run Structured Learning on several graphs at once, given as lists of graph and ground truth dictionaries "
+		"in the same order. Every graph becomes its own instance of the learning dataset and all share one set of weights, "
+		"which is faster and needs less memory than merging the graphs into one (see Model::learnFromInstances). "
+		"All graphs must have the same number of features of every kind, the settings of the first graph are used for learning.\n\n"
+		"Returns a python dictionary containing a weights entry");
 	def("validate", train, args("graph", "solution"),
 		"Validate a solution on a graph specified as a dictionary,"
 		"in the same structure as the supported JSON format." 
 		"Similarly, the solution is also given as dict as in a result.json file .\n\n"
 		"Returns a boolean whether the solution is valid");
+
+	class_<TrackingSession, boost::noncopyable>("TrackingSession",
+		"A graph and weights that stay in memory, so that hypotheses can be added, removed and fixed, e.g. while proofreading, "
+		"and the graph solved again without reading it anew (see Model::addSegmentationHypothesis). Every solve after edits starts "
+		"from the previous solution, in which new hypotheses are inactive and which is repaired if the edits broke it. "
+		"With decomposeIntoComponents, only the connected components that were edited are built again.",
+		init<object&, object&>((arg("graph"), arg("weights"))))
+		.def("track", &TrackingSession::track, (arg("arrays") = false),
+			"Solve the graph as it is now, returns a result dictionary like track")
+		.def("setWeights", &TrackingSession::setWeights, (arg("weights")),
+			"Use the given weights dict for the following solves")
+		.def("addSegmentationHypothesis", &TrackingSession::addSegmentationHypothesis, (arg("hypothesis")),
+			"Add a detection given as dict like in the segmentationHypotheses list of a graph")
+		.def("addLinkingHypothesis", &TrackingSession::addLinkingHypothesis, (arg("hypothesis")),
+			"Add a link given as dict like in the linkingHypotheses list of a graph, between existing detections")
+		.def("addDivisionHypothesis", &TrackingSession::addDivisionHypothesis, (arg("hypothesis")),
+			"Add a division given as dict like in the divisionHypotheses list of a graph, between existing detections")
+		.def("addExclusionConstraint", &TrackingSession::addExclusionConstraint, (arg("ids")),
+			"Let the detections with the given ids exclude each other")
+		.def("removeSegmentationHypothesis", &TrackingSession::removeSegmentationHypothesis, (arg("id")),
+			"Remove a detection together with its links, divisions and from all exclusion constraints")
+		.def("removeLinkingHypothesis", &TrackingSession::removeLinkingHypothesis, (arg("src"), arg("dest")))
+		.def("removeDivisionHypothesis", &TrackingSession::removeDivisionHypothesis, (arg("parent"), arg("children")))
+		.def("removeExclusionConstraint", &TrackingSession::removeExclusionConstraint, (arg("ids")),
+			"Allow the detections with the given ids to be active at the same time")
+		.def("fixDetection", &TrackingSession::fixDetection, (arg("id"), arg("value")),
+			"Force the detection into the given value (number of objects) in all following solves, a negative value releases it")
+		.def("fixDivision", &TrackingSession::fixDivision, (arg("id"), arg("value")),
+			"Force the division variable of the detection into the given value, like fixDetection")
+		.def("fixLink", &TrackingSession::fixLink, (arg("src"), arg("dest"), arg("value")),
+			"Force the link into the given value, like fixDetection")
+		.def("fixExternalDivision", &TrackingSession::fixExternalDivision, (arg("parent"), arg("children"), arg("value")),
+			"Force the division hypothesis into the given value, like fixDetection")
+		.def("telemetry", &TrackingSession::telemetry,
+			"Phases and counters of all solves so far, like the telemetry entry of a result");
 }
@@ -1,6 +1,11 @@
 #include "pythonmodel.h"
 #include <assert.h>
 #include <fstream>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "parallel.h"
 
 using namespace boost::python;
 using namespace helpers;
@@ -8,7 +13,252 @@ using namespace helpers;
 namespace mht
 {
 
+namespace
+{
+
+/**
+ * @brief Read-only view of a C-contiguous array that supports the python buffer protocol, e.g. a NumPy array.
+ *        The data is accessed in place, without copying or converting the array in python.
+ */
+class ArrayView
+{
+public:
+	ArrayView(const object& array, const std::string& name):
+		name_(name)
+	{
+		if(PyObject_GetBuffer(array.ptr(), &buffer_, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0)
+		{
+			PyErr_Clear();
+			throw std::runtime_error("Entry " + name + " must be a C-contiguous array");
+		}
+
+		// only native and little endian byte order, element types are identified by their kind and size
+		const char* format = buffer_.format ? buffer_.format : "B";
+		if(*format == '@' || *format == '=' || *format == '<')
+			format++;
+		if(std::string("bhilqn").find(*format) != std::string::npos)
+			kind_ = 'i';
+		else if(std::string("?BHILQN").find(*format) != std::string::npos)
+			kind_ = 'u';
+		else if(*format == 'f' || *format == 'd')
+			kind_ = 'f';
+		else
+			kind_ = 0;
+
+		if(kind_ == 0 || format[1] != '\0' || (kind_ == 'f' && buffer_.itemsize != 4 && buffer_.itemsize != 8))
+		{
+			std::string error = "Entry " + name + " has unsupported element type " + std::string(buffer_.format ? buffer_.format : "");
+			PyBuffer_Release(&buffer_);
+			throw std::runtime_error(error);
+		}
+	}
+
+	~ArrayView()
+	{
+		PyBuffer_Release(&buffer_);
+	}
+
+	ArrayView(const ArrayView&) = delete;
+	ArrayView& operator=(const ArrayView&) = delete;
+
+	size_t getNumDimensions() const { return buffer_.ndim; }
+	size_t getShape(size_t dimension) const { return dimension < (size_t)buffer_.ndim ? buffer_.shape[dimension] : 1; }
+	size_t getSize() const { return buffer_.len / buffer_.itemsize; }
+
+	/**
+	 * @brief Check that the array has the given number of dimensions and the given length along the first one
+	 */
+	void checkShape(size_t numDimensions, size_t numRows) const
+	{
+		if(getNumDimensions() != numDimensions)
+			throw std::runtime_error("Entry " + name_ + " must have " + std::to_string(numDimensions) + " dimensions");
+		if(getShape(0) != numRows)
+			throw std::runtime_error("Entry " + name_ + " must have " + std::to_string(numRows) + " rows");
+	}
+
+	ValueType getValue(size_t index) const
+	{
+		const char* element = static_cast<const char*>(buffer_.buf) + index * buffer_.itemsize;
+		if(kind_ == 'f')
+			return buffer_.itemsize == 4 ? *reinterpret_cast<const float*>(element) : *reinterpret_cast<const double*>(element);
+		return (ValueType)getInteger(index);
+	}
+
+	long long getInteger(size_t index) const
+	{
+		const char* element = static_cast<const char*>(buffer_.buf) + index * buffer_.itemsize;
+		if(kind_ == 'f')
+			throw std::runtime_error("Entry " + name_ + " must contain integers");
+
+		switch(buffer_.itemsize)
+		{
+			case 1: return kind_ == 'i' ? (long long)*reinterpret_cast<const int8_t*>(element) : (long long)*reinterpret_cast<const uint8_t*>(element);
+			case 2: return kind_ == 'i' ? (long long)*reinterpret_cast<const int16_t*>(element) : (long long)*reinterpret_cast<const uint16_t*>(element);
+			case 4: return kind_ == 'i' ? (long long)*reinterpret_cast<const int32_t*>(element) : (long long)*reinterpret_cast<const uint32_t*>(element);
+			case 8: return kind_ == 'i' ? (long long)*reinterpret_cast<const int64_t*>(element) : (long long)*reinterpret_cast<const uint64_t*>(element);
+			default: throw std::runtime_error("Entry " + name_ + " has unsupported integer size");
+		}
+	}
+
+	IdLabelType getId(size_t index) const
+	{
+		long long id = getInteger(index);
+#ifdef USE_STRING_IDS
+		return std::to_string(id);
+#else
+		if(id < 0 || id > (long long)std::numeric_limits<IdLabelType>::max())
+			throw std::runtime_error("Entry " + name_ + " contains an invalid id " + std::to_string(id));
+		return (IdLabelType)id;
+#endif
+	}
+
+	/**
+	 * @brief Get the features of one hypothesis from a (rows x states x features) array
+	 * @return the features per state, or an empty vector if all entries of the row are NaN
+	 */
+	StateFeatureVector getStateFeatures(size_t row) const
+	{
+		size_t numStates = getShape(1);
+		size_t numFeatures = getShape(2);
+		size_t offset = row * numStates * numFeatures;
+
+		bool allNaN = true;
+		StateFeatureVector features(numStates, FeatureVector(numFeatures));
+		for(size_t state = 0; state < numStates; ++state)
+		{
+			for(size_t i = 0; i < numFeatures; ++i)
+			{
+				ValueType value = getValue(offset++);
+				features[state][i] = value;
+				allNaN = allNaN && std::isnan(value);
+			}
+		}
+
+		if(allNaN)
+			features.clear();
+		return features;
+	}
+
+private:
+	Py_buffer buffer_;
+	std::string name_;
+	char kind_; // 'i' for signed and 'u' for unsigned integers, 'f' for floating point numbers
+};
+
+/**
+ * @brief A new one dimensional NumPy array of the given element type, whose elements can be written from any thread
+ */
+template<class T>
+class ResultArray
+{
+public:
+	ResultArray(size_t size, const char* dtype)
+	{
+		allocate(import("numpy").attr("empty")(size, dtype));
+	}
+
+	/// a C-contiguous array of rows x columns entries, entry (row, column) is at index row * columns + column
+	ResultArray(size_t rows, size_t columns, const char* dtype)
+	{
+		allocate(import("numpy").attr("empty")(boost::python::make_tuple(rows, columns), dtype));
+	}
+
+	~ResultArray()
+	{
+		PyBuffer_Release(&buffer_);
+	}
+
+	ResultArray(const ResultArray&) = delete;
+	ResultArray& operator=(const ResultArray&) = delete;
+
+	T& operator[](size_t index) { return static_cast<T*>(buffer_.buf)[index]; }
+	const object& getArray() const { return array_; }
+
+private:
+	void allocate(const object& array)
+	{
+		array_ = array;
+		if(PyObject_GetBuffer(array_.ptr(), &buffer_, PyBUF_C_CONTIGUOUS | PyBUF_WRITABLE) != 0)
+		{
+			PyErr_Clear();
+			throw std::runtime_error("Could not write to a new NumPy array");
+		}
+		if((size_t)buffer_.itemsize != sizeof(T))
+		{
+			PyBuffer_Release(&buffer_);
+			throw std::runtime_error("NumPy array has an unexpected element size");
+		}
+	}
+
+	object array_;
+	Py_buffer buffer_;
+};
+
+/// array of ids or states
+class IndexArray : public ResultArray<uint32_t>
+{
+public:
+	IndexArray(size_t size): ResultArray<uint32_t>(size, "uint32") {}
+	IndexArray(size_t rows, size_t columns): ResultArray<uint32_t>(rows, columns, "uint32") {}
+};
+
+/// array of fractional values
+class ValueArray : public ResultArray<double>
+{
+public:
+	ValueArray(size_t size): ResultArray<double>(size, "float64") {}
+};
+
+/**
+ * @brief Call func(i, row) for the active items, which are numbered by their row in the result arrays, in chunks on several threads
+ */
+template<class FUNCTOR>
+void forEachActiveItem(const std::vector<size_t>& activeItems, size_t numThreads, FUNCTOR func)
+{
+	const size_t chunkSize = 4096;
+	parallelFor((activeItems.size() + chunkSize - 1) / chunkSize, numThreads, [&](size_t chunk)
+	{
+		size_t end = std::min(activeItems.size(), (chunk + 1) * chunkSize);
+		for(size_t row = chunk * chunkSize; row < end; ++row)
+			func(activeItems[row], row);
+	});
+}
+
+uint32_t idToArray(const IdLabelType& id)
+{
+#ifdef USE_STRING_IDS
+	throw std::runtime_error("Results can only be returned as arrays for numeric ids");
+#else
+	return id;
+#endif
+}
+
+/**
+ * @brief Create a view of the array stored under the given key, or nullptr if the dictionary has no such entry
+ */
+std::unique_ptr<ArrayView> getArray(dict& entries, JsonTypes type, const std::string& parentName, bool required)
+{
+	const std::string& key = JsonTypeNames[type];
+	if(!entries.has_key(key) || object(entries[key]).ptr() == Py_None)
+	{
+		if(required)
+			throw std::runtime_error("Python dict entry " + parentName + " is invalid: missing " + key);
+		return std::unique_ptr<ArrayView>();
+	}
+	return std::unique_ptr<ArrayView>(new ArrayView(entries[key], parentName + "." + key));
+}
+
+} // end anonymous namespace
+
 void PythonModel::readLinkingHypothesis(dict& entry)
+{
+    // add to list, registering with the segmentations happens once the whole graph is read
+    LinkingHypothesis link = extractLinkingHypothesis(entry);
+    std::pair<helpers::IdLabelType, helpers::IdLabelType> ids = std::make_pair(link.getSrcId(), link.getDestId());
+    linkingHypotheses_[ids] = std::move(link);
+}
+
+LinkingHypothesis PythonModel::extractLinkingHypothesis(dict& entry)
 {
 	if(!entry.has_key(JsonTypeNames[JsonTypes::SrcId]))
         throw std::runtime_error("Python dict entry for LinkingHypothesis is invalid: missing srcId"); 
@@ -23,14 +273,17 @@ void PythonModel::readLinkingHypothesis(dict& entry)
     // get transition features
     helpers::StateFeatureVector features = extractFeatures(entry, JsonTypes::Features);
 
-    // add to list
-    std::shared_ptr<LinkingHypothesis> hyp = std::make_shared<LinkingHypothesis>(srcId, destId, features);
-    std::pair<helpers::IdLabelType, helpers::IdLabelType> ids = std::make_pair(srcId, destId);
-    hyp->registerWithSegmentations(segmentationHypotheses_);
-    linkingHypotheses_[ids] = hyp;
+    return LinkingHypothesis(srcId, destId, std::move(features));
 }
 
 void PythonModel::readSegmentationHypothesis(dict& entry)
+{
+    SegmentationHypothesis hyp = extractSegmentationHypothesis(entry);
+    IdLabelType id = hyp.getId();
+    segmentationHypotheses_[id] = std::move(hyp);
+}
+
+SegmentationHypothesis PythonModel::extractSegmentationHypothesis(dict& entry)
 {
 	if(!entry.has_key(JsonTypeNames[JsonTypes::Id]))
 		throw std::runtime_error("Cannot read detection hypothesis without Id!");
@@ -54,12 +307,30 @@ void PythonModel::readSegmentationHypothesis(dict& entry)
     if(entry.has_key(JsonTypeNames[JsonTypes::DisappearanceFeatures]))
         disappearanceFeatures = extractFeatures(entry, JsonTypes::DisappearanceFeatures);
 
-    // add to list
-    SegmentationHypothesis hyp(id, detectionFeatures, divisionFeatures, appearanceFeatures, disappearanceFeatures);
-    segmentationHypotheses_[id] = hyp;
+    SegmentationHypothesis hyp(id, std::move(detectionFeatures), std::move(divisionFeatures), std::move(appearanceFeatures), std::move(disappearanceFeatures));
+
+    // the timestep can be given as number or as [first, last] list like in ilastik, where we use the first entry
+    if(entry.has_key(JsonTypeNames[JsonTypes::Timestep]))
+    {
+        object timestep = entry[JsonTypeNames[JsonTypes::Timestep]];
+        extract<list> timestepList(timestep);
+        if(timestepList.check())
+            hyp.setTimestep(extract<int>(timestepList()[0]));
+        else
+            hyp.setTimestep(extract<int>(timestep));
+    }
+    return hyp;
 }
 
 void PythonModel::readDivisionHypothesis(dict& entry)
+{
+    // add to list, registering with the segmentations happens once the whole graph is read
+    DivisionHypothesis division = extractDivisionHypothesis(entry);
+    auto ids = std::make_tuple(division.getParentId(), division.getChildrenIds()[0], division.getChildrenIds()[1]);
+    divisionHypotheses_[ids] = std::move(division);
+}
+
+DivisionHypothesis PythonModel::extractDivisionHypothesis(dict& entry)
 {
     if(!entry.has_key(JsonTypeNames[JsonTypes::Parent]))
         throw std::runtime_error("JSON entry for DivisionHypothesis is invalid: missing srcId"); 
@@ -83,11 +354,7 @@ void PythonModel::readDivisionHypothesis(dict& entry)
     // get transition features
     StateFeatureVector features = extractFeatures(entry, JsonTypes::Features);
 
-    // add to list
-    std::shared_ptr<DivisionHypothesis> hyp = std::make_shared<DivisionHypothesis>(parentId, childrenIds, features);
-    hyp->registerWithSegmentations(segmentationHypotheses_);
-    auto ids = std::make_tuple(parentId, childrenIds[0], childrenIds[1]);
-    divisionHypotheses_[ids] = hyp;
+    return DivisionHypothesis(parentId, childrenIds, std::move(features));
 }
 
 void PythonModel::readExclusionConstraint(list& entry)
@@ -108,6 +375,21 @@ void PythonModel::readExclusionConstraint(list& entry)
     exclusionConstraints_.push_back(ExclusionConstraint(ids));
 }
 
+void PythonModel::addSegmentationHypothesisFromPython(dict& entry)
+{
+    addSegmentationHypothesis(extractSegmentationHypothesis(entry));
+}
+
+void PythonModel::addLinkingHypothesisFromPython(dict& entry)
+{
+    addLinkingHypothesis(extractLinkingHypothesis(entry));
+}
+
+void PythonModel::addDivisionHypothesisFromPython(dict& entry)
+{
+    addDivisionHypothesis(extractDivisionHypothesis(entry));
+}
+
 void PythonModel::setPythonGt(boost::python::dict& gtDict)
 {
 	// store the python GT in a set of maps (_gt...States)
@@ -229,7 +511,7 @@ void PythonModel::setPythonGt(boost::python::dict& gtDict)
     }
 }
 
-void PythonModel::readFromPython(dict& graphDict)
+void PythonModel::readSettingsFromPython(dict& graphDict)
 {
 	// get flag whether states should share weights or not
 	settings_ = std::make_shared<helpers::Settings>();
@@ -253,6 +535,34 @@ void PythonModel::readFromPython(dict& graphDict)
 			settings_->optimizerNumThreads_ = extract<int>(settings[JsonTypeNames[JsonTypes::OptimizerNumThreads]]);
         if(settings.has_key(JsonTypeNames[JsonTypes::NonNegativeWeightsOnly]))
 			settings_->nonNegativeWeightsOnly_ = extract<bool>(settings[JsonTypeNames[JsonTypes::NonNegativeWeightsOnly]]);
+		if(settings.has_key(JsonTypeNames[JsonTypes::DecomposeIntoComponents]))
+			settings_->decomposeIntoComponents_ = extract<bool>(settings[JsonTypeNames[JsonTypes::DecomposeIntoComponents]]);
+		if(settings.has_key(JsonTypeNames[JsonTypes::ComponentNumThreads]))
+			settings_->componentNumThreads_ = extract<int>(settings[JsonTypeNames[JsonTypes::ComponentNumThreads]]);
+		if(settings.has_key(JsonTypeNames[JsonTypes::UseFlowSolver]))
+			settings_->useFlowSolver_ = extract<bool>(settings[JsonTypeNames[JsonTypes::UseFlowSolver]]);
+		if(settings.has_key(JsonTypeNames[JsonTypes::SlidingWindowSize]))
+			settings_->slidingWindowSize_ = extract<int>(settings[JsonTypeNames[JsonTypes::SlidingWindowSize]]);
+		if(settings.has_key(JsonTypeNames[JsonTypes::SlidingWindowStep]))
+			settings_->slidingWindowStep_ = extract<int>(settings[JsonTypeNames[JsonTypes::SlidingWindowStep]]);
+		if(settings.has_key(JsonTypeNames[JsonTypes::DualDecompositionChunkSize]))
+			settings_->dualDecompositionChunkSize_ = extract<int>(settings[JsonTypeNames[JsonTypes::DualDecompositionChunkSize]]);
+		if(settings.has_key(JsonTypeNames[JsonTypes::DualDecompositionOverlap]))
+			settings_->dualDecompositionOverlap_ = extract<int>(settings[JsonTypeNames[JsonTypes::DualDecompositionOverlap]]);
+		if(settings.has_key(JsonTypeNames[JsonTypes::DualDecompositionIterations]))
+			settings_->dualDecompositionIterations_ = extract<int>(settings[JsonTypeNames[JsonTypes::DualDecompositionIterations]]);
+		if(settings.has_key(JsonTypeNames[JsonTypes::GreedyWarmStart]))
+			settings_->greedyWarmStart_ = extract<bool>(settings[JsonTypeNames[JsonTypes::GreedyWarmStart]]);
+		if(settings.has_key(JsonTypeNames[JsonTypes::Presolve]))
+			settings_->presolve_ = extract<bool>(settings[JsonTypeNames[JsonTypes::Presolve]]);
+		if(settings.has_key(JsonTypeNames[JsonTypes::BuildNumThreads]))
+			settings_->buildNumThreads_ = extract<int>(settings[JsonTypeNames[JsonTypes::BuildNumThreads]]);
+		if(settings.has_key(JsonTypeNames[JsonTypes::SolverBackend]))
+			settings_->solverBackend_ = extract<std::string>(settings[JsonTypeNames[JsonTypes::SolverBackend]]);
+		if(settings.has_key(JsonTypeNames[JsonTypes::SolutionCacheDirectory]))
+			settings_->solutionCacheDirectory_ = extract<std::string>(settings[JsonTypeNames[JsonTypes::SolutionCacheDirectory]]);
+		if(settings.has_key(JsonTypeNames[JsonTypes::SolutionCacheSize]))
+			settings_->solutionCacheSize_ = extract<int>(settings[JsonTypeNames[JsonTypes::SolutionCacheSize]]);
 	}
 	else
 	{
@@ -260,6 +570,20 @@ void PythonModel::readFromPython(dict& graphDict)
 	}
 
 	settings_->print();
+}
+
+void PythonModel::readFromPython(dict& graphDict)
+{
+	// hypotheses given as dictionary of arrays instead of list of dictionaries
+	if(graphDict.has_key(JsonTypeNames[JsonTypes::Segmentations]) 
+		&& extract<dict>(graphDict[JsonTypeNames[JsonTypes::Segmentations]]).check())
+	{
+		readFromArrays(graphDict);
+		return;
+	}
+
+	Telemetry::ScopedPhase parsePhase(telemetry_, "parse");
+	readSettingsFromPython(graphDict);
 
 	list segmentationHypotheses = extract<list>(graphDict[JsonTypeNames[JsonTypes::Segmentations]]);
 	list linkingHypotheses = extract<list>(graphDict[JsonTypeNames[JsonTypes::Links]]);
@@ -304,6 +628,193 @@ void PythonModel::readFromPython(dict& graphDict)
 			readExclusionConstraint(exclusionSet);
 		}
 	}
+
+	parsePhase.stop();
+	buildAdjacency();
+}
+
+void PythonModel::readFromArrays(dict& graphDict)
+{
+	Telemetry::ScopedPhase parsePhase(telemetry_, "parse");
+	readSettingsFromPython(graphDict);
+
+	// ------------------------------------------------------------------------------
+	// segmentation hypotheses
+	const std::string& segmentationsName = JsonTypeNames[JsonTypes::Segmentations];
+	if(!graphDict.has_key(segmentationsName))
+		throw std::runtime_error("Python dict is invalid: missing " + segmentationsName);
+	dict segmentations = extract<dict>(graphDict[segmentationsName]);
+
+	std::unique_ptr<ArrayView> ids = getArray(segmentations, JsonTypes::Id, segmentationsName, true);
+	size_t numSegmentations = ids->getSize();
+	ids->checkShape(1, numSegmentations);
+
+	std::unique_ptr<ArrayView> detectionFeatures = getArray(segmentations, JsonTypes::Features, segmentationsName, true);
+	std::unique_ptr<ArrayView> divisionFeatures = getArray(segmentations, JsonTypes::DivisionFeatures, segmentationsName, false);
+	std::unique_ptr<ArrayView> appearanceFeatures = getArray(segmentations, JsonTypes::AppearanceFeatures, segmentationsName, false);
+	std::unique_ptr<ArrayView> disappearanceFeatures = getArray(segmentations, JsonTypes::DisappearanceFeatures, segmentationsName, false);
+	std::unique_ptr<ArrayView> timesteps = getArray(segmentations, JsonTypes::Timestep, segmentationsName, false);
+	for(ArrayView* features : {detectionFeatures.get(), divisionFeatures.get(), appearanceFeatures.get(), disappearanceFeatures.get()})
+	{
+		if(features)
+			features->checkShape(3, numSegmentations);
+	}
+	if(timesteps)
+		timesteps->checkShape(1, numSegmentations);
+
+	std::cout << "\tcontains " << numSegmentations << " segmentation hypotheses" << std::endl;
+	segmentationHypotheses_.reserve(numSegmentations);
+	for(size_t i = 0; i < numSegmentations; ++i)
+	{
+		IdLabelType id = ids->getId(i);
+		StateFeatureVector features = detectionFeatures->getStateFeatures(i);
+		if(features.empty())
+			throw std::runtime_error("Cannot read detection hypothesis without features!");
+
+		auto inserted = segmentationHypotheses_.emplace(id, 
+			id,
+			std::move(features),
+			divisionFeatures ? divisionFeatures->getStateFeatures(i) : StateFeatureVector(),
+			appearanceFeatures ? appearanceFeatures->getStateFeatures(i) : StateFeatureVector(),
+			disappearanceFeatures ? disappearanceFeatures->getStateFeatures(i) : StateFeatureVector());
+		if(!inserted.second)
+		{
+			std::stringstream error;
+			error << "Segmentation hypothesis " << id << " is given more than once";
+			throw std::runtime_error(error.str());
+		}
+
+		if(timesteps)
+			inserted.first->second.setTimestep((int)timesteps->getInteger(i));
+	}
+
+	// ------------------------------------------------------------------------------
+	// linking hypotheses
+	const std::string& linksName = JsonTypeNames[JsonTypes::Links];
+	if(graphDict.has_key(linksName))
+	{
+		dict links = extract<dict>(graphDict[linksName]);
+		std::unique_ptr<ArrayView> srcIds = getArray(links, JsonTypes::SrcId, linksName, true);
+		std::unique_ptr<ArrayView> destIds = getArray(links, JsonTypes::DestId, linksName, true);
+		std::unique_ptr<ArrayView> features = getArray(links, JsonTypes::Features, linksName, true);
+		size_t numLinks = srcIds->getSize();
+		srcIds->checkShape(1, numLinks);
+		destIds->checkShape(1, numLinks);
+		features->checkShape(3, numLinks);
+
+		std::cout << "\tcontains " << numLinks << " linking hypotheses" << std::endl;
+		linkingHypotheses_.reserve(numLinks);
+		for(size_t i = 0; i < numLinks; ++i)
+		{
+			IdLabelType srcId = srcIds->getId(i);
+			IdLabelType destId = destIds->getId(i);
+			linkingHypotheses_.emplace(std::make_pair(srcId, destId), srcId, destId, features->getStateFeatures(i));
+		}
+	}
+
+	// ------------------------------------------------------------------------------
+	// external division hypotheses
+	const std::string& divisionsName = JsonTypeNames[JsonTypes::Divisions];
+	if(graphDict.has_key(divisionsName))
+	{
+		dict divisions = extract<dict>(graphDict[divisionsName]);
+		std::unique_ptr<ArrayView> parentIds = getArray(divisions, JsonTypes::Parent, divisionsName, true);
+		std::unique_ptr<ArrayView> childrenIds = getArray(divisions, JsonTypes::Children, divisionsName, true);
+		std::unique_ptr<ArrayView> features = getArray(divisions, JsonTypes::Features, divisionsName, true);
+		size_t numDivisions = parentIds->getSize();
+		parentIds->checkShape(1, numDivisions);
+		childrenIds->checkShape(2, numDivisions);
+		features->checkShape(3, numDivisions);
+		if(childrenIds->getShape(1) != 2)
+			throw std::runtime_error("Python dict entry " + divisionsName + " is invalid: must have two children per division");
+
+		std::cout << "\tcontains " << numDivisions << " division hypotheses" << std::endl;
+		divisionHypotheses_.reserve(numDivisions);
+		for(size_t i = 0; i < numDivisions; ++i)
+		{
+			IdLabelType parentId = parentIds->getId(i);
+			std::vector<IdLabelType> children = {childrenIds->getId(2 * i), childrenIds->getId(2 * i + 1)};
+
+			// always use ordered list of children!
+			std::sort(children.begin(), children.end());
+			auto divisionId = std::make_tuple(parentId, children[0], children[1]);
+			divisionHypotheses_.emplace(divisionId, parentId, children, features->getStateFeatures(i));
+		}
+	}
+
+	// ------------------------------------------------------------------------------
+	// exclusion constraints, which refer to rows of the segmentation hypothesis arrays
+	const std::string& exclusionsName = JsonTypeNames[JsonTypes::Exclusions];
+	if(graphDict.has_key(exclusionsName))
+	{
+		dict exclusions = extract<dict>(graphDict[exclusionsName]);
+		std::unique_ptr<ArrayView> offsets = getArray(exclusions, JsonTypes::Offsets, exclusionsName, true);
+		std::unique_ptr<ArrayView> indices = getArray(exclusions, JsonTypes::Indices, exclusionsName, true);
+		offsets->checkShape(1, offsets->getSize());
+		indices->checkShape(1, indices->getSize());
+		if(offsets->getSize() == 0)
+			throw std::runtime_error("Python dict entry " + exclusionsName + ".offsets must start with 0");
+
+		size_t numExclusions = offsets->getSize() - 1;
+		std::cout << "\tcontains " << numExclusions << " exclusions" << std::endl;
+		exclusionConstraints_.reserve(numExclusions);
+		for(size_t i = 0; i < numExclusions; ++i)
+		{
+			long long begin = offsets->getInteger(i);
+			long long end = offsets->getInteger(i + 1);
+			if(begin < 0 || end < begin || end > (long long)indices->getSize())
+				throw std::runtime_error("Python dict entry " + exclusionsName + ".offsets must be increasing and within indices");
+
+			std::vector<IdLabelType> exclusionIds;
+			for(long long j = begin; j < end; ++j)
+			{
+				long long row = indices->getInteger(j);
+				if(row < 0 || row >= (long long)numSegmentations)
+					throw std::runtime_error("Python dict entry " + exclusionsName + ".indices must be rows of the segmentation hypotheses");
+				exclusionIds.push_back(ids->getId(row));
+			}
+
+			if(exclusionIds.size() >= 2)
+				exclusionConstraints_.push_back(ExclusionConstraint(exclusionIds));
+		}
+	}
+
+	parsePhase.stop();
+	buildAdjacency();
+}
+
+dict PythonModel::telemetryToPython() const
+{
+	dict phases;
+	for(auto& phase : telemetry_.getPhases())
+	{
+		dict entry;
+		entry["wallTime"] = phase.second.wallTime;
+		entry["cpuTime"] = phase.second.cpuTime;
+		entry["calls"] = phase.second.calls;
+		phases[phase.first] = entry;
+	}
+
+	dict concurrentPhases;
+	for(auto& phase : telemetry_.getConcurrentPhases())
+	{
+		dict entry;
+		entry["wallTime"] = phase.second.wallTime;
+		entry["busyTime"] = phase.second.busyTime;
+		entry["cpuTime"] = phase.second.cpuTime;
+		entry["calls"] = phase.second.calls;
+		concurrentPhases[phase.first] = entry;
+	}
+
+	dict counters;
+	for(auto& counter : telemetry_.getCounters())
+		counters[counter.first] = counter.second;
+
+	dict result;
+	result["phases"] = phases;
+	result["concurrentPhases"] = concurrentPhases;
+	result["counters"] = counters;
+	return result;
 }
 
 dict PythonModel::saveWeightsToPython(const std::vector<double>& weights) const
@@ -320,6 +831,7 @@ dict PythonModel::saveWeightsToPython(const std::vector<double>& weights) const
 
 dict PythonModel::saveResultToPython(const Solution& sol) const
 {
+	Telemetry::ScopedPhase exportPhase(telemetry_, "export");
 	list detectionResults;
 	list linkResults;
 	list divisionResults;
@@ -328,7 +840,7 @@ dict PythonModel::saveResultToPython(const Solution& sol) const
 	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
 	{
 		// store in extra list
-		size_t value = sol[iter->second->getVariable().getOpenGMVariableId()];
+		size_t value = sol[iter->second.getVariable().getOpenGMVariableId()];
 		if(value > 0)
 		linkResults.append(linkToPython(iter->second, value));
 	}
@@ -345,9 +857,9 @@ dict PythonModel::saveResultToPython(const Solution& sol) const
     }
     for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
     {
-        if(iter->second->getVariable().getOpenGMVariableId() >= 0)
+        if(iter->second.getVariable().getOpenGMVariableId() >= 0)
         {
-            size_t value = sol[iter->second->getVariable().getOpenGMVariableId()];
+            size_t value = sol[iter->second.getVariable().getOpenGMVariableId()];
             if(value > 0)
                 divisionResults.append(divisionToPython(iter->second, value));
         }
@@ -369,22 +881,183 @@ dict PythonModel::saveResultToPython(const Solution& sol) const
 	result[JsonTypeNames[JsonTypes::LinkResults]] = linkResults;
 	result[JsonTypeNames[JsonTypes::DivisionResults]] = divisionResults;
     result[JsonTypeNames[JsonTypes::ResultEnergy]] = getLastSolutionValue();
+
+	exportPhase.stop();
+	result[JsonTypeNames[JsonTypes::Telemetry]] = telemetryToPython();
 	return result;
 }
 
-dict PythonModel::linkToPython(const std::shared_ptr<LinkingHypothesis>& link, size_t state) const
+template<class VALUE_ARRAY>
+dict PythonModel::valuesToArrays(const std::function<double(const Variable&)>& getValue) const
+{
+	auto isActive = [&](const Variable& var)
+	{
+		return var.getOpenGMVariableId() >= 0 && getValue(var) > 1e-9;
+	};
+
+	// find the active hypotheses in the same order as saveResultToPython(), 
+	// divisions of segmentation hypotheses are numbered before the division hypotheses
+	std::vector<size_t> activeLinks;
+	for(size_t i = 0; i < linkingHypotheses_.size(); ++i)
+	{
+		if(isActive((linkingHypotheses_.begin() + i)->second.getVariable()))
+			activeLinks.push_back(i);
+	}
+	std::vector<size_t> activeDivisions;
+	for(size_t i = 0; i < segmentationHypotheses_.size(); ++i)
+	{
+		if(isActive((segmentationHypotheses_.begin() + i)->second.getDivisionVariable()))
+			activeDivisions.push_back(i);
+	}
+	for(size_t i = 0; i < divisionHypotheses_.size(); ++i)
+	{
+		if(isActive((divisionHypotheses_.begin() + i)->second.getVariable()))
+			activeDivisions.push_back(segmentationHypotheses_.size() + i);
+	}
+	std::vector<size_t> activeDetections;
+	for(size_t i = 0; i < segmentationHypotheses_.size(); ++i)
+	{
+		if(isActive((segmentationHypotheses_.begin() + i)->second.getDetectionVariable()))
+			activeDetections.push_back(i);
+	}
+
+	// the arrays are created while holding the GIL, filling them does not touch any python object
+	IndexArray linkSrc(activeLinks.size()), linkDest(activeLinks.size());
+	IndexArray divisionId(activeDivisions.size()), divisionParent(activeDivisions.size()), divisionChildren(activeDivisions.size(), 2);
+	IndexArray detectionId(activeDetections.size());
+	VALUE_ARRAY linkValue(activeLinks.size()), divisionValue(activeDivisions.size()), detectionValue(activeDetections.size());
+	const size_t numThreads = settings_->buildNumThreads_;
+
+	forEachActiveItem(activeLinks, numThreads, [&](size_t i, size_t row)
+	{
+		const LinkingHypothesis& link = (linkingHypotheses_.begin() + i)->second;
+		linkSrc[row] = idToArray(link.getSrcId());
+		linkDest[row] = idToArray(link.getDestId());
+		linkValue[row] = getValue(link.getVariable());
+	});
+	forEachActiveItem(activeDivisions, numThreads, [&](size_t i, size_t row)
+	{
+		if(i < segmentationHypotheses_.size())
+		{
+			// the children are the destinations of the two outgoing links with the largest values,
+			// a link that carries both children is given twice
+			const SegmentationHypothesis& segmentation = (segmentationHypotheses_.begin() + i)->second;
+			double values[2] = {0.0, 0.0};
+			IdLabelType children[2] = {segmentation.getId(), segmentation.getId()};
+			for(auto link : segmentation.getOutgoingLinks())
+			{
+				if(link->getVariable().getOpenGMVariableId() < 0)
+					continue;
+				double value = getValue(link->getVariable());
+				if(value > values[0])
+				{
+					values[1] = values[0];
+					children[1] = children[0];
+					values[0] = value;
+					children[0] = link->getDestId();
+				}
+				else if(value > values[1])
+				{
+					values[1] = value;
+					children[1] = link->getDestId();
+				}
+			}
+			if(values[1] <= 1e-9)
+				children[1] = children[0];
+
+			divisionId[row] = idToArray(segmentation.getId());
+			divisionParent[row] = idToArray(segmentation.getId());
+			divisionChildren[2 * row] = idToArray(std::min(children[0], children[1]));
+			divisionChildren[2 * row + 1] = idToArray(std::max(children[0], children[1]));
+			divisionValue[row] = getValue(segmentation.getDivisionVariable());
+		}
+		else
+		{
+			const DivisionHypothesis& division = (divisionHypotheses_.begin() + (i - segmentationHypotheses_.size()))->second;
+			divisionId[row] = idToArray(division.getParentId());
+			divisionParent[row] = idToArray(division.getParentId());
+			divisionChildren[2 * row] = idToArray(division.getChildrenIds()[0]);
+			divisionChildren[2 * row + 1] = idToArray(division.getChildrenIds()[1]);
+			divisionValue[row] = getValue(division.getVariable());
+		}
+	});
+	forEachActiveItem(activeDetections, numThreads, [&](size_t i, size_t row)
+	{
+		const SegmentationHypothesis& segmentation = (segmentationHypotheses_.begin() + i)->second;
+		detectionId[row] = idToArray(segmentation.getId());
+		detectionValue[row] = getValue(segmentation.getDetectionVariable());
+	});
+
+	dict linkResults;
+	linkResults[JsonTypeNames[JsonTypes::SrcId]] = linkSrc.getArray();
+	linkResults[JsonTypeNames[JsonTypes::DestId]] = linkDest.getArray();
+	linkResults[JsonTypeNames[JsonTypes::Value]] = linkValue.getArray();
+	dict divisionResults;
+	divisionResults[JsonTypeNames[JsonTypes::Id]] = divisionId.getArray();
+	divisionResults[JsonTypeNames[JsonTypes::Parent]] = divisionParent.getArray();
+	divisionResults[JsonTypeNames[JsonTypes::Children]] = divisionChildren.getArray();
+	divisionResults[JsonTypeNames[JsonTypes::Value]] = divisionValue.getArray();
+	dict detectionResults;
+	detectionResults[JsonTypeNames[JsonTypes::Id]] = detectionId.getArray();
+	detectionResults[JsonTypeNames[JsonTypes::Value]] = detectionValue.getArray();
+
+	dict result;
+	result[JsonTypeNames[JsonTypes::DetectionResults]] = detectionResults;
+	result[JsonTypeNames[JsonTypes::LinkResults]] = linkResults;
+	result[JsonTypeNames[JsonTypes::DivisionResults]] = divisionResults;
+	return result;
+}
+
+dict PythonModel::saveResultToArrays(const Solution& sol) const
+{
+	Telemetry::ScopedPhase exportPhase(telemetry_, "export");
+	dict result = valuesToArrays<IndexArray>([&](const Variable& var)
+	{
+		return (double)sol[var.getOpenGMVariableId()];
+	});
+	result[JsonTypeNames[JsonTypes::ResultEnergy]] = getLastSolutionValue();
+
+	exportPhase.stop();
+	result[JsonTypeNames[JsonTypes::Telemetry]] = telemetryToPython();
+	return result;
+}
+
+dict PythonModel::saveRelaxationToPython(const Relaxation& relaxation, bool arrays) const
+{
+	Telemetry::ScopedPhase exportPhase(telemetry_, "export");
+	dict result = valuesToArrays<ValueArray>([&](const Variable& var)
+	{
+		return relaxation.values_[var.getOpenGMVariableId()];
+	});
+	result["lowerBound"] = relaxation.lowerBound_;
+	result["numFractional"] = relaxation.numFractional_;
+	result["maxFractionality"] = relaxation.maxFractionality_;
+	exportPhase.stop();
+
+	if(!relaxation.rounded_.empty())
+	{
+		dict rounded = arrays ? saveResultToArrays(relaxation.rounded_) : saveResultToPython(relaxation.rounded_);
+		rounded[JsonTypeNames[JsonTypes::ResultEnergy]] = relaxation.roundedEnergy_;
+		rounded[JsonTypeNames[JsonTypes::Telemetry]].del();
+		result["rounded"] = rounded;
+	}
+	result[JsonTypeNames[JsonTypes::Telemetry]] = telemetryToPython();
+	return result;
+}
+
+dict PythonModel::linkToPython(const LinkingHypothesis& link, size_t state) const
 {
 	dict linkRes;
-	linkRes[JsonTypeNames[JsonTypes::SrcId]] = link->getSrcId();
-    linkRes[JsonTypeNames[JsonTypes::DestId]] = link->getDestId();
+	linkRes[JsonTypeNames[JsonTypes::SrcId]] = link.getSrcId();
+    linkRes[JsonTypeNames[JsonTypes::DestId]] = link.getDestId();
     linkRes[JsonTypeNames[JsonTypes::Value]] = (unsigned int)state;
 	return linkRes;
 }
 
-dict PythonModel::divisionToPython(const std::shared_ptr<DivisionHypothesis>& division, size_t state) const
+dict PythonModel::divisionToPython(const DivisionHypothesis& division, size_t state) const
 {
 	dict divRes;
-	divRes[JsonTypeNames[JsonTypes::Id]] = division->getParentId();
+	divRes[JsonTypeNames[JsonTypes::Id]] = division.getParentId();
 	divRes[JsonTypeNames[JsonTypes::Value]] = state;
 	return divRes;
 }
@@ -445,34 +1118,32 @@ helpers::StateFeatureVector PythonModel::extractFeatures(boost::python::dict& en
 
 Solution PythonModel::getGroundTruth()
 {
-	if(!model_.numberOfVariables() > 0)
-        throw std::runtime_error("OpenGM model must be initialized before reading a ground truth!");
-	
-    // create a solution vector that holds a value for each segmentation / detection / link
-    Solution solution(model_.numberOfVariables(), 0);
+    // create a solution vector that holds a value for each segmentation / detection / link,
+    // the variable ids are the same as in the OpenGM model but the model does not need to be built for that
+    Solution solution(assignOpenGMVariableIds(), 0);
 
     for(auto link_iter = _gtLinkStates.begin(); link_iter != _gtLinkStates.end(); ++link_iter)
     {
-    	std::shared_ptr<LinkingHypothesis> hyp = linkingHypotheses_[link_iter->first];
-    	solution[hyp->getVariable().getOpenGMVariableId()] = link_iter->second;
+    	const LinkingHypothesis& hyp = linkingHypotheses_.at(link_iter->first);
+    	solution[hyp.getVariable().getOpenGMVariableId()] = link_iter->second;
     }
 
     for(auto segment_iter = _gtDetectionStates.begin(); segment_iter != _gtDetectionStates.begin(); ++segment_iter)
     {
-    	SegmentationHypothesis hyp = segmentationHypotheses_[segment_iter->first];
+    	const SegmentationHypothesis& hyp = segmentationHypotheses_.at(segment_iter->first);
     	solution[hyp.getDetectionVariable().getOpenGMVariableId()] = segment_iter->second;
     }
 
     for(auto division_iter = _gtDivisionStates.begin(); division_iter != _gtDivisionStates.begin(); ++division_iter)
     {
-    	SegmentationHypothesis hyp = segmentationHypotheses_[division_iter->first];
+    	const SegmentationHypothesis& hyp = segmentationHypotheses_.at(division_iter->first);
     	solution[hyp.getDivisionVariable().getOpenGMVariableId()] = division_iter->second;
     }
 
     for(auto ext_div_iter = _gtExternalDivisionStates.begin(); ext_div_iter != _gtExternalDivisionStates.begin(); ++ext_div_iter)
     {
-    	std::shared_ptr<DivisionHypothesis> hyp = divisionHypotheses_[ext_div_iter->first];
-    	solution[hyp->getVariable().getOpenGMVariableId()] = ext_div_iter->second;
+    	const DivisionHypothesis& hyp = divisionHypotheses_.at(ext_div_iter->first);
+    	solution[hyp.getVariable().getOpenGMVariableId()] = ext_div_iter->second;
     }
 
 	deduceAppearanceDisappearanceStates(solution);
@@ -7,6 +7,7 @@
 #include <vector>
 #include <map>
 #include <tuple>
+#include <functional>
 
 #include "model.h"
 #include "helpers.h"
@@ -25,8 +26,6 @@ helpers::FeatureVector readWeightsFromPython(boost::python::dict& weightsDict);
 
 /**
  * @brief Model specialized for Python loading and writing
- * @detail WARNING: at the moment you can only run either learn or infer once on the model. 
- *         Build a new one if you need it multiple times
  */
 class PythonModel : public Model
 {
@@ -37,6 +36,31 @@ public:
      */
     void readFromPython(boost::python::dict& graphDict);
 
+    /**
+     * @brief Read a model whose hypotheses are given as arrays, e.g. NumPy arrays, instead of lists of dictionaries
+     * @details The dictionary has the same top level entries as for readFromPython(), but each of them is a dictionary 
+     *          of arrays with one row per hypothesis, named like the attributes of a single hypothesis:
+     *          - "segmentationHypotheses": "id" (N), "features" (N x states x features), optional "timestep" (N),
+     *            "divisionFeatures" (N x 2 x features), "appearanceFeatures" and "disappearanceFeatures" (N x states x features),
+     *            where rows that only contain NaN mean that the hypothesis has no such variable
+     *          - "linkingHypotheses": "src" (L), "dest" (L), "features" (L x states x features)
+     *          - "divisions": "parent" (D), "children" (D x 2), "features" (D x 2 x features)
+     *          - "exclusions": "offsets" (E + 1) and "indices", where the rows of the segmentation hypotheses 
+     *            in [offsets[i], offsets[i+1]) of indices form the i'th exclusion constraint
+     *          The arrays must be C-contiguous and are read in place through the python buffer protocol,
+     *          integer and floating point arrays of any width are accepted.
+     *          readFromPython() calls this automatically if the segmentation hypotheses are given as dictionary.
+     */
+    void readFromArrays(boost::python::dict& graphDict);
+
+    /**
+     * @brief Add a hypothesis given as python dictionary with the same entries as in readFromPython() to a model 
+     *        that has been read already, see Model::addSegmentationHypothesis()
+     */
+    void addSegmentationHypothesisFromPython(boost::python::dict& entry);
+    void addLinkingHypothesisFromPython(boost::python::dict& entry);
+    void addDivisionHypothesisFromPython(boost::python::dict& entry);
+
     /**
      * @brief Export a found solution vector as a python dictionary
      * 
@@ -44,6 +68,29 @@ public:
      */
     boost::python::dict saveResultToPython(const helpers::Solution& sol) const;
 
+    /**
+     * @brief Export a found solution vector as a python dictionary of NumPy arrays, which is much faster for large graphs
+     * @details Has the same entries as saveResultToPython(), but "detectionResults", "linkingResults" and "divisionResults" 
+     *          are dictionaries of uint32 arrays with one row per active hypothesis, in the same order as the lists:
+     *          "id" and "value" for detections, "src", "dest" and "value" for links, and "id" (the parent), "parent", 
+     *          "children" (two ids per row, sorted) and "value" for divisions. The children of the division of a detection 
+     *          are the destinations of its two outgoing links with the largest values, or twice the one that carries both.
+     *          The arrays are filled on buildNumThreads threads. Only numeric ids are supported.
+     * 
+     * @param sol the labeling to save
+     */
+    boost::python::dict saveResultToArrays(const helpers::Solution& sol) const;
+
+    /**
+     * @brief Export the LP relaxation of inferRelaxation() as a python dictionary of NumPy arrays
+     * @details The detection, link and division results are dictionaries of arrays like in saveResultToArrays(),
+     *          with one row per hypothesis whose variable has a nonzero expected state, which is given as float64 "value".
+     *          The dictionary also contains the entries "lowerBound", "numFractional" and "maxFractionality" of the relaxation,
+     *          and the rounded tracking as "rounded", if there is one, in the format of saveResultToPython(),
+     *          or of saveResultToArrays() if arrays is set.
+     */
+    boost::python::dict saveRelaxationToPython(const Relaxation& relaxation, bool arrays) const;
+
     /**
      * @brief Export a found weight vector as a python dictionary
      * 
@@ -51,6 +98,12 @@ public:
      */
     boost::python::dict saveWeightsToPython(const std::vector<double>& weights) const;
 
+    /**
+     * @brief Export the telemetry of this model as a python dictionary, 
+     *        with the same "phases" and "counters" entries as in the JSON result file
+     */
+    boost::python::dict telemetryToPython() const;
+
     /**
      * @brief Specify the python dictionary containing a ground trouth which will be used in the getGroundTruth method.
      * 
@@ -65,6 +118,11 @@ public:
     virtual helpers::Solution getGroundTruth();
 
 private:
+    /**
+     * @brief read the settings of a model from its graph dictionary, or use the defaults if there are none
+     */
+    void readSettingsFromPython(boost::python::dict& graphDict);
+
     /**
      * @brief read linking hypothesis from Python and adds it to linkingHypotheses_
      * @details expects the json value to contain attributes "src"(helpers::IdLabelType), 
@@ -92,6 +150,13 @@ private:
      */
     void readDivisionHypothesis(boost::python::dict& entry);
 
+    /**
+     * @brief Create the hypothesis of a python dictionary, as read by the functions above
+     */
+    SegmentationHypothesis extractSegmentationHypothesis(boost::python::dict& entry);
+    LinkingHypothesis extractLinkingHypothesis(boost::python::dict& entry);
+    DivisionHypothesis extractDivisionHypothesis(boost::python::dict& entry);
+
     /**
      * @brief read exclusion constraint from Python
      * @details expects the json array to be a list of ints representing ids
@@ -100,13 +165,20 @@ private:
      */
     void readExclusionConstraint(boost::python::list& entry);
 
+    /**
+     * @brief Put the hypotheses with a nonzero value into arrays, in the layout of saveResultToArrays()
+     * @tparam VALUE_ARRAY type of the value arrays, for integer states or fractional values
+     */
+    template<class VALUE_ARRAY>
+    boost::python::dict valuesToArrays(const std::function<double(const Variable&)>& getValue) const;
+
     /**
      * @brief Create a json string describing this link with its value (for result saving)
      * 
      * @param state the state that this link has (will be saved as "value" in JSON)
      * @return the Python value to put in an array into the result file
      */
-    boost::python::dict linkToPython(const std::shared_ptr<LinkingHypothesis>& link, size_t state) const;
+    boost::python::dict linkToPython(const LinkingHypothesis& link, size_t state) const;
 
     /**
      * @brief Create a json string describing this division with its value (for result saving)
@@ -114,7 +186,7 @@ private:
      * @param state the state that this division has (will be saved as "value" in JSON)
      * @return the Python value to put in an array into the result file
      */
-    boost::python::dict divisionToPython(const std::shared_ptr<DivisionHypothesis>& division, size_t state) const;
+    boost::python::dict divisionToPython(const DivisionHypothesis& division, size_t state) const;
 
     /**
      * @brief Create json value containing the state of this division, linked to this detection's id
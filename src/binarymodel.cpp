@@ -0,0 +1,644 @@
+#include "binarymodel.h"
+#include "settings.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cstring>
+#include <numeric>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace helpers;
+
+namespace mht
+{
+
+namespace
+{
+
+const char BinaryMagic[8] = {'M', 'H', 'T', 'B', 'I', 'N', '\0', '\0'};
+const uint32_t BinaryVersion = 1;
+const uint32_t BinaryFlagGroundTruth = 1;
+const uint32_t BinaryFlagTimesteps = 2;
+
+struct BinaryHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t numSegmentations;
+    uint64_t numLinks;
+    uint64_t numDivisions;
+    uint64_t numExclusions;
+};
+
+/**
+ * @brief Read-only view of a whole file, memory mapped where possible
+ */
+class MappedFile
+{
+public:
+    MappedFile(const std::string& filename)
+    {
+#ifdef _WIN32
+        std::ifstream input(filename.c_str(), std::ios::binary | std::ios::ate);
+        if(!input.good())
+            throw std::runtime_error("Could not open binary model file " + filename);
+        buffer_.resize((size_t)input.tellg());
+        input.seekg(0);
+        input.read(buffer_.data(), buffer_.size());
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+#else
+        int fd = open(filename.c_str(), O_RDONLY);
+        if(fd < 0)
+            throw std::runtime_error("Could not open binary model file " + filename);
+
+        struct stat fileStat;
+        if(fstat(fd, &fileStat) != 0)
+        {
+            close(fd);
+            throw std::runtime_error("Could not determine size of binary model file " + filename);
+        }
+        size_ = fileStat.st_size;
+
+        void* mapping = size_ > 0 ? mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+        close(fd);
+        if(mapping == MAP_FAILED)
+            throw std::runtime_error("Could not memory map binary model file " + filename);
+
+        // we read the file front to back exactly once
+        if(mapping != nullptr)
+            madvise(mapping, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(mapping);
+#endif
+    }
+
+    ~MappedFile()
+    {
+#ifndef _WIN32
+        if(data_ != nullptr)
+            munmap(const_cast<char*>(data_), size_);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+#ifdef _WIN32
+    std::vector<char> buffer_;
+#endif
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+/**
+ * @brief Hands out typed pointers to the arrays in a binary model container without copying them
+ */
+class BinaryReader
+{
+public:
+    BinaryReader(const char* data, size_t size):
+        data_(data),
+        size_(size),
+        position_(0)
+    {}
+
+    void readHeader(BinaryHeader& header)
+    {
+        require(sizeof(BinaryHeader));
+        std::memcpy(&header, data_, sizeof(BinaryHeader));
+        position_ = sizeof(BinaryHeader);
+
+        if(std::memcmp(header.magic, BinaryMagic, sizeof(BinaryMagic)) != 0)
+            throw std::runtime_error("File is not a binary tracking model");
+        if(header.version != BinaryVersion)
+            throw std::runtime_error("Unsupported version of the binary tracking model format");
+    }
+
+    /**
+     * @brief Return a pointer to the next array and check that it has the expected number of elements
+     */
+    template<class T>
+    const T* readArray(uint64_t expectedCount)
+    {
+        uint64_t count;
+        require(sizeof(count));
+        std::memcpy(&count, data_ + position_, sizeof(count));
+        position_ += sizeof(count);
+
+        if(count != expectedCount)
+            throw std::runtime_error("Binary tracking model is corrupt: unexpected array length");
+
+        if(count > size_ / sizeof(T))
+            throw std::runtime_error("Binary tracking model is truncated");
+        size_t bytes = count * sizeof(T);
+        require(bytes);
+        const T* values = reinterpret_cast<const T*>(data_ + position_);
+        position_ += bytes + (8 - bytes % 8) % 8;
+        return values;
+    }
+
+    /**
+     * @brief Return the length of the next array without consuming it
+     */
+    uint64_t peekArrayLength()
+    {
+        uint64_t count;
+        require(sizeof(count));
+        std::memcpy(&count, data_ + position_, sizeof(count));
+        return count;
+    }
+
+private:
+    void require(size_t bytes) const
+    {
+        if(position_ > size_ || bytes > size_ - position_)
+            throw std::runtime_error("Binary tracking model is truncated");
+    }
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t position_;
+};
+
+/**
+ * @brief Writes arrays preceded by their length and padded to 8 bytes, so that they can be used in place when mapped
+ */
+class BinaryWriter
+{
+public:
+    BinaryWriter(const std::string& filename):
+        output_(filename.c_str(), std::ios::binary)
+    {
+        if(!output_.good())
+            throw std::runtime_error("Could not open binary model file for saving: " + filename);
+    }
+
+    void writeHeader(const BinaryHeader& header)
+    {
+        output_.write(reinterpret_cast<const char*>(&header), sizeof(BinaryHeader));
+    }
+
+    template<class T>
+    void writeArray(const std::vector<T>& values)
+    {
+        static const char zeros[8] = {0};
+        uint64_t count = values.size();
+        size_t bytes = count * sizeof(T);
+        output_.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        if(bytes > 0)
+            output_.write(reinterpret_cast<const char*>(values.data()), bytes);
+        output_.write(zeros, (8 - bytes % 8) % 8);
+    }
+
+    void finish()
+    {
+        output_.close();
+        if(output_.fail())
+            throw std::runtime_error("Could not write binary model file");
+    }
+
+private:
+    std::ofstream output_;
+};
+
+/**
+ * @brief Features of a list of variables in three flat arrays:
+ *        per variable offsets into the list of states, per state offsets into the feature values
+ */
+struct FeatureBlock
+{
+    std::vector<uint64_t> stateOffsets = {0};
+    std::vector<uint64_t> featureOffsets = {0};
+    std::vector<double> values;
+
+    void add(const StateFeatureVector& features)
+    {
+        for(auto& stateFeatures : features)
+        {
+            values.insert(values.end(), stateFeatures.begin(), stateFeatures.end());
+            featureOffsets.push_back(values.size());
+        }
+        stateOffsets.push_back(featureOffsets.size() - 1);
+    }
+
+    void write(BinaryWriter& writer) const
+    {
+        writer.writeArray(stateOffsets);
+        writer.writeArray(featureOffsets);
+        writer.writeArray(values);
+    }
+};
+
+/**
+ * @brief A feature block inside a mapped file
+ */
+class FeatureBlockView
+{
+public:
+    FeatureBlockView(BinaryReader& reader, size_t numVariables)
+    {
+        stateOffsets_ = reader.readArray<uint64_t>(numVariables + 1);
+        uint64_t numStates = stateOffsets_[numVariables];
+        featureOffsets_ = reader.readArray<uint64_t>(numStates + 1);
+        values_ = reader.readArray<double>(featureOffsets_[numStates]);
+
+        // validate once, so that get() does not need to check anything
+        checkOffsets(stateOffsets_, numVariables);
+        checkOffsets(featureOffsets_, numStates);
+    }
+
+    StateFeatureVector get(size_t variable) const
+    {
+        StateFeatureVector features;
+        features.reserve(stateOffsets_[variable + 1] - stateOffsets_[variable]);
+        for(uint64_t state = stateOffsets_[variable]; state < stateOffsets_[variable + 1]; ++state)
+            features.push_back(FeatureVector(values_ + featureOffsets_[state], values_ + featureOffsets_[state + 1]));
+        return features;
+    }
+
+private:
+    static void checkOffsets(const uint64_t* offsets, size_t num)
+    {
+        if(offsets[0] != 0)
+            throw std::runtime_error("Binary tracking model is corrupt: offsets must start at zero");
+        for(size_t i = 0; i < num; ++i)
+            if(offsets[i] > offsets[i + 1])
+                throw std::runtime_error("Binary tracking model is corrupt: offsets must be increasing");
+    }
+
+private:
+    const uint64_t* stateOffsets_;
+    const uint64_t* featureOffsets_;
+    const double* values_;
+};
+
+/**
+ * @brief Read CSR offsets that split a list into numRows rows and validate them
+ */
+const uint64_t* readRowOffsets(BinaryReader& reader, size_t numRows)
+{
+    const uint64_t* offsets = reader.readArray<uint64_t>(numRows + 1);
+    if(offsets[0] != 0)
+        throw std::runtime_error("Binary tracking model is corrupt: adjacency offsets must start at zero");
+    for(size_t i = 0; i < numRows; ++i)
+        if(offsets[i] > offsets[i + 1])
+            throw std::runtime_error("Binary tracking model is corrupt: adjacency offsets must be increasing");
+    return offsets;
+}
+
+/**
+ * @brief Read indices into the list of segmentation hypotheses and validate them
+ */
+const uint32_t* readSegmentationIndices(BinaryReader& reader, size_t count, size_t numSegmentations)
+{
+    const uint32_t* indices = reader.readArray<uint32_t>(count);
+    for(size_t i = 0; i < count; ++i)
+        if(indices[i] >= numSegmentations)
+            throw std::runtime_error("Binary tracking model is corrupt: invalid segmentation hypothesis index");
+    return indices;
+}
+
+} // end anonymous namespace
+
+bool BinaryModel::isBinaryModelFile(const std::string& filename)
+{
+    std::ifstream input(filename.c_str(), std::ios::binary);
+    char magic[sizeof(BinaryMagic)];
+    if(!input.read(magic, sizeof(magic)))
+        return false;
+    return std::memcmp(magic, BinaryMagic, sizeof(BinaryMagic)) == 0;
+}
+
+void BinaryModel::read(const std::string& filename)
+{
+    if(isBinaryModelFile(filename))
+        readFromBinary(filename);
+    else
+        readFromJson(filename);
+}
+
+void BinaryModel::readFromBinary(const std::string& filename)
+{
+#ifdef USE_STRING_IDS
+    throw std::runtime_error("The binary model format only supports numeric ids");
+#else
+    Telemetry::ScopedPhase parsePhase(telemetry_, "parse");
+    MappedFile file(filename);
+    BinaryReader reader(file.data(), file.size());
+
+    BinaryHeader header;
+    reader.readHeader(header);
+    const size_t numSegmentations = header.numSegmentations;
+    const size_t numLinks = header.numLinks;
+    const size_t numDivisions = header.numDivisions;
+    const size_t numExclusions = header.numExclusions;
+
+    // read settings:
+    uint64_t settingsLength = reader.peekArrayLength();
+    const char* settingsString = reader.readArray<char>(settingsLength);
+    Json::Value settingsJson;
+    std::istringstream settingsStream(std::string(settingsString, settingsLength));
+    settingsStream >> settingsJson;
+    settings_ = std::make_shared<helpers::Settings>(settingsJson);
+    settings_->print();
+
+    // read segmentation hypotheses, in the order in which they were stored
+    std::cout << "\tcontains " << numSegmentations << " segmentation hypotheses" << std::endl;
+    const uint32_t* ids = reader.readArray<uint32_t>(numSegmentations);
+    const int32_t* timesteps = nullptr;
+    if((header.flags & BinaryFlagTimesteps) != 0)
+        timesteps = reader.readArray<int32_t>(numSegmentations);
+    FeatureBlockView detectionFeatures(reader, numSegmentations);
+    FeatureBlockView divisionFeatures(reader, numSegmentations);
+    FeatureBlockView appearanceFeatures(reader, numSegmentations);
+    FeatureBlockView disappearanceFeatures(reader, numSegmentations);
+
+    segmentationHypotheses_.reserve(numSegmentations);
+    for(size_t i = 0; i < numSegmentations; ++i)
+    {
+        auto inserted = segmentationHypotheses_.emplace(ids[i],
+            ids[i],
+            detectionFeatures.get(i),
+            divisionFeatures.get(i),
+            appearanceFeatures.get(i),
+            disappearanceFeatures.get(i));
+        if(!inserted.second)
+            throw std::runtime_error("Binary tracking model is corrupt: segmentation ids must be unique");
+        if(timesteps != nullptr)
+            inserted.first->second.setTimestep(timesteps[i]);
+    }
+
+    // read linking hypotheses, grouped by source segmentation
+    std::cout << "\tcontains " << numLinks << " linking hypotheses" << std::endl;
+    const uint64_t* linkOffsets = readRowOffsets(reader, numSegmentations);
+    if(linkOffsets[numSegmentations] != numLinks)
+        throw std::runtime_error("Binary tracking model is corrupt: wrong number of links");
+    const uint32_t* linkTargets = readSegmentationIndices(reader, numLinks, numSegmentations);
+    FeatureBlockView linkFeatures(reader, numLinks);
+
+    linkingHypotheses_.reserve(numLinks);
+    for(size_t src = 0; src < numSegmentations; ++src)
+    {
+        for(uint64_t l = linkOffsets[src]; l < linkOffsets[src + 1]; ++l)
+        {
+            size_t dest = linkTargets[l];
+            linkingHypotheses_.emplace(std::make_pair(ids[src], ids[dest]), ids[src], ids[dest], linkFeatures.get(l));
+        }
+    }
+
+    // read division hypotheses, grouped by parent segmentation
+    std::cout << "\tcontains " << numDivisions << " division hypotheses" << std::endl;
+    const uint64_t* divisionOffsets = readRowOffsets(reader, numSegmentations);
+    if(divisionOffsets[numSegmentations] != numDivisions)
+        throw std::runtime_error("Binary tracking model is corrupt: wrong number of divisions");
+    const uint32_t* divisionChildren = readSegmentationIndices(reader, 2 * numDivisions, numSegmentations);
+    FeatureBlockView divisionHypothesisFeatures(reader, numDivisions);
+
+    for(size_t parent = 0; parent < numSegmentations; ++parent)
+    {
+        for(uint64_t d = divisionOffsets[parent]; d < divisionOffsets[parent + 1]; ++d)
+        {
+            size_t childA = divisionChildren[2 * d];
+            size_t childB = divisionChildren[2 * d + 1];
+            std::vector<IdLabelType> childrenIds = {ids[childA], ids[childB]};
+            divisionHypotheses_.emplace(std::make_tuple(ids[parent], ids[childA], ids[childB]),
+                ids[parent], childrenIds, divisionHypothesisFeatures.get(d));
+        }
+    }
+
+    // read exclusion constraints between detections
+    std::cout << "\tcontains " << numExclusions << " exclusions" << std::endl;
+    const uint64_t* exclusionOffsets = readRowOffsets(reader, numExclusions);
+    const uint32_t* exclusionMembers = readSegmentationIndices(reader, exclusionOffsets[numExclusions], numSegmentations);
+
+    exclusionConstraints_.reserve(exclusionConstraints_.size() + numExclusions);
+    for(size_t e = 0; e < numExclusions; ++e)
+    {
+        std::vector<IdLabelType> exclusionIds;
+        exclusionIds.reserve(exclusionOffsets[e + 1] - exclusionOffsets[e]);
+        for(uint64_t m = exclusionOffsets[e]; m < exclusionOffsets[e + 1]; ++m)
+            exclusionIds.push_back(ids[exclusionMembers[m]]);
+        exclusionConstraints_.push_back(ExclusionConstraint(exclusionIds));
+    }
+
+    // read the ground truth, if any
+    hasGroundTruth_ = (header.flags & BinaryFlagGroundTruth) != 0;
+    if(hasGroundTruth_)
+    {
+        const uint32_t* detectionValues = reader.readArray<uint32_t>(numSegmentations);
+        const uint32_t* divisionValues = reader.readArray<uint32_t>(numSegmentations);
+        const uint32_t* linkValues = reader.readArray<uint32_t>(numLinks);
+        const uint32_t* externalDivisionValues = reader.readArray<uint32_t>(numDivisions);
+        gtDetectionValues_.assign(detectionValues, detectionValues + numSegmentations);
+        gtDivisionValues_.assign(divisionValues, divisionValues + numSegmentations);
+        gtLinkValues_.assign(linkValues, linkValues + numLinks);
+        gtExternalDivisionValues_.assign(externalDivisionValues, externalDivisionValues + numDivisions);
+        std::cout << "	contains a ground truth" << std::endl;
+    }
+
+    parsePhase.stop();
+    buildAdjacency();
+#endif
+}
+
+Solution BinaryModel::getGroundTruth()
+{
+    // an explicitly given ground truth file wins over the embedded one
+    if(!hasGroundTruth_ || hasJsonGtFile())
+        return JsonModel::getGroundTruth();
+
+    // the file stores one value per hypothesis in the order in which the hypotheses were read
+    Solution solution(assignOpenGMVariableIds(), 0);
+
+    size_t index = 0;
+    for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter, ++index)
+    {
+        solution[iter->second.getDetectionVariable().getOpenGMVariableId()] = gtDetectionValues_[index];
+
+        if(gtDivisionValues_[index] > 0)
+        {
+            if(iter->second.getDivisionVariable().getOpenGMVariableId() < 0)
+            {
+                std::stringstream error;
+                error << "Trying to set division of " << iter->first << " active but the variable had no division features!";
+                throw std::runtime_error(error.str());
+            }
+            solution[iter->second.getDivisionVariable().getOpenGMVariableId()] = gtDivisionValues_[index];
+        }
+    }
+
+    index = 0;
+    for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter, ++index)
+        solution[iter->second.getVariable().getOpenGMVariableId()] = gtLinkValues_[index];
+
+    index = 0;
+    for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter, ++index)
+        solution[iter->second.getVariable().getOpenGMVariableId()] = gtExternalDivisionValues_[index];
+
+    deduceAppearanceDisappearanceStates(solution);
+    return solution;
+}
+
+void Model::saveToBinary(const std::string& filename, const Solution* groundTruth)
+{
+#ifdef USE_STRING_IDS
+    throw std::runtime_error("The binary model format only supports numeric ids");
+#else
+    if(groundTruth != nullptr && groundTruth->size() != assignOpenGMVariableIds())
+        throw std::runtime_error("Ground truth solution does not fit to the model");
+
+    auto getValue = [&](const Variable& var) -> uint32_t
+    {
+        return var.getOpenGMVariableId() >= 0 ? (*groundTruth)[var.getOpenGMVariableId()] : 0;
+    };
+
+    // timesteps are only stored if any hypothesis has one
+    bool hasTimesteps = false;
+    for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+        hasTimesteps = hasTimesteps || iter->second.getTimestep() >= 0;
+
+    BinaryHeader header;
+    std::memcpy(header.magic, BinaryMagic, sizeof(BinaryMagic));
+    header.version = BinaryVersion;
+    header.flags = groundTruth != nullptr ? BinaryFlagGroundTruth : 0;
+    if(hasTimesteps)
+        header.flags |= BinaryFlagTimesteps;
+    header.numSegmentations = segmentationHypotheses_.size();
+    header.numLinks = linkingHypotheses_.size();
+    header.numDivisions = divisionHypotheses_.size();
+    header.numExclusions = exclusionConstraints_.size();
+
+    BinaryWriter writer(filename);
+    writer.writeHeader(header);
+
+    // settings
+    Json::Value settingsJson(Json::objectValue);
+    if(settings_)
+        settings_->saveToJson(settingsJson);
+    std::stringstream settingsStream;
+    settingsStream << settingsJson;
+    std::string settingsString = settingsStream.str();
+    writer.writeArray(std::vector<char>(settingsString.begin(), settingsString.end()));
+
+    // segmentation hypotheses, in the order in which they are stored
+    std::vector<uint32_t> ids;
+    std::vector<int32_t> timesteps;
+    FeatureBlock detectionFeatures, divisionFeatures, appearanceFeatures, disappearanceFeatures;
+    for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+    {
+        ids.push_back(iter->first);
+        timesteps.push_back(iter->second.getTimestep());
+        detectionFeatures.add(iter->second.getDetectionVariable().getFeatures());
+        divisionFeatures.add(iter->second.getDivisionVariable().getFeatures());
+        appearanceFeatures.add(iter->second.getAppearanceVariable().getFeatures());
+        disappearanceFeatures.add(iter->second.getDisappearanceVariable().getFeatures());
+    }
+    writer.writeArray(ids);
+    if(hasTimesteps)
+        writer.writeArray(timesteps);
+    detectionFeatures.write(writer);
+    divisionFeatures.write(writer);
+    appearanceFeatures.write(writer);
+    disappearanceFeatures.write(writer);
+
+    auto getIndex = [&](const IdLabelType& id)
+    {
+        size_t index = segmentationHypotheses_.indexOf(id);
+        if(index == SegmentationHypothesisMap::npos)
+        {
+            std::stringstream s;
+            s << "Cannot find segmentation hypothesis " << id << " referenced in the model";
+            throw std::runtime_error(s.str());
+        }
+        return (uint32_t)index;
+    };
+
+    // links grouped by source segmentation, in the order of the outgoing adjacency, 
+    // which is also the order in which they are read back
+    std::vector<uint64_t> linkOffsets(1, 0);
+    std::vector<const LinkingHypothesis*> links;
+    std::vector<uint32_t> linkTargets;
+    FeatureBlock linkFeatures;
+    for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+    {
+        for(auto link : iter->second.getOutgoingLinks())
+        {
+            links.push_back(link);
+            linkTargets.push_back(getIndex(link->getDestId()));
+            linkFeatures.add(link->getVariable().getFeatures());
+        }
+        linkOffsets.push_back(links.size());
+    }
+    writer.writeArray(linkOffsets);
+    writer.writeArray(linkTargets);
+    linkFeatures.write(writer);
+
+    // same for divisions, grouped by parent segmentation
+    std::vector<uint64_t> divisionOffsets(1, 0);
+    std::vector<const DivisionHypothesis*> divisions;
+    std::vector<uint32_t> divisionChildren;
+    FeatureBlock divisionHypothesisFeatures;
+    for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+    {
+        for(auto division : iter->second.getOutgoingDivisions())
+        {
+            divisions.push_back(division);
+            for(auto& childId : division->getChildrenIds())
+                divisionChildren.push_back(getIndex(childId));
+            divisionHypothesisFeatures.add(division->getVariable().getFeatures());
+        }
+        divisionOffsets.push_back(divisions.size());
+    }
+    writer.writeArray(divisionOffsets);
+    writer.writeArray(divisionChildren);
+    divisionHypothesisFeatures.write(writer);
+
+    // exclusions
+    std::vector<uint64_t> exclusionOffsets(1, 0);
+    std::vector<uint32_t> exclusionMembers;
+    for(auto iter = exclusionConstraints_.begin(); iter != exclusionConstraints_.end() ; ++iter)
+    {
+        for(auto& id : iter->getIds())
+            exclusionMembers.push_back(getIndex(id));
+        exclusionOffsets.push_back(exclusionMembers.size());
+    }
+    writer.writeArray(exclusionOffsets);
+    writer.writeArray(exclusionMembers);
+
+    if(groundTruth != nullptr)
+    {
+        std::vector<uint32_t> detectionValues, divisionValues, linkValues, externalDivisionValues;
+        for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+        {
+            detectionValues.push_back(getValue(iter->second.getDetectionVariable()));
+            divisionValues.push_back(getValue(iter->second.getDivisionVariable()));
+        }
+        for(auto link : links)
+            linkValues.push_back(getValue(link->getVariable()));
+        for(auto division : divisions)
+            externalDivisionValues.push_back(getValue(division->getVariable()));
+
+        writer.writeArray(detectionValues);
+        writer.writeArray(divisionValues);
+        writer.writeArray(linkValues);
+        writer.writeArray(externalDivisionValues);
+    }
+
+    writer.finish();
+#endif
+}
+
+} // end namespace mht
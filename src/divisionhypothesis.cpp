@@ -12,11 +12,14 @@ DivisionHypothesis::DivisionHypothesis()
 
 DivisionHypothesis::DivisionHypothesis(helpers::IdLabelType parent, 
                                        const std::vector<helpers::IdLabelType>& children, 
-                                       const helpers::StateFeatureVector& features):
+                                       helpers::StateFeatureVector features):
     parentId_(parent),
     childrenIds_(children),
-    variable_(features)
-{}
+    variable_(std::move(features))
+{
+    // divisions are identified by their parent and sorted children, see Model::addDivisionHypothesis()
+    std::sort(childrenIds_.begin(), childrenIds_.end());
+}
 
 void DivisionHypothesis::toDot(std::ostream& stream, const Solution* sol) const
 {
@@ -40,28 +43,25 @@ void DivisionHypothesis::toDot(std::ostream& stream, const Solution* sol) const
     stream << divNodeName.str() << " -> " << childrenIds_[1] << "; \n" << std::flush;
 }
 
-void DivisionHypothesis::registerWithSegmentations(std::map<helpers::IdLabelType, SegmentationHypothesis>& segmentationHypotheses)
+void DivisionHypothesis::addToOpenGMModel(GraphicalModelType& model)
 {
-    assert(segmentationHypotheses.find(parentId_) != segmentationHypotheses.end());
-    for(auto c : childrenIds_)
-        assert(segmentationHypotheses.find(c) != segmentationHypotheses.end());
+    // std::cout << "Adding linking hypothesis between " << srcId_ << " and " << destId_ << " to opengm" << std::endl;
 
-    // std::cout << "Registering outgoing link for " << srcId_ << std::endl;
-    segmentationHypotheses[parentId_].addOutgoingDivision(shared_from_this());
-    // std::cout << "Registering incoming link for " << destId_ << std::endl;
-    for(auto c : childrenIds_)
-        segmentationHypotheses[c].addIncomingDivision(shared_from_this());
+    variable_.addToOpenGM(model);
 }
 
-void DivisionHypothesis::addToOpenGMModel(
-    GraphicalModelType& model, 
+void DivisionHypothesis::addFactorsToOpenGMModel(
+    FactorBuffer& buffer, 
     WeightsType& weights, 
     bool statesShareWeights,
-    const std::vector<size_t>& weightIds)
+    const std::vector<size_t>& weightIds) const
 {
-    // std::cout << "Adding linking hypothesis between " << srcId_ << " and " << destId_ << " to opengm" << std::endl;
+    variable_.addUnaryToOpenGM(buffer, statesShareWeights, weights, weightIds);
+}
 
-    variable_.addToOpenGM(model, statesShareWeights, weights, weightIds);
+void DivisionHypothesis::assignOpenGMVariableIds(int& nextId)
+{
+    variable_.assignOpenGMVariableId(nextId);
 }
 
 } // end namespace mht
@@ -0,0 +1,216 @@
+#include "dualdecomposition.h"
+
+#include <iostream>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <stdexcept>
+
+#include "parallel.h"
+
+using namespace helpers;
+
+namespace mht
+{
+
+DualDecomposition::DualDecomposition(const LinearProgram& program, const std::vector< std::vector<size_t> >& subproblemRows):
+	program_(program),
+	upperBound_(std::numeric_limits<double>::infinity())
+{
+	if(subproblemRows.empty())
+		throw std::runtime_error("Dual decomposition needs at least one subproblem");
+	const size_t numSubproblems = subproblemRows.size();
+	const size_t numColumns = program.numColumns();
+
+	// the subproblems that hold a copy of every column
+	std::vector< std::vector<size_t> > rows = subproblemRows;
+	std::vector< std::vector<size_t> > columnSubproblems(numColumns);
+	auto addColumn = [&](size_t column, size_t subproblem)
+	{
+		std::vector<size_t>& holders = columnSubproblems[column];
+		if(std::find(holders.begin(), holders.end(), subproblem) == holders.end())
+			holders.push_back(subproblem);
+	};
+
+	std::vector<bool> isAssigned(program.numRows(), false);
+	for(size_t s = 0; s < numSubproblems; ++s)
+	{
+		for(size_t row : rows[s])
+		{
+			if(row >= program.numRows())
+				throw std::runtime_error("Dual decomposition got a subproblem row that is not part of the program");
+			isAssigned[row] = true;
+			for(size_t entry = program.rowOffsets_[row]; entry < program.rowOffsets_[row + 1]; ++entry)
+				addColumn(program.columns_[entry], s);
+		}
+	}
+
+	for(size_t column = 0; column < numColumns; ++column)
+	{
+		if(columnSubproblems[column].empty())
+			columnSubproblems[column].push_back(0);
+	}
+
+	for(size_t row = 0; row < program.numRows(); ++row)
+	{
+		if(isAssigned[row])
+			continue;
+		std::vector<size_t> holders;
+		for(size_t entry = program.rowOffsets_[row]; entry < program.rowOffsets_[row + 1]; ++entry)
+		{
+			for(size_t s : columnSubproblems[program.columns_[entry]])
+			{
+				if(std::find(holders.begin(), holders.end(), s) == holders.end())
+					holders.push_back(s);
+			}
+		}
+		for(size_t s : holders)
+		{
+			rows[s].push_back(row);
+			for(size_t entry = program.rowOffsets_[row]; entry < program.rowOffsets_[row + 1]; ++entry)
+				addColumn(program.columns_[entry], s);
+		}
+	}
+
+	// the columns of every subproblem keep the order of the whole program
+	numCopies_.resize(numColumns);
+	subproblemColumns_.resize(numSubproblems);
+	for(size_t column = 0; column < numColumns; ++column)
+	{
+		numCopies_[column] = columnSubproblems[column].size();
+		if(numCopies_[column] > 1)
+			numSharedColumns_++;
+		for(size_t s : columnSubproblems[column])
+			subproblemColumns_[s].push_back(column);
+	}
+
+	const size_t npos = std::numeric_limits<size_t>::max();
+	std::vector<size_t> localColumns(numColumns, npos);
+	subproblems_.resize(numSubproblems);
+	for(size_t s = 0; s < numSubproblems; ++s)
+	{
+		LinearProgram& subproblem = subproblems_[s];
+		const std::vector<size_t>& columns = subproblemColumns_[s];
+		for(size_t i = 0; i < columns.size(); ++i)
+		{
+			localColumns[columns[i]] = i;
+			subproblem.objective_.push_back(program.objective_[columns[i]] / numCopies_[columns[i]]);
+		}
+		for(size_t row : rows[s])
+		{
+			for(size_t entry = program.rowOffsets_[row]; entry < program.rowOffsets_[row + 1]; ++entry)
+			{
+				subproblem.columns_.push_back(localColumns[program.columns_[entry]]);
+				subproblem.coefficients_.push_back(program.coefficients_[entry]);
+			}
+			subproblem.closeRow(program.rowLower_[row], program.rowUpper_[row]);
+		}
+		for(size_t column : columns)
+			localColumns[column] = npos;
+	}
+}
+
+double DualDecomposition::run(const Parameter& parameter, const PrimalHeuristic& primalHeuristic, Telemetry& telemetry)
+{
+	const double infinity = std::numeric_limits<double>::infinity();
+	const double tolerance = 1e-9;
+	const size_t numSubproblems = subproblems_.size();
+	SolverParameters solverParameters = parameter.solverParameters_;
+	// the logs of concurrent solves would interleave
+	if(getNumWorkerThreads(parameter.numThreads_, numSubproblems) > 1)
+		solverParameters.verbose = false;
+
+	std::vector< std::vector<double> > multipliers(numSubproblems);
+	std::vector< std::vector<double> > values(numSubproblems);
+	std::vector<double> bounds(numSubproblems, 0.0);
+	for(size_t s = 0; s < numSubproblems; ++s)
+		multipliers[s].assign(subproblemColumns_[s].size(), 0.0);
+	std::vector<double> columnValues(program_.numColumns(), 0.0);
+	if(parameter.backends_.size() < getNumWorkerThreads(parameter.numThreads_, numSubproblems))
+		throw std::runtime_error("Dual decomposition needs a solver backend for every worker thread");
+
+	double lowerBound = -infinity;
+	upperBound_ = infinity;
+	double stepScale = 1.0;
+	size_t numStalled = 0;
+	size_t iteration = 0;
+	while(iteration < parameter.maxIterations_)
+	{
+		++iteration;
+		Telemetry::ScopedPhase solvePhase(telemetry, "solve");
+		parallelForWorkers(numSubproblems, parameter.numThreads_, [&](size_t s, size_t worker)
+		{
+			LinearProgram& subproblem = subproblems_[s];
+			const std::vector<size_t>& columns = subproblemColumns_[s];
+			for(size_t i = 0; i < columns.size(); ++i)
+				subproblem.objective_[i] = program_.objective_[columns[i]] / numCopies_[columns[i]] + multipliers[s][i];
+
+			// only the objective changes, so the previous solution is a feasible start
+			SolverResult result = parameter.backends_[worker]->solve(subproblem, solverParameters, values[s]);
+			values[s].swap(result.columnValues);
+			bounds[s] = result.bound;
+			result.addToTelemetry(telemetry);
+		});
+		solvePhase.stop();
+		telemetry.addToCounter("solver.solves", numSubproblems);
+
+		// the multipliers of every column sum up to zero, so the subproblems together are a lower bound of the whole program
+		double dualValue = program_.objectiveOffset_;
+		std::fill(columnValues.begin(), columnValues.end(), 0.0);
+		for(size_t s = 0; s < numSubproblems; ++s)
+		{
+			dualValue += bounds[s];
+			const std::vector<size_t>& columns = subproblemColumns_[s];
+			for(size_t i = 0; i < columns.size(); ++i)
+				columnValues[columns[i]] += values[s][i] / numCopies_[columns[i]];
+		}
+
+		// the projected subgradient is the deviation of every copy from the mean of its column
+		double squaredNorm = 0.0;
+		for(size_t s = 0; s < numSubproblems; ++s)
+		{
+			const std::vector<size_t>& columns = subproblemColumns_[s];
+			for(size_t i = 0; i < columns.size(); ++i)
+				squaredNorm += std::pow(values[s][i] - columnValues[columns[i]], 2);
+		}
+
+		if(primalHeuristic)
+			upperBound_ = std::min(upperBound_, primalHeuristic(columnValues));
+
+		if(dualValue > lowerBound)
+		{
+			lowerBound = dualValue;
+			numStalled = 0;
+		}
+		else if(++numStalled >= 3)
+		{
+			stepScale /= 2.0;
+			numStalled = 0;
+		}
+
+		double gap = (upperBound_ - lowerBound) / std::max(std::abs(upperBound_), 1e-10);
+		if(parameter.verbose_)
+		{
+			std::cout << "Dual decomposition iteration " << iteration << ": lower bound " << lowerBound
+					  << ", upper bound " << upperBound_ << ", disagreement " << std::sqrt(squaredNorm) << std::endl;
+		}
+		if(squaredNorm < tolerance || gap <= parameter.relativeGap_ + tolerance)
+			break;
+
+		// Polyak's step towards the best primal energy, or a decreasing one while there is none
+		double step = std::isinf(upperBound_) ? stepScale / iteration : stepScale * (upperBound_ - dualValue) / squaredNorm;
+		for(size_t s = 0; s < numSubproblems; ++s)
+		{
+			const std::vector<size_t>& columns = subproblemColumns_[s];
+			for(size_t i = 0; i < columns.size(); ++i)
+				multipliers[s][i] += step * (values[s][i] - columnValues[columns[i]]);
+		}
+	}
+
+	telemetry.setCounter("dualDecomposition.iterations", iteration);
+	telemetry.setCounter("dualDecomposition.lowerBound", lowerBound);
+	telemetry.setCounter("dualDecomposition.upperBound", upperBound_);
+	return lowerBound;
+}
+
+} // end namespace mht
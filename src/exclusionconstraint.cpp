@@ -10,7 +10,7 @@ ExclusionConstraint::ExclusionConstraint(const std::vector<helpers::IdLabelType>
 	ids_(ids)
 {}
 
-void ExclusionConstraint::addToOpenGMModel(GraphicalModelType& model, std::map<helpers::IdLabelType, SegmentationHypothesis>& segmentationHypotheses)
+void ExclusionConstraint::addToOpenGMModel(FactorBuffer& buffer, const SegmentationHypothesisMap& segmentationHypotheses)
 {
 	LinearConstraintFunctionType::LinearConstraintType exclusionConstraint;
 	std::vector<LabelType> factorVariables;
@@ -18,27 +18,33 @@ void ExclusionConstraint::addToOpenGMModel(GraphicalModelType& model, std::map<h
     
 	// sort because OpenGM likes to have variable ids in order
 	std::sort(ids_.begin(), ids_.end(), [&](const helpers::IdLabelType& a, const helpers::IdLabelType& b){
-		return segmentationHypotheses[b].getDetectionVariable().getOpenGMVariableId() > segmentationHypotheses[a].getDetectionVariable().getOpenGMVariableId();
+		return segmentationHypotheses.at(b).getDetectionVariable().getOpenGMVariableId() > segmentationHypotheses.at(a).getDetectionVariable().getOpenGMVariableId();
 	});
 
-    // sum of all participating indicator variables for states > 0 must not exceed 1
+    // sum of all participating indicator variables for states > 0 must not exceed 1, pruned detections are always off
     for(size_t i = 0; i < ids_.size(); ++i)
     {
+    	if(segmentationHypotheses.at(ids_[i]).getDetectionVariable().getOpenGMVariableId() < 0)
+    		continue;
+
     	// indicator variable references the i'th argument of the constraint function, and its states > 0
-    	for(size_t state = 1; state < model.numberOfLabels(segmentationHypotheses[ids_[i]].getDetectionVariable().getOpenGMVariableId()); ++state)
+    	for(size_t state = 1; state < buffer.numberOfLabels(segmentationHypotheses.at(ids_[i]).getDetectionVariable().getOpenGMVariableId()); ++state)
     	{
-	    	addOpenGMVariableToConstraint(exclusionConstraint, segmentationHypotheses[ids_[i]].getDetectionVariable().getOpenGMVariableId(),
-				state, 1.0, constraintShape, factorVariables, model);
+	    	addOpenGMVariableToConstraint(exclusionConstraint, segmentationHypotheses.at(ids_[i]).getDetectionVariable().getOpenGMVariableId(),
+				state, 1.0, constraintShape, factorVariables, buffer);
 	    }
     }
 
+    if(factorVariables.size() < 2)
+    	return;
+
     exclusionConstraint.setBound( 1 );
     exclusionConstraint.setConstraintOperator(LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::LessEqual);
 
-    addConstraintToOpenGMModel(exclusionConstraint, constraintShape, factorVariables, model);
+    addConstraintToOpenGMModel(exclusionConstraint, constraintShape, factorVariables, buffer);
 }
 
-bool ExclusionConstraint::verifySolution(const Solution& sol, const std::map<helpers::IdLabelType, SegmentationHypothesis>& segmentationHypotheses) const
+bool ExclusionConstraint::verifySolution(const Solution& sol, const SegmentationHypothesisMap& segmentationHypotheses) const
 {
 	size_t sum = 0;
 
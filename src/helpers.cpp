@@ -1,6 +1,7 @@
 #include <fstream>
 #include <json/json.h>
 #include "helpers.h"
+#include "jsonstreamreader.h"
 
 namespace helpers
 {
@@ -19,12 +20,16 @@ std::map<JsonTypes, std::string> JsonTypeNames = {
 	{JsonTypes::Id, "id"}, 
 	{JsonTypes::Children, "children"}, 
 	{JsonTypes::Parent, "parent"}, 
+	{JsonTypes::Offsets, "offsets"},
+	{JsonTypes::Indices, "indices"},
 	{JsonTypes::Features, "features"},
 	{JsonTypes::DivisionFeatures, "divisionFeatures"},
 	{JsonTypes::AppearanceFeatures, "appearanceFeatures"},
 	{JsonTypes::DisappearanceFeatures, "disappearanceFeatures"},
+	{JsonTypes::Timestep, "timestep"},
 	{JsonTypes::Weights, "weights"},
 	{JsonTypes::ResultEnergy, "resultEnergy"},
+	{JsonTypes::Telemetry, "telemetry"},
 	{JsonTypes::StatesShareWeights, "statesShareWeights"},
 	{JsonTypes::Settings, "settings"},
 	{JsonTypes::OptimizerEpGap, "optimizerEpGap"},
@@ -33,7 +38,21 @@ std::map<JsonTypes, std::string> JsonTypeNames = {
 	{JsonTypes::AllowPartialMergerAppearance, "allowPartialMergerAppearance"},
 	{JsonTypes::AllowLengthOneTracks, "allowLengthOneTracks"},
 	{JsonTypes::RequireSeparateChildrenOfDivision, "requireSeparateChildrenOfDivision"},
-	{JsonTypes::NonNegativeWeightsOnly, "nonNegativeWeightsOnly"}
+	{JsonTypes::NonNegativeWeightsOnly, "nonNegativeWeightsOnly"},
+	{JsonTypes::DecomposeIntoComponents, "decomposeIntoComponents"},
+	{JsonTypes::ComponentNumThreads, "componentNumThreads"},
+	{JsonTypes::UseFlowSolver, "useFlowSolver"},
+	{JsonTypes::SlidingWindowSize, "slidingWindowSize"},
+	{JsonTypes::SlidingWindowStep, "slidingWindowStep"},
+	{JsonTypes::DualDecompositionChunkSize, "dualDecompositionChunkSize"},
+	{JsonTypes::DualDecompositionOverlap, "dualDecompositionOverlap"},
+	{JsonTypes::DualDecompositionIterations, "dualDecompositionIterations"},
+	{JsonTypes::SolverBackend, "solverBackend"},
+	{JsonTypes::SolutionCacheDirectory, "solutionCacheDirectory"},
+	{JsonTypes::SolutionCacheSize, "solutionCacheSize"},
+	{JsonTypes::GreedyWarmStart, "greedyWarmStart"},
+	{JsonTypes::Presolve, "presolve"},
+	{JsonTypes::BuildNumThreads, "buildNumThreads"}
 };
 
 void saveWeightsToJson(
@@ -71,21 +90,34 @@ std::vector<ValueType> readWeightsFromJson(const std::string& filename)
 	if(!input.good())
 		throw std::runtime_error("Could not open JSON weight file for reading: " + filename);
 
-	Json::Value root;
-	input >> root;
-
-	if(!root.isMember(JsonTypeNames[JsonTypes::Weights]))
+	JsonStreamReader reader(input);
+	if(reader.peek() != JsonStreamReader::TokenType::Object)
 		throw std::runtime_error("Could not find 'Weights' group in JSON file");
-	
-	const Json::Value entry = root[JsonTypeNames[JsonTypes::Weights]];
-	if(!entry.isArray())
-		throw std::runtime_error("Cannot extract Weights from non-array JSON entry");
 
 	std::vector<ValueType> weights;
-	for(int i = 0; i < (int)entry.size(); i++)
+	bool foundWeights = false;
+	std::string key;
+	reader.beginObject();
+	while(reader.nextMember(key))
 	{
-		weights.push_back(entry[i].asDouble());
+		if(key != JsonTypeNames[JsonTypes::Weights])
+		{
+			reader.skipValue();
+			continue;
+		}
+
+		if(reader.peek() != JsonStreamReader::TokenType::Array)
+			throw std::runtime_error("Cannot extract Weights from non-array JSON entry");
+
+		foundWeights = true;
+		weights.clear();
+		reader.beginArray();
+		while(reader.nextElement())
+			weights.push_back(reader.readDouble());
 	}
+
+	if(!foundWeights)
+		throw std::runtime_error("Could not find 'Weights' group in JSON file");
 	return weights;
 }
 
@@ -131,6 +163,87 @@ StateFeatureVector extractFeatures(const Json::Value& entry, JsonTypes type)
 	return stateFeatVec;
 }
 
+StateFeatureVector extractFeatures(JsonStreamReader& reader, JsonTypes type)
+{
+	StateFeatureVector stateFeatVec;
+	if(reader.peek() != JsonStreamReader::TokenType::Array)
+		throw std::runtime_error(JsonTypeNames[type] + " must be an array");
+
+	// get the features per state
+	reader.beginArray();
+	while(reader.nextElement())
+	{
+		if(reader.peek() != JsonStreamReader::TokenType::Array)
+			throw std::runtime_error("Expected to find a list of features for each state");
+
+		// get features for the specific state
+		FeatureVector featVec;
+		reader.beginArray();
+		while(reader.nextElement())
+			featVec.push_back(reader.readDouble());
+
+		if(featVec.empty())
+			throw std::runtime_error("Features for state may not be empty for " + JsonTypeNames[type]);
+
+		stateFeatVec.push_back(featVec);
+	}
+
+	if(stateFeatVec.empty())
+		throw std::runtime_error("Features may not be empty for " + JsonTypeNames[type]);
+
+	return stateFeatVec;
+}
+
+void FactorBuffer::addFactor(LearnableUnaryFuncType function, size_t variable)
+{
+	unaries_.push_back(std::move(function));
+	variables_.push_back(variable);
+	factors_.push_back({Unary, unaries_.size() - 1, variables_.size()});
+}
+
+void FactorBuffer::addFactor(LearnableWeightedSumOfFuncType function, size_t variable)
+{
+	weightedSums_.push_back(std::move(function));
+	variables_.push_back(variable);
+	factors_.push_back({WeightedSum, weightedSums_.size() - 1, variables_.size()});
+}
+
+void FactorBuffer::addFactor(LinearConstraintFunctionType function, const std::vector<LabelType>& variables)
+{
+	constraints_.push_back(std::move(function));
+	variables_.insert(variables_.end(), variables.begin(), variables.end());
+	factors_.push_back({Constraint, constraints_.size() - 1, variables_.size()});
+}
+
+void FactorBuffer::addToModel(GraphicalModelType& model)
+{
+	size_t variablesBegin = 0;
+	for(const Factor& factor : factors_)
+	{
+		GraphicalModelType::FunctionIdentifier fid;
+		switch(factor.kind)
+		{
+			case Unary:
+				fid = model.addFunction(unaries_[factor.function]);
+				break;
+			case WeightedSum:
+				fid = model.addFunction(weightedSums_[factor.function]);
+				break;
+			case Constraint:
+				fid = model.addFunction(constraints_[factor.function]);
+				break;
+		}
+		model.addFactor(fid, variables_.begin() + variablesBegin, variables_.begin() + factor.variablesEnd);
+		variablesBegin = factor.variablesEnd;
+	}
+
+	unaries_.clear();
+	weightedSums_.clear();
+	constraints_.clear();
+	factors_.clear();
+	variables_.clear();
+}
+
 void addOpenGMVariableToConstraint(
 	LinearConstraintFunctionType::LinearConstraintType& constraint, 
 	size_t opengmVariableId,
@@ -138,13 +251,13 @@ void addOpenGMVariableToConstraint(
 	double coefficient,
 	std::vector<LabelType>& constraintShape,
 	std::vector<LabelType>& factorVariables,
-	GraphicalModelType& model)
+	const FactorBuffer& buffer)
 {
 	IndicatorVariableType indicatorVariable(constraintShape.size(), LabelType(state));
     constraint.add(indicatorVariable, coefficient);
 
     factorVariables.push_back(opengmVariableId);
-    constraintShape.push_back(model.numberOfLabels(opengmVariableId));
+    constraintShape.push_back(buffer.numberOfLabels(opengmVariableId));
 }
 
 void addOpenGMVariableStateToConstraint(
@@ -153,9 +266,9 @@ void addOpenGMVariableStateToConstraint(
 	double coefficient,
 	std::vector<LabelType>& constraintShape,
 	std::vector<LabelType>& factorVariables,
-	GraphicalModelType& model)
+	const FactorBuffer& buffer)
 {
-	size_t numStates = model.numberOfLabels(opengmVariableId);
+	size_t numStates = buffer.numberOfLabels(opengmVariableId);
 
 	for(size_t i = 1; i < numStates; i++)
 	{
@@ -171,11 +284,10 @@ void addConstraintToOpenGMModel(
 	LinearConstraintFunctionType::LinearConstraintType& constraint, 
 	std::vector<LabelType>& constraintShape,
 	std::vector<LabelType>& factorVariables,
-	GraphicalModelType& model)
+	FactorBuffer& buffer)
 {
 	LinearConstraintFunctionType linearConstraintFunction(constraintShape.begin(), constraintShape.end(), &constraint, &constraint + 1);
-    GraphicalModelType::FunctionIdentifier linearConstraintFunctionID = model.addFunction(linearConstraintFunction);
-    model.addFactor(linearConstraintFunctionID, factorVariables.begin(), factorVariables.end());
+    buffer.addFactor(std::move(linearConstraintFunction), factorVariables);
 }
 
 } // end namespace mht
@@ -5,111 +5,200 @@
 #include <numeric>
 #include <sstream>
 #include <tuple>
+#include <functional>
 
 using namespace helpers;
 
 namespace mht
 {
 
-void JsonModel::readLinkingHypothesis(const Json::Value& entry)
+void JsonModel::readLinkingHypothesis(JsonStreamReader& reader)
 {
-    if(!entry.isObject())
+    if(reader.peek() != JsonStreamReader::TokenType::Object)
         throw std::runtime_error("Cannot extract LinkingHypothesis from non-object JSON entry");
-    if(!entry.isMember(JsonTypeNames[JsonTypes::SrcId]) || !entry[JsonTypeNames[JsonTypes::SrcId]].isLabelType())
+
+    const std::string& srcKey = JsonTypeNames[JsonTypes::SrcId];
+    const std::string& destKey = JsonTypeNames[JsonTypes::DestId];
+    const std::string& featuresKey = JsonTypeNames[JsonTypes::Features];
+
+    bool hasSrc = false, hasDest = false, hasFeatures = false;
+    helpers::IdLabelType srcId;
+    helpers::IdLabelType destId;
+    helpers::StateFeatureVector features;
+
+    std::string key;
+    reader.beginObject();
+    while(reader.nextMember(key))
+    {
+        if(key == srcKey)
+        {
+            srcId = reader.readId();
+            hasSrc = true;
+        }
+        else if(key == destKey)
+        {
+            destId = reader.readId();
+            hasDest = true;
+        }
+        else if(key == featuresKey)
+        {
+            // get transition features
+            features = extractFeatures(reader, JsonTypes::Features);
+            hasFeatures = true;
+        }
+        else
+            reader.skipValue();
+    }
+
+    if(!hasSrc)
         throw std::runtime_error("JSON entry for LinkingHypothesis is invalid: missing srcId"); 
-    if(!entry.isMember(JsonTypeNames[JsonTypes::DestId]) || !entry[JsonTypeNames[JsonTypes::DestId]].isLabelType())
+    if(!hasDest)
         throw std::runtime_error("JSON entry for LinkingHypothesis is invalid: missing destId");
-    if(!entry.isMember(JsonTypeNames[JsonTypes::Features]) || !entry[JsonTypeNames[JsonTypes::Features]].isArray())
+    if(!hasFeatures)
         throw std::runtime_error("JSON entry for LinkingHypothesis is invalid: missing features");
 
-    helpers::IdLabelType srcId = entry[JsonTypeNames[JsonTypes::SrcId]].asLabelType();
-    helpers::IdLabelType destId = entry[JsonTypeNames[JsonTypes::DestId]].asLabelType();
-
-    // get transition features
-    helpers::StateFeatureVector features = extractFeatures(entry, JsonTypes::Features);
-
-    // add to list
-    std::shared_ptr<LinkingHypothesis> hyp = std::make_shared<LinkingHypothesis>(srcId, destId, features);
+    // add to list, registering with the segmentations happens once the whole file is read
     std::pair<helpers::IdLabelType, helpers::IdLabelType> ids = std::make_pair(srcId, destId);
-    hyp->registerWithSegmentations(segmentationHypotheses_);
-    linkingHypotheses_[ids] = hyp;
+    linkingHypotheses_[ids] = LinkingHypothesis(srcId, destId, std::move(features));
 }
 
-void JsonModel::readSegmentationHypothesis(const Json::Value& entry)
+void JsonModel::readSegmentationHypothesis(JsonStreamReader& reader)
 {
-    if(!entry.isObject())
+    if(reader.peek() != JsonStreamReader::TokenType::Object)
         throw std::runtime_error("Cannot extract SegmentationHypothesis from non-object JSON entry");
-    if(!entry.isMember(JsonTypeNames[JsonTypes::Id]) || !entry[JsonTypeNames[JsonTypes::Id]].isLabelType() 
-        || !entry.isMember(JsonTypeNames[JsonTypes::Features]) || !entry[JsonTypeNames[JsonTypes::Features]].isArray())
-        throw std::runtime_error("JSON entry for SegmentationHytpohesis is invalid");
 
+    const std::string& idKey = JsonTypeNames[JsonTypes::Id];
+    const std::string& featuresKey = JsonTypeNames[JsonTypes::Features];
+    const std::string& divisionFeaturesKey = JsonTypeNames[JsonTypes::DivisionFeatures];
+    const std::string& appearanceFeaturesKey = JsonTypeNames[JsonTypes::AppearanceFeatures];
+    const std::string& disappearanceFeaturesKey = JsonTypeNames[JsonTypes::DisappearanceFeatures];
+    const std::string& timestepKey = JsonTypeNames[JsonTypes::Timestep];
+
+    bool hasId = false, hasFeatures = false;
+    int timestep = -1;
+    IdLabelType id;
     StateFeatureVector detectionFeatures;
     StateFeatureVector divisionFeatures;
     StateFeatureVector appearanceFeatures;
     StateFeatureVector disappearanceFeatures;
 
-    IdLabelType id = entry[JsonTypeNames[JsonTypes::Id]].asLabelType();
-
-    detectionFeatures = extractFeatures(entry, JsonTypes::Features);
-
-    if(entry.isMember(JsonTypeNames[JsonTypes::DivisionFeatures]))
-        divisionFeatures = extractFeatures(entry, JsonTypes::DivisionFeatures);
+    std::string key;
+    reader.beginObject();
+    while(reader.nextMember(key))
+    {
+        if(key == idKey)
+        {
+            id = reader.readId();
+            hasId = true;
+        }
+        else if(key == featuresKey)
+        {
+            detectionFeatures = extractFeatures(reader, JsonTypes::Features);
+            hasFeatures = true;
+        }
+        else if(key == divisionFeaturesKey)
+            divisionFeatures = extractFeatures(reader, JsonTypes::DivisionFeatures);
+        // read appearance and disappearance if present
+        else if(key == appearanceFeaturesKey)
+            appearanceFeatures = extractFeatures(reader, JsonTypes::AppearanceFeatures);
+        else if(key == disappearanceFeaturesKey)
+            disappearanceFeatures = extractFeatures(reader, JsonTypes::DisappearanceFeatures);
+        else if(key == timestepKey)
+        {
+            // the timestep can be given as number or as [first, last] list like in ilastik, where we use the first entry
+            if(reader.peek() == JsonStreamReader::TokenType::Array)
+            {
+                reader.beginArray();
+                for(size_t i = 0; reader.nextElement(); ++i)
+                {
+                    if(i == 0)
+                        timestep = (int)reader.readDouble();
+                    else
+                        reader.skipValue();
+                }
+            }
+            else
+                timestep = (int)reader.readDouble();
+        }
+        else
+            reader.skipValue();
+    }
 
-    // read appearance and disappearance if present
-    if(entry.isMember(JsonTypeNames[JsonTypes::AppearanceFeatures]))
-        appearanceFeatures = extractFeatures(entry, JsonTypes::AppearanceFeatures);
-    
-    if(entry.isMember(JsonTypeNames[JsonTypes::DisappearanceFeatures]))
-        disappearanceFeatures = extractFeatures(entry, JsonTypes::DisappearanceFeatures);
+    if(!hasId || !hasFeatures)
+        throw std::runtime_error("JSON entry for SegmentationHytpohesis is invalid");
 
     // add to list
-    SegmentationHypothesis hyp(id, detectionFeatures, divisionFeatures, appearanceFeatures, disappearanceFeatures);
-    segmentationHypotheses_[id] = hyp;
+    SegmentationHypothesis hyp(id, std::move(detectionFeatures), std::move(divisionFeatures), std::move(appearanceFeatures), std::move(disappearanceFeatures));
+    hyp.setTimestep(timestep);
+    segmentationHypotheses_[id] = std::move(hyp);
 }
 
-void JsonModel::readDivisionHypothesis(const Json::Value& entry)
+void JsonModel::readDivisionHypothesis(JsonStreamReader& reader)
 {
-    if(!entry.isObject())
+    if(reader.peek() != JsonStreamReader::TokenType::Object)
         throw std::runtime_error("Cannot extract DivisionHypothesis from non-object JSON entry");
-    if(!entry.isMember(JsonTypeNames[JsonTypes::Parent]) || !entry[JsonTypeNames[JsonTypes::Parent]].isLabelType())
-        throw std::runtime_error("JSON entry for DivisionHypothesis is invalid: missing srcId"); 
-    if(!entry.isMember(JsonTypeNames[JsonTypes::Children]) || !entry[JsonTypeNames[JsonTypes::Children]].isArray() 
-            || entry[JsonTypeNames[JsonTypes::Children]].size() != 2)
-        throw std::runtime_error("JSON entry for DivisionHypothesis is invalid: must have two children as array");
-    if(!entry.isMember(JsonTypeNames[JsonTypes::Features]) || !entry[JsonTypeNames[JsonTypes::Features]].isArray())
-        throw std::runtime_error("JSON entry for DivisionHypothesis is invalid: missing features");
 
-    IdLabelType parentId = entry[JsonTypeNames[JsonTypes::Parent]].asLabelType();
+    const std::string& parentKey = JsonTypeNames[JsonTypes::Parent];
+    const std::string& childrenKey = JsonTypeNames[JsonTypes::Children];
+    const std::string& featuresKey = JsonTypeNames[JsonTypes::Features];
+
+    bool hasParent = false, hasFeatures = false;
+    IdLabelType parentId;
     std::vector<helpers::IdLabelType> childrenIds;
+    StateFeatureVector features;
 
-    const Json::Value children = entry[JsonTypeNames[JsonTypes::Children]];
-    for(int i = 0; i < (int)children.size(); ++i)
+    std::string key;
+    reader.beginObject();
+    while(reader.nextMember(key))
     {
-        childrenIds.push_back(children[i].asLabelType());
+        if(key == parentKey)
+        {
+            parentId = reader.readId();
+            hasParent = true;
+        }
+        else if(key == childrenKey)
+        {
+            if(reader.peek() != JsonStreamReader::TokenType::Array)
+                throw std::runtime_error("JSON entry for DivisionHypothesis is invalid: must have two children as array");
+            reader.beginArray();
+            while(reader.nextElement())
+                childrenIds.push_back(reader.readId());
+        }
+        else if(key == featuresKey)
+        {
+            // get transition features
+            features = extractFeatures(reader, JsonTypes::Features);
+            hasFeatures = true;
+        }
+        else
+            reader.skipValue();
     }
 
+    if(!hasParent)
+        throw std::runtime_error("JSON entry for DivisionHypothesis is invalid: missing srcId"); 
+    if(childrenIds.size() != 2)
+        throw std::runtime_error("JSON entry for DivisionHypothesis is invalid: must have two children as array");
+    if(!hasFeatures)
+        throw std::runtime_error("JSON entry for DivisionHypothesis is invalid: missing features");
+
     // always use ordered list of children!
     std::sort(childrenIds.begin(), childrenIds.end());
 
-    // get transition features
-    StateFeatureVector features = extractFeatures(entry, JsonTypes::Features);
-
-    // add to list
-    std::shared_ptr<DivisionHypothesis> hyp = std::make_shared<DivisionHypothesis>(parentId, childrenIds, features);
-    hyp->registerWithSegmentations(segmentationHypotheses_);
+    // add to list, registering with the segmentations happens once the whole file is read
     auto ids = std::make_tuple(parentId, childrenIds[0], childrenIds[1]);
-    divisionHypotheses_[ids] = hyp;
+    divisionHypotheses_[ids] = DivisionHypothesis(parentId, childrenIds, std::move(features));
 }
 
-void JsonModel::readExclusionConstraints(const Json::Value& entry)
+void JsonModel::readExclusionConstraints(JsonStreamReader& reader)
 {
-    if(!entry.isArray())
+    if(reader.peek() != JsonStreamReader::TokenType::Array)
         throw std::runtime_error("Cannot extract Constraint from non-array JSON entry");
 
     std::vector<helpers::IdLabelType> ids;
-    for(int i = 0; i < (int)entry.size(); i++)
+    reader.beginArray();
+    while(reader.nextElement())
     {
-        ids.push_back(entry[i].asLabelType());
+        ids.push_back(reader.readId());
     }
 
     if(ids.size() < 2)
@@ -128,54 +217,74 @@ void JsonModel::readFromJson(const std::string& filename)
     if(!input.good())
         throw std::runtime_error("Could not open JSON model file " + filename);
 
-    Json::Value root;
-    input >> root;
+    // stream through the file, hypotheses are created as soon as their entry has been read
+    Telemetry::ScopedPhase parsePhase(telemetry_, "parse");
+    JsonStreamReader reader(input);
+    if(reader.peek() != JsonStreamReader::TokenType::Object)
+        throw std::runtime_error("JSON model file must contain an object: " + filename);
 
-    // read settings:
-    Json::Value settingsJson;
-    if(!root.isMember(JsonTypeNames[JsonTypes::Settings]))
-        std::cout << "WARNING: JSON JsonModel has no settings specified, using defaults" << std::endl;
-    else
-        settingsJson = root[JsonTypeNames[JsonTypes::Settings]];
-    settings_ = std::make_shared<helpers::Settings>(settingsJson);
-    settings_->print();
-
-    // read segmentation hypotheses
-    const Json::Value segmentationHypotheses = root[JsonTypeNames[JsonTypes::Segmentations]];
-    std::cout << "\tcontains " << segmentationHypotheses.size() << " segmentation hypotheses" << std::endl;
-    
-    for(int i = 0; i < (int)segmentationHypotheses.size(); i++)
+    // calls readEntry for each element of the array, returns the number of elements
+    auto readArray = [&](const std::string& name, std::function<void(JsonStreamReader&)> readEntry)
     {
-        const Json::Value jsonHyp = segmentationHypotheses[i];
-        readSegmentationHypothesis(jsonHyp);
-    }
+        if(reader.peek() != JsonStreamReader::TokenType::Array)
+            throw std::runtime_error("JSON entry " + name + " must be an array");
 
-    // read linking hypotheses
-    const Json::Value linkingHypotheses = root[JsonTypeNames[JsonTypes::Links]];
-    std::cout << "\tcontains " << linkingHypotheses.size() << " linking hypotheses" << std::endl;
-    for(int i = 0; i < (int)linkingHypotheses.size(); i++)
-    {
-        const Json::Value jsonHyp = linkingHypotheses[i];
-        readLinkingHypothesis(jsonHyp);
-    }
+        size_t numEntries = 0;
+        reader.beginArray();
+        while(reader.nextElement())
+        {
+            readEntry(reader);
+            numEntries++;
+        }
+        return numEntries;
+    };
 
-    // read division hypotheses
-    const Json::Value divisionHypotheses = root[JsonTypeNames[JsonTypes::Divisions]];
-    std::cout << "\tcontains " << divisionHypotheses.size() << " division hypotheses" << std::endl;
-    for(int i = 0; i < (int)divisionHypotheses.size(); i++)
+    Json::Value settingsJson;
+    bool hasSettings = false;
+    std::string key;
+    reader.beginObject();
+    while(reader.nextMember(key))
     {
-        const Json::Value jsonHyp = divisionHypotheses[i];
-        readDivisionHypothesis(jsonHyp);
+        if(key == JsonTypeNames[JsonTypes::Settings])
+        {
+            // settings are small, so we can afford a json tree for them
+            settingsJson = reader.readValue();
+            hasSettings = true;
+        }
+        else if(key == JsonTypeNames[JsonTypes::Segmentations])
+        {
+            size_t num = readArray(key, [&](JsonStreamReader& r){ readSegmentationHypothesis(r); });
+            std::cout << "\tcontains " << num << " segmentation hypotheses" << std::endl;
+        }
+        else if(key == JsonTypeNames[JsonTypes::Links])
+        {
+            size_t num = readArray(key, [&](JsonStreamReader& r){ readLinkingHypothesis(r); });
+            std::cout << "\tcontains " << num << " linking hypotheses" << std::endl;
+        }
+        else if(key == JsonTypeNames[JsonTypes::Divisions])
+        {
+            size_t num = readArray(key, [&](JsonStreamReader& r){ readDivisionHypothesis(r); });
+            std::cout << "\tcontains " << num << " division hypotheses" << std::endl;
+        }
+        else if(key == JsonTypeNames[JsonTypes::Exclusions])
+        {
+            // exclusion constraints between detections
+            size_t num = readArray(key, [&](JsonStreamReader& r){ readExclusionConstraints(r); });
+            std::cout << "\tcontains " << num << " exclusions" << std::endl;
+        }
+        else
+            reader.skipValue();
     }
 
-    // read exclusion constraints between detections
-    const Json::Value exclusions = root[JsonTypeNames[JsonTypes::Exclusions]];
-    std::cout << "\tcontains " << exclusions.size() << " exclusions" << std::endl;
-    for(int i = 0; i < (int)exclusions.size(); i++)
-    {
-        const Json::Value jsonExc = exclusions[i];
-        readExclusionConstraints(jsonExc);
-    }
+    // read settings:
+    if(!hasSettings)
+        std::cout << "WARNING: JSON JsonModel has no settings specified, using defaults" << std::endl;
+    settings_ = std::make_shared<helpers::Settings>(settingsJson);
+    settings_->print();
+    parsePhase.stop();
+
+    // links and divisions may appear before the segmentation hypotheses in the file
+    buildAdjacency();
 }
 
 void JsonModel::setJsonGtFile(const std::string& filename)
@@ -189,140 +298,221 @@ Solution JsonModel::getGroundTruth()
     if(!input.good())
         throw std::runtime_error("Could not open JSON ground truth file " + groundTruthFilename_);
 
-    if(!model_.numberOfVariables() > 0)
-        throw std::runtime_error("OpenGM model must be initialized before reading a ground truth file!");
-
-    Json::Value root;
-    input >> root;
+    // create a solution vector that holds a value for each segmentation / detection / link,
+    // the variable ids are the same as in the OpenGM model but the model does not need to be built for that
+    Solution solution(assignOpenGMVariableIds(), 0);
 
-    const Json::Value linkingResults = root[JsonTypeNames[JsonTypes::LinkResults]];
-    std::cout << "\tcontains " << linkingResults.size() << " linking annotations" << std::endl;
+    // fields of one entry of any of the result lists,
+    // division results can only be checked once all detections are known, so they are buffered
+    struct ResultEntry
+    {
+        bool hasId = false;
+        bool hasSrc = false;
+        bool hasDest = false;
+        bool hasParent = false;
+        bool hasChildren = false;
+        helpers::IdLabelType id;
+        helpers::IdLabelType srcId;
+        helpers::IdLabelType destId;
+        helpers::IdLabelType parent;
+        std::vector<helpers::IdLabelType> children;
+        size_t value = 0;
+    };
+    std::vector<ResultEntry> divisionResults;
+
+    const std::string& idKey = JsonTypeNames[JsonTypes::Id];
+    const std::string& srcKey = JsonTypeNames[JsonTypes::SrcId];
+    const std::string& destKey = JsonTypeNames[JsonTypes::DestId];
+    const std::string& valueKey = JsonTypeNames[JsonTypes::Value];
+    const std::string& parentKey = JsonTypeNames[JsonTypes::Parent];
+    const std::string& childrenKey = JsonTypeNames[JsonTypes::Children];
+
+    JsonStreamReader reader(input);
+    if(reader.peek() != JsonStreamReader::TokenType::Object)
+        throw std::runtime_error("JSON ground truth file must contain an object: " + groundTruthFilename_);
+
+    std::string key;
+    std::string entryKey;
+    reader.beginObject();
+    while(reader.nextMember(key))
+    {
+        if(key != JsonTypeNames[JsonTypes::LinkResults]
+           && key != JsonTypeNames[JsonTypes::DetectionResults]
+           && key != JsonTypeNames[JsonTypes::DivisionResults])
+        {
+            reader.skipValue();
+            continue;
+        }
 
-    // create a solution vector that holds a value for each segmentation / detection / link
-    Solution solution(model_.numberOfVariables(), 0);
+        if(reader.peek() != JsonStreamReader::TokenType::Array)
+            throw std::runtime_error("JSON entry " + key + " must be an array");
 
-    // first set all links and the respective source nodes to active
-    for(int i = 0; i < (int)linkingResults.size(); ++i)
-    {
-        const Json::Value jsonHyp = linkingResults[i];
-        helpers::IdLabelType srcId = jsonHyp[JsonTypeNames[JsonTypes::SrcId]].asLabelType();
-        helpers::IdLabelType destId = jsonHyp[JsonTypeNames[JsonTypes::DestId]].asLabelType();
-        size_t value = jsonHyp[JsonTypeNames[JsonTypes::Value]].asUInt();
-        if(value > 0)
+        size_t numEntries = 0;
+        reader.beginArray();
+        while(reader.nextElement())
         {
-            // try to find link
-            if(linkingHypotheses_.find(std::make_pair(srcId, destId)) == linkingHypotheses_.end())
+            if(reader.peek() != JsonStreamReader::TokenType::Object)
+                throw std::runtime_error("Entries of " + key + " must be objects");
+            numEntries++;
+
+            ResultEntry entry;
+            reader.beginObject();
+            while(reader.nextMember(entryKey))
             {
-                std::stringstream s;
-                s << "Cannot find link to annotate: " << srcId << " to " << destId;
-                throw std::runtime_error(s.str());
+                if(entryKey == idKey)
+                {
+                    entry.id = reader.readId();
+                    entry.hasId = true;
+                }
+                else if(entryKey == srcKey)
+                {
+                    entry.srcId = reader.readId();
+                    entry.hasSrc = true;
+                }
+                else if(entryKey == destKey)
+                {
+                    entry.destId = reader.readId();
+                    entry.hasDest = true;
+                }
+                else if(entryKey == valueKey)
+                {
+                    entry.value = reader.readUInt();
+                }
+                else if(entryKey == parentKey)
+                {
+                    entry.parent = reader.readId();
+                    entry.hasParent = true;
+                }
+                else if(entryKey == childrenKey && reader.peek() == JsonStreamReader::TokenType::Array)
+                {
+                    entry.hasChildren = true;
+                    reader.beginArray();
+                    while(reader.nextElement())
+                        entry.children.push_back(reader.readId());
+                }
+                else if(entryKey == childrenKey)
+                {
+                    // not an array, reported as invalid below
+                    entry.hasChildren = true;
+                    reader.skipValue();
+                }
+                else
+                    reader.skipValue();
             }
-            
-            // set link active
-            std::shared_ptr<LinkingHypothesis> hyp = linkingHypotheses_[std::make_pair(srcId, destId)];
-            solution[hyp->getVariable().getOpenGMVariableId()] = value;
-        }
-    }
 
-    // read segmentation variables
-    const Json::Value segmentationResults = root[JsonTypeNames[JsonTypes::DetectionResults]];
-    std::cout << "\tcontains " << segmentationResults.size() << " detection annotations" << std::endl;
-    for(int i = 0; i < (int)segmentationResults.size(); ++i)
-    {
-        const Json::Value jsonHyp = segmentationResults[i];
-        helpers::IdLabelType id = jsonHyp[JsonTypeNames[JsonTypes::Id]].asLabelType();
-        size_t value = jsonHyp[JsonTypeNames[JsonTypes::Value]].asUInt();
+            if(key == JsonTypeNames[JsonTypes::LinkResults])
+            {
+                // set all links to active
+                if(entry.value > 0)
+                {
+                    if(!entry.hasSrc || !entry.hasDest)
+                        throw std::runtime_error("JSON link result entry is invalid: needs srcId and destId");
+                    helpers::IdLabelType srcId = entry.srcId;
+                    helpers::IdLabelType destId = entry.destId;
+
+                    // try to find link
+                    if(linkingHypotheses_.find(std::make_pair(srcId, destId)) == linkingHypotheses_.end())
+                    {
+                        std::stringstream s;
+                        s << "Cannot find link to annotate: " << srcId << " to " << destId;
+                        throw std::runtime_error(s.str());
+                    }
+                    
+                    // set link active
+                    const LinkingHypothesis& hyp = linkingHypotheses_.at(std::make_pair(srcId, destId));
+                    solution[hyp.getVariable().getOpenGMVariableId()] = entry.value;
+                }
+            }
+            else if(key == JsonTypeNames[JsonTypes::DetectionResults])
+            {
+                // read segmentation variables
+                if(!entry.hasId)
+                    throw std::runtime_error("JSON detection result entry is invalid: missing id");
+                solution[segmentationHypotheses_.at(entry.id).getDetectionVariable().getOpenGMVariableId()] = entry.value;
+            }
+            else if(entry.value > 0)
+            {
+                divisionResults.push_back(entry);
+            }
+        }
 
-        solution[segmentationHypotheses_[id].getDetectionVariable().getOpenGMVariableId()] = value;
+        if(key == JsonTypeNames[JsonTypes::LinkResults])
+            std::cout << "\tcontains " << numEntries << " linking annotations" << std::endl;
+        else if(key == JsonTypeNames[JsonTypes::DetectionResults])
+            std::cout << "\tcontains " << numEntries << " detection annotations" << std::endl;
+        else
+            std::cout << "\tcontains " << numEntries << " division annotations" << std::endl;
     }
 
-    // read division variable states
-    const Json::Value divisionResults = root[JsonTypeNames[JsonTypes::DivisionResults]];
-    std::cout << "\tcontains " << divisionResults.size() << " division annotations" << std::endl;
-    for(int i = 0; i < (int)divisionResults.size(); ++i)
+    // set division variable states, all buffered entries are active
+    for(const ResultEntry& jsonHyp : divisionResults)
     {
-        const Json::Value jsonHyp = divisionResults[i];
-        bool value = jsonHyp[JsonTypeNames[JsonTypes::Value]].asBool();
-
-        if(value)
+        // depending on internal or external division node setup, handle both gracefully!
+        helpers::IdLabelType id;
+        if(jsonHyp.hasId)
         {
-            // depending on internal or external division node setup, handle both gracefully!
-            helpers::IdLabelType id;
-            if(jsonHyp.isMember(JsonTypeNames[JsonTypes::Id]))
-            {
-                // id is given for internal division
-                id = jsonHyp[JsonTypeNames[JsonTypes::Id]].asLabelType();
-            }
-            else
-            {
-                // parent is given for external
-                if(!jsonHyp.isMember(JsonTypeNames[JsonTypes::Parent]))
-                    throw std::runtime_error("Invalid configuration of a JSON division result entry");
+            // id is given for internal division
+            id = jsonHyp.id;
+        }
+        else
+        {
+            // parent is given for external
+            if(!jsonHyp.hasParent)
+                throw std::runtime_error("Invalid configuration of a JSON division result entry");
 
-                id = jsonHyp[JsonTypeNames[JsonTypes::Parent]].asLabelType();
-            }
+            id = jsonHyp.parent;
+        }
 
-            if(solution[segmentationHypotheses_[id].getDetectionVariable().getOpenGMVariableId()] == 0)
+        if(solution[segmentationHypotheses_.at(id).getDetectionVariable().getOpenGMVariableId()] == 0)
+        {
+            // in any case the parent must be active!
+            std::stringstream error;
+            error << "Cannot activate division of node " << id << " that is not active!";
+            throw std::runtime_error(error.str());
+        }
+
+        if(jsonHyp.hasId)
+        {
+            if(segmentationHypotheses_.at(id).getDivisionVariable().getOpenGMVariableId() < 0)
             {
-                // in any case the parent must be active!
                 std::stringstream error;
-                error << "Cannot activate division of node " << id << " that is not active!";
+                error << "Trying to set division of " << id << " active but the variable had no division features!";
                 throw std::runtime_error(error.str());
             }
-
-            if(jsonHyp.isMember(JsonTypeNames[JsonTypes::Id]))
+            // internal if id is given AND there is a opengm variable for the internal division
+            solution[segmentationHypotheses_.at(id).getDivisionVariable().getOpenGMVariableId()] = 1;
+        }
+        else if(jsonHyp.hasParent && jsonHyp.hasChildren)
+        {
+            if(jsonHyp.children.size() != 2)
             {
-                if(segmentationHypotheses_[id].getDivisionVariable().getOpenGMVariableId() < 0)
-                {
-                    std::stringstream error;
-                    error << "Trying to set division of " << id << " active but the variable had no division features!";
-                    throw std::runtime_error(error.str());
-                }
-                // internal if id is given AND there is a opengm variable for the internal division
-                solution[segmentationHypotheses_[id].getDivisionVariable().getOpenGMVariableId()] = 1;
+                std::stringstream error;
+                error << "Activating an external division of parent " << id << " requires two children!";
+                throw std::runtime_error(error.str());
             }
-            else if(jsonHyp.isMember(JsonTypeNames[JsonTypes::Parent]) && jsonHyp.isMember(JsonTypeNames[JsonTypes::Children]))
-            {
-                const Json::Value& children = jsonHyp[JsonTypeNames[JsonTypes::Children]];
-
-                if(!children.isArray() || children.size() != 2)
-                {
-                    std::stringstream error;
-                    error << "Activating an external division of parent " << id << " requires two children!";
-                    throw std::runtime_error(error.str());
-                }
-
-                std::vector<IdLabelType> childrenIds;
-                for(int i = 0; i < (int)children.size(); ++i)
-                {
-                    childrenIds.push_back(children[i].asLabelType());
-                }
 
-                // always use ordered list of children!
-                std::sort(childrenIds.begin(), childrenIds.end());
+            // always use ordered list of children!
+            std::vector<IdLabelType> childrenIds = jsonHyp.children;
+            std::sort(childrenIds.begin(), childrenIds.end());
 
-                DivisionHypothesis::IdType idx = std::make_tuple(jsonHyp[JsonTypeNames[JsonTypes::Parent]].asLabelType(),
-                                                                childrenIds[0],
-                                                                childrenIds[1]);
+            DivisionHypothesis::IdType idx = std::make_tuple(jsonHyp.parent, childrenIds[0], childrenIds[1]);
 
-                if(divisionHypotheses_.find(idx) == divisionHypotheses_.end())
-                {
-                    std::stringstream error;
-                    error << "Parent " << id << " does not have division to " << children[0].asLabelType() << " and " << children[1].asLabelType() << " to set active!";
-                    throw std::runtime_error(error.str());
-                }
-
-                std::cout << "Setting external division to active! " << std::endl;
-                auto divHyp = divisionHypotheses_[idx];
-                solution[divHyp->getVariable().getOpenGMVariableId()] = 1;
-            }
-            else
+            if(divisionHypotheses_.find(idx) == divisionHypotheses_.end())
             {
                 std::stringstream error;
-                error << "Trying to set division of " << id << " active but the variable had no division features and no external divisions!";
+                error << "Parent " << id << " does not have division to " << jsonHyp.children[0] << " and " << jsonHyp.children[1] << " to set active!";
                 throw std::runtime_error(error.str());
             }
-                
+
+            std::cout << "Setting external division to active! " << std::endl;
+            const DivisionHypothesis& divHyp = divisionHypotheses_.at(idx);
+            solution[divHyp.getVariable().getOpenGMVariableId()] = 1;
+        }
+        else
+        {
+            std::stringstream error;
+            error << "Trying to set division of " << id << " active but the variable had no division features and no external divisions!";
+            throw std::runtime_error(error.str());
         }
     }
 
@@ -339,13 +529,14 @@ void JsonModel::saveResultToJson(const std::string& filename, const Solution& so
     if(!output.good())
         throw std::runtime_error("Could not open JSON result file for saving: " + filename);
 
+    Telemetry::ScopedPhase exportPhase(telemetry_, "export");
     Json::Value root;
 
     // save links
     Json::Value& linksJson = root[JsonTypeNames[JsonTypes::LinkResults]];
     for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
     {
-        size_t value = sol[iter->second->getVariable().getOpenGMVariableId()];
+        size_t value = sol[iter->second.getVariable().getOpenGMVariableId()];
         if(value > 0)
             linksJson.append(linkToJson(iter->second, value));
     }
@@ -363,9 +554,9 @@ void JsonModel::saveResultToJson(const std::string& filename, const Solution& so
     }
     for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
     {
-        if(iter->second->getVariable().getOpenGMVariableId() >= 0)
+        if(iter->second.getVariable().getOpenGMVariableId() >= 0)
         {
-            size_t value = sol[iter->second->getVariable().getOpenGMVariableId()];
+            size_t value = sol[iter->second.getVariable().getOpenGMVariableId()];
             if(value > 0)
                 divisionsJson.append(divisionToJson(iter->second, value));
         }
@@ -386,24 +577,28 @@ void JsonModel::saveResultToJson(const std::string& filename, const Solution& so
     // store result energy
     root[JsonTypeNames[JsonTypes::ResultEnergy]] = Json::Value(getLastSolutionValue());
 
+    // the telemetry includes the export up to here, but not writing the file
+    exportPhase.stop();
+    telemetry_.toJson(root[JsonTypeNames[JsonTypes::Telemetry]]);
+
     output << root << std::endl;
 }
 
-const Json::Value JsonModel::linkToJson(const std::shared_ptr<LinkingHypothesis>& link, size_t state) const
+const Json::Value JsonModel::linkToJson(const LinkingHypothesis& link, size_t state) const
 {
     Json::Value val;
-    val[JsonTypeNames[JsonTypes::SrcId]] = Json::Value(link->getSrcId());
-    val[JsonTypeNames[JsonTypes::DestId]] = Json::Value(link->getDestId());
+    val[JsonTypeNames[JsonTypes::SrcId]] = Json::Value(link.getSrcId());
+    val[JsonTypeNames[JsonTypes::DestId]] = Json::Value(link.getDestId());
     val[JsonTypeNames[JsonTypes::Value]] = Json::Value((unsigned int)state);
     return val;
 }
 
-const Json::Value JsonModel::divisionToJson(const std::shared_ptr<DivisionHypothesis>& division, size_t state) const
+const Json::Value JsonModel::divisionToJson(const DivisionHypothesis& division, size_t state) const
 {
     Json::Value val;
-    val[JsonTypeNames[JsonTypes::Parent]] = Json::Value(division->getParentId());
+    val[JsonTypeNames[JsonTypes::Parent]] = Json::Value(division.getParentId());
     Json::Value& children = val[JsonTypeNames[JsonTypes::Children]];
-    for(auto c : division->getChildrenIds())
+    for(auto c : division.getChildrenIds())
         children.append(c);
 
     val[JsonTypeNames[JsonTypes::Value]] = Json::Value(state==1);
@@ -0,0 +1,441 @@
+#include "jsonstreamreader.h"
+
+#include <stdexcept>
+#include <sstream>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+
+namespace helpers
+{
+
+namespace
+{
+	const size_t BufferSize = 1 << 16;
+}
+
+JsonStreamReader::JsonStreamReader(std::istream& input):
+	input_(input),
+	buffer_(BufferSize),
+	bufferPosition_(0),
+	bufferSize_(0),
+	line_(1)
+{}
+
+void JsonStreamReader::error(const std::string& message) const
+{
+	std::stringstream s;
+	s << "JSON parse error in line " << line_ << ": " << message;
+	throw std::runtime_error(s.str());
+}
+
+int JsonStreamReader::peekRawChar()
+{
+	if(bufferPosition_ == bufferSize_)
+	{
+		input_.read(buffer_.data(), buffer_.size());
+		bufferSize_ = input_.gcount();
+		bufferPosition_ = 0;
+		if(bufferSize_ == 0)
+			return -1;
+	}
+	return (unsigned char)buffer_[bufferPosition_];
+}
+
+int JsonStreamReader::getRawChar()
+{
+	int c = peekRawChar();
+	if(c >= 0)
+	{
+		bufferPosition_++;
+		if(c == '\n')
+			line_++;
+	}
+	return c;
+}
+
+void JsonStreamReader::skipComment()
+{
+	// the leading slash has already been consumed
+	int c = getRawChar();
+	if(c == '/')
+	{
+		while(c >= 0 && c != '\n')
+			c = getRawChar();
+	}
+	else if(c == '*')
+	{
+		int previous = 0;
+		c = getRawChar();
+		while(c >= 0 && !(previous == '*' && c == '/'))
+		{
+			previous = c;
+			c = getRawChar();
+		}
+		if(c < 0)
+			error("Unterminated comment");
+	}
+	else
+	{
+		error("Unexpected character '/'");
+	}
+}
+
+int JsonStreamReader::peekChar()
+{
+	while(true)
+	{
+		int c = peekRawChar();
+		if(c == ' ' || c == '\t' || c == '\n' || c == '\r')
+			getRawChar();
+		else if(c == '/')
+		{
+			getRawChar();
+			skipComment();
+		}
+		else
+			return c;
+	}
+}
+
+void JsonStreamReader::expect(char c)
+{
+	if(peekChar() != c)
+		error(std::string("Expected '") + c + "'");
+	getRawChar();
+}
+
+void JsonStreamReader::expectLiteral(const char* literal)
+{
+	for(const char* l = literal; *l != '\0'; ++l)
+	{
+		if(getRawChar() != *l)
+			error(std::string("Invalid literal, expected ") + literal);
+	}
+}
+
+JsonStreamReader::TokenType JsonStreamReader::peek()
+{
+	int c = peekChar();
+	switch(c)
+	{
+		case -1: return TokenType::EndOfInput;
+		case '{': return TokenType::Object;
+		case '[': return TokenType::Array;
+		case '"': return TokenType::String;
+		case 't':
+		case 'f': return TokenType::Bool;
+		case 'n': return TokenType::Null;
+		default:
+			if(c == '-' || (c >= '0' && c <= '9'))
+				return TokenType::Number;
+			error(std::string("Unexpected character '") + (char)c + "'");
+	}
+	return TokenType::EndOfInput;
+}
+
+void JsonStreamReader::beginObject()
+{
+	expect('{');
+	isFirstStack_.push_back(true);
+}
+
+bool JsonStreamReader::nextMember(std::string& key)
+{
+	if(isFirstStack_.empty())
+		error("nextMember() called outside of an object");
+
+	if(peekChar() == '}')
+	{
+		getRawChar();
+		isFirstStack_.pop_back();
+		return false;
+	}
+
+	if(!isFirstStack_.back())
+		expect(',');
+	isFirstStack_.back() = false;
+
+	if(peek() != TokenType::String)
+		error("Expected the name of an object member");
+	key = readString();
+	expect(':');
+	return true;
+}
+
+void JsonStreamReader::beginArray()
+{
+	expect('[');
+	isFirstStack_.push_back(true);
+}
+
+bool JsonStreamReader::nextElement()
+{
+	if(isFirstStack_.empty())
+		error("nextElement() called outside of an array");
+
+	if(peekChar() == ']')
+	{
+		getRawChar();
+		isFirstStack_.pop_back();
+		return false;
+	}
+
+	if(!isFirstStack_.back())
+		expect(',');
+	isFirstStack_.back() = false;
+	return true;
+}
+
+unsigned int JsonStreamReader::readHexQuad()
+{
+	unsigned int value = 0;
+	for(int i = 0; i < 4; ++i)
+	{
+		int c = getRawChar();
+		value <<= 4;
+		if(c >= '0' && c <= '9')
+			value += c - '0';
+		else if(c >= 'a' && c <= 'f')
+			value += c - 'a' + 10;
+		else if(c >= 'A' && c <= 'F')
+			value += c - 'A' + 10;
+		else
+			error("Invalid unicode escape sequence");
+	}
+	return value;
+}
+
+void JsonStreamReader::appendUtf8(std::string& result, unsigned int codePoint)
+{
+	if(codePoint < 0x80)
+		result += (char)codePoint;
+	else if(codePoint < 0x800)
+	{
+		result += (char)(0xC0 | (codePoint >> 6));
+		result += (char)(0x80 | (codePoint & 0x3F));
+	}
+	else if(codePoint < 0x10000)
+	{
+		result += (char)(0xE0 | (codePoint >> 12));
+		result += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+		result += (char)(0x80 | (codePoint & 0x3F));
+	}
+	else
+	{
+		result += (char)(0xF0 | (codePoint >> 18));
+		result += (char)(0x80 | ((codePoint >> 12) & 0x3F));
+		result += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+		result += (char)(0x80 | (codePoint & 0x3F));
+	}
+}
+
+std::string JsonStreamReader::readString()
+{
+	expect('"');
+	std::string result;
+	while(true)
+	{
+		int c = getRawChar();
+		if(c < 0)
+			error("Unterminated string");
+		if(c == '"')
+			return result;
+		if(c != '\\')
+		{
+			result += (char)c;
+			continue;
+		}
+
+		c = getRawChar();
+		switch(c)
+		{
+			case '"': result += '"'; break;
+			case '\\': result += '\\'; break;
+			case '/': result += '/'; break;
+			case 'b': result += '\b'; break;
+			case 'f': result += '\f'; break;
+			case 'n': result += '\n'; break;
+			case 'r': result += '\r'; break;
+			case 't': result += '\t'; break;
+			case 'u':
+			{
+				unsigned int codePoint = readHexQuad();
+				if(codePoint >= 0xD800 && codePoint <= 0xDBFF)
+				{
+					// surrogate pair
+					if(getRawChar() != '\\' || getRawChar() != 'u')
+						error("Expected second half of a unicode surrogate pair");
+					unsigned int low = readHexQuad();
+					codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+				}
+				appendUtf8(result, codePoint);
+				break;
+			}
+			default:
+				error("Invalid escape sequence in string");
+		}
+	}
+}
+
+std::string JsonStreamReader::readNumberToken()
+{
+	if(peek() != TokenType::Number)
+		error("Expected a number");
+
+	std::string token;
+	while(true)
+	{
+		int c = peekRawChar();
+		if((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')
+			token += (char)getRawChar();
+		else
+			return token;
+	}
+}
+
+double JsonStreamReader::readDouble()
+{
+	switch(peek())
+	{
+		case TokenType::Bool:
+			return readBool() ? 1.0 : 0.0;
+		case TokenType::Null:
+			expectLiteral("null");
+			return 0.0;
+		default:
+			break;
+	}
+
+	std::string token = readNumberToken();
+	char* end = nullptr;
+	double value = std::strtod(token.c_str(), &end);
+	if(end != token.c_str() + token.size())
+		error("Invalid number " + token);
+	return value;
+}
+
+unsigned int JsonStreamReader::readUInt()
+{
+	if(peek() != TokenType::Number)
+		return (unsigned int)readDouble();
+
+	double value = readDouble();
+	if(value < 0 || value > std::numeric_limits<unsigned int>::max() || std::floor(value) != value)
+		error("Expected an unsigned integer");
+	return (unsigned int)value;
+}
+
+bool JsonStreamReader::readBool()
+{
+	switch(peek())
+	{
+		case TokenType::Bool:
+			if(peekChar() == 't')
+			{
+				expectLiteral("true");
+				return true;
+			}
+			expectLiteral("false");
+			return false;
+		case TokenType::Null:
+			expectLiteral("null");
+			return false;
+		case TokenType::Number:
+			return readDouble() != 0.0;
+		default:
+			error("Expected a boolean");
+	}
+	return false;
+}
+
+IdLabelType JsonStreamReader::readId()
+{
+#ifdef USE_STRING_IDS
+	if(peek() != TokenType::String)
+		error("Expected a string id");
+	return readString();
+#else
+	if(peek() != TokenType::Number)
+		error("Expected a numeric id");
+	return readUInt();
+#endif
+}
+
+void JsonStreamReader::skipValue()
+{
+	std::string key;
+	switch(peek())
+	{
+		case TokenType::Object:
+			beginObject();
+			while(nextMember(key))
+				skipValue();
+			break;
+		case TokenType::Array:
+			beginArray();
+			while(nextElement())
+				skipValue();
+			break;
+		case TokenType::String:
+			readString();
+			break;
+		case TokenType::Number:
+			readNumberToken();
+			break;
+		case TokenType::Bool:
+			readBool();
+			break;
+		case TokenType::Null:
+			expectLiteral("null");
+			break;
+		case TokenType::EndOfInput:
+			error("Unexpected end of input");
+	}
+}
+
+Json::Value JsonStreamReader::readValue()
+{
+	std::string key;
+	switch(peek())
+	{
+		case TokenType::Object:
+		{
+			Json::Value value(Json::objectValue);
+			beginObject();
+			while(nextMember(key))
+				value[key] = readValue();
+			return value;
+		}
+		case TokenType::Array:
+		{
+			Json::Value value(Json::arrayValue);
+			beginArray();
+			while(nextElement())
+				value.append(readValue());
+			return value;
+		}
+		case TokenType::String:
+			return Json::Value(readString());
+		case TokenType::Number:
+		{
+			std::string token = readNumberToken();
+			bool isInteger = token.find_first_of(".eE") == std::string::npos;
+			if(isInteger && token[0] != '-')
+				return Json::Value((Json::UInt64)std::strtoull(token.c_str(), nullptr, 10));
+			if(isInteger)
+				return Json::Value((Json::Int64)std::strtoll(token.c_str(), nullptr, 10));
+			return Json::Value(std::strtod(token.c_str(), nullptr));
+		}
+		case TokenType::Bool:
+			return Json::Value(readBool());
+		case TokenType::Null:
+			expectLiteral("null");
+			return Json::Value();
+		case TokenType::EndOfInput:
+			error("Unexpected end of input");
+	}
+	return Json::Value();
+}
+
+} // end namespace helpers
@@ -9,10 +9,10 @@ namespace mht
 LinkingHypothesis::LinkingHypothesis()
 {}
 
-LinkingHypothesis::LinkingHypothesis(helpers::IdLabelType srcId, helpers::IdLabelType destId, const helpers::StateFeatureVector& features):
+LinkingHypothesis::LinkingHypothesis(helpers::IdLabelType srcId, helpers::IdLabelType destId, helpers::StateFeatureVector features):
     srcId_(srcId),
     destId_(destId),
-    variable_(features)
+    variable_(std::move(features))
 {}
 
 void LinkingHypothesis::toDot(std::ostream& stream, const Solution* sol) const
@@ -33,26 +33,25 @@ void LinkingHypothesis::toDot(std::ostream& stream, const Solution* sol) const
     stream << "; \n" << std::flush;
 }
 
-void LinkingHypothesis::registerWithSegmentations(std::map<helpers::IdLabelType, SegmentationHypothesis>& segmentationHypotheses)
+void LinkingHypothesis::addToOpenGMModel(GraphicalModelType& model)
 {
-    assert(segmentationHypotheses.find(srcId_) != segmentationHypotheses.end());
-    assert(segmentationHypotheses.find(destId_) != segmentationHypotheses.end());
+    // std::cout << "Adding linking hypothesis between " << srcId_ << " and " << destId_ << " to opengm" << std::endl;
 
-    // std::cout << "Registering outgoing link for " << srcId_ << std::endl;
-    segmentationHypotheses[srcId_].addOutgoingLink(shared_from_this());
-    // std::cout << "Registering incoming link for " << destId_ << std::endl;
-    segmentationHypotheses[destId_].addIncomingLink(shared_from_this());
+    variable_.addToOpenGM(model);
 }
 
-void LinkingHypothesis::addToOpenGMModel(
-    GraphicalModelType& model, 
+void LinkingHypothesis::addFactorsToOpenGMModel(
+    FactorBuffer& buffer, 
     WeightsType& weights, 
     bool statesShareWeights,
-    const std::vector<size_t>& weightIds)
+    const std::vector<size_t>& weightIds) const
 {
-    // std::cout << "Adding linking hypothesis between " << srcId_ << " and " << destId_ << " to opengm" << std::endl;
+    variable_.addUnaryToOpenGM(buffer, statesShareWeights, weights, weightIds);
+}
 
-    variable_.addToOpenGM(model, statesShareWeights, weights, weightIds);
+void LinkingHypothesis::assignOpenGMVariableIds(int& nextId)
+{
+    variable_.assignOpenGMVariableId(nextId);
 }
 
 } // end namespace mht
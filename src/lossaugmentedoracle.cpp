@@ -0,0 +1,87 @@
+#include "lossaugmentedoracle.h"
+
+#include <opengm/learning/gradient-accumulator.hxx>
+
+#include "parallel.h"
+
+using namespace helpers;
+
+namespace mht
+{
+
+LossAugmentedOracle::LossAugmentedOracle(DatasetType& dataset,
+										 const MipInference::Parameter& parameter,
+										 size_t numThreads,
+										 Telemetry& telemetry):
+	dataset_(dataset),
+	parameter_(parameter),
+	numThreads_(numThreads),
+	telemetry_(telemetry),
+	mostViolated_(dataset.getNumberOfModels())
+{
+	// the logs of concurrent solves would interleave
+	const size_t numWorkers = getNumWorkerThreads(numThreads_, dataset.getNumberOfModels());
+	if(numWorkers > 1)
+		parameter_.verbose_ = false;
+	for(size_t worker = 0; worker < numWorkers; ++worker)
+		backends_.push_back(SolverBackend::create(parameter_.backend_));
+}
+
+void LossAugmentedOracle::operator()(const WeightsType& weights, double& value, WeightsType& gradient)
+{
+	typedef opengm::learning::GradientAccumulator<WeightsType, Solution> GradientAccumulatorType;
+	const size_t numInstances = dataset_.getNumberOfModels();
+
+	// all models refer to the weights of the dataset, which the workers only read
+	dataset_.getWeights() = weights;
+	for(size_t i = 0; i < numInstances; ++i)
+		dataset_.lockModel(i);
+
+	std::vector<double> instanceValues(numInstances, 0.0);
+	std::vector<WeightsType> instanceGradients(numInstances, WeightsType(gradient.numberOfWeights()));
+	parallelForWorkers(numInstances, numThreads_, [&](size_t i, size_t worker)
+	{
+		const GraphicalModelType& model = dataset_.getModel(i);
+		const DatasetType::GMWITHLOSS& modelWithLoss = dataset_.getModelWithLoss(i);
+		const Solution& groundTruth = dataset_.getGT(i);
+
+		// find the labeling y* that minimizes E(y,w) - loss(y',y)
+		MipInference inference(modelWithLoss, parameter_, *backends_[worker]);
+		if(mostViolated_[i].size() == modelWithLoss.numberOfVariables())
+			inference.setStartingPoint(mostViolated_[i].begin());
+		inference.infer();
+		inference.arg(mostViolated_[i]);
+
+		// the value of this instance is E(y',w) - (E(y*,w) - loss(y',y*)), its gradient is dE(y',w)/dw - dE(y*,w)/dw
+		instanceValues[i] = model.evaluate(groundTruth.begin()) - modelWithLoss.evaluate(mostViolated_[i].begin());
+		WeightsType& instanceGradient = instanceGradients[i];
+		for(size_t w = 0; w < instanceGradient.numberOfWeights(); ++w)
+			instanceGradient[w] = 0.0;
+		GradientAccumulatorType addGroundTruth(instanceGradient, groundTruth, GradientAccumulatorType::Add);
+		GradientAccumulatorType subtractMostViolated(instanceGradient, mostViolated_[i], GradientAccumulatorType::Subtract);
+		for(size_t f = 0; f < model.numberOfFactors(); ++f)
+		{
+			model[f].callViFunctor(addGroundTruth);
+			model[f].callViFunctor(subtractMostViolated);
+		}
+	});
+
+	for(size_t i = 0; i < numInstances; ++i)
+		dataset_.unlockModel(i);
+
+	// reduce in the order of the instances, so rounding does not depend on the scheduling
+	value = 0.0;
+	for(size_t w = 0; w < gradient.numberOfWeights(); ++w)
+		gradient[w] = 0.0;
+	for(size_t i = 0; i < numInstances; ++i)
+	{
+		value += instanceValues[i];
+		for(size_t w = 0; w < gradient.numberOfWeights(); ++w)
+			gradient[w] += instanceGradients[i][w];
+	}
+
+	telemetry_.addToCounter("learn.oracleCalls", 1);
+	telemetry_.addToCounter("solver.solves", numInstances);
+}
+
+} // end namespace mht
@@ -0,0 +1,567 @@
+#include "lpfile.h"
+#include "model.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <limits>
+#include <cmath>
+#include <cstdlib>
+#include <cctype>
+#include <unordered_map>
+#include <algorithm>
+#include <iostream>
+
+using namespace helpers;
+
+namespace mht
+{
+
+namespace
+{
+
+std::string getColumnName(const LinearProgram& program, size_t column)
+{
+	if(program.columnNames_.size() == program.numColumns())
+		return program.columnNames_[column];
+	return "x" + std::to_string(column);
+}
+
+std::string getRowName(const LinearProgram& program, size_t row)
+{
+	if(program.rowNames_.size() == program.numRows())
+		return program.rowNames_[row];
+	return "c" + std::to_string(row);
+}
+
+// append " + a name" or " - a name", starting a new line every few terms to stay below the line length limits of LP readers
+void writeTerm(std::ostream& stream, double coefficient, const std::string& name, size_t& termsInLine)
+{
+	if(termsInLine == 8)
+	{
+		stream << "\n   ";
+		termsInLine = 0;
+	}
+	stream << (coefficient < 0 ? " - " : " + ") << std::abs(coefficient) << " " << name;
+	++termsInLine;
+}
+
+void writeLpFormat(const LinearProgram& program, std::ostream& stream)
+{
+	stream << "\\ objective offset " << program.objectiveOffset_ << "\n";
+	stream << "Minimize\n obj:";
+	size_t termsInLine = 0;
+	for(size_t c = 0; c < program.numColumns(); ++c)
+	{
+		if(program.objective_[c] != 0.0)
+			writeTerm(stream, program.objective_[c], getColumnName(program, c), termsInLine);
+	}
+
+	stream << "\nSubject To\n";
+	auto writeRow = [&](size_t r, const std::string& name, const std::string& sense, double bound)
+	{
+		stream << " " << name << ":";
+		termsInLine = 0;
+		for(size_t i = program.rowOffsets_[r]; i < program.rowOffsets_[r + 1]; ++i)
+			writeTerm(stream, program.coefficients_[i], getColumnName(program, program.columns_[i]), termsInLine);
+		stream << " " << sense << " " << bound << "\n";
+	};
+	for(size_t r = 0; r < program.numRows(); ++r)
+	{
+		double lower = program.rowLower_[r];
+		double upper = program.rowUpper_[r];
+		if(program.rowOffsets_[r] == program.rowOffsets_[r + 1])
+			continue;
+
+		if(lower == upper)
+			writeRow(r, getRowName(program, r), "=", lower);
+		else if(std::isfinite(lower) && std::isfinite(upper))
+		{
+			// ranged rows become two rows
+			writeRow(r, getRowName(program, r) + "_lower", ">=", lower);
+			writeRow(r, getRowName(program, r) + "_upper", "<=", upper);
+		}
+		else if(std::isfinite(lower))
+			writeRow(r, getRowName(program, r), ">=", lower);
+		else if(std::isfinite(upper))
+			writeRow(r, getRowName(program, r), "<=", upper);
+	}
+
+	stream << "Binaries\n";
+	for(size_t c = 0; c < program.numColumns(); ++c)
+		stream << " " << getColumnName(program, c) << "\n";
+	stream << "End\n";
+}
+
+void writeMpsFormat(const LinearProgram& program, std::ostream& stream)
+{
+	// MPS lists the matrix column by column
+	std::vector< std::vector< std::pair<size_t, double> > > columnEntries(program.numColumns());
+	for(size_t r = 0; r < program.numRows(); ++r)
+		for(size_t i = program.rowOffsets_[r]; i < program.rowOffsets_[r + 1]; ++i)
+			columnEntries[program.columns_[i]].push_back(std::make_pair(r, program.coefficients_[i]));
+
+	stream << "* objective offset " << program.objectiveOffset_ << "\n";
+	stream << "NAME tracking\nROWS\n N obj\n";
+	for(size_t r = 0; r < program.numRows(); ++r)
+	{
+		double lower = program.rowLower_[r];
+		double upper = program.rowUpper_[r];
+		char type = 'N';
+		if(lower == upper)
+			type = 'E';
+		else if(std::isfinite(lower))
+			type = 'G';
+		else if(std::isfinite(upper))
+			type = 'L';
+		stream << " " << type << " " << getRowName(program, r) << "\n";
+	}
+
+	stream << "COLUMNS\n";
+	stream << " MARKER 'MARKER' 'INTORG'\n";
+	for(size_t c = 0; c < program.numColumns(); ++c)
+	{
+		std::string name = getColumnName(program, c);
+		if(program.objective_[c] != 0.0 || columnEntries[c].empty())
+			stream << " " << name << " obj " << program.objective_[c] << "\n";
+		for(const auto& entry : columnEntries[c])
+			stream << " " << name << " " << getRowName(program, entry.first) << " " << entry.second << "\n";
+	}
+	stream << " MARKER 'MARKER' 'INTEND'\n";
+
+	stream << "RHS\n";
+	for(size_t r = 0; r < program.numRows(); ++r)
+	{
+		double rhs = std::isfinite(program.rowLower_[r]) ? program.rowLower_[r] : program.rowUpper_[r];
+		if(std::isfinite(rhs) && rhs != 0.0)
+			stream << " rhs " << getRowName(program, r) << " " << rhs << "\n";
+	}
+
+	// G rows with a range R are bounded by [rhs, rhs + R]
+	bool hasRanges = false;
+	for(size_t r = 0; r < program.numRows(); ++r)
+	{
+		double lower = program.rowLower_[r];
+		double upper = program.rowUpper_[r];
+		if(lower != upper && std::isfinite(lower) && std::isfinite(upper))
+		{
+			if(!hasRanges)
+				stream << "RANGES\n";
+			hasRanges = true;
+			stream << " rng " << getRowName(program, r) << " " << upper - lower << "\n";
+		}
+	}
+
+	stream << "BOUNDS\n";
+	for(size_t c = 0; c < program.numColumns(); ++c)
+		stream << " UP bnd " << getColumnName(program, c) << " 1\n";
+	stream << "ENDATA\n";
+}
+
+bool parseNumber(const std::string& token, double& value)
+{
+	if(token.empty())
+		return false;
+	char* end = nullptr;
+	value = std::strtod(token.c_str(), &end);
+	return end == token.c_str() + token.size();
+}
+
+// ids may be strings, which are restricted to characters that all LP and MPS readers accept
+std::string toName(const IdLabelType& id)
+{
+	std::stringstream stream;
+	stream << id;
+	std::string name = stream.str();
+	for(char& c : name)
+		if(!std::isalnum((unsigned char)c) && c != '_' && c != '.')
+			c = '_';
+	return name;
+}
+
+// value of an XML attribute key="value" in the given line, empty if there is none
+std::string getAttribute(const std::string& line, const std::string& key)
+{
+	size_t begin = line.find(" " + key + "=\"");
+	if(begin == std::string::npos)
+		return std::string();
+	begin += key.size() + 3;
+	size_t end = line.find('"', begin);
+	if(end == std::string::npos)
+		return std::string();
+	return line.substr(begin, end - begin);
+}
+
+} // end anonymous namespace
+
+void writeLinearProgram(const LinearProgram& program, const std::string& filename)
+{
+	std::ofstream stream(filename.c_str());
+	if(!stream.good())
+		throw std::runtime_error("Could not open file " + filename + " for writing");
+	stream.precision(std::numeric_limits<double>::max_digits10);
+
+	bool isMps = filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".mps") == 0;
+	if(isMps)
+		writeMpsFormat(program, stream);
+	else
+		writeLpFormat(program, stream);
+
+	if(!stream.good())
+		throw std::runtime_error("Could not write linear program to " + filename);
+}
+
+std::vector<double> readLinearProgramSolution(const LinearProgram& program, const std::string& filename)
+{
+	std::ifstream stream(filename.c_str());
+	if(!stream.good())
+		throw std::runtime_error("Could not open solution file " + filename);
+
+	std::unordered_map<std::string, size_t> columnIds;
+	for(size_t c = 0; c < program.numColumns(); ++c)
+		columnIds[getColumnName(program, c)] = c;
+
+	std::vector<double> values(program.numColumns(), 0.0);
+	// only the first value of a column counts, solvers may list dual values afterwards
+	std::vector<bool> found(program.numColumns(), false);
+	size_t numFound = 0;
+	auto setValue = [&](const std::string& name, double value)
+	{
+		auto it = columnIds.find(name);
+		if(it == columnIds.end() || found[it->second])
+			return;
+		values[it->second] = value;
+		found[it->second] = true;
+		++numFound;
+	};
+
+	std::string line;
+	while(std::getline(stream, line))
+	{
+		if(line.empty() || line[0] == '#')
+			continue;
+
+		double value;
+		std::string name = getAttribute(line, "name");
+		if(!name.empty())
+		{
+			if(parseNumber(getAttribute(line, "value"), value))
+				setValue(name, value);
+			continue;
+		}
+
+		std::istringstream tokenStream(line);
+		std::vector<std::string> tokens;
+		std::string token;
+		while(tokenStream >> token)
+			tokens.push_back(token);
+		for(size_t i = 0; i + 1 < tokens.size(); ++i)
+		{
+			if(columnIds.count(tokens[i]) > 0 && parseNumber(tokens[i + 1], value))
+			{
+				setValue(tokens[i], value);
+				break;
+			}
+		}
+	}
+
+	if(numFound == 0 && program.numColumns() > 0)
+		throw std::runtime_error("Solution file " + filename + " does not contain any column of the linear program");
+	return values;
+}
+
+LinearProgram Model::buildLinearProgram(
+	const std::vector<ValueType>& weights,
+	std::vector< std::pair<size_t, LabelType> >* columnStates,
+	std::vector<int>* rowTimesteps)
+{
+	computeNumWeights();
+	double fixedEnergy = 0.0;
+	if(settings_->presolve_)
+		presolve(weights, fixedEnergy);
+
+	Telemetry::ScopedPhase phase(telemetry_, "export");
+	const size_t numVariables = assignOpenGMVariableIds();
+	const size_t npos = std::numeric_limits<size_t>::max();
+	const double infinity = std::numeric_limits<double>::infinity();
+	LinearProgram program;
+	if(columnStates != nullptr)
+		columnStates->clear();
+	if(rowTimesteps != nullptr)
+		rowTimesteps->clear();
+	// the rows added since the last call belong to the given timestep
+	auto markRows = [&](int timestep)
+	{
+		if(rowTimesteps != nullptr)
+			rowTimesteps->resize(program.numRows(), timestep);
+	};
+
+	// first column and number of states of every variable that is part of the program
+	std::vector<size_t> firstColumns(numVariables, npos);
+	std::vector<size_t> numStates(numVariables, 0);
+	auto addColumns = [&](const Variable& var, const std::vector<size_t>& weightIds, const std::string& name)
+	{
+		if(var.getOpenGMVariableId() < 0)
+			return;
+		std::vector<ValueType> energies = var.getStateEnergies(settings_->statesShareWeights_, weights, weightIds);
+		program.objectiveOffset_ += energies[0];
+		if(var.isPruned())
+			return;
+
+		size_t id = var.getOpenGMVariableId();
+		firstColumns[id] = program.numColumns();
+		numStates[id] = energies.size();
+		for(size_t state = 1; state < energies.size(); ++state)
+		{
+			program.objective_.push_back(energies[state] - energies[0]);
+			program.columnNames_.push_back(name + "_" + std::to_string(state));
+			if(columnStates != nullptr)
+				columnStates->push_back(std::make_pair(id, LabelType(state)));
+		}
+
+		// the columns are indicators of the states, of which at most one can be taken
+		if(energies.size() > 2)
+		{
+			for(size_t state = 1; state < energies.size(); ++state)
+			{
+				program.columns_.push_back(firstColumns[id] + state - 1);
+				program.coefficients_.push_back(1.0);
+			}
+			program.closeRow(-infinity, 1.0, "states_" + name);
+		}
+
+		// a variable fixed to state 0 takes none of its columns, otherwise the column of its state
+		if(var.getFixedState() == 0)
+		{
+			for(size_t state = 1; state < energies.size(); ++state)
+			{
+				program.columns_.push_back(firstColumns[id] + state - 1);
+				program.coefficients_.push_back(1.0);
+			}
+			program.closeRow(0.0, 0.0, "fixed_" + name);
+		}
+		else if(var.getFixedState() > 0)
+		{
+			program.columns_.push_back(firstColumns[id] + var.getFixedState() - 1);
+			program.coefficients_.push_back(1.0);
+			program.closeRow(1.0, 1.0, "fixed_" + name);
+		}
+	};
+	auto isInProgram = [&](const Variable& var)
+	{
+		return var.getOpenGMVariableId() >= 0 && firstColumns[var.getOpenGMVariableId()] != npos;
+	};
+	// the number of objects in the variable, which is the state
+	auto addValue = [&](const Variable& var, double coefficient)
+	{
+		if(!isInProgram(var))
+			return;
+		size_t id = var.getOpenGMVariableId();
+		for(size_t state = 1; state < numStates[id]; ++state)
+		{
+			program.columns_.push_back(firstColumns[id] + state - 1);
+			program.coefficients_.push_back(coefficient * state);
+		}
+	};
+	// one if the variable is in any state > 0
+	auto addActive = [&](const Variable& var, double coefficient)
+	{
+		if(!isInProgram(var))
+			return;
+		size_t id = var.getOpenGMVariableId();
+		for(size_t state = 1; state < numStates[id]; ++state)
+		{
+			program.columns_.push_back(firstColumns[id] + state - 1);
+			program.coefficients_.push_back(coefficient);
+		}
+	};
+	auto addFirstState = [&](const Variable& var, double coefficient)
+	{
+		if(!isInProgram(var))
+			return;
+		program.columns_.push_back(firstColumns[var.getOpenGMVariableId()]);
+		program.coefficients_.push_back(coefficient);
+	};
+	auto getDivisionName = [&](const DivisionHypothesis& division)
+	{
+		std::string name = "extdiv_" + toName(division.getParentId());
+		for(auto& childId : division.getChildrenIds())
+			name += "_" + toName(childId);
+		return name;
+	};
+
+	// same order as assignOpenGMVariableIds(), so columns are sorted by OpenGM variable id
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+		addColumns(iter->second.getVariable(), linkWeightIds_, 
+			"link_" + toName(iter->second.getSrcId()) + "_" + toName(iter->second.getDestId()));
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+		addColumns(iter->second.getVariable(), externalDivWeightIds_, getDivisionName(iter->second));
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		const SegmentationHypothesis& seg = iter->second;
+		std::string id = toName(seg.getId());
+		if(seg.getDetectionVariable().getOpenGMVariableId() < 0)
+			throw std::runtime_error("Detection variable must have some features!");
+		addColumns(seg.getDetectionVariable(), detWeightIds_, "det_" + id);
+		addColumns(seg.getDivisionVariable(), divWeightIds_, "div_" + id);
+		addColumns(seg.getAppearanceVariable(), appWeightIds_, "app_" + id);
+		addColumns(seg.getDisappearanceVariable(), disWeightIds_, "dis_" + id);
+	}
+	markRows(-1);
+
+	// the constraints of SegmentationHypothesis::addFactorsToOpenGMModel()
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		const SegmentationHypothesis& seg = iter->second;
+		const Variable& detection = seg.getDetectionVariable();
+		const Variable& division = seg.getDivisionVariable();
+		const Variable& appearance = seg.getAppearanceVariable();
+		const Variable& disappearance = seg.getDisappearanceVariable();
+		if(!isInProgram(detection))
+			continue;
+		std::string id = toName(seg.getId());
+
+		// flow conservation: sum of incoming = detection = sum of outgoing - division
+		for(auto link : seg.getIncomingLinks())
+			addValue(link->getVariable(), 1.0);
+		for(auto externalDivision : seg.getIncomingDivisions())
+			addValue(externalDivision->getVariable(), 1.0);
+		addValue(detection, -1.0);
+		addValue(appearance, 1.0);
+		program.closeRow(0.0, 0.0, "in_" + id);
+
+		for(auto link : seg.getOutgoingLinks())
+			addValue(link->getVariable(), 1.0);
+		for(auto externalDivision : seg.getOutgoingDivisions())
+			addValue(externalDivision->getVariable(), 1.0);
+		addValue(detection, -1.0);
+		addValue(division, -1.0);
+		addValue(disappearance, 1.0);
+		program.closeRow(0.0, 0.0, "out_" + id);
+
+		if(isInProgram(division))
+		{
+			addFirstState(division, 1.0);
+			addFirstState(detection, -1.0);
+			program.closeRow(-infinity, 0.0, "division_" + id);
+
+			if(settings_->requireSeparateChildrenOfDivision_)
+			{
+				for(auto link : seg.getOutgoingLinks())
+					addFirstState(link->getVariable(), -1.0);
+				addFirstState(division, 2.0);
+				program.closeRow(-infinity, 0.0, "children_" + id);
+			}
+		}
+
+		size_t numExternalDivisions = 0;
+		for(auto externalDivision : seg.getOutgoingDivisions())
+		{
+			if(!isInProgram(externalDivision->getVariable()))
+				continue;
+			addFirstState(externalDivision->getVariable(), 1.0);
+			addFirstState(detection, -1.0);
+			program.closeRow(-infinity, 0.0, "extdivision_" + id + "_" + std::to_string(numExternalDivisions++));
+		}
+		if(numExternalDivisions > 0)
+		{
+			for(auto externalDivision : seg.getOutgoingDivisions())
+				addFirstState(externalDivision->getVariable(), 1.0);
+			program.closeRow(-infinity, 1.0, "onedivision_" + id);
+		}
+
+		// at least one of two variables must take state 0
+		auto addExclusion = [&](const Variable& a, const Variable& b, const std::string& name)
+		{
+			if(!isInProgram(a) || !isInProgram(b))
+				return;
+			addActive(a, 1.0);
+			addActive(b, 1.0);
+			program.closeRow(-infinity, 1.0, name);
+		};
+
+		if(!settings_->allowLengthOneTracks_)
+			addExclusion(appearance, disappearance, "lengthone_" + id);
+
+		// see SegmentationHypothesis::addTransitionExclusionConstraintToOpenGM()
+		auto addTransitionExclusion = [&](const Variable& var, const PointerRange<LinkingHypothesis>& links, double maxObjects, const std::string& name)
+		{
+			if(!isInProgram(var))
+				return;
+			size_t begin = program.columns_.size();
+			for(auto link : links)
+				addValue(link->getVariable(), 1.0);
+			if(program.columns_.size() == begin)
+				return;
+			addActive(var, maxObjects);
+			program.closeRow(-infinity, maxObjects, name);
+		};
+
+		if(detection.getNumStates() > 1)
+		{
+			size_t maxObjects = detection.getNumStates() - 1;
+			if(!settings_->allowPartialMergerAppearance_)
+			{
+				addTransitionExclusion(appearance, seg.getIncomingLinks(), maxObjects, "appearance_" + id);
+				addTransitionExclusion(disappearance, seg.getOutgoingLinks(), 
+					isInProgram(division) ? std::max(maxObjects, size_t(2)) : maxObjects, "disappearance_" + id);
+			}
+			addExclusion(disappearance, division, "disdivision_" + id);
+		}
+		markRows(seg.getTimestep());
+	}
+
+	size_t numExclusions = 0;
+	std::vector<ExclusionConstraint>& exclusions = getMergedExclusionConstraints();
+	for(auto iter = exclusions.begin(); iter != exclusions.end() ; ++iter)
+	{
+		size_t begin = program.columns_.size();
+		for(auto& segId : iter->getIds())
+			addActive(segmentationHypotheses_.at(segId).getDetectionVariable(), 1.0);
+
+		// see ExclusionConstraint::addToOpenGMModel()
+		if(program.columns_.size() - begin < 2)
+		{
+			program.columns_.resize(begin);
+			program.coefficients_.resize(begin);
+			continue;
+		}
+		program.closeRow(-infinity, 1.0, "exclusion_" + std::to_string(numExclusions++));
+		markRows(segmentationHypotheses_.at(iter->getIds().at(0)).getTimestep());
+	}
+
+	if(settings_->presolve_)
+		clearPresolve();
+	return program;
+}
+
+void Model::exportLinearProgram(const std::vector<ValueType>& weights, const std::string& filename)
+{
+	LinearProgram program = buildLinearProgram(weights);
+	std::cout << "Writing ILP with " << program.numColumns() << " columns and " << program.numRows() << " rows to " << filename << std::endl;
+	Telemetry::ScopedPhase phase(telemetry_, "export");
+	writeLinearProgram(program, filename);
+}
+
+Solution Model::readLinearProgramSolution(const std::vector<ValueType>& weights, const std::string& filename)
+{
+	std::vector< std::pair<size_t, LabelType> > columnStates;
+	LinearProgram program = buildLinearProgram(weights, &columnStates);
+	std::vector<double> values = mht::readLinearProgramSolution(program, filename);
+
+	Solution solution(assignOpenGMVariableIds(), 0);
+	foundSolutionValue_ = program.objectiveOffset_;
+	for(size_t c = 0; c < program.numColumns(); ++c)
+	{
+		if(values[c] > 0.5)
+		{
+			solution[columnStates[c].first] = columnStates[c].second;
+			foundSolutionValue_ += program.objective_[c];
+		}
+	}
+	lastSolution_ = solution;
+	std::cout << "solution read from " << filename << " has energy: " << foundSolutionValue_ << std::endl;
+	return solution;
+}
+
+} // end namespace mht
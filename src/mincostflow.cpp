@@ -0,0 +1,171 @@
+#include "mincostflow.h"
+
+#include <limits>
+#include <queue>
+#include <functional>
+#include <algorithm>
+#include <stdexcept>
+
+namespace mht
+{
+
+namespace
+{
+	const double INF = std::numeric_limits<double>::infinity();
+}
+
+MinCostFlow::MinCostFlow(size_t numNodes):
+	numNodes_(numNodes),
+	outgoingResidualArcs_(numNodes),
+	cost_(0.0),
+	numPaths_(0)
+{}
+
+size_t MinCostFlow::addArc(size_t from, size_t to, double cost)
+{
+	if(from >= numNodes_ || to >= numNodes_)
+		throw std::runtime_error("Cannot add arc between nodes that are not part of the flow graph");
+
+	size_t arc = arcSources_.size();
+	arcSources_.push_back(from);
+	arcTargets_.push_back(to);
+	arcCosts_.push_back(cost);
+	flow_.push_back(false);
+
+	outgoingResidualArcs_[from].push_back(2 * arc);
+	outgoingResidualArcs_[to].push_back(2 * arc + 1);
+	return arc;
+}
+
+double MinCostFlow::getResidualCost(size_t residualArc) const
+{
+	if(residualArc % 2 == 0)
+		return arcCosts_[residualArc / 2];
+	else
+		return -arcCosts_[residualArc / 2];
+}
+
+bool MinCostFlow::hasResidualCapacity(size_t residualArc) const
+{
+	// forward arcs can take flow if they are empty, reverse arcs if the forward arc is used
+	return flow_[residualArc / 2] == (residualArc % 2 == 1);
+}
+
+bool MinCostFlow::initializePotentials(size_t source)
+{
+	// no flow yet, so only forward arcs are part of the residual graph
+	potentials_.assign(numNodes_, INF);
+	potentials_[source] = 0.0;
+
+	for(size_t pass = 0; pass < numNodes_; ++pass)
+	{
+		bool changed = false;
+		for(size_t arc = 0; arc < arcSources_.size(); ++arc)
+		{
+			double distance = potentials_[arcSources_[arc]] + arcCosts_[arc];
+			if(distance < potentials_[arcTargets_[arc]])
+			{
+				potentials_[arcTargets_[arc]] = distance;
+				changed = true;
+			}
+		}
+
+		if(!changed)
+			return true;
+	}
+
+	// still relaxing after numNodes passes
+	return false;
+}
+
+bool MinCostFlow::findShortestPath(size_t source, size_t target)
+{
+	typedef std::pair<double, size_t> QueueEntry;
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > queue;
+
+	distances_.assign(numNodes_, INF);
+	predecessorArcs_.assign(numNodes_, std::numeric_limits<size_t>::max());
+	std::vector<bool> settled(numNodes_, false);
+
+	distances_[source] = 0.0;
+	queue.push(std::make_pair(0.0, source));
+
+	while(!queue.empty())
+	{
+		size_t node = queue.top().second;
+		queue.pop();
+		if(settled[node])
+			continue;
+		settled[node] = true;
+
+		// only need the distances up to the target, see potential update in solve()
+		if(node == target)
+			break;
+
+		for(size_t residualArc : outgoingResidualArcs_[node])
+		{
+			if(!hasResidualCapacity(residualArc))
+				continue;
+
+			size_t next = (residualArc % 2 == 0) ? arcTargets_[residualArc / 2] : arcSources_[residualArc / 2];
+			if(settled[next] || potentials_[next] == INF)
+				continue;
+
+			// reduced costs are non-negative, up to rounding errors
+			double reducedCost = std::max(0.0, getResidualCost(residualArc) + potentials_[node] - potentials_[next]);
+			double distance = distances_[node] + reducedCost;
+			if(distance < distances_[next])
+			{
+				distances_[next] = distance;
+				predecessorArcs_[next] = residualArc;
+				queue.push(std::make_pair(distance, next));
+			}
+		}
+	}
+
+	return settled[target];
+}
+
+bool MinCostFlow::solve(size_t source, size_t target)
+{
+	std::fill(flow_.begin(), flow_.end(), false);
+	cost_ = 0.0;
+	numPaths_ = 0;
+
+	if(!initializePotentials(source))
+		return false;
+
+	if(potentials_[target] == INF)
+		return true;
+
+	while(findShortestPath(source, target))
+	{
+		// nodes that were not settled before reaching the target get the target's distance,
+		// which keeps all reduced costs non-negative
+		double targetDistance = distances_[target];
+		for(size_t node = 0; node < numNodes_; ++node)
+		{
+			if(potentials_[node] != INF)
+				potentials_[node] += std::min(distances_[node], targetDistance);
+		}
+
+		// the cost of a path only increases with every augmentation, so we can stop at the first one that does not pay off
+		double pathCost = potentials_[target] - potentials_[source];
+		if(pathCost >= 0.0)
+			break;
+
+		for(size_t node = target; node != source; )
+		{
+			size_t residualArc = predecessorArcs_[node];
+			flow_[residualArc / 2] = (residualArc % 2 == 0);
+			node = (residualArc % 2 == 0) ? arcSources_[residualArc / 2] : arcTargets_[residualArc / 2];
+		}
+
+		cost_ += pathCost;
+		numPaths_++;
+	}
+
+	return true;
+}
+
+} // end namespace mht
@@ -0,0 +1,188 @@
+#include "mipinference.h"
+
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+
+using namespace helpers;
+
+namespace mht
+{
+
+MipInference::MipInference(const GraphicalModelType& model, const Parameter& parameter):
+	model_(model),
+	parameter_(parameter),
+	ownedBackend_(SolverBackend::create(parameter.backend_)),
+	backend_(*ownedBackend_),
+	solved_(false)
+{
+	buildLinearProgram();
+}
+
+MipInference::MipInference(const GraphicalModelType& model, const Parameter& parameter, SolverBackend& backend):
+	model_(model),
+	parameter_(parameter),
+	backend_(backend),
+	solved_(false)
+{
+	buildLinearProgram();
+}
+
+void MipInference::buildLinearProgram()
+{
+	typedef LinearConstraintFunctionType::LinearConstraintType LinearConstraintType;
+	const size_t constraintFunctionType = opengm::meta::GetIndexInTypeList<FunctionTypeList, LinearConstraintFunctionType>::value;
+	const double infinity = std::numeric_limits<double>::infinity();
+
+	// one indicator column per label of every variable
+	variableOffsets_.reserve(model_.numberOfVariables() + 1);
+	size_t numColumns = 0;
+	for(size_t i = 0; i < model_.numberOfVariables(); i++)
+	{
+		variableOffsets_.push_back(numColumns);
+		numColumns += model_.numberOfLabels(i);
+	}
+	variableOffsets_.push_back(numColumns);
+	program_.objective_.assign(numColumns, 0.0);
+
+	// every variable takes exactly one label
+	for(size_t i = 0; i < model_.numberOfVariables(); i++)
+	{
+		for(size_t column = variableOffsets_[i]; column < variableOffsets_[i + 1]; column++)
+		{
+			program_.columns_.push_back(column);
+			program_.coefficients_.push_back(1.0);
+		}
+		program_.closeRow(1.0, 1.0);
+	}
+
+	for(size_t f = 0; f < model_.numberOfFactors(); f++)
+	{
+		const GraphicalModelType::FactorType& factor = model_[f];
+		if(factor.functionType() == constraintFunctionType)
+		{
+			const LinearConstraintFunctionType& function = model_.getFunction<LinearConstraintFunctionType>(
+				GraphicalModelType::FunctionIdentifier(factor.functionIndex(), factor.functionType()));
+
+			for(auto constraint = function.linearConstraintsBegin(); constraint != function.linearConstraintsEnd(); ++constraint)
+			{
+				auto coefficient = constraint->coefficientsBegin();
+				for(auto indicator = constraint->indicatorVariablesBegin(); indicator != constraint->indicatorVariablesEnd(); ++indicator, ++coefficient)
+				{
+					// the tracking constraints only use indicators of a single variable state, see helpers::addOpenGMVariableToConstraint()
+					if(indicator->end() - indicator->begin() != 1 || indicator->getLogicalOperatorType() == IndicatorVariableType::Not)
+						throw std::runtime_error("MipInference only supports indicator variables of a single variable state");
+
+					size_t variable = factor.variableIndex(indicator->begin()->first);
+					program_.columns_.push_back(variableOffsets_[variable] + indicator->begin()->second);
+					program_.coefficients_.push_back(*coefficient);
+				}
+
+				double bound = constraint->getBound();
+				switch(constraint->getConstraintOperator())
+				{
+					case LinearConstraintType::LinearConstraintOperatorType::LessEqual:
+						program_.closeRow(-infinity, bound);
+						break;
+					case LinearConstraintType::LinearConstraintOperatorType::Equal:
+						program_.closeRow(bound, bound);
+						break;
+					case LinearConstraintType::LinearConstraintOperatorType::GreaterEqual:
+						program_.closeRow(bound, infinity);
+						break;
+				}
+			}
+		}
+		else if(factor.numberOfVariables() == 1)
+		{
+			size_t variable = factor.variableIndex(0);
+			for(LabelType label = 0; label < model_.numberOfLabels(variable); label++)
+				program_.objective_[variableOffsets_[variable] + label] += factor(&label);
+		}
+		else
+		{
+			throw std::runtime_error("MipInference only supports unary factors and linear constraints");
+		}
+	}
+}
+
+std::string MipInference::name() const
+{
+	return "MipInference(" + backend_.name() + ")";
+}
+
+const MipInference::GraphicalModelType& MipInference::graphicalModel() const
+{
+	return model_;
+}
+
+opengm::InferenceTermination MipInference::infer()
+{
+	SolverParameters parameters;
+	parameters.epGap = parameter_.epGap_;
+	parameters.numThreads = parameter_.numberOfThreads_;
+	parameters.verbose = parameter_.verbose_;
+	parameters.integer = parameter_.integerConstraints_;
+
+	result_ = backend_.solve(program_, parameters, start_);
+	solved_ = true;
+	return opengm::NORMAL;
+}
+
+opengm::InferenceTermination MipInference::arg(std::vector<LabelType>& labeling, const size_t n) const
+{
+	if(n != 1)
+		return opengm::UNKNOWN;
+
+	labeling.resize(model_.numberOfVariables());
+	if(!solved_)
+	{
+		std::fill(labeling.begin(), labeling.end(), 0);
+		return opengm::UNKNOWN;
+	}
+
+	// the label with the largest indicator value, which is the only nonzero one if the program was solved with integer constraints
+	for(size_t i = 0; i < model_.numberOfVariables(); i++)
+	{
+		auto begin = result_.columnValues.begin() + variableOffsets_[i];
+		auto end = result_.columnValues.begin() + variableOffsets_[i + 1];
+		labeling[i] = std::max_element(begin, end) - begin;
+	}
+	return opengm::NORMAL;
+}
+
+MipInference::ValueType MipInference::value() const
+{
+	if(!solved_)
+		return std::numeric_limits<ValueType>::infinity();
+
+	if(!parameter_.integerConstraints_)
+		return result_.value;
+
+	// evaluate the labeling instead of using the objective, so numerical noise of the solver does not show up in the energy
+	std::vector<LabelType> labeling;
+	arg(labeling);
+	return model_.evaluate(labeling.begin());
+}
+
+MipInference::ValueType MipInference::bound() const
+{
+	return solved_ ? result_.bound : -std::numeric_limits<ValueType>::infinity();
+}
+
+void MipInference::setStartingPoint(std::vector<LabelType>::const_iterator begin)
+{
+	start_.assign(program_.numColumns(), 0.0);
+	for(size_t i = 0; i < model_.numberOfVariables(); i++, ++begin)
+		start_[variableOffsets_[i] + *begin] = 1.0;
+}
+
+std::vector<double> MipInference::getIndicatorValues(size_t variable) const
+{
+	if(!solved_)
+		return std::vector<double>(variableOffsets_[variable + 1] - variableOffsets_[variable], 0.0);
+	return std::vector<double>(result_.columnValues.begin() + variableOffsets_[variable],
+							   result_.columnValues.begin() + variableOffsets_[variable + 1]);
+}
+
+} // end namespace mht
@@ -3,15 +3,22 @@
 #include <stdexcept>
 #include <numeric>
 #include <sstream>
+#include <set>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "parallel.h"
+#include "mincostflow.h"
+#include "solutioncache.h"
+#include "lossaugmentedoracle.h"
+#include "dualdecomposition.h"
 
 // include the LPDef symbols only once!
 #undef OPENGM_LPDEF_NO_SYMBOLS
 #include <opengm/inference/auxiliary/lpdef.hxx>
 
-#include <opengm/inference/lpgurobi2.hxx>
-#include <opengm/inference/lpgurobi.hxx>
-
-#include <opengm/learning/struct-max-margin.hxx>
+#include <opengm/learning/bundle-optimizer.hxx>
 
 using namespace helpers;
 
@@ -50,15 +57,15 @@ size_t Model::computeNumWeights()
 
 		for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
 		{
-			checkNumWeights(iter->second->getVariable(), numExternalDivWeights, "External Divisions");
+			checkNumWeights(iter->second.getVariable(), numExternalDivWeights, "External Divisions");
 		}
 
 		for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
 		{
 			if(numLinkWeights < 0)
-				numLinkWeights = iter->second->getVariable().getNumWeights(settings_->statesShareWeights_);
+				numLinkWeights = iter->second.getVariable().getNumWeights(settings_->statesShareWeights_);
 			else
-				if(iter->second->getVariable().getNumWeights(settings_->statesShareWeights_) != numLinkWeights)
+				if(iter->second.getVariable().getNumWeights(settings_->statesShareWeights_) != numLinkWeights)
 					throw std::runtime_error("Links do not have the same number of features!");
 		}
 
@@ -78,6 +85,20 @@ size_t Model::computeNumWeights()
 		// std::cout << "need " << numAppWeights_ << " appearance weights" << std::endl;
 		// std::cout << "need " << numDisWeights_ << " disappearance weights" << std::endl;
 		// std::cout << "need " << numLinkWeights_ << " link weights" << std::endl;
+
+		// the weight vector is ordered as link, det, div, app, dis, external div weights
+		auto fillWeightIds = [](std::vector<size_t>& weightIds, size_t numWeights, size_t offset)
+		{
+			weightIds.resize(numWeights);
+			std::iota(weightIds.begin(), weightIds.end(), offset); // fill with increasing values starting at offset
+		};
+		fillWeightIds(linkWeightIds_, numLinkWeights_, 0);
+		fillWeightIds(detWeightIds_, numDetWeights_, numLinkWeights_);
+		fillWeightIds(divWeightIds_, numDivWeights_, numLinkWeights_ + numDetWeights_);
+		fillWeightIds(appWeightIds_, numAppWeights_, numLinkWeights_ + numDetWeights_ + numDivWeights_);
+		fillWeightIds(disWeightIds_, numDisWeights_, numLinkWeights_ + numDetWeights_ + numDivWeights_ + numAppWeights_);
+		fillWeightIds(externalDivWeightIds_, numExternalDivWeights_, 
+			numLinkWeights_ + numDetWeights_ + numDivWeights_ + numAppWeights_ + numDisWeights_);
 	}
 
 	return numDetWeights_ + numDivWeights_ + numAppWeights_ + numDisWeights_ + numExternalDivWeights_ + numLinkWeights_;
@@ -89,245 +110,2631 @@ void Model::initializeOpenGMModel(WeightsType& weights)
 	computeNumWeights();
 
 	std::cout << "Initializing opengm model..." << std::endl;
-	// we need two sets of weights for all features to represent state "on" and "off"!
-	std::vector<size_t> linkWeightIds(numLinkWeights_);
-	std::iota(linkWeightIds.begin(), linkWeightIds.end(), 0); // fill with increasing values starting at 0
+	model_ = GraphicalModelType();
+	Subgraph fullGraph = getFullGraph();
+	addSubgraphToOpenGMModel(model_, weights, fullGraph, settings_->buildNumThreads_);
+	openGMModelWeights_ = &weights;
+	evaluationWeights_ = &weights;
+	lastSolution_.clear();
+
+	recordModelStatistics({&model_});
+	std::cout << "Model has " << telemetry_.getCounter("opengm.indicatorVariables") << " indicator variables" << std::endl;
+}
 
-	// first add all link variables, because segmentations will use them when defining constraints
+Subgraph Model::getFullGraph()
+{
+	Subgraph fullGraph;
 	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+		fullGraph.links_.push_back(&iter->second);
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+		fullGraph.divisions_.push_back(&iter->second);
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+		fullGraph.segmentations_.push_back(&iter->second);
+	std::vector<ExclusionConstraint>& exclusions = getMergedExclusionConstraints();
+	for(auto iter = exclusions.begin(); iter != exclusions.end() ; ++iter)
+		fullGraph.exclusions_.push_back(&(*iter));
+	return fullGraph;
+}
+
+void Model::recordModelStatistics(const std::vector<const GraphicalModelType*>& models)
+{
+	size_t numVariables = 0;
+	size_t numIndicatorVariables = 0;
+	size_t numUnaries = 0;
+	size_t numConstraints = 0;
+	const size_t constraintFunctionType = opengm::meta::GetIndexInTypeList<FunctionTypeList, LinearConstraintFunctionType>::value;
+	for(auto model : models)
 	{
-		iter->second->addToOpenGMModel(model_, weights, settings_->statesShareWeights_, linkWeightIds);
+		numVariables += model->numberOfVariables();
+		for(size_t i = 0; i < model->numberOfVariables(); i++)
+			numIndicatorVariables += model->numberOfLabels(i);
+		for(size_t f = 0; f < model->numberOfFactors(); f++)
+		{
+			if((*model)[f].functionType() == constraintFunctionType)
+				numConstraints++;
+			else
+				numUnaries++;
+		}
 	}
 
-	std::vector<size_t> detWeightIds(numDetWeights_);
-	std::iota(detWeightIds.begin(), detWeightIds.end(), numLinkWeights_); // fill with increasing values starting at the next valid index
-
-	std::vector<size_t> divWeightIds(numDivWeights_);
-	std::iota(divWeightIds.begin(), divWeightIds.end(), numLinkWeights_ + numDetWeights_);
+	telemetry_.setCounter("opengm.models", models.size());
+	telemetry_.setCounter("opengm.variables", numVariables);
+	telemetry_.setCounter("opengm.indicatorVariables", numIndicatorVariables);
+	telemetry_.setCounter("opengm.unaries", numUnaries);
+	telemetry_.setCounter("opengm.constraints", numConstraints);
 
-	std::vector<size_t> appWeightIds(numAppWeights_);
-	std::iota(appWeightIds.begin(), appWeightIds.end(), numLinkWeights_ + numDetWeights_ + numDivWeights_);
-
-	std::vector<size_t> disWeightIds(numDisWeights_);
-	std::iota(disWeightIds.begin(), disWeightIds.end(), numLinkWeights_ + numDetWeights_ + numDivWeights_ + numAppWeights_);
+	// same rules as in addSubgraphToOpenGMModel(): variables without features are not added
+	size_t numDetections = 0, numDivisions = 0, numAppearances = 0, numDisappearances = 0;
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		const SegmentationHypothesis& seg = iter->second;
+		numDetections += seg.getDetectionVariable().hasFeatures();
+		numDivisions += seg.getDivisionVariable().hasFeatures() && seg.getOutgoingLinks().size() > 1;
+		numAppearances += seg.getAppearanceVariable().hasFeatures();
+		numDisappearances += seg.getDisappearanceVariable().hasFeatures();
+	}
+	size_t numLinks = 0, numExternalDivisions = 0;
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+		numLinks += iter->second.getVariable().hasFeatures();
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+		numExternalDivisions += iter->second.getVariable().hasFeatures();
+
+	telemetry_.setCounter("variables.detections", numDetections);
+	telemetry_.setCounter("variables.divisions", numDivisions);
+	telemetry_.setCounter("variables.appearances", numAppearances);
+	telemetry_.setCounter("variables.disappearances", numDisappearances);
+	telemetry_.setCounter("variables.links", numLinks);
+	telemetry_.setCounter("variables.externalDivisions", numExternalDivisions);
+	telemetry_.setCounter("constraints.exclusions", exclusionConstraints_.size());
+}
 
-	std::vector<size_t> externalDivWeightIds(numExternalDivWeights_);
-	std::iota(externalDivWeightIds.begin(), externalDivWeightIds.end(), numLinkWeights_ + numDetWeights_ + numDivWeights_ + numAppWeights_ + numDisWeights_);
+void Model::addSubgraphToOpenGMModel(GraphicalModelType& model, WeightsType& weights, Subgraph& subgraph, size_t numThreads)
+{
+	// make sure the weight ids are initialized
+	computeNumWeights();
+	Telemetry::ScopedPhase phase(telemetry_, "initializeOpenGMModel");
+
+	// first add all variables, in the order in which assignOpenGMVariableIds() numbers them,
+	// because the constraints of segmentations and exclusions refer to them
+	for(auto link : subgraph.links_)
+		link->addToOpenGMModel(model);
+	for(auto division : subgraph.divisions_)
+		division->addToOpenGMModel(model);
+	for(auto segmentation : subgraph.segmentations_)
+		segmentation->addToOpenGMModel(model);
+
+	// the factors of every hypothesis only depend on the hypothesis itself
+	const size_t numLinks = subgraph.links_.size();
+	const size_t numDivisions = subgraph.divisions_.size();
+	const size_t numSegmentations = subgraph.segmentations_.size();
+	const size_t numItems = numLinks + numDivisions + numSegmentations + subgraph.exclusions_.size();
+	auto addFactors = [&](size_t item, FactorBuffer& buffer)
+	{
+		if(item < numLinks)
+			subgraph.links_[item]->addFactorsToOpenGMModel(buffer, weights, settings_->statesShareWeights_, linkWeightIds_);
+		else if((item -= numLinks) < numDivisions)
+			subgraph.divisions_[item]->addFactorsToOpenGMModel(buffer, weights, settings_->statesShareWeights_, externalDivWeightIds_);
+		else if((item -= numDivisions) < numSegmentations)
+			subgraph.segmentations_[item]->addFactorsToOpenGMModel(buffer, weights, settings_, detWeightIds_, divWeightIds_, appWeightIds_, disWeightIds_);
+		else
+			subgraph.exclusions_[item - numSegmentations]->addToOpenGMModel(buffer, segmentationHypotheses_);
+	};
 
-	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+	// Chunks of hypotheses build their factors concurrently, each into its own buffer. The buffers are added 
+	// to the model in the order of the chunks, so the model is the same for any number of threads.
+	// Only a few chunks per thread are buffered at once, which bounds the extra memory.
+	const size_t chunkSize = 1024;
+	const size_t numChunks = (numItems + chunkSize - 1) / chunkSize;
+	const size_t chunksPerRound = 4 * getNumWorkerThreads(numThreads, numChunks);
+	std::vector<FactorBuffer> buffers(std::min(chunksPerRound, numChunks), FactorBuffer(model));
+	for(size_t firstChunk = 0; firstChunk < numChunks; firstChunk += chunksPerRound)
 	{
-		iter->second->addToOpenGMModel(model_, weights, settings_->statesShareWeights_, externalDivWeightIds);
+		const size_t numRoundChunks = std::min(chunksPerRound, numChunks - firstChunk);
+		parallelFor(numRoundChunks, numThreads, [&](size_t c)
+		{
+			size_t end = std::min(numItems, (firstChunk + c + 1) * chunkSize);
+			for(size_t item = (firstChunk + c) * chunkSize; item < end; ++item)
+				addFactors(item, buffers[c]);
+		});
+
+		for(size_t c = 0; c < numRoundChunks; ++c)
+			buffers[c].addToModel(model);
 	}
+}
 
-	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+void Model::buildComponentInstances(WeightsType& weights, const Solution& solution, std::vector<GraphicalModelType>& models, std::vector<Solution>& solutions)
+{
+	std::vector<Subgraph> components = findConnectedComponents();
+	models.assign(components.size(), GraphicalModelType());
+	std::vector< std::vector<const Variable*> > variables(components.size());
+	parallelFor(components.size(), settings_->componentNumThreads_, [&](size_t c)
+	{
+		addSubgraphToOpenGMModel(models[c], weights, components[c], 1);
+		variables[c] = getSubgraphVariables(components[c], models[c].numberOfVariables());
+	});
+
+	// the component models numbered their variables independently, give them their ids in the full model back
+	assignOpenGMVariableIds();
+	solutions.assign(components.size(), Solution());
+	for(size_t c = 0; c < components.size(); ++c)
 	{
-		iter->second.addToOpenGMModel(model_, weights, settings_, detWeightIds, divWeightIds, appWeightIds, disWeightIds);
+		solutions[c].resize(models[c].numberOfVariables(), 0);
+		for(size_t i = 0; i < variables[c].size(); ++i)
+		{
+			if(variables[c][i] != nullptr)
+				solutions[c][i] = solution[variables[c][i]->getOpenGMVariableId()];
+		}
 	}
+}
 
-	for(auto iter = exclusionConstraints_.begin(); iter != exclusionConstraints_.end() ; ++iter)
+std::vector<const Variable*> Model::getSubgraphVariables(const Subgraph& subgraph, size_t numVariables) const
+{
+	std::vector<const Variable*> variables(numVariables, nullptr);
+	auto addVariable = [&](const Variable& var)
 	{
-		iter->addToOpenGMModel(model_, segmentationHypotheses_);
-	}
+		if(var.getOpenGMVariableId() >= 0)
+			variables[var.getOpenGMVariableId()] = &var;
+	};
 
-	size_t numIndicatorVars = 0;
-	for(size_t i = 0; i < model_.numberOfVariables(); i++)
+	for(auto link : subgraph.links_)
+		addVariable(link->getVariable());
+	for(auto division : subgraph.divisions_)
+		addVariable(division->getVariable());
+	for(auto segmentation : subgraph.segmentations_)
 	{
-		numIndicatorVars += model_.numberOfLabels(i);
+		addVariable(segmentation->getDetectionVariable());
+		addVariable(segmentation->getDivisionVariable());
+		addVariable(segmentation->getAppearanceVariable());
+		addVariable(segmentation->getDisappearanceVariable());
 	}
-	std::cout << "Model has " << numIndicatorVars << " indicator variables" << std::endl;
+
+	return variables;
 }
 
-Solution Model::infer(const std::vector<ValueType>& weights, bool withIntegerConstraints)
+void Model::buildAdjacency()
 {
-	// use weights that were given
-	WeightsType weightObject(computeNumWeights());
-	assert(weights.size() == weightObject.numberOfWeights());
-	if(weights.size() != weightObject.numberOfWeights())
+	Telemetry::ScopedPhase phase(telemetry_, "buildAdjacency");
+	auto getIndex = [&](const IdLabelType& id)
 	{
-		std::cout << "Provided length of vector with initial weights has wrong length!" << std::endl;
-		throw std::runtime_error("Provided length of vector with initial weights has wrong length!");
+		size_t index = segmentationHypotheses_.indexOf(id);
+		if(index == SegmentationHypothesisMap::npos)
+		{
+			std::stringstream s;
+			s << "Cannot find segmentation hypothesis " << id << " referenced in the model";
+			throw std::runtime_error(s.str());
+		}
+		return index;
+	};
+
+	std::vector< std::pair<size_t, LinkingHypothesis*> > incomingLinks, outgoingLinks;
+	incomingLinks.reserve(linkingHypotheses_.size());
+	outgoingLinks.reserve(linkingHypotheses_.size());
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+	{
+		outgoingLinks.push_back(std::make_pair(getIndex(iter->second.getSrcId()), &iter->second));
+		incomingLinks.push_back(std::make_pair(getIndex(iter->second.getDestId()), &iter->second));
 	}
-	for(size_t i = 0; i < weights.size(); i++)
-		weightObject.setWeight(i, weights[i]);
-	initializeOpenGMModel(weightObject);
 
-	if(withIntegerConstraints)
+	std::vector< std::pair<size_t, DivisionHypothesis*> > incomingDivisions, outgoingDivisions;
+	outgoingDivisions.reserve(divisionHypotheses_.size());
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
 	{
+		outgoingDivisions.push_back(std::make_pair(getIndex(iter->second.getParentId()), &iter->second));
+		for(auto& childId : iter->second.getChildrenIds())
+			incomingDivisions.push_back(std::make_pair(getIndex(childId), &iter->second));
+	}
 
-		std::cout << "Using gurobi optimizer" << std::endl;
-		typedef opengm::LPGurobi2<GraphicalModelType, opengm::Minimizer> OptimizerType;
+	const size_t numSegmentations = segmentationHypotheses_.size();
+	linkAdjacency_.resize(incomingLinks.size() + outgoingLinks.size());
+	divisionAdjacency_.resize(incomingDivisions.size() + outgoingDivisions.size());
+	LinkingHypothesis** incomingLinkStorage = linkAdjacency_.data();
+	LinkingHypothesis** outgoingLinkStorage = incomingLinkStorage + incomingLinks.size();
+	DivisionHypothesis** incomingDivisionStorage = divisionAdjacency_.data();
+	DivisionHypothesis** outgoingDivisionStorage = incomingDivisionStorage + incomingDivisions.size();
+
+	std::vector<size_t> incomingLinkOffsets = fillAdjacency(incomingLinks, numSegmentations, incomingLinkStorage);
+	std::vector<size_t> outgoingLinkOffsets = fillAdjacency(outgoingLinks, numSegmentations, outgoingLinkStorage);
+	std::vector<size_t> incomingDivisionOffsets = fillAdjacency(incomingDivisions, numSegmentations, incomingDivisionStorage);
+	std::vector<size_t> outgoingDivisionOffsets = fillAdjacency(outgoingDivisions, numSegmentations, outgoingDivisionStorage);
+
+	size_t index = 0;
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter, ++index)
+	{
+		iter->second.setAdjacency(
+			PointerRange<LinkingHypothesis>(incomingLinkStorage + incomingLinkOffsets[index], incomingLinkStorage + incomingLinkOffsets[index + 1]),
+			PointerRange<LinkingHypothesis>(outgoingLinkStorage + outgoingLinkOffsets[index], outgoingLinkStorage + outgoingLinkOffsets[index + 1]),
+			PointerRange<DivisionHypothesis>(incomingDivisionStorage + incomingDivisionOffsets[index], incomingDivisionStorage + incomingDivisionOffsets[index + 1]),
+			PointerRange<DivisionHypothesis>(outgoingDivisionStorage + outgoingDivisionOffsets[index], outgoingDivisionStorage + outgoingDivisionOffsets[index + 1]));
+	}
 
-		OptimizerType::Parameter optimizerParam;
-		optimizerParam.relaxation_ = OptimizerType::Parameter::TightPolytope;
-		optimizerParam.verbose_ = settings_->optimizerVerbose_;
-		optimizerParam.useSoftConstraints_ = false;
-		optimizerParam.integerConstraintNodeVar_ = true;
-		optimizerParam.epGap_ = settings_->optimizerEpGap_;
-		optimizerParam.numberOfThreads_ = settings_->optimizerNumThreads_;
+	editedAdjacency_.clear();
+	hasMergedExclusionConstraints_ = false;
+	mergedExclusionConstraints_.clear();
+}
 
-		OptimizerType optimizer(model_, optimizerParam);
+std::vector<ExclusionConstraint>& Model::getMergedExclusionConstraints()
+{
+	if(!hasMergedExclusionConstraints_)
+	{
+		mergedExclusionConstraints_ = mergeExclusionConstraints();
+		hasMergedExclusionConstraints_ = true;
+	}
+	return mergedExclusionConstraints_;
+}
 
-		Solution solution(model_.numberOfVariables());
-		OptimizerType::VerboseVisitorType optimizerVisitor;
-		optimizer.infer(optimizerVisitor);
-		optimizer.arg(solution);
-		std::cout << "solution has energy: " << optimizer.value() << std::endl;
-		foundSolutionValue_ = optimizer.value();
-		return solution;
+std::vector<ExclusionConstraint> Model::mergeExclusionConstraints() const
+{
+	if(exclusionConstraints_.size() < 2)
+		return exclusionConstraints_;
+
+	// members of every constraint and neighbors of every detection in the graph of detections that exclude each other
+	std::vector< std::vector<size_t> > members(exclusionConstraints_.size());
+	std::vector< std::vector<size_t> > neighbors(segmentationHypotheses_.size());
+	for(size_t e = 0; e < exclusionConstraints_.size(); ++e)
+	{
+		for(auto& id : exclusionConstraints_[e].getIds())
+		{
+			size_t index = segmentationHypotheses_.indexOf(id);
+			if(index == SegmentationHypothesisMap::npos)
+			{
+				std::stringstream s;
+				s << "Cannot find segmentation hypothesis " << id << " referenced in the model";
+				throw std::runtime_error(s.str());
+			}
+			members[e].push_back(index);
+		}
+		std::sort(members[e].begin(), members[e].end());
+		members[e].erase(std::unique(members[e].begin(), members[e].end()), members[e].end());
+		for(size_t a : members[e])
+			for(size_t b : members[e])
+				if(a != b)
+					neighbors[a].push_back(b);
 	}
-	else
+	for(auto& list : neighbors)
+	{
+		std::sort(list.begin(), list.end());
+		list.erase(std::unique(list.begin(), list.end()), list.end());
+	}
+	auto excludes = [&](size_t a, size_t b)
 	{
-		std::cout << "Using gurobi optimizer" << std::endl;
-		typedef opengm::LPGurobi<GraphicalModelType, opengm::Minimizer> OptimizerType;
+		return std::binary_search(neighbors[a].begin(), neighbors[a].end(), b);
+	};
 
-		OptimizerType::Parameter optimizerParam;
-		optimizerParam.verbose_ = settings_->optimizerVerbose_;
-		optimizerParam.integerConstraint_ = true;
-		optimizerParam.epGap_ = settings_->optimizerEpGap_;
-		optimizerParam.numberOfThreads_ = settings_->optimizerNumThreads_;
+	std::vector<size_t> order(exclusionConstraints_.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return members[a].size() > members[b].size(); });
 
-		OptimizerType optimizer(model_, optimizerParam);
+	std::set< std::pair<size_t, size_t> > coveredPairs;
+	auto countUncovered = [&](size_t candidate, const std::vector<size_t>& clique)
+	{
+		size_t count = 0;
+		for(size_t member : clique)
+			count += member != candidate && coveredPairs.count(std::make_pair(std::min(candidate, member), std::max(candidate, member))) == 0;
+		return count;
+	};
 
-		Solution solution(model_.numberOfVariables());
-		OptimizerType::VerboseVisitorType optimizerVisitor;
-		optimizer.infer(optimizerVisitor);
-		optimizer.arg(solution);
-		
-		for(size_t i = 0; i < solution.size(); i++)
-        {
-            opengm::IndependentFactor<double, size_t, size_t> values;
-            optimizer.variable(i, values);
-            std::cout << "Variable " << i << ": ";
-            for(size_t state = 0; state < model_.numberOfLabels(i); state++)
-            {
-                std::cout << "(" << state << ")=" << values(state) << " ";
-            }
-            std::cout << std::endl;
-        }
-		
-		std::cout << "solution has energy: " << optimizer.value() << std::endl;
-		foundSolutionValue_ = optimizer.value();
-		return solution;
+	std::vector<ExclusionConstraint> cliques;
+	for(size_t e : order)
+	{
+		std::vector<size_t> clique = members[e];
+		bool needed = false;
+		for(size_t i = 0; i < clique.size() && !needed; ++i)
+			needed = countUncovered(clique[i], clique) > 0;
+		if(!needed)
+			continue;
+
+		// add the detection that excludes all members and covers the most new pairs, until there is none
+		std::vector<size_t> candidates;
+		for(size_t candidate : neighbors[clique[0]])
+		{
+			if(std::all_of(clique.begin(), clique.end(), [&](size_t member) { return member != candidate && excludes(member, candidate); }))
+				candidates.push_back(candidate);
+		}
+		while(!candidates.empty())
+		{
+			auto best = std::max_element(candidates.begin(), candidates.end(), [&](size_t a, size_t b) { 
+				return countUncovered(a, clique) < countUncovered(b, clique); 
+			});
+			size_t added = *best;
+			clique.push_back(added);
+			candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](size_t candidate) { 
+				return candidate == added || !excludes(added, candidate); 
+			}), candidates.end());
+		}
+
+		std::sort(clique.begin(), clique.end());
+		std::vector<IdLabelType> ids;
+		for(size_t i = 0; i < clique.size(); ++i)
+		{
+			ids.push_back((segmentationHypotheses_.begin() + clique[i])->first);
+			for(size_t j = i + 1; j < clique.size(); ++j)
+				coveredPairs.insert(std::make_pair(clique[i], clique[j]));
+		}
+		cliques.push_back(ExclusionConstraint(ids));
 	}
+
+	if(cliques.size() != exclusionConstraints_.size())
+		std::cout << "Merged " << exclusionConstraints_.size() << " exclusion constraints into " << cliques.size() << " cliques" << std::endl;
+	return cliques;
 }
 
-std::vector<ValueType> Model::learn()
+size_t Model::assignOpenGMVariableIds()
 {
-	std::vector<helpers::ValueType> weights(computeNumWeights(), 0);
-	return learn(weights);
+	// same order as in initializeOpenGMModel()
+	int nextId = 0;
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+		iter->second.assignOpenGMVariableIds(nextId);
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+		iter->second.assignOpenGMVariableIds(nextId);
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+		iter->second.assignOpenGMVariableIds(nextId);
+	return nextId;
 }
 
-std::vector<ValueType> Model::learn(const std::vector<helpers::ValueType>& weights)
+std::vector<Subgraph> Model::findConnectedComponents()
 {
-	// prepare OpenGM for learning
-	DatasetType dataset;
-	WeightsType initialWeights(computeNumWeights());
+	// union-find over the segmentation hypotheses, indexed in the order of their storage
+	std::vector<SegmentationHypothesis*> segmentations;
+	segmentations.reserve(segmentationHypotheses_.size());
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+		segmentations.push_back(&iter->second);
+
+	std::vector<size_t> parents(segmentations.size());
+	std::iota(parents.begin(), parents.end(), 0);
 
-	if(weights.size() != computeNumWeights())
+	auto findRoot = [&](size_t i)
 	{
-		std::cout << "Provided length of vector with initial weights has wrong length!" << std::endl;
-		throw std::runtime_error("Provided length of vector with initial weights has wrong length!");
-	}
-	for(size_t i = 0; i < weights.size(); ++i)
+		while(parents[i] != i)
+		{
+			parents[i] = parents[parents[i]];
+			i = parents[i];
+		}
+		return i;
+	};
+
+	auto getIndex = [&](const IdLabelType& id)
 	{
-		initialWeights.setWeight(i, weights[i]);
+		size_t index = segmentationHypotheses_.indexOf(id);
+		if(index == SegmentationHypothesisMap::npos)
+		{
+			std::stringstream s;
+			s << "Cannot find segmentation hypothesis " << id << " referenced in the model";
+			throw std::runtime_error(s.str());
+		}
+		return index;
+	};
+
+	auto merge = [&](const IdLabelType& a, const IdLabelType& b)
+	{
+		size_t rootA = findRoot(getIndex(a));
+		size_t rootB = findRoot(getIndex(b));
+		// the smaller index becomes the root, so every component is represented by its first segmentation
+		if(rootA < rootB)
+			parents[rootB] = rootA;
+		else if(rootB < rootA)
+			parents[rootA] = rootB;
+	};
+
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+		merge(iter->second.getSrcId(), iter->second.getDestId());
+
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+		for(auto& childId : iter->second.getChildrenIds())
+			merge(iter->second.getParentId(), childId);
+
+	std::vector<ExclusionConstraint>& exclusions = getMergedExclusionConstraints();
+	for(auto iter = exclusions.begin(); iter != exclusions.end() ; ++iter)
+		for(auto& id : iter->getIds())
+			merge(iter->getIds().front(), id);
+
+	// enumerate components in the order of their first segmentation hypothesis
+	std::vector<int> componentOfRoot(segmentations.size(), -1);
+	std::vector<Subgraph> components;
+	auto getComponent = [&](const IdLabelType& id) -> Subgraph&
+	{
+		return components[componentOfRoot[findRoot(getIndex(id))]];
+	};
+
+	for(size_t i = 0; i < segmentations.size(); ++i)
+	{
+		size_t root = findRoot(i);
+		if(componentOfRoot[root] < 0)
+		{
+			componentOfRoot[root] = components.size();
+			components.push_back(Subgraph());
+		}
+		components[componentOfRoot[root]].segmentations_.push_back(segmentations[i]);
 	}
-	
-	dataset.setWeights(initialWeights);
-	initializeOpenGMModel(dataset.getWeights());
 
-	// load GT from subclass-specified method
-	Solution gt = getGroundTruth();
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+		getComponent(iter->second.getSrcId()).links_.push_back(&iter->second);
+
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+		getComponent(iter->second.getParentId()).divisions_.push_back(&iter->second);
 
-	dataset.pushBackInstance(model_, gt);
-	
-	std::cout << "Done setting up dataset, creating learner" << std::endl;
-	opengm::learning::StructMaxMargin<DatasetType>::Parameter learnerParam;
-	learnerParam.optimizerParameter_.lambda = 1.00;
-	learnerParam.optimizerParameter_.nonNegativeWeights = settings_->nonNegativeWeightsOnly_;
-	opengm::learning::StructMaxMargin<DatasetType> learner(dataset, learnerParam);
+	for(auto iter = exclusions.begin(); iter != exclusions.end() ; ++iter)
+		getComponent(iter->getIds().front()).exclusions_.push_back(&(*iter));
 
-	typedef opengm::LPGurobi2<GraphicalModelType, opengm::Minimizer> OptimizerType;
-	
-	OptimizerType::Parameter optimizerParam;
-	optimizerParam.integerConstraintNodeVar_ = true;
-	optimizerParam.relaxation_ = OptimizerType::Parameter::TightPolytope;
-	optimizerParam.verbose_ = settings_->optimizerVerbose_;
-	optimizerParam.useSoftConstraints_ = false;
+	return components;
+}
+
+MipInference::Parameter Model::getMipInferenceParameter(bool verbose) const
+{
+	MipInference::Parameter optimizerParam;
+	optimizerParam.backend_ = settings_->solverBackend_;
+	optimizerParam.verbose_ = verbose && settings_->optimizerVerbose_;
+	optimizerParam.integerConstraints_ = true;
 	optimizerParam.epGap_ = settings_->optimizerEpGap_;
 	optimizerParam.numberOfThreads_ = settings_->optimizerNumThreads_;
-
-	std::cout << "Calling learn()..." << std::endl;
-	learner.learn<OptimizerType>(optimizerParam); 
-	std::cout << "extracting weights" << std::endl;
-	const WeightsType& finalWeights = learner.getWeights();
-	std::vector<double> resultWeights;
-	for(size_t i = 0; i < finalWeights.numberOfWeights(); ++i)
-		resultWeights.push_back(finalWeights.getWeight(i));
-	return resultWeights;
+	return optimizerParam;
 }
 
-double Model::evaluateSolution(const Solution& sol) const
+std::vector<SolverBackend*> Model::getSolverBackends(size_t numWorkers) const
 {
-	return model_.evaluate(sol);
+	if(solverBackends_.size() < numWorkers)
+		solverBackends_.resize(numWorkers);
+	std::vector<SolverBackend*> backends;
+	for(size_t worker = 0; worker < numWorkers; ++worker)
+	{
+		// the settings may select another backend between solves
+		if(!solverBackends_[worker] || solverBackends_[worker]->name() != settings_->solverBackend_)
+			solverBackends_[worker] = SolverBackend::create(settings_->solverBackend_);
+		backends.push_back(solverBackends_[worker].get());
+	}
+	return backends;
 }
 
-double Model::getLastSolutionValue() const
+double Model::optimizeOpenGMModel(const GraphicalModelType& model, Solution& solution, bool verbose, SolverBackend& backend, const Solution* start) const
 {
-	return foundSolutionValue_;
+	Telemetry::ScopedPhase setupPhase(telemetry_, "solverSetup");
+	MipInference optimizer(model, getMipInferenceParameter(verbose), backend);
+	if(start != nullptr && start->size() == model.numberOfVariables())
+	{
+		optimizer.setStartingPoint(start->begin());
+		telemetry_.addToCounter("solver.startingPoints", 1);
+	}
+	setupPhase.stop();
+
+	Telemetry::ScopedPhase solvePhase(telemetry_, "solve");
+	solution.resize(model.numberOfVariables());
+	optimizer.infer();
+	optimizer.arg(solution);
+	solvePhase.stop();
+
+	// relative gap between the solution and the best bound the solver has proven
+	double value = optimizer.value();
+	double bound = optimizer.bound();
+	telemetry_.addToCounter("solver.solves", 1);
+	optimizer.getSolverResult().addToTelemetry(telemetry_);
+	if(std::isfinite(value) && std::isfinite(bound))
+		telemetry_.setCounterToMax("solver.maxGap", std::abs(value - bound) / std::max(1e-10, std::abs(value)));
+	return value;
 }
 
-bool Model::verifySolution(const Solution& sol) const
+Solution Model::inferComponentwise()
 {
-	std::cout << "Checking solution..." << std::endl;
+	// only after edits are components skipped, other calls solve all of them again, starting from their previous solutions
+	std::vector<char> isSolved;
+	if(componentModels_.empty() || !editedSegmentations_.empty())
+	{
+		computeNumWeights();
+		std::vector<Subgraph> components = findConnectedComponents();
+
+		size_t largestComponent = 0;
+		for(auto& component : components)
+			largestComponent = std::max(largestComponent, component.segmentations_.size());
+		std::cout << "Solving " << components.size() << " connected components separately, the largest has "
+				  << largestComponent << " segmentation hypotheses" << std::endl;
+
+		// After edits, a component without edited segmentations is one of the previous components, because every edit 
+		// marks the segmentations on both sides of what it changes. Its hypotheses kept their order, so its model is kept as well.
+		std::vector< std::unique_ptr<GraphicalModelType> > keptModels(components.size());
+		std::vector<Solution> keptSolutions(components.size());
+		std::vector<double> keptEnergies(components.size(), 0.0);
+		if(!componentModels_.empty())
+		{
+			std::unordered_map<IdLabelType, size_t, IdHash> previousComponents;
+			for(size_t c = 0; c < componentFirstIds_.size(); ++c)
+				previousComponents[componentFirstIds_[c]] = c;
+			for(size_t c = 0; c < components.size(); ++c)
+			{
+				bool isEdited = false;
+				for(auto segmentation : components[c].segmentations_)
+					isEdited = isEdited || editedSegmentations_.count(segmentation->getId()) > 0;
+				auto previous = previousComponents.find(components[c].segmentations_.front()->getId());
+				if(!isEdited && previous != previousComponents.end())
+				{
+					keptModels[c] = std::move(componentModels_[previous->second]);
+					keptSolutions[c].swap(componentSolutions_[previous->second]);
+					if(previous->second < componentEnergies_.size())
+						keptEnergies[c] = componentEnergies_[previous->second];
+				}
+			}
+		}
 
-	bool valid = true;
+		// the component models are kept, they refer to inferenceWeights_ which is updated by every call to infer()
+		componentModels_.swap(keptModels);
+		componentVariables_.assign(components.size(), std::vector<const Variable*>());
+		componentFirstIds_.clear();
+		for(auto& component : components)
+			componentFirstIds_.push_back(component.segmentations_.front()->getId());
+		componentSolutions_.swap(keptSolutions);
+		componentEnergies_.swap(keptEnergies);
+		isSolved.assign(components.size(), false);
+		std::vector<char> isRebuilt(components.size(), false);
+		parallelFor(components.size(), settings_->componentNumThreads_, [&](size_t c)
+		{
+			if(componentModels_[c])
+			{
+				// number the variables as when the model was built
+				int nextId = 0;
+				for(auto link : components[c].links_)
+					link->assignOpenGMVariableIds(nextId);
+				for(auto division : components[c].divisions_)
+					division->assignOpenGMVariableIds(nextId);
+				for(auto segmentation : components[c].segmentations_)
+					segmentation->assignOpenGMVariableIds(nextId);
+				if((size_t)nextId != componentModels_[c]->numberOfVariables())
+				{
+					componentModels_[c].reset();
+					componentSolutions_[c].clear();
+				}
+			}
+			if(!componentModels_[c])
+			{
+				// the components are built in parallel already
+				componentModels_[c].reset(new GraphicalModelType());
+				addSubgraphToOpenGMModel(*componentModels_[c], inferenceWeights_, components[c], 1);
+				isRebuilt[c] = true;
+			}
+			componentVariables_[c] = getSubgraphVariables(components[c], componentModels_[c]->numberOfVariables());
+		});
+		editedSegmentations_.clear();
+		telemetry_.setCounter("opengm.rebuiltModels", std::count(isRebuilt.begin(), isRebuilt.end(), true));
+
+		// the solutions of the kept models are still optimal if the weights did not change since they were found
+		std::vector<ValueType> weights(inferenceWeights_.numberOfWeights());
+		for(size_t i = 0; i < weights.size(); ++i)
+			weights[i] = inferenceWeights_.getWeight(i);
+		if(weights == componentSolutionWeights_)
+		{
+			for(size_t c = 0; c < components.size(); ++c)
+				isSolved[c] = !componentSolutions_[c].empty();
+		}
 
-	// check that all exclusions are obeyed
-	for(auto iter = exclusionConstraints_.begin(); iter != exclusionConstraints_.end() ; ++iter)
+		std::vector<const GraphicalModelType*> models;
+		for(auto& model : componentModels_)
+			models.push_back(model.get());
+		recordModelStatistics(models);
+	}
+
+	isSolved.resize(componentModels_.size(), false);
+
+	// the component models numbered their variables independently, 
+	// now give every variable the id it would have in the full model
+	Solution solution(assignOpenGMVariableIds(), 0);
+
+	// start from the solution of the previous call, or from a start of the full model cut into the components
+	std::vector<Solution> starts = componentSolutions_;
+	for(size_t c = 0; c < componentModels_.size(); ++c)
 	{
-		if(!iter->verifySolution(sol, segmentationHypotheses_))
+		if(!starts[c].empty() || lastSolution_.size() != solution.size())
+			continue;
+		starts[c].assign(componentModels_[c]->numberOfVariables(), 0);
+		for(size_t i = 0; i < componentVariables_[c].size(); ++i)
 		{
-			std::cout << "\tFound violated exclusion constraint " << std::endl;
-			valid = false;
+			if(componentVariables_[c][i] != nullptr)
+				starts[c][i] = lastSolution_[componentVariables_[c][i]->getOpenGMVariableId()];
 		}
 	}
 
-	// check that flow-conservation + division constraints are satisfied
-	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	std::vector<double> componentEnergies(componentModels_.size(), 0.0);
+	std::vector<SolverBackend*> backends = getSolverBackends(getNumWorkerThreads(settings_->componentNumThreads_, componentModels_.size()));
+	parallelForWorkers(componentModels_.size(), settings_->componentNumThreads_, [&](size_t c, size_t worker)
 	{
-		if(!iter->second.verifySolution(sol, settings_))
+		// inferPresolved() leaves pruned hypotheses out, components whose hypotheses have all been pruned are empty
+		if(isSolved[c])
+			componentEnergies[c] = componentEnergies_[c];
+		else if(componentModels_[c]->numberOfVariables() > 0)
+			componentEnergies[c] = optimizeOpenGMModel(*componentModels_[c], componentSolutions_[c], false, *backends[worker], &starts[c]);
+	});
+	telemetry_.setCounter("opengm.solvedComponents", std::count(isSolved.begin(), isSolved.end(), false));
+	componentEnergies_ = componentEnergies;
+	componentSolutionWeights_.resize(inferenceWeights_.numberOfWeights());
+	for(size_t i = 0; i < componentSolutionWeights_.size(); ++i)
+		componentSolutionWeights_[i] = inferenceWeights_.getWeight(i);
+
+	// stitch the solutions together
+	for(size_t c = 0; c < componentModels_.size(); ++c)
+	{
+		for(size_t i = 0; i < componentVariables_[c].size(); ++i)
 		{
-			std::cout << "\tFound violated flow conservation constraint " << std::endl;
-			valid = false;
+			if(componentVariables_[c][i] != nullptr)
+				solution[componentVariables_[c][i]->getOpenGMVariableId()] = componentSolutions_[c][i];
 		}
 	}
 
-	return valid;
+	lastSolution_ = solution;
+
+	// components do not share any factors, so the energies simply add up
+	foundSolutionValue_ = std::accumulate(componentEnergies.begin(), componentEnergies.end(), 0.0);
+	std::cout << "solution has energy: " << foundSolutionValue_ << std::endl;
+	return solution;
 }
 
-void Model::toDot(const std::string& filename, const Solution* sol) const
+bool Model::isFlowProblem()
 {
-	std::ofstream out_file(filename.c_str());
+	computeNumWeights();
+	if(divisionHypotheses_.size() > 0 || exclusionConstraints_.size() > 0 || hasFixedStates())
+		return false;
 
-    if(!out_file.good())
-    {
-        throw std::runtime_error("Could not open file " + filename + " to save graph to");
-    }
+	auto isBinary = [](const Variable& var){ return var.getNumStates() == 2; };
+	auto isBinaryOrEmpty = [&](const Variable& var){ return !var.hasFeatures() || isBinary(var); };
 
-    out_file << "digraph G {\n";
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+	{
+		if(!iter->second.getVariable().hasFeatures() || !isBinary(iter->second.getVariable()))
+			return false;
+	}
 
-    // nodes
-    for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
-		iter->second.toDot(out_file, sol);
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		const SegmentationHypothesis& seg = iter->second;
+		if(!isBinary(seg.getDetectionVariable()) 
+			|| !isBinaryOrEmpty(seg.getAppearanceVariable()) 
+			|| !isBinaryOrEmpty(seg.getDisappearanceVariable()))
+			return false;
+
+		// division variables are only used if there is more than one outgoing link, see SegmentationHypothesis::addToOpenGMModel()
+		if(seg.getDivisionVariable().hasFeatures() && seg.getOutgoingLinks().size() > 1)
+			return false;
+
+		// a flow path source -> appearance -> disappearance -> sink cannot be forbidden
+		if(!settings_->allowLengthOneTracks_ 
+			&& seg.getAppearanceVariable().hasFeatures() 
+			&& seg.getDisappearanceVariable().hasFeatures())
+			return false;
+	}
+
+	return true;
+}
+
+bool Model::inferMinCostFlow(const std::vector<ValueType>& weights, Solution& solution)
+{
+	computeNumWeights();
+
+	// all variables in state 0 is the baseline, each arc costs the difference of switching its variable to state 1
+	ValueType baseEnergy = 0.0;
+	auto getActivationCost = [&](const Variable& var, const std::vector<size_t>& weightIds)
+	{
+		std::vector<ValueType> energies = var.getStateEnergies(settings_->statesShareWeights_, weights, weightIds);
+		baseEnergy += energies[0];
+		return energies[1] - energies[0];
+	};
+
+	// node 0 is the source, node 1 the sink, and every detection is split into an incoming and an outgoing node
+	const size_t source = 0;
+	const size_t sink = 1;
+	// no OpenGM model is built, but the numbers of variables are recorded anyway
+	recordModelStatistics({});
+
+	Telemetry::ScopedPhase setupPhase(telemetry_, "solverSetup");
+	MinCostFlow flow(2 + 2 * segmentationHypotheses_.size());
+	std::vector< std::pair<const Variable*, size_t> > variableArcs;
+	// the nodes of a detection follow from its index in the segmentation storage
+	auto getInNode = [&](const IdLabelType& id) { return 2 + 2 * segmentationHypotheses_.indexOf(id); };
+
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		const SegmentationHypothesis& seg = iter->second;
+		size_t inNode = 2 + 2 * (iter - segmentationHypotheses_.begin());
+		size_t outNode = inNode + 1;
+
+		variableArcs.push_back(std::make_pair(&seg.getDetectionVariable(), 
+			flow.addArc(inNode, outNode, getActivationCost(seg.getDetectionVariable(), detWeightIds_))));
+
+		if(seg.getAppearanceVariable().hasFeatures())
+			variableArcs.push_back(std::make_pair(&seg.getAppearanceVariable(), 
+				flow.addArc(source, inNode, getActivationCost(seg.getAppearanceVariable(), appWeightIds_))));
+
+		if(seg.getDisappearanceVariable().hasFeatures())
+			variableArcs.push_back(std::make_pair(&seg.getDisappearanceVariable(), 
+				flow.addArc(outNode, sink, getActivationCost(seg.getDisappearanceVariable(), disWeightIds_))));
+	}
 
-	// links
 	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
-		iter->second->toDot(out_file, sol);
+	{
+		const Variable& var = iter->second.getVariable();
+		variableArcs.push_back(std::make_pair(&var, 
+			flow.addArc(getInNode(iter->second.getSrcId()) + 1, getInNode(iter->second.getDestId()), getActivationCost(var, linkWeightIds_))));
+	}
 
-	// divisions
-	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
-		iter->second->toDot(out_file, sol);
+	setupPhase.stop();
+
+	Telemetry::ScopedPhase solvePhase(telemetry_, "solve");
+	bool solved = flow.solve(source, sink);
+	solvePhase.stop();
+	telemetry_.addToCounter("solver.solves", 1);
+	if(!solved)
+		return false;
+	telemetry_.setCounter("solver.flowPaths", flow.getNumPaths());
+
+	// the solution should look exactly as if the opengm model had been built
+	solution.assign(assignOpenGMVariableIds(), 0);
+	for(auto& variableArc : variableArcs)
+		solution[variableArc.first->getOpenGMVariableId()] = flow.hasFlow(variableArc.second) ? 1 : 0;
+
+	foundSolutionValue_ = baseEnergy + flow.getCost();
+	std::cout << "Found " << flow.getNumPaths() << " tracks by min-cost-flow" << std::endl;
+	std::cout << "solution has energy: " << foundSolutionValue_ << std::endl;
+	return true;
+}
+
+Solution Model::constructGreedySolution(const std::vector<ValueType>& weights)
+{
+	computeNumWeights();
+	Telemetry::ScopedPhase phase(telemetry_, "greedyStart");
+	Solution solution(assignOpenGMVariableIds(), 0);
+	const size_t npos = std::numeric_limits<size_t>::max();
+	const double infinity = std::numeric_limits<double>::infinity();
+
+	// cost of switching a variable from state 0 to state 1, infinite if it does not exist
+	auto getActivationCost = [&](const Variable& var, const std::vector<size_t>& weightIds)
+	{
+		if(var.getOpenGMVariableId() < 0 || var.getNumStates() < 2)
+			return infinity;
+		std::vector<ValueType> energies = var.getStateEnergies(settings_->statesShareWeights_, weights, weightIds);
+		return energies[1] - energies[0];
+	};
+
+	const size_t numSegmentations = segmentationHypotheses_.size();
+	std::vector<double> detectionCosts(numSegmentations);
+	std::vector<double> appearanceCosts(numSegmentations);
+	std::vector<double> disappearanceCosts(numSegmentations);
+	for(size_t i = 0; i < numSegmentations; ++i)
+	{
+		const SegmentationHypothesis& seg = (segmentationHypotheses_.begin() + i)->second;
+		detectionCosts[i] = getActivationCost(seg.getDetectionVariable(), detWeightIds_);
+		appearanceCosts[i] = getActivationCost(seg.getAppearanceVariable(), appWeightIds_);
+		disappearanceCosts[i] = getActivationCost(seg.getDisappearanceVariable(), disWeightIds_);
+	}
+
+	// a link replaces the disappearance of its source and the appearance of its target,
+	// links are accepted by how much that saves as long as every detection has at most one predecessor and successor
+	struct LinkCandidate
+	{
+		double saving;
+		double cost;
+		size_t src;
+		size_t dest;
+		const LinkingHypothesis* link;
+	};
+	std::vector<LinkCandidate> candidates;
+	candidates.reserve(linkingHypotheses_.size());
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+	{
+		LinkCandidate candidate;
+		candidate.src = segmentationHypotheses_.indexOf(iter->second.getSrcId());
+		candidate.dest = segmentationHypotheses_.indexOf(iter->second.getDestId());
+		candidate.cost = getActivationCost(iter->second.getVariable(), linkWeightIds_);
+		candidate.link = &iter->second;
+		if(candidate.src == SegmentationHypothesisMap::npos || candidate.dest == SegmentationHypothesisMap::npos
+			|| candidate.src == candidate.dest || !std::isfinite(candidate.cost)
+			|| !std::isfinite(detectionCosts[candidate.src]) || !std::isfinite(detectionCosts[candidate.dest]))
+			continue;
+		// detections that cannot disappear (appear) get a saving of -infinity, their links are taken first
+		candidate.saving = candidate.cost - disappearanceCosts[candidate.src] - appearanceCosts[candidate.dest];
+		if(candidate.saving < 0)
+			candidates.push_back(candidate);
+	}
+	std::sort(candidates.begin(), candidates.end(), [](const LinkCandidate& a, const LinkCandidate& b) { return a.saving < b.saving; });
+
+	std::vector<size_t> successors(numSegmentations, npos);
+	std::vector<size_t> predecessors(numSegmentations, npos);
+	std::vector<const LinkCandidate*> outgoingLinks(numSegmentations, nullptr);
+	for(const LinkCandidate& candidate : candidates)
+	{
+		if(successors[candidate.src] != npos || predecessors[candidate.dest] != npos)
+			continue;
+		successors[candidate.src] = candidate.dest;
+		predecessors[candidate.dest] = candidate.src;
+		outgoingLinks[candidate.src] = &candidate;
+	}
+
+	// of every chain, take the contiguous part of lowest energy that can appear at its start and disappear at its end
+	struct Track
+	{
+		double cost;
+		size_t first;
+		size_t last;
+	};
+	std::vector<Track> tracks;
+	std::vector<size_t> chain;
+	for(size_t head = 0; head < numSegmentations; ++head)
+	{
+		if(predecessors[head] != npos || !std::isfinite(detectionCosts[head]))
+			continue;
+
+		chain.clear();
+		for(size_t i = head; i != npos; i = successors[i])
+			chain.push_back(i);
+
+		// cost(a, b) = appearance[a] - prefix[a] + prefix[b] + detection[b] + disappearance[b], 
+		// where prefix[i] sums the detections and links before position i
+		Track best = {0.0, npos, npos};
+		double prefix = 0.0;
+		double bestStart = infinity;
+		size_t bestStartIndex = npos;
+		for(size_t b = 0; b < chain.size(); ++b)
+		{
+			double startHere = appearanceCosts[chain[b]] - prefix;
+			bool canStartHere = startHere < bestStart;
+			if(settings_->allowLengthOneTracks_ && canStartHere)
+			{
+				bestStart = startHere;
+				bestStartIndex = b;
+			}
+
+			double cost = bestStart + prefix + detectionCosts[chain[b]] + disappearanceCosts[chain[b]];
+			if(cost < best.cost)
+				best = {cost, chain[bestStartIndex], chain[b]};
+
+			// without length one tracks a track may only end after the detection it started at
+			if(!settings_->allowLengthOneTracks_ && canStartHere)
+			{
+				bestStart = startHere;
+				bestStartIndex = b;
+			}
+
+			if(b + 1 < chain.size())
+				prefix += detectionCosts[chain[b]] + outgoingLinks[chain[b]]->cost;
+		}
+
+		if(best.first != npos)
+			tracks.push_back(best);
+	}
+
+	// commit the cheapest tracks first, skip those that contain a detection excluded by an active one
+	std::vector< std::vector<size_t> > excludedBy(numSegmentations);
+	for(auto iter = exclusionConstraints_.begin(); iter != exclusionConstraints_.end() ; ++iter)
+	{
+		std::vector<size_t> indices;
+		for(auto& id : iter->getIds())
+		{
+			size_t index = segmentationHypotheses_.indexOf(id);
+			if(index != SegmentationHypothesisMap::npos)
+				indices.push_back(index);
+		}
+		for(size_t a : indices)
+			for(size_t b : indices)
+				if(a != b)
+					excludedBy[a].push_back(b);
+	}
+
+	std::sort(tracks.begin(), tracks.end(), [](const Track& a, const Track& b) { return a.cost < b.cost; });
+	std::vector<bool> active(numSegmentations, false);
+	size_t numTracks = 0;
+	for(const Track& track : tracks)
+	{
+		bool excluded = false;
+		size_t end = successors[track.last];
+		for(size_t i = track.first; i != end && !excluded; i = successors[i])
+		{
+			for(size_t other : excludedBy[i])
+				excluded = excluded || active[other];
+			active[i] = true;
+		}
+
+		for(size_t i = track.first; i != end; i = successors[i])
+		{
+			if(excluded)
+			{
+				active[i] = false;
+				continue;
+			}
+
+			const SegmentationHypothesis& seg = (segmentationHypotheses_.begin() + i)->second;
+			solution[seg.getDetectionVariable().getOpenGMVariableId()] = 1;
+			if(i == track.first)
+				solution[seg.getAppearanceVariable().getOpenGMVariableId()] = 1;
+			if(i == track.last)
+				solution[seg.getDisappearanceVariable().getOpenGMVariableId()] = 1;
+			else
+				solution[outgoingLinks[i]->link->getVariable().getOpenGMVariableId()] = 1;
+		}
+
+		if(!excluded)
+			numTracks++;
+	}
+
+	std::cout << "Constructed a greedy solution with " << numTracks << " tracks" << std::endl;
+	return solution;
+}
+
+std::vector< std::vector<ValueType> > Model::computeStateEnergies(const std::vector<ValueType>& weights)
+{
+	// energies of all states of every variable, by OpenGM variable id
+	std::vector< std::vector<ValueType> > stateEnergies(assignOpenGMVariableIds());
+	auto addVariable = [&](const Variable& var, const std::vector<size_t>& weightIds)
+	{
+		if(var.getOpenGMVariableId() >= 0)
+			stateEnergies[var.getOpenGMVariableId()] = var.getStateEnergies(settings_->statesShareWeights_, weights, weightIds);
+	};
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		addVariable(iter->second.getDetectionVariable(), detWeightIds_);
+		addVariable(iter->second.getDivisionVariable(), divWeightIds_);
+		addVariable(iter->second.getAppearanceVariable(), appWeightIds_);
+		addVariable(iter->second.getDisappearanceVariable(), disWeightIds_);
+	}
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+		addVariable(iter->second.getVariable(), linkWeightIds_);
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+		addVariable(iter->second.getVariable(), externalDivWeightIds_);
+
+	return stateEnergies;
+}
+
+double Model::computeSolutionEnergy(const Solution& sol, const std::vector<ValueType>& weights) const
+{
+	double energy = 0.0;
+	auto addEnergy = [&](const Variable& var, const std::vector<size_t>& weightIds)
+	{
+		if(var.getOpenGMVariableId() < 0)
+			return;
+		if(size_t(var.getOpenGMVariableId()) >= sol.size())
+			throw std::runtime_error("Solution vector is too short for this model");
+		energy += var.getStateEnergies(settings_->statesShareWeights_, weights, weightIds)[sol[var.getOpenGMVariableId()]];
+	};
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		addEnergy(iter->second.getDetectionVariable(), detWeightIds_);
+		addEnergy(iter->second.getDivisionVariable(), divWeightIds_);
+		addEnergy(iter->second.getAppearanceVariable(), appWeightIds_);
+		addEnergy(iter->second.getDisappearanceVariable(), disWeightIds_);
+	}
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+		addEnergy(iter->second.getVariable(), linkWeightIds_);
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+		addEnergy(iter->second.getVariable(), externalDivWeightIds_);
+	return energy;
+}
+
+Solution Model::addPathsApproximately(const std::vector< std::vector<ValueType> >& stateEnergies, 
+									 size_t& numPaths, 
+									 size_t& numPasses, 
+									 size_t& numDivisions)
+{
+	Solution solution(assignOpenGMVariableIds(), 0);
+	const size_t npos = std::numeric_limits<size_t>::max();
+	const double infinity = std::numeric_limits<double>::infinity();
+	const bool allowLengthOneTracks = settings_->allowLengthOneTracks_;
+
+	auto getState = [&](const Variable& var) -> size_t
+	{
+		return var.getOpenGMVariableId() < 0 ? 0 : solution[var.getOpenGMVariableId()];
+	};
+	// energy difference of moving a variable one state up (down), infinite if it has no such state
+	auto getIncreaseCost = [&](const Variable& var) -> double
+	{
+		if(var.getOpenGMVariableId() < 0)
+			return infinity;
+		const std::vector<ValueType>& energies = stateEnergies[var.getOpenGMVariableId()];
+		size_t state = solution[var.getOpenGMVariableId()];
+		return state + 1 < energies.size() ? energies[state + 1] - energies[state] : infinity;
+	};
+	auto getDecreaseCost = [&](const Variable& var) -> double
+	{
+		size_t state = getState(var);
+		if(state == 0)
+			return infinity;
+		const std::vector<ValueType>& energies = stateEnergies[var.getOpenGMVariableId()];
+		return energies[state - 1] - energies[state];
+	};
+	auto getSegmentation = [&](size_t index) -> const SegmentationHypothesis& 
+	{
+		return (segmentationHypotheses_.begin() + index)->second;
+	};
+
+	// incoming links of every detection by index of their source, in compressed form
+	struct IncomingLink
+	{
+		const Variable* variable;
+		size_t src;
+	};
+	const size_t numSegmentations = segmentationHypotheses_.size();
+	std::vector<size_t> incomingOffsets(1, 0);
+	std::vector<IncomingLink> incomingLinks;
+	incomingOffsets.reserve(numSegmentations + 1);
+	incomingLinks.reserve(linkingHypotheses_.size());
+	for(size_t i = 0; i < numSegmentations; ++i)
+	{
+		for(auto link : getSegmentation(i).getIncomingLinks())
+		{
+			size_t src = segmentationHypotheses_.indexOf(link->getSrcId());
+			if(src != SegmentationHypothesisMap::npos)
+				incomingLinks.push_back({&link->getVariable(), src});
+		}
+		incomingOffsets.push_back(incomingLinks.size());
+	}
+
+	// tracks are found by dynamic programming over the detections in topological order of the links
+	std::vector<size_t> order = getTopologicalOrder();
+	if(order.size() != numSegmentations)
+		throw std::runtime_error("Approximate inference needs a tracking graph whose links do not form cycles");
+
+	// detections that are excluded together with each detection, and how many of those are active
+	std::vector< std::vector<size_t> > excludedBy(numSegmentations);
+	for(auto iter = exclusionConstraints_.begin(); iter != exclusionConstraints_.end() ; ++iter)
+	{
+		std::vector<size_t> indices;
+		for(auto& id : iter->getIds())
+		{
+			size_t index = segmentationHypotheses_.indexOf(id);
+			if(index != SegmentationHypothesisMap::npos)
+				indices.push_back(index);
+		}
+		for(size_t a : indices)
+			for(size_t b : indices)
+				if(a != b)
+					excludedBy[a].push_back(b);
+	}
+	std::vector<size_t> numActiveExclusions(numSegmentations, 0);
+
+	// a path sends one more object through some detections, each of which it passes in one of these ways:
+	// starting there by an appearance, arriving over an incoming link, extending the track that disappears there,
+	// or (only at its end) arriving over an incoming link at the start of a track, whose appearance it replaces
+	enum PathStepType { Start, Arrival, Extension, Junction };
+	struct PathStep
+	{
+		size_t index;
+		PathStepType type;
+		size_t link; // index into incomingLinks for Arrival and Junction
+	};
+	struct PathEnd
+	{
+		double cost;
+		PathStep step;
+		bool disappears; // false for paths that end at a Junction
+	};
+
+	// cheapest paths to every detection, and the cheapest way to leave it over an outgoing link
+	std::vector<double> startCosts(numSegmentations);
+	std::vector<double> arrivalCosts(numSegmentations);
+	std::vector<size_t> arrivalLinks(numSegmentations);
+	std::vector<double> leaveCosts(numSegmentations);
+	std::vector<PathStepType> leaveTypes(numSegmentations);
+	std::vector<char> touched(numSegmentations);
+
+	std::vector<PathEnd> pathEnds;
+	std::vector<PathStep> path;
+	numPaths = 0;
+	numPasses = 0;
+
+	while(true)
+	{
+		numPasses++;
+		pathEnds.clear();
+		for(size_t v : order)
+		{
+			const SegmentationHypothesis& seg = getSegmentation(v);
+			startCosts[v] = arrivalCosts[v] = leaveCosts[v] = infinity;
+			arrivalLinks[v] = npos;
+
+			// the same constraints as SegmentationHypothesis::verifySolution()
+			const size_t detection = getState(seg.getDetectionVariable());
+			const size_t appearance = getState(seg.getAppearanceVariable());
+			const size_t disappearance = getState(seg.getDisappearanceVariable());
+
+			double incomingCost = infinity;
+			size_t incomingLink = npos;
+			for(size_t k = incomingOffsets[v]; k < incomingOffsets[v + 1]; ++k)
+			{
+				double cost = leaveCosts[incomingLinks[k].src] + getIncreaseCost(*incomingLinks[k].variable);
+				if(cost < incomingCost)
+				{
+					incomingCost = cost;
+					incomingLink = k;
+				}
+			}
+
+			// tracks can only be joined where a single object appears (disappears), 
+			// otherwise appearance and incoming links (disappearance and outgoing links) would be active together
+			if(detection > 0 && appearance == 1)
+			{
+				double cost = incomingCost + getDecreaseCost(seg.getAppearanceVariable());
+				if(cost < 0)
+					pathEnds.push_back({cost, {v, Junction, incomingLink}, false});
+			}
+			if(detection > 0 && disappearance == 1)
+			{
+				leaveCosts[v] = getDecreaseCost(seg.getDisappearanceVariable());
+				leaveTypes[v] = Extension;
+			}
+
+			double detectionCost = getIncreaseCost(seg.getDetectionVariable());
+			if(!std::isfinite(detectionCost) || (detection == 0 && numActiveExclusions[v] > 0))
+				continue;
+
+			if((allowLengthOneTracks || disappearance == 0) && seg.getNumActiveIncomingLinks(solution) == 0)
+				startCosts[v] = getIncreaseCost(seg.getAppearanceVariable()) + detectionCost;
+			if(appearance == 0)
+			{
+				arrivalCosts[v] = incomingCost + detectionCost;
+				arrivalLinks[v] = incomingLink;
+			}
+
+			if(disappearance == 0)
+			{
+				leaveTypes[v] = startCosts[v] < arrivalCosts[v] ? Start : Arrival;
+				leaveCosts[v] = std::min(startCosts[v], arrivalCosts[v]);
+			}
+
+			if(getState(seg.getDivisionVariable()) > 0 || seg.getNumActiveOutgoingLinks(solution) > 0)
+				continue;
+			double disappearanceCost = getIncreaseCost(seg.getDisappearanceVariable());
+			if(allowLengthOneTracks && startCosts[v] + disappearanceCost < 0)
+				pathEnds.push_back({startCosts[v] + disappearanceCost, {v, Start, npos}, true});
+			if((allowLengthOneTracks || appearance == 0) && arrivalCosts[v] + disappearanceCost < 0)
+				pathEnds.push_back({arrivalCosts[v] + disappearanceCost, {v, Arrival, arrivalLinks[v]}, true});
+		}
+
+		// add the cheapest paths first, and all others whose detections were not affected by the paths added before
+		std::sort(pathEnds.begin(), pathEnds.end(), [](const PathEnd& a, const PathEnd& b) { return a.cost < b.cost; });
+		std::fill(touched.begin(), touched.end(), 0);
+		size_t numPassPaths = 0;
+		for(const PathEnd& end : pathEnds)
+		{
+			path.assign(1, end.step);
+			bool blocked = touched[end.step.index];
+			while(!blocked && (path.back().type == Arrival || path.back().type == Junction))
+			{
+				size_t v = incomingLinks[path.back().link].src;
+				path.push_back({v, leaveTypes[v], leaveTypes[v] == Arrival ? arrivalLinks[v] : npos});
+				blocked = touched[v];
+			}
+			if(blocked)
+				continue;
+
+			for(const PathStep& step : path)
+			{
+				const SegmentationHypothesis& seg = getSegmentation(step.index);
+				touched[step.index] = 1;
+				if(step.type == Start || step.type == Arrival)
+				{
+					if(solution[seg.getDetectionVariable().getOpenGMVariableId()]++ == 0)
+					{
+						for(size_t other : excludedBy[step.index])
+						{
+							numActiveExclusions[other]++;
+							touched[other] = 1;
+						}
+					}
+				}
+
+				if(step.type == Start)
+					solution[seg.getAppearanceVariable().getOpenGMVariableId()]++;
+				else if(step.type == Junction)
+					solution[seg.getAppearanceVariable().getOpenGMVariableId()]--;
+				else if(step.type == Extension)
+					solution[seg.getDisappearanceVariable().getOpenGMVariableId()]--;
+				if(step.type == Arrival || step.type == Junction)
+					solution[incomingLinks[step.link].variable->getOpenGMVariableId()]++;
+			}
+			if(end.disappears)
+				solution[getSegmentation(end.step.index).getDisappearanceVariable().getOpenGMVariableId()]++;
+			numPassPaths++;
+		}
+
+		numPaths += numPassPaths;
+		if(numPassPaths == 0)
+			break;
+	}
+
+	// let active detections divide by taking over tracks that appear right after them
+	numDivisions = 0;
+	for(size_t v = 0; v < numSegmentations; ++v)
+	{
+		const SegmentationHypothesis& seg = getSegmentation(v);
+		const Variable& division = seg.getDivisionVariable();
+		if(division.getOpenGMVariableId() < 0 || getState(division) > 0 || getState(seg.getDetectionVariable()) == 0)
+			continue;
+
+		// the two cheapest outgoing links to detections whose appearance they could replace
+		double bestCosts[2] = {infinity, infinity};
+		const LinkingHypothesis* bestLinks[2] = {nullptr, nullptr};
+		for(auto link : seg.getOutgoingLinks())
+		{
+			size_t dest = segmentationHypotheses_.indexOf(link->getDestId());
+			if(dest == SegmentationHypothesisMap::npos)
+				continue;
+			const Variable& childAppearance = getSegmentation(dest).getAppearanceVariable();
+			if(getState(childAppearance) == 0 
+				|| getState(childAppearance) > 1
+				|| (settings_->requireSeparateChildrenOfDivision_ && getState(link->getVariable()) > 0))
+				continue;
+
+			double cost = getIncreaseCost(link->getVariable()) + getDecreaseCost(childAppearance);
+			if(cost < bestCosts[0])
+			{
+				bestCosts[1] = bestCosts[0];
+				bestLinks[1] = bestLinks[0];
+				bestCosts[0] = cost;
+				bestLinks[0] = link;
+			}
+			else if(cost < bestCosts[1])
+			{
+				bestCosts[1] = cost;
+				bestLinks[1] = link;
+			}
+		}
+
+		// a detection that continues needs one more outgoing link, one that disappears needs two instead of the disappearance
+		std::vector<const LinkingHypothesis*> newLinks;
+		double cost = getIncreaseCost(division);
+		if(getState(seg.getDisappearanceVariable()) == 0)
+		{
+			newLinks.assign(bestLinks, bestLinks + 1);
+			cost += bestCosts[0];
+		}
+		else if(getState(seg.getDisappearanceVariable()) == 1 && getState(seg.getDetectionVariable()) == 1)
+		{
+			newLinks.assign(bestLinks, bestLinks + 2);
+			cost += bestCosts[0] + bestCosts[1] + getDecreaseCost(seg.getDisappearanceVariable());
+		}
+		if(newLinks.empty() || !(cost < 0))
+			continue;
+
+		solution[division.getOpenGMVariableId()]++;
+		if(newLinks.size() == 2)
+			solution[seg.getDisappearanceVariable().getOpenGMVariableId()]--;
+		for(const LinkingHypothesis* link : newLinks)
+		{
+			solution[link->getVariable().getOpenGMVariableId()]++;
+			const SegmentationHypothesis& child = segmentationHypotheses_.at(link->getDestId());
+			solution[child.getAppearanceVariable().getOpenGMVariableId()]--;
+		}
+		numDivisions++;
+	}
+
+	// external divisions replace the disappearance of their parent and the appearances of both children
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+	{
+		const Variable& division = iter->second.getVariable();
+		size_t parent = segmentationHypotheses_.indexOf(iter->second.getParentId());
+		if(division.getOpenGMVariableId() < 0 || parent == SegmentationHypothesisMap::npos 
+			|| getState(getSegmentation(parent).getDetectionVariable()) == 0)
+			continue;
+
+		bool parentDivides = false;
+		for(auto other : getSegmentation(parent).getOutgoingDivisions())
+			parentDivides = parentDivides || getState(other->getVariable()) > 0;
+		if(parentDivides)
+			continue;
+
+		double cost = getIncreaseCost(division) + getDecreaseCost(getSegmentation(parent).getDisappearanceVariable());
+		std::vector<const Variable*> childAppearances;
+		for(auto& childId : iter->second.getChildrenIds())
+		{
+			size_t child = segmentationHypotheses_.indexOf(childId);
+			if(child == SegmentationHypothesisMap::npos)
+				break;
+			childAppearances.push_back(&getSegmentation(child).getAppearanceVariable());
+			cost += getDecreaseCost(*childAppearances.back());
+		}
+		if(childAppearances.size() != iter->second.getChildrenIds().size() || !(cost < 0))
+			continue;
+
+		solution[division.getOpenGMVariableId()]++;
+		solution[getSegmentation(parent).getDisappearanceVariable().getOpenGMVariableId()]--;
+		for(const Variable* appearance : childAppearances)
+			solution[appearance->getOpenGMVariableId()]--;
+		numDivisions++;
+	}
+
+	return solution;
+}
+
+Solution Model::inferApproximate(const std::vector<ValueType>& weights, bool computeLowerBound)
+{
+	// also checks the number of weights, and the lower bound needs them in the OpenGM model
+	setInferenceWeights(weights);
+	Telemetry::ScopedPhase phase(telemetry_, "approximate");
+	const double infinity = std::numeric_limits<double>::infinity();
+	std::vector< std::vector<ValueType> > stateEnergies = computeStateEnergies(weights);
+	size_t numPaths, numPasses, numDivisions;
+	Solution solution = addPathsApproximately(stateEnergies, numPaths, numPasses, numDivisions);
+
+	// the energy is the sum of all unaries, as the constraints are satisfied
+	foundSolutionValue_ = 0.0;
+	for(size_t i = 0; i < solution.size(); ++i)
+		foundSolutionValue_ += stateEnergies[i][solution[i]];
+	lastLowerBound_ = -infinity;
+	phase.stop();
+
+	telemetry_.setCounter("approximate.paths", numPaths);
+	telemetry_.setCounter("approximate.passes", numPasses);
+	telemetry_.setCounter("approximate.divisions", numDivisions);
+	telemetry_.setCounter("approximate.energy", foundSolutionValue_);
+	std::cout << "Found " << numPaths << " tracks and " << numDivisions << " divisions approximately" << std::endl;
+	std::cout << "solution has energy: " << foundSolutionValue_ << std::endl;
+
+	if(computeLowerBound)
+	{
+		lastLowerBound_ = solveRelaxation(false).lowerBound_;
+		double gap = (foundSolutionValue_ - lastLowerBound_) / std::max(std::abs(foundSolutionValue_), 1e-10);
+		telemetry_.setCounter("approximate.lowerBound", lastLowerBound_);
+		telemetry_.setCounter("approximate.gap", gap);
+		std::cout << "LP relaxation lower bound: " << lastLowerBound_ << ", relative gap: " << gap << std::endl;
+	}
+
+	return solution;
+}
+
+Relaxation Model::solveRelaxation(bool verbose)
+{
+	if(openGMModelWeights_ != &inferenceWeights_)
+		initializeOpenGMModel(inferenceWeights_);
+
+	MipInference::Parameter optimizerParam = getMipInferenceParameter(verbose);
+	optimizerParam.integerConstraints_ = false;
+	Telemetry::ScopedPhase setupPhase(telemetry_, "solverSetup");
+	MipInference optimizer(model_, optimizerParam, *getSolverBackends(1).front());
+	setupPhase.stop();
+
+	Telemetry::ScopedPhase solvePhase(telemetry_, "solve");
+	optimizer.infer();
+	solvePhase.stop();
+	telemetry_.addToCounter("solver.solves", 1);
+	optimizer.getSolverResult().addToTelemetry(telemetry_);
+
+	Relaxation relaxation;
+	relaxation.lowerBound_ = optimizer.value();
+	optimizer.arg(relaxation.largestStates_);
+	relaxation.stateValues_.resize(model_.numberOfVariables());
+	relaxation.values_.assign(model_.numberOfVariables(), 0.0);
+	const double tolerance = 1e-6;
+	for(size_t i = 0; i < model_.numberOfVariables(); i++)
+	{
+		relaxation.stateValues_[i] = optimizer.getIndicatorValues(i);
+		double fractionality = 0.0;
+		for(size_t state = 0; state < relaxation.stateValues_[i].size(); state++)
+		{
+			double value = relaxation.stateValues_[i][state];
+			relaxation.values_[i] += state * value;
+			fractionality = std::max(fractionality, std::min(std::abs(value), std::abs(1.0 - value)));
+		}
+		relaxation.maxFractionality_ = std::max(relaxation.maxFractionality_, fractionality);
+		if(fractionality > tolerance)
+			relaxation.numFractional_++;
+	}
+
+	telemetry_.setCounter("relaxation.lowerBound", relaxation.lowerBound_);
+	telemetry_.setCounter("relaxation.fractionalVariables", relaxation.numFractional_);
+	telemetry_.setCounter("relaxation.maxFractionality", relaxation.maxFractionality_);
+	std::cout << "LP relaxation has energy " << relaxation.lowerBound_ << ", " << relaxation.numFractional_ << " of " 
+			  << model_.numberOfVariables() << " variables are fractional (at most " << relaxation.maxFractionality_ << " from integral)" << std::endl;
+	return relaxation;
+}
+
+Solution Model::roundStateValues(const std::vector< std::vector<ValueType> >& stateEnergies,
+								 const std::vector< std::vector<double> >& stateValues,
+								 double& energy)
+{
+	auto getEnergy = [&](const Solution& solution)
+	{
+		double energy = 0.0;
+		for(size_t i = 0; i < solution.size(); ++i)
+			energy += stateEnergies[i][solution[i]];
+		return energy;
+	};
+
+	const double tolerance = 1e-6;
+	Solution largestStates(stateEnergies.size(), 0);
+	bool isFractional = false;
+	for(size_t i = 0; i < largestStates.size() && i < stateValues.size(); ++i)
+	{
+		const std::vector<double>& values = stateValues[i];
+		if(!values.empty())
+			largestStates[i] = std::max_element(values.begin(), values.end()) - values.begin();
+		for(double value : values)
+			isFractional = isFractional || std::min(std::abs(value), std::abs(1.0 - value)) > tolerance;
+	}
+
+	// an integral labeling is optimal, and rounding often leaves a valid tracking if only few variables are fractional
+	Solution solution;
+	energy = std::numeric_limits<double>::infinity();
+	if(verifySolution(largestStates))
+	{
+		solution = largestStates;
+		energy = getEnergy(solution);
+	}
+
+	// repair by taking the paths that the values support first: a state with value x gets a bonus of x times 
+	// more than the largest energy difference within any variable, so it is preferred over any state with less support
+	if(isFractional || solution.empty())
+	{
+		double largestRange = 0.0;
+		for(auto& energies : stateEnergies)
+		{
+			if(!energies.empty())
+				largestRange = std::max(largestRange, *std::max_element(energies.begin(), energies.end()) - *std::min_element(energies.begin(), energies.end()));
+		}
+		const double bonus = 2.0 * largestRange + 1.0;
+
+		std::vector< std::vector<ValueType> > guidedEnergies = stateEnergies;
+		for(size_t i = 0; i < guidedEnergies.size() && i < stateValues.size(); ++i)
+		{
+			for(size_t state = 0; state < guidedEnergies[i].size() && state < stateValues[i].size(); ++state)
+				guidedEnergies[i][state] -= bonus * stateValues[i][state];
+		}
+
+		size_t numPaths, numPasses, numDivisions;
+		Solution repaired = addPathsApproximately(guidedEnergies, numPaths, numPasses, numDivisions);
+		double repairedEnergy = getEnergy(repaired);
+		if(repairedEnergy < energy)
+		{
+			solution = repaired;
+			energy = repairedEnergy;
+		}
+	}
+	return solution;
+}
+
+Relaxation Model::inferRelaxation(const std::vector<ValueType>& weights, bool round)
+{
+	setInferenceWeights(weights);
+	std::cout << "Using " << settings_->solverBackend_ << " optimizer" << std::endl;
+	Relaxation relaxation = solveRelaxation(true);
+	lastLowerBound_ = relaxation.lowerBound_;
+	foundSolutionValue_ = relaxation.lowerBound_;
+	if(!round)
+		return relaxation;
+
+	Telemetry::ScopedPhase phase(telemetry_, "rounding");
+	std::vector< std::vector<ValueType> > stateEnergies = computeStateEnergies(weights);
+	relaxation.rounded_ = roundStateValues(stateEnergies, relaxation.stateValues_, relaxation.roundedEnergy_);
+	phase.stop();
+
+	foundSolutionValue_ = relaxation.roundedEnergy_;
+	lastSolution_ = relaxation.rounded_;
+	double gap = (relaxation.roundedEnergy_ - relaxation.lowerBound_) / std::max(std::abs(relaxation.roundedEnergy_), 1e-10);
+	telemetry_.setCounter("relaxation.roundedEnergy", relaxation.roundedEnergy_);
+	telemetry_.setCounter("relaxation.gap", gap);
+	std::cout << "Rounded solution has energy " << relaxation.roundedEnergy_ << ", relative gap: " << gap << std::endl;
+	return relaxation;
+}
+
+std::vector<size_t> Model::getTopologicalOrder() const
+{
+	const size_t numSegmentations = segmentationHypotheses_.size();
+	std::vector<size_t> numUnorderedPredecessors(numSegmentations, 0);
+	size_t index = 0;
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter, ++index)
+	{
+		for(auto link : iter->second.getIncomingLinks())
+			if(segmentationHypotheses_.indexOf(link->getSrcId()) != SegmentationHypothesisMap::npos)
+				numUnorderedPredecessors[index]++;
+	}
+
+	// Kahn's algorithm, detections on cycles never run out of predecessors
+	std::vector<size_t> order;
+	order.reserve(numSegmentations);
+	for(size_t i = 0; i < numSegmentations; ++i)
+		if(numUnorderedPredecessors[i] == 0)
+			order.push_back(i);
+	for(size_t next = 0; next < order.size(); ++next)
+	{
+		for(auto link : (segmentationHypotheses_.begin() + order[next])->second.getOutgoingLinks())
+		{
+			size_t dest = segmentationHypotheses_.indexOf(link->getDestId());
+			if(dest != SegmentationHypothesisMap::npos && --numUnorderedPredecessors[dest] == 0)
+				order.push_back(dest);
+		}
+	}
+	return order;
+}
+
+size_t Model::presolve(const std::vector<ValueType>& weights, double& fixedEnergy)
+{
+	Telemetry::ScopedPhase phase(telemetry_, "presolve");
+	clearPresolve();
+	fixedEnergy = 0.0;
+
+	const size_t numSegmentations = segmentationHypotheses_.size();
+	std::vector<size_t> order = getTopologicalOrder();
+	if(order.size() != numSegmentations)
+	{
+		std::cout << "Skipping presolve, the links of the tracking graph form cycles" << std::endl;
+		return 0;
+	}
+	if(hasFixedStates())
+	{
+		std::cout << "Skipping presolve, some variables are fixed to a state" << std::endl;
+		return 0;
+	}
+
+	const double infinity = std::numeric_limits<double>::infinity();
+	// the cheapest energy difference between two neighboring states, which sending one object more or 
+	// less through the variable changes the energy by at least. Infinite if it is not part of the model.
+	auto getMarginalCost = [&](const Variable& var, const std::vector<size_t>& weightIds) -> double
+	{
+		std::vector<ValueType> energies = var.getStateEnergies(settings_->statesShareWeights_, weights, weightIds);
+		double cost = infinity;
+		for(size_t state = 1; state < energies.size(); ++state)
+			cost = std::min(cost, energies[state] - energies[state - 1]);
+		return cost;
+	};
+	auto getSegmentation = [&](size_t index) -> SegmentationHypothesis& 
+	{
+		return (segmentationHypotheses_.begin() + index)->second;
+	};
+	auto getLinkCost = [&](const LinkingHypothesis* link)
+	{
+		return getMarginalCost(link->getVariable(), linkWeightIds_);
+	};
+	auto hasExternalDivision = [&](PointerRange<DivisionHypothesis> divisions)
+	{
+		for(auto division : divisions)
+			if(division->getVariable().hasFeatures())
+				return true;
+		return false;
+	};
+
+	// Detections that may divide, or are part of an external division, can emit or absorb more objects than reach them,
+	// so paths through them are never ruled out. The same holds for detections without features, which must not be pruned.
+	std::vector<double> detectionCost(numSegmentations), appearanceCost(numSegmentations), disappearanceCost(numSegmentations);
+	std::vector<bool> isAnchor(numSegmentations);
+	for(size_t i = 0; i < numSegmentations; ++i)
+	{
+		SegmentationHypothesis& seg = getSegmentation(i);
+		detectionCost[i] = getMarginalCost(seg.getDetectionVariable(), detWeightIds_);
+		appearanceCost[i] = getMarginalCost(seg.getAppearanceVariable(), appWeightIds_);
+		disappearanceCost[i] = getMarginalCost(seg.getDisappearanceVariable(), disWeightIds_);
+		isAnchor[i] = !seg.getDetectionVariable().hasFeatures() 
+			|| (seg.getDivisionVariable().hasFeatures() && seg.getOutgoingLinks().size() > 1)
+			|| hasExternalDivision(seg.getIncomingDivisions()) || hasExternalDivision(seg.getOutgoingDivisions());
+	}
+
+	// cheapest cost of a path from any appearance that leaves (enters) a detection, including the detection itself, 
+	// and to any disappearance that enters (leaves) it. Infinite if there is no such path.
+	auto passThrough = [&](size_t i, double pathCost) -> double
+	{
+		if(!std::isfinite(detectionCost[i]) || pathCost == infinity)
+			return infinity;
+		return isAnchor[i] ? -infinity : pathCost + detectionCost[i];
+	};
+	std::vector<double> arriving(numSegmentations, infinity), leaving(numSegmentations, infinity);
+	for(size_t i : order)
+	{
+		arriving[i] = appearanceCost[i];
+		for(auto link : getSegmentation(i).getIncomingLinks())
+			arriving[i] = std::min(arriving[i], leaving[segmentationHypotheses_.indexOf(link->getSrcId())] + getLinkCost(link));
+		leaving[i] = passThrough(i, arriving[i]);
+	}
+	std::vector<double> departing(numSegmentations, infinity), entering(numSegmentations, infinity);
+	for(auto iter = order.rbegin(); iter != order.rend(); ++iter)
+	{
+		size_t i = *iter;
+		departing[i] = disappearanceCost[i];
+		for(auto link : getSegmentation(i).getOutgoingLinks())
+			departing[i] = std::min(departing[i], getLinkCost(link) + entering[segmentationHypotheses_.indexOf(link->getDestId())]);
+		entering[i] = passThrough(i, departing[i]);
+	}
+
+	// Every object in a solution takes such a path, and removing it from a path whose cheapest cost is positive
+	// lowers the energy without violating constraints. So everything only found on these paths stays off.
+	auto isPositive = [&](double a, double b) { return a == infinity || b == infinity || a + b > 0; };
+	size_t numPrunedDetections = 0, numPrunedLinks = 0, numPrunedVariables = 0;
+	auto prune = [&](Variable& var)
+	{
+		if(var.hasFeatures() && !var.isPruned())
+		{
+			var.setPruned(true);
+			numPrunedVariables++;
+		}
+	};
+	std::vector<bool> isPruned(numSegmentations, false);
+	for(size_t i = 0; i < numSegmentations; ++i)
+	{
+		SegmentationHypothesis& seg = getSegmentation(i);
+		if(seg.getDetectionVariable().hasFeatures() 
+			&& (!std::isfinite(detectionCost[i]) || isPositive(arriving[i], entering[i]) || isPositive(leaving[i], departing[i])))
+		{
+			isPruned[i] = true;
+			numPrunedDetections++;
+			prune(seg.getDetectionVariable());
+			if(seg.getOutgoingLinks().size() > 1)
+				prune(seg.getDivisionVariable());
+			prune(seg.getAppearanceVariable());
+			prune(seg.getDisappearanceVariable());
+			continue;
+		}
+
+		if(isPositive(appearanceCost[i], entering[i]))
+			prune(seg.getAppearanceVariable());
+		if(isPositive(leaving[i], disappearanceCost[i]))
+			prune(seg.getDisappearanceVariable());
+	}
+
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+	{
+		LinkingHypothesis& link = iter->second;
+		size_t src = segmentationHypotheses_.indexOf(link.getSrcId());
+		size_t dest = segmentationHypotheses_.indexOf(link.getDestId());
+		if(isPruned[src] || isPruned[dest] || isPositive(leaving[src], getLinkCost(&link) + entering[dest]))
+		{
+			numPrunedLinks += link.getVariable().hasFeatures();
+			prune(link.getVariable());
+		}
+	}
+
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+	{
+		DivisionHypothesis& division = iter->second;
+		bool prunedChild = false;
+		for(auto& childId : division.getChildrenIds())
+			prunedChild = prunedChild || isPruned[segmentationHypotheses_.indexOf(childId)];
+		if(prunedChild || isPruned[segmentationHypotheses_.indexOf(division.getParentId())])
+			prune(division.getVariable());
+	}
+
+	// pruned variables stay in state 0, whose energy is part of every solution
+	auto addFixedEnergy = [&](const Variable& var, const std::vector<size_t>& weightIds)
+	{
+		if(var.isPruned() && var.getOpenGMVariableId() >= 0)
+			fixedEnergy += var.getStateEnergies(settings_->statesShareWeights_, weights, weightIds)[0];
+	};
+	assignOpenGMVariableIds();
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		addFixedEnergy(iter->second.getDetectionVariable(), detWeightIds_);
+		addFixedEnergy(iter->second.getDivisionVariable(), divWeightIds_);
+		addFixedEnergy(iter->second.getAppearanceVariable(), appWeightIds_);
+		addFixedEnergy(iter->second.getDisappearanceVariable(), disWeightIds_);
+	}
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+		addFixedEnergy(iter->second.getVariable(), linkWeightIds_);
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+		addFixedEnergy(iter->second.getVariable(), externalDivWeightIds_);
+
+	telemetry_.setCounter("presolve.prunedVariables", numPrunedVariables);
+	telemetry_.setCounter("presolve.prunedDetections", numPrunedDetections);
+	telemetry_.setCounter("presolve.prunedLinks", numPrunedLinks);
+	std::cout << "Presolve pruned " << numPrunedVariables << " variables, of them " << numPrunedDetections 
+			  << " detections and " << numPrunedLinks << " links" << std::endl;
+	return numPrunedVariables;
+}
+
+void Model::clearPresolve()
+{
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		iter->second.getDetectionVariable().setPruned(false);
+		iter->second.getDivisionVariable().setPruned(false);
+		iter->second.getAppearanceVariable().setPruned(false);
+		iter->second.getDisappearanceVariable().setPruned(false);
+	}
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+		iter->second.getVariable().setPruned(false);
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+		iter->second.getVariable().setPruned(false);
+}
+
+Solution Model::inferPresolved(const std::vector<ValueType>& weights)
+{
+	double fixedEnergy = 0.0;
+	presolve(weights, fixedEnergy);
+
+	Solution solution;
+	if(settings_->decomposeIntoComponents_)
+	{
+		// the component models leave out the pruned variables, so they cannot be reused by other calls
+		componentModels_.clear();
+		solution = inferComponentwise();
+		componentModels_.clear();
+	}
+	else
+	{
+		// the pruned variables are not added, model_ stays the full model
+		GraphicalModelType reducedModel;
+		Subgraph fullGraph = getFullGraph();
+		addSubgraphToOpenGMModel(reducedModel, inferenceWeights_, fullGraph, settings_->buildNumThreads_);
+		std::vector<const Variable*> variables = getSubgraphVariables(fullGraph, reducedModel.numberOfVariables());
+		recordModelStatistics({&reducedModel});
+		std::cout << "Reduced model has " << telemetry_.getCounter("opengm.indicatorVariables") << " indicator variables" << std::endl;
+
+		// map the start into the reduced model, and its solution back to the layout of the full model
+		solution.assign(assignOpenGMVariableIds(), 0);
+		Solution reducedStart;
+		if(lastSolution_.size() == solution.size())
+		{
+			reducedStart.assign(variables.size(), 0);
+			for(size_t i = 0; i < variables.size(); ++i)
+				if(variables[i] != nullptr)
+					reducedStart[i] = lastSolution_[variables[i]->getOpenGMVariableId()];
+		}
+
+		Solution reducedSolution;
+		foundSolutionValue_ = optimizeOpenGMModel(reducedModel, reducedSolution, true, *getSolverBackends(1).front(), &reducedStart);
+		for(size_t i = 0; i < variables.size(); ++i)
+			if(variables[i] != nullptr)
+				solution[variables[i]->getOpenGMVariableId()] = reducedSolution[i];
+	}
+	clearPresolve();
+
+	foundSolutionValue_ += fixedEnergy;
+	lastSolution_ = solution;
+	std::cout << "solution has energy: " << foundSolutionValue_ << " including the pruned variables" << std::endl;
+	return solution;
+}
+
+void Model::setInferenceWeights(const std::vector<ValueType>& weights)
+{
+	size_t numWeights = computeNumWeights();
+	assert(weights.size() == numWeights);
+	if(weights.size() != numWeights)
+	{
+		std::cout << "Provided length of vector with initial weights has wrong length!" << std::endl;
+		throw std::runtime_error("Provided length of vector with initial weights has wrong length!");
+	}
+
+	// only replace the weights object if its size changes, the OpenGM models keep pointers to it
+	if(inferenceWeights_.numberOfWeights() != numWeights)
+		inferenceWeights_ = WeightsType(numWeights);
+	for(size_t i = 0; i < weights.size(); i++)
+		inferenceWeights_.setWeight(i, weights[i]);
+	evaluationWeights_ = &inferenceWeights_;
+}
+
+Solution Model::infer(const std::vector<ValueType>& weights, const Solution& start)
+{
+	if(settings_->slidingWindowSize_ > 0)
+		throw std::runtime_error("The sliding window solves every window from scratch and cannot start from a given solution");
+
+	computeNumWeights();
+	size_t numVariables = assignOpenGMVariableIds();
+	if(start.size() != numVariables)
+		std::cout << "Ignoring starting solution with " << start.size() << " instead of " << numVariables << " variables" << std::endl;
+	else if(!verifySolution(start))
+		std::cout << "Ignoring starting solution because it violates constraints" << std::endl;
+	else
+		startSolution_ = start;
+	if(startSolution_.empty())
+		telemetry_.addToCounter("start.ignored", 1);
+	return infer(weights);
+}
+
+void Model::prepareStartSolution(const std::vector<ValueType>& weights, Solution& start)
+{
+	if(!start.empty())
+	{
+		// a given start replaces the previous solutions, also those of the components
+		lastSolution_.swap(start);
+		componentSolutions_.assign(componentSolutions_.size(), Solution());
+	}
+	else if(lastSolution_.empty() && settings_->greedyWarmStart_)
+	{
+		lastSolution_ = constructGreedySolution(weights);
+	}
+}
+
+void Model::setSolutionCache(const std::string& directory, size_t maxEntries)
+{
+	settings_->solutionCacheDirectory_ = directory;
+	settings_->solutionCacheSize_ = maxEntries;
+}
+
+void Model::limitNumThreads(size_t numThreads)
+{
+	numThreads = std::max((size_t)1, numThreads);
+	// 0 means all CPU cores
+	auto limit = [&](size_t& setting, size_t maximum)
+	{
+		setting = (setting == 0) ? maximum : std::min(setting, maximum);
+	};
+	limit(settings_->buildNumThreads_, numThreads);
+	limit(settings_->componentNumThreads_, numThreads);
+	limit(settings_->optimizerNumThreads_, std::max((size_t)1, numThreads / settings_->componentNumThreads_));
+}
+
+std::string Model::computeSolutionCacheKey(const std::vector<ValueType>& weights) const
+{
+	ContentHash hash;
+	// changes of the formulation must change the key as well
+	hash.add(std::string("mht solution cache key 1"));
+
+	auto addVariable = [&](const Variable& var)
+	{
+		hash.add(var.getFeatures());
+		hash.add(var.getFixedState());
+	};
+	hash.add(segmentationHypotheses_.size());
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		const SegmentationHypothesis& seg = iter->second;
+		hash.add(seg.getId());
+		hash.add(seg.getTimestep());
+		addVariable(seg.getDetectionVariable());
+		addVariable(seg.getDivisionVariable());
+		addVariable(seg.getAppearanceVariable());
+		addVariable(seg.getDisappearanceVariable());
+	}
+	hash.add(linkingHypotheses_.size());
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+	{
+		hash.add(iter->second.getSrcId());
+		hash.add(iter->second.getDestId());
+		addVariable(iter->second.getVariable());
+	}
+	hash.add(divisionHypotheses_.size());
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+	{
+		hash.add(iter->second.getParentId());
+		hash.add(iter->second.getChildrenIds());
+		addVariable(iter->second.getVariable());
+	}
+	hash.add(exclusionConstraints_.size());
+	for(auto iter = exclusionConstraints_.begin(); iter != exclusionConstraints_.end() ; ++iter)
+		hash.add(iter->getIds());
+
+	// thread counts, verbosity and the cache itself do not change the result
+	hash.add(settings_->statesShareWeights_);
+	hash.add(settings_->allowPartialMergerAppearance_);
+	hash.add(settings_->allowLengthOneTracks_);
+	hash.add(settings_->requireSeparateChildrenOfDivision_);
+	hash.add(settings_->optimizerEpGap_);
+	hash.add(settings_->decomposeIntoComponents_);
+	hash.add(settings_->useFlowSolver_);
+	hash.add(settings_->slidingWindowSize_);
+	hash.add(settings_->slidingWindowStep_);
+	hash.add(settings_->dualDecompositionChunkSize_);
+	hash.add(settings_->dualDecompositionOverlap_);
+	hash.add(settings_->dualDecompositionIterations_);
+	hash.add(settings_->greedyWarmStart_);
+	hash.add(settings_->presolve_);
+	hash.add(settings_->solverBackend_);
+
+	hash.add(weights);
+	return hash.hexDigest();
+}
+
+Solution Model::infer(const std::vector<ValueType>& weights, bool withIntegerConstraints)
+{
+	if(!withIntegerConstraints || settings_->solutionCacheDirectory_.empty())
+		return inferUncached(weights, withIntegerConstraints);
+
+	// fails for weights of the wrong length, as inferUncached() would
+	setInferenceWeights(weights);
+
+	Telemetry::ScopedPhase lookupPhase(telemetry_, "cache");
+	SolutionCache cache(settings_->solutionCacheDirectory_, settings_->solutionCacheSize_);
+	std::string key = computeSolutionCacheKey(weights);
+	Solution solution;
+	double energy = 0.0;
+	bool found = cache.load(key, solution, energy) && solution.size() == assignOpenGMVariableIds();
+	lookupPhase.stop();
+
+	if(found)
+	{
+		std::cout << "Found solution in cache " << settings_->solutionCacheDirectory_ << ", it has energy: " << energy << std::endl;
+		telemetry_.addToCounter("cache.hits", 1);
+		startSolution_.clear();
+		hasPendingEdits_ = false;
+		foundSolutionValue_ = energy;
+		lastSolution_ = solution;
+		return solution;
+	}
+
+	telemetry_.addToCounter("cache.misses", 1);
+	solution = inferUncached(weights, withIntegerConstraints);
+	Telemetry::ScopedPhase storePhase(telemetry_, "cache");
+	cache.store(key, solution, foundSolutionValue_);
+	return solution;
+}
+
+Solution Model::inferUncached(const std::vector<ValueType>& weights, bool withIntegerConstraints)
+{
+	// a start given to infer(weights, start) is only used by this call, after edits the previous solution is carried over
+	Solution start;
+	start.swap(startSolution_);
+	if(hasPendingEdits_ && start.empty() && lastSolution_.empty())
+		start = getStartAfterEdits(weights);
+	hasPendingEdits_ = false;
+
+	if(withIntegerConstraints && settings_->slidingWindowSize_ > 0)
+		return inferSlidingWindow(weights, settings_->slidingWindowSize_, settings_->slidingWindowStep_);
+
+	if(withIntegerConstraints && settings_->dualDecompositionChunkSize_ > 0)
+		return inferDualDecomposition(weights, settings_->dualDecompositionChunkSize_, settings_->dualDecompositionOverlap_);
+
+	// use weights that were given, models built by previous calls see the new values as well
+	setInferenceWeights(weights);
+
+	if(withIntegerConstraints && settings_->useFlowSolver_ && isFlowProblem())
+	{
+		std::cout << "Using min-cost-flow solver" << std::endl;
+		Solution solution;
+		if(inferMinCostFlow(weights, solution))
+			return solution;
+		std::cout << "Flow graph contains cycles of negative cost, falling back to the ILP" << std::endl;
+	}
+
+	if(withIntegerConstraints && settings_->presolve_)
+	{
+		std::cout << "Using " << settings_->solverBackend_ << " optimizer" << std::endl;
+		prepareStartSolution(weights, start);
+		return inferPresolved(weights);
+	}
+
+	if(withIntegerConstraints && settings_->decomposeIntoComponents_)
+	{
+		std::cout << "Using " << settings_->solverBackend_ << " optimizer" << std::endl;
+		prepareStartSolution(weights, start);
+		return inferComponentwise();
+	}
+
+	if(openGMModelWeights_ != &inferenceWeights_)
+		initializeOpenGMModel(inferenceWeights_);
+	else
+		std::cout << "Reusing opengm model with new weights" << std::endl;
+
+	if(withIntegerConstraints)
+	{
+		std::cout << "Using " << settings_->solverBackend_ << " optimizer" << std::endl;
+		prepareStartSolution(weights, start);
+		Solution solution;
+		foundSolutionValue_ = optimizeOpenGMModel(model_, solution, true, *getSolverBackends(1).front(), &lastSolution_);
+		lastSolution_ = solution;
+		std::cout << "solution has energy: " << foundSolutionValue_ << std::endl;
+		return solution;
+	}
+	else
+	{
+		std::cout << "Using " << settings_->solverBackend_ << " optimizer" << std::endl;
+		Relaxation relaxation = solveRelaxation(true);
+		foundSolutionValue_ = relaxation.lowerBound_;
+		return relaxation.largestStates_;
+	}
+}
+
+std::vector<Solution> Model::inferWithWeightSequence(const std::vector< std::vector<ValueType> >& weightSequence, 
+													  std::vector<double>& energies)
+{
+	std::vector<Solution> solutions;
+	energies.clear();
+	for(size_t i = 0; i < weightSequence.size(); ++i)
+	{
+		std::cout << "Solving for weight vector " << i + 1 << " of " << weightSequence.size() << std::endl;
+		solutions.push_back(infer(weightSequence[i]));
+		energies.push_back(foundSolutionValue_);
+	}
+	return solutions;
+}
+
+void Model::addCommittedFlowConstraintsToOpenGMModel(
+	GraphicalModelType& model,
+	const SegmentationHypothesis& segmentation,
+	const std::function<bool(const Variable&)>& isFree,
+	const Solution& solution)
+{
+	auto getValue = [&](const Variable& var) -> int
+	{
+		return var.getOpenGMVariableId() >= 0 ? (int)solution[var.getOpenGMVariableId()] : 0;
+	};
+
+	const int detection = getValue(segmentation.getDetectionVariable());
+	const int division = getValue(segmentation.getDivisionVariable());
+	const int appearance = getValue(segmentation.getAppearanceVariable());
+	const int disappearance = getValue(segmentation.getDisappearanceVariable());
+	FactorBuffer buffer(model);
+
+	// outgoing: sum of free outgoing links and divisions = detection + division - disappearance - committed outgoing flow
+	{
+		LinearConstraintFunctionType::LinearConstraintType outgoingConstraint;
+		std::vector<LabelType> factorVariables;
+		std::vector<LabelType> constraintShape;
+		int remainingFlow = detection + division - disappearance;
+
+		LinearConstraintFunctionType::LinearConstraintType separateChildrenConstraint;
+		std::vector<LabelType> separateChildrenFactorVariables;
+		std::vector<LabelType> separateChildrenShape;
+		int remainingChildren = 2 * division;
+
+		for(auto link : segmentation.getOutgoingLinks())
+		{
+			const Variable& var = link->getVariable();
+			if(isFree(var))
+			{
+				addOpenGMVariableStateToConstraint(outgoingConstraint, var.getOpenGMVariableId(),
+					1.0, constraintShape, factorVariables, buffer);
+				addOpenGMVariableToConstraint(separateChildrenConstraint, var.getOpenGMVariableId(),
+					1, 1.0, separateChildrenShape, separateChildrenFactorVariables, buffer);
+			}
+			else
+			{
+				remainingFlow -= getValue(var);
+				if(getValue(var) == 1)
+					remainingChildren--;
+			}
+		}
+
+		LinearConstraintFunctionType::LinearConstraintType onlyOneDivisionConstraint;
+		std::vector<LabelType> onlyOneFactorVariables;
+		std::vector<LabelType> onlyOneConstraintShape;
+		int remainingDivisions = 1;
+
+		for(auto externalDivision : segmentation.getOutgoingDivisions())
+		{
+			const Variable& var = externalDivision->getVariable();
+			if(isFree(var))
+			{
+				addOpenGMVariableStateToConstraint(outgoingConstraint, var.getOpenGMVariableId(),
+					1.0, constraintShape, factorVariables, buffer);
+				addOpenGMVariableToConstraint(onlyOneDivisionConstraint, var.getOpenGMVariableId(),
+					1, 1.0, onlyOneConstraintShape, onlyOneFactorVariables, buffer);
+			}
+			else
+			{
+				remainingFlow -= getValue(var);
+				remainingDivisions -= getValue(var);
+			}
+		}
+
+		if(factorVariables.size() > 0)
+		{
+			outgoingConstraint.setBound(remainingFlow);
+			outgoingConstraint.setConstraintOperator(LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::Equal);
+			addConstraintToOpenGMModel(outgoingConstraint, constraintShape, factorVariables, buffer);
+		}
+
+		if(onlyOneFactorVariables.size() > 0)
+		{
+			onlyOneDivisionConstraint.setBound(remainingDivisions);
+			onlyOneDivisionConstraint.setConstraintOperator(LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::LessEqual);
+			addConstraintToOpenGMModel(onlyOneDivisionConstraint, onlyOneConstraintShape, onlyOneFactorVariables, buffer);
+		}
+
+		if(settings_->requireSeparateChildrenOfDivision_ && separateChildrenFactorVariables.size() > 0 && remainingChildren > 0)
+		{
+			separateChildrenConstraint.setBound(remainingChildren);
+			separateChildrenConstraint.setConstraintOperator(LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::GreaterEqual);
+			addConstraintToOpenGMModel(separateChildrenConstraint, separateChildrenShape, separateChildrenFactorVariables, buffer);
+		}
+	}
+
+	// incoming: sum of free incoming links and divisions = detection - appearance - committed incoming flow
+	{
+		LinearConstraintFunctionType::LinearConstraintType incomingConstraint;
+		std::vector<LabelType> factorVariables;
+		std::vector<LabelType> constraintShape;
+		int remainingFlow = detection - appearance;
+
+		auto addIncoming = [&](const Variable& var)
+		{
+			if(isFree(var))
+				addOpenGMVariableStateToConstraint(incomingConstraint, var.getOpenGMVariableId(),
+					1.0, constraintShape, factorVariables, buffer);
+			else
+				remainingFlow -= getValue(var);
+		};
+
+		for(auto link : segmentation.getIncomingLinks())
+			addIncoming(link->getVariable());
+		for(auto externalDivision : segmentation.getIncomingDivisions())
+			addIncoming(externalDivision->getVariable());
+
+		if(factorVariables.size() > 0)
+		{
+			incomingConstraint.setBound(remainingFlow);
+			incomingConstraint.setConstraintOperator(LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::Equal);
+			addConstraintToOpenGMModel(incomingConstraint, constraintShape, factorVariables, buffer);
+		}
+	}
+
+	buffer.addToModel(model);
+}
+
+Solution Model::inferSlidingWindow(const std::vector<ValueType>& weights, size_t windowSize, size_t stepSize, FrameCallback frameCallback)
+{
+	if(windowSize == 0 || stepSize == 0 || stepSize > windowSize)
+		throw std::runtime_error("Sliding window needs a size > 0 and a step between 1 and the window size");
+
+	setInferenceWeights(weights);
+
+	// sort the timesteps and find the frame index of every segmentation hypothesis
+	std::map<int, size_t> frameIndices;
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		if(iter->second.getTimestep() < 0)
+		{
+			std::stringstream error;
+			error << "Sliding window tracking needs a timestep for every segmentation hypothesis, but " << iter->first << " has none";
+			throw std::runtime_error(error.str());
+		}
+		frameIndices[iter->second.getTimestep()] = 0;
+	}
+
+	std::vector<int> timesteps;
+	for(auto& frameIndex : frameIndices)
+	{
+		frameIndex.second = timesteps.size();
+		timesteps.push_back(frameIndex.first);
+	}
+	const size_t numFrames = timesteps.size();
+	auto getFrame = [&](const IdLabelType& id) { return frameIndices[segmentationHypotheses_.at(id).getTimestep()]; };
+
+	// sort all hypotheses into frames: segmentations and exclusions by their own timestep, 
+	// links and divisions by the timestep of their source and the last timestep they reach
+	std::vector< std::vector<SegmentationHypothesis*> > frameSegmentations(numFrames);
+	std::vector< std::vector<ExclusionConstraint*> > frameExclusions(numFrames);
+	std::vector< std::vector<LinkingHypothesis*> > frameOutgoingLinks(numFrames);
+	std::vector< std::vector<DivisionHypothesis*> > frameOutgoingDivisions(numFrames);
+	std::map<const Variable*, size_t> lastFrames;
+
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+		frameSegmentations[getFrame(iter->first)].push_back(&iter->second);
+
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+	{
+		size_t srcFrame = getFrame(iter->second.getSrcId());
+		size_t destFrame = getFrame(iter->second.getDestId());
+		if(destFrame <= srcFrame)
+			throw std::runtime_error("Sliding window tracking needs all links to point forward in time");
+		frameOutgoingLinks[srcFrame].push_back(&iter->second);
+		lastFrames[&iter->second.getVariable()] = destFrame;
+	}
+
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+	{
+		size_t parentFrame = getFrame(iter->second.getParentId());
+		size_t lastFrame = parentFrame;
+		for(auto& childId : iter->second.getChildrenIds())
+		{
+			if(getFrame(childId) <= parentFrame)
+				throw std::runtime_error("Sliding window tracking needs all divisions to point forward in time");
+			lastFrame = std::max(lastFrame, getFrame(childId));
+		}
+		frameOutgoingDivisions[parentFrame].push_back(&iter->second);
+		lastFrames[&iter->second.getVariable()] = lastFrame;
+	}
+
+	for(auto& exclusion : getMergedExclusionConstraints())
+	{
+		size_t frame = getFrame(exclusion.getIds().at(0));
+		for(auto& id : exclusion.getIds())
+		{
+			if(getFrame(id) != frame)
+				throw std::runtime_error("Sliding window tracking needs all exclusion constraints to stay within one timestep");
+		}
+		frameExclusions[frame].push_back(&exclusion);
+	}
+
+	std::cout << "Tracking " << numFrames << " timesteps in a sliding window of size " << windowSize 
+			  << " with step " << stepSize << std::endl;
+	// the window models are not kept, only the numbers of variables of the whole movie are recorded
+	recordModelStatistics({});
+
+	// the solution is kept in the layout of the full model, so every variable needs its id of the full model 
+	// whenever it is not part of the window model that is being built
+	Solution solution(assignOpenGMVariableIds(), 0);
+
+	// links and divisions that start in a committed frame but are not committed yet
+	std::vector<LinkingHypothesis*> pendingLinks;
+	std::vector<DivisionHypothesis*> pendingDivisions;
+
+	for(size_t windowStart = 0; windowStart < numFrames; windowStart += stepSize)
+	{
+		size_t windowEnd = std::min(windowStart + windowSize, numFrames);
+		// the last window commits all remaining frames
+		size_t commitEnd = windowEnd == numFrames ? numFrames : windowStart + stepSize;
+
+		Subgraph window;
+		window.links_ = pendingLinks;
+		window.divisions_ = pendingDivisions;
+		for(size_t frame = windowStart; frame < windowEnd; ++frame)
+		{
+			window.segmentations_.insert(window.segmentations_.end(), frameSegmentations[frame].begin(), frameSegmentations[frame].end());
+			window.exclusions_.insert(window.exclusions_.end(), frameExclusions[frame].begin(), frameExclusions[frame].end());
+			window.links_.insert(window.links_.end(), frameOutgoingLinks[frame].begin(), frameOutgoingLinks[frame].end());
+			window.divisions_.insert(window.divisions_.end(), frameOutgoingDivisions[frame].begin(), frameOutgoingDivisions[frame].end());
+		}
+
+		// remember the ids in the full model before the window model renumbers the variables
+		std::vector<int> linkIds, divisionIds, segmentationIds;
+		for(auto link : window.links_)
+			linkIds.push_back(link->getVariable().getOpenGMVariableId());
+		for(auto division : window.divisions_)
+			divisionIds.push_back(division->getVariable().getOpenGMVariableId());
+		for(auto segmentation : window.segmentations_)
+			segmentationIds.push_back(segmentation->getDetectionVariable().getOpenGMVariableId());
+
+		GraphicalModelType windowModel;
+		addSubgraphToOpenGMModel(windowModel, inferenceWeights_, window, settings_->buildNumThreads_);
+
+		// committed segmentations that are connected to free links or divisions must keep their flow
+		std::set<const Variable*> freeVariables;
+		for(auto link : window.links_)
+			freeVariables.insert(&link->getVariable());
+		for(auto division : window.divisions_)
+			freeVariables.insert(&division->getVariable());
+		auto isFree = [&](const Variable& var) { return freeVariables.count(&var) > 0; };
+
+		std::set<IdLabelType> committedIds;
+		for(auto link : pendingLinks)
+			committedIds.insert(link->getSrcId());
+		for(auto division : pendingDivisions)
+		{
+			committedIds.insert(division->getParentId());
+			for(auto& childId : division->getChildrenIds())
+			{
+				if(getFrame(childId) < windowStart)
+					committedIds.insert(childId);
+			}
+		}
+		for(auto& id : committedIds)
+			addCommittedFlowConstraintsToOpenGMModel(windowModel, segmentationHypotheses_.at(id), isFree, solution);
+
+		std::vector<const Variable*> windowVariables = getSubgraphVariables(window, windowModel.numberOfVariables());
+
+		// give the variables of the window their ids in the full model back
+		for(size_t i = 0; i < window.links_.size(); ++i)
+			window.links_[i]->assignOpenGMVariableIds(linkIds[i]);
+		for(size_t i = 0; i < window.divisions_.size(); ++i)
+			window.divisions_[i]->assignOpenGMVariableIds(divisionIds[i]);
+		for(size_t i = 0; i < window.segmentations_.size(); ++i)
+			window.segmentations_[i]->assignOpenGMVariableIds(segmentationIds[i]);
+
+		std::cout << "Solving timesteps " << timesteps[windowStart] << " to " << timesteps[windowEnd - 1] 
+				  << " with " << windowModel.numberOfVariables() << " variables" << std::endl;
+		Solution windowSolution;
+		optimizeOpenGMModel(windowModel, windowSolution, false, *getSolverBackends(1).front());
+
+		// committed variables are never part of a later window, so all other entries will still be overwritten
+		for(size_t i = 0; i < windowVariables.size(); ++i)
+		{
+			if(windowVariables[i] != nullptr)
+				solution[windowVariables[i]->getOpenGMVariableId()] = windowSolution[i];
+		}
+
+		// links and divisions reaching beyond the committed frames stay pending
+		auto isPending = [&](const Variable& var) { return lastFrames[&var] >= commitEnd; };
+		std::vector<LinkingHypothesis*> nextPendingLinks;
+		for(auto link : window.links_)
+		{
+			if(getFrame(link->getSrcId()) < commitEnd && isPending(link->getVariable()))
+				nextPendingLinks.push_back(link);
+		}
+		std::vector<DivisionHypothesis*> nextPendingDivisions;
+		for(auto division : window.divisions_)
+		{
+			if(getFrame(division->getParentId()) < commitEnd && isPending(division->getVariable()))
+				nextPendingDivisions.push_back(division);
+		}
+		pendingLinks.swap(nextPendingLinks);
+		pendingDivisions.swap(nextPendingDivisions);
+
+		if(frameCallback)
+		{
+			for(size_t frame = windowStart; frame < commitEnd; ++frame)
+				frameCallback(timesteps[frame], solution);
+		}
+
+		if(commitEnd == numFrames)
+			break;
+	}
+
+	// the energy of the whole solution, which is the sum of all unaries
+	foundSolutionValue_ = computeSolutionEnergy(solution, weights);
+	std::cout << "solution has energy: " << foundSolutionValue_ << std::endl;
+
+	return solution;
+}
+
+Solution Model::inferDualDecomposition(const std::vector<ValueType>& weights, size_t chunkSize, size_t overlap)
+{
+	if(chunkSize == 0)
+		throw std::runtime_error("Dual decomposition needs chunks of at least one timestep");
+
+	// also checks the number of weights
+	setInferenceWeights(weights);
+
+	// sort the timesteps and find the frame index of every segmentation hypothesis
+	std::map<int, size_t> frameIndices;
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		if(iter->second.getTimestep() < 0)
+		{
+			std::stringstream error;
+			error << "Dual decomposition needs a timestep for every segmentation hypothesis, but " << iter->first << " has none";
+			throw std::runtime_error(error.str());
+		}
+		frameIndices[iter->second.getTimestep()] = 0;
+	}
+	size_t numFrames = 0;
+	for(auto& frameIndex : frameIndices)
+		frameIndex.second = numFrames++;
+
+	std::vector< std::pair<size_t, LabelType> > columnStates;
+	std::vector<int> rowTimesteps;
+	LinearProgram program = buildLinearProgram(weights, &columnStates, &rowTimesteps);
+
+	// a chunk holds the rows of its own timesteps and of the first overlap timesteps of the following chunks.
+	// The rows that limit the states of a variable are added to every chunk with a copy of it by DualDecomposition.
+	std::vector< std::vector<size_t> > chunkRows((numFrames + chunkSize - 1) / chunkSize);
+	for(size_t row = 0; row < rowTimesteps.size(); ++row)
+	{
+		if(rowTimesteps[row] < 0)
+			continue;
+		size_t frame = frameIndices[rowTimesteps[row]];
+		size_t chunk = frame / chunkSize;
+		chunkRows[chunk].push_back(row);
+		while(chunk > 0 && frame < chunk * chunkSize + overlap)
+			chunkRows[--chunk].push_back(row);
+	}
+	chunkRows.erase(std::remove_if(chunkRows.begin(), chunkRows.end(), 
+		[](const std::vector<size_t>& rows) { return rows.empty(); }), chunkRows.end());
+	if(chunkRows.empty())
+		chunkRows.resize(1);
+
+	Telemetry::ScopedPhase setupPhase(telemetry_, "solverSetup");
+	DualDecomposition decomposition(program, chunkRows);
+	setupPhase.stop();
+	telemetry_.setCounter("dualDecomposition.chunks", decomposition.getNumSubproblems());
+	telemetry_.setCounter("dualDecomposition.sharedColumns", decomposition.getNumSharedColumns());
+	std::cout << "Decomposing " << numFrames << " timesteps into " << decomposition.getNumSubproblems() << " chunks of " << chunkSize 
+			  << " timesteps, which share " << decomposition.getNumSharedColumns() << " of " << program.numColumns() << " columns" << std::endl;
+
+	// every iteration rounds the mean values of the copies to a valid labeling, of which the best is kept
+	std::vector< std::vector<ValueType> > stateEnergies = computeStateEnergies(weights);
+	Solution bestSolution;
+	double bestEnergy = std::numeric_limits<double>::infinity();
+	auto primalHeuristic = [&](const std::vector<double>& columnValues)
+	{
+		Telemetry::ScopedPhase phase(telemetry_, "rounding");
+		// state 0 takes what the other states leave, so variables without columns stay in state 0
+		std::vector< std::vector<double> > stateValues(stateEnergies.size());
+		for(size_t i = 0; i < stateValues.size(); ++i)
+		{
+			stateValues[i].assign(stateEnergies[i].size(), 0.0);
+			if(!stateValues[i].empty())
+				stateValues[i][0] = 1.0;
+		}
+		for(size_t c = 0; c < columnStates.size(); ++c)
+		{
+			std::vector<double>& values = stateValues[columnStates[c].first];
+			values[columnStates[c].second] = columnValues[c];
+			values[0] -= columnValues[c];
+		}
+
+		double energy;
+		Solution solution = roundStateValues(stateEnergies, stateValues, energy);
+		if(energy < bestEnergy)
+		{
+			bestEnergy = energy;
+			bestSolution.swap(solution);
+		}
+		return energy;
+	};
+
+	std::cout << "Using " << settings_->solverBackend_ << " optimizer" << std::endl;
+	DualDecomposition::Parameter parameter;
+	parameter.backends_ = getSolverBackends(getNumWorkerThreads(settings_->componentNumThreads_, decomposition.getNumSubproblems()));
+	parameter.solverParameters_.epGap = settings_->optimizerEpGap_;
+	parameter.solverParameters_.numThreads = settings_->optimizerNumThreads_;
+	parameter.numThreads_ = settings_->componentNumThreads_;
+	parameter.maxIterations_ = settings_->dualDecompositionIterations_;
+	parameter.relativeGap_ = settings_->optimizerEpGap_;
+	parameter.verbose_ = settings_->optimizerVerbose_;
+	lastLowerBound_ = decomposition.run(parameter, primalHeuristic, telemetry_);
+
+	if(bestSolution.empty())
+		throw std::runtime_error("Dual decomposition did not find a valid tracking");
+	foundSolutionValue_ = bestEnergy;
+	lastSolution_ = bestSolution;
+	double gap = (foundSolutionValue_ - lastLowerBound_) / std::max(std::abs(foundSolutionValue_), 1e-10);
+	telemetry_.setCounter("dualDecomposition.gap", gap);
+	std::cout << "solution has energy: " << foundSolutionValue_ << ", lower bound: " << lastLowerBound_ 
+			  << ", relative gap: " << gap << std::endl;
+	return bestSolution;
+}
+
+std::vector<ValueType> Model::learn()
+{
+	std::vector<helpers::ValueType> weights(computeNumWeights(), 0);
+	return learn(weights);
+}
+
+std::vector<ValueType> Model::learn(const std::vector<helpers::ValueType>& weights)
+{
+	return learnFromInstances(std::vector<Model*>(1, this), weights);
+}
+
+std::vector<ValueType> Model::learnFromInstances(const std::vector<Model*>& models, const std::vector<helpers::ValueType>& weights)
+{
+	if(models.empty())
+		throw std::runtime_error("Learning needs at least one annotated model");
+	Model& firstModel = *models.front();
+	for(Model* model : models)
+	{
+		if(model->computeNumWeights() != firstModel.computeNumWeights())
+			throw std::runtime_error("All models used for learning must have the same number of features of every kind!");
+	}
+
+	// prepare OpenGM for learning
+	DatasetType dataset;
+	WeightsType initialWeights(firstModel.computeNumWeights());
+
+	if(weights.size() != firstModel.computeNumWeights())
+	{
+		std::cout << "Provided length of vector with initial weights has wrong length!" << std::endl;
+		throw std::runtime_error("Provided length of vector with initial weights has wrong length!");
+	}
+	for(size_t i = 0; i < weights.size(); ++i)
+	{
+		initialWeights.setWeight(i, weights[i]);
+	}
+	
+	dataset.setWeights(initialWeights);
+
+	// every model builds its OpenGM model on the weights of the dataset and loads its GT from the subclass-specified method,
+	// which are independent of the other models. Only adding them to the dataset has to happen in order.
+	// Decomposed models contribute one instance per connected component, whose loss augmented inference is independent as well.
+	std::vector< std::vector<GraphicalModelType> > componentModels(models.size());
+	std::vector< std::vector<Solution> > groundTruths(models.size());
+	parallelFor(models.size(), firstModel.settings_->componentNumThreads_, [&](size_t m)
+	{
+		// decomposed models only build their component models, the full model would not be used
+		Model& model = *models[m];
+		if(model.settings_->decomposeIntoComponents_)
+		{
+			Solution gt = model.getGroundTruth();
+			model.buildComponentInstances(dataset.getWeights(), gt, componentModels[m], groundTruths[m]);
+		}
+		else
+		{
+			model.initializeOpenGMModel(dataset.getWeights());
+			groundTruths[m].push_back(model.getGroundTruth());
+		}
+	});
+
+	size_t numInstances = 0;
+	for(size_t m = 0; m < models.size(); ++m)
+	{
+		if(!models[m]->settings_->decomposeIntoComponents_)
+		{
+			dataset.pushBackInstance(models[m]->model_, groundTruths[m].front());
+			++numInstances;
+			continue;
+		}
+		// every component has at least one detection, and learning does not prune any
+		for(size_t c = 0; c < componentModels[m].size(); ++c)
+			dataset.pushBackInstance(componentModels[m][c], groundTruths[m][c]);
+		numInstances += componentModels[m].size();
+		componentModels[m].clear();
+	}
+	
+	std::cout << "Done setting up dataset with " << numInstances << " instances from " << models.size() << " models, creating learner" << std::endl;
+	opengm::learning::BundleOptimizer<ValueType>::Parameter learnerParam;
+	learnerParam.lambda = 1.00;
+	learnerParam.nonNegativeWeights = firstModel.settings_->nonNegativeWeightsOnly_;
+	opengm::learning::BundleOptimizer<ValueType> learner(learnerParam);
+
+	// loss augmented inference runs on the configured solver backend, as many instances at once as components would be solved at once.
+	// The learner's own QP is solved by OpenGM
+	LossAugmentedOracle oracle(dataset, firstModel.getMipInferenceParameter(true), firstModel.settings_->componentNumThreads_, firstModel.telemetry_);
+	WeightsType finalWeights = dataset.getWeights();
+
+	std::cout << "Calling learn()..." << std::endl;
+	opengm::learning::OptimizerResult result;
+	{
+		Telemetry::ScopedPhase phase(firstModel.telemetry_, "learn");
+		result = learner.optimize(oracle, finalWeights);
+	}
+
+	// the full models point to the weights of the dataset, which go out of scope, the next infer() builds them again
+	for(Model* model : models)
+	{
+		if(model->openGMModelWeights_ != &dataset.getWeights())
+			continue;
+		model->model_ = GraphicalModelType();
+		model->openGMModelWeights_ = nullptr;
+		model->evaluationWeights_ = nullptr;
+	}
+
+	if(result == opengm::learning::Error)
+		throw std::runtime_error("Structured learning did not succeed");
+	if(result == opengm::learning::ReachedSteps)
+		std::cout << "Structured learning stopped after the maximum number of iterations" << std::endl;
+	std::cout << "extracting weights" << std::endl;
+	std::vector<double> resultWeights;
+	for(size_t i = 0; i < finalWeights.numberOfWeights(); ++i)
+		resultWeights.push_back(finalWeights.getWeight(i));
+	return resultWeights;
+}
+
+double Model::evaluateSolution(const Solution& sol) const
+{
+	if(evaluationWeights_ == nullptr)
+		throw std::runtime_error("Solutions can only be evaluated after infer() or initializeOpenGMModel() provided weights");
+
+	std::vector<ValueType> weights(evaluationWeights_->numberOfWeights());
+	for(size_t i = 0; i < weights.size(); i++)
+		weights[i] = evaluationWeights_->getWeight(i);
+	return computeSolutionEnergy(sol, weights);
+}
+
+double Model::getLastSolutionValue() const
+{
+	return foundSolutionValue_;
+}
+
+double Model::getLastLowerBound() const
+{
+	return lastLowerBound_;
+}
+
+bool Model::verifySolution(const Solution& sol) const
+{
+	std::cout << "Checking solution..." << std::endl;
+
+	bool valid = true;
+
+	// check that all exclusions are obeyed
+	for(auto iter = exclusionConstraints_.begin(); iter != exclusionConstraints_.end() ; ++iter)
+	{
+		if(!iter->verifySolution(sol, segmentationHypotheses_))
+		{
+			std::cout << "\tFound violated exclusion constraint " << std::endl;
+			valid = false;
+		}
+	}
+
+	// check that flow-conservation + division constraints are satisfied
+	for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+	{
+		if(!iter->second.verifySolution(sol, settings_))
+		{
+			std::cout << "\tFound violated flow conservation constraint " << std::endl;
+			valid = false;
+		}
+	}
+
+	// check that fixed variables are in their state
+	forEachVariable(*this, [&](const Variable& var)
+	{
+		if(var.isFixed() && var.getOpenGMVariableId() >= 0 && sol[var.getOpenGMVariableId()] != (LabelType)var.getFixedState())
+		{
+			std::cout << "\tFound variable that is not in its fixed state " << std::endl;
+			valid = false;
+		}
+	});
+
+	return valid;
+}
+
+void Model::toDot(const std::string& filename, const Solution* sol) const
+{
+	std::ofstream out_file(filename.c_str());
+
+    if(!out_file.good())
+    {
+        throw std::runtime_error("Could not open file " + filename + " to save graph to");
+    }
+
+    out_file << "digraph G {\n";
+
+    // nodes
+    for(auto iter = segmentationHypotheses_.begin(); iter != segmentationHypotheses_.end() ; ++iter)
+		iter->second.toDot(out_file, sol);
+
+	// links
+	for(auto iter = linkingHypotheses_.begin(); iter != linkingHypotheses_.end() ; ++iter)
+		iter->second.toDot(out_file, sol);
+
+	// divisions
+	for(auto iter = divisionHypotheses_.begin(); iter != divisionHypotheses_.end() ; ++iter)
+		iter->second.toDot(out_file, sol);
 
 	// exclusions
 	for(auto iter = exclusionConstraints_.begin(); iter != exclusionConstraints_.end() ; ++iter)
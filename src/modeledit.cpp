@@ -0,0 +1,408 @@
+#include "model.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <iostream>
+
+using namespace helpers;
+
+namespace mht
+{
+
+namespace
+{
+
+std::string describeIds(const std::string& kind, const std::vector<IdLabelType>& ids)
+{
+	std::stringstream s;
+	s << kind;
+	for(auto& id : ids)
+		s << " " << id;
+	return s.str();
+}
+
+// divisions are stored by their parent and sorted children, see the readers
+DivisionHypothesis::IdType getDivisionKey(const IdLabelType& parentId, std::vector<IdLabelType> childrenIds)
+{
+	if(childrenIds.size() != 2)
+		throw std::runtime_error(describeIds("Division hypothesis must have two children, but has", childrenIds));
+	std::sort(childrenIds.begin(), childrenIds.end());
+	return std::make_tuple(parentId, childrenIds[0], childrenIds[1]);
+}
+
+// nullptr as oldPointer adds newPointer, nullptr as newPointer removes oldPointer
+template<class T>
+void replacePointer(std::vector<T*>& pointers, T* oldPointer, T* newPointer)
+{
+	if(oldPointer == nullptr)
+		pointers.push_back(newPointer);
+	else if(newPointer == nullptr)
+		pointers.erase(std::remove(pointers.begin(), pointers.end(), oldPointer), pointers.end());
+	else
+		std::replace(pointers.begin(), pointers.end(), oldPointer, newPointer);
+}
+
+template<class T>
+PointerRange<T> toRange(std::vector<T*>& pointers)
+{
+	return PointerRange<T>(pointers.data(), pointers.data() + pointers.size());
+}
+
+} // end anonymous namespace
+
+void Model::beginEdit(const std::vector<IdLabelType>& touchedIds)
+{
+	// every edit discards the last solution, so a new one means that the model has been solved since the first edit
+	if(!hasPendingEdits_ || !lastSolution_.empty())
+	{
+		const size_t numVariables = assignOpenGMVariableIds();
+		hasPreviousStates_ = lastSolution_.size() == numVariables;
+		forEachVariable(*this, [&](Variable& var)
+		{
+			int id = var.getOpenGMVariableId();
+			var.setPreviousState(hasPreviousStates_ && id >= 0 ? lastSolution_[id] : 0);
+		});
+		hasPendingEdits_ = true;
+	}
+	editedSegmentations_.insert(touchedIds.begin(), touchedIds.end());
+
+	// everything in the layout of the full model is outdated, the full OpenGM model is built again by the next solve.
+	// The components keep their solutions, inferComponentwise() only solves the edited ones again
+	lastSolution_.clear();
+	startSolution_.clear();
+	openGMModelWeights_ = nullptr;
+}
+
+void Model::updateAdjacency(const IdLabelType& id, const std::function<void(AdjacencyLists&)>& change)
+{
+	SegmentationHypothesis& segmentation = segmentationHypotheses_.at(id);
+	AdjacencyLists lists;
+	lists.incomingLinks_.assign(segmentation.getIncomingLinks().begin(), segmentation.getIncomingLinks().end());
+	lists.outgoingLinks_.assign(segmentation.getOutgoingLinks().begin(), segmentation.getOutgoingLinks().end());
+	lists.incomingDivisions_.assign(segmentation.getIncomingDivisions().begin(), segmentation.getIncomingDivisions().end());
+	lists.outgoingDivisions_.assign(segmentation.getOutgoingDivisions().begin(), segmentation.getOutgoingDivisions().end());
+	change(lists);
+
+	// setAdjacency() only accepts hypotheses that are not part of a model, the next solve numbers them again
+	segmentation.getDetectionVariable().resetOpenGMVariableId();
+	segmentation.getDivisionVariable().resetOpenGMVariableId();
+	segmentation.getAppearanceVariable().resetOpenGMVariableId();
+	segmentation.getDisappearanceVariable().resetOpenGMVariableId();
+
+	AdjacencyLists& stored = editedAdjacency_[id];
+	stored = std::move(lists);
+	segmentation.setAdjacency(toRange(stored.incomingLinks_), toRange(stored.outgoingLinks_), 
+		toRange(stored.incomingDivisions_), toRange(stored.outgoingDivisions_));
+	editedSegmentations_.insert(id);
+}
+
+void Model::replaceInAdjacency(const LinkingHypothesis& link, LinkingHypothesis* oldPointer, LinkingHypothesis* newPointer)
+{
+	updateAdjacency(link.getSrcId(), [&](AdjacencyLists& lists) { replacePointer(lists.outgoingLinks_, oldPointer, newPointer); });
+	updateAdjacency(link.getDestId(), [&](AdjacencyLists& lists) { replacePointer(lists.incomingLinks_, oldPointer, newPointer); });
+}
+
+void Model::replaceInAdjacency(const DivisionHypothesis& division, DivisionHypothesis* oldPointer, DivisionHypothesis* newPointer)
+{
+	updateAdjacency(division.getParentId(), [&](AdjacencyLists& lists) { replacePointer(lists.outgoingDivisions_, oldPointer, newPointer); });
+	for(auto& childId : division.getChildrenIds())
+		updateAdjacency(childId, [&](AdjacencyLists& lists) { replacePointer(lists.incomingDivisions_, oldPointer, newPointer); });
+}
+
+void Model::eraseLinkingHypothesis(const std::pair<IdLabelType, IdLabelType>& key)
+{
+	LinkingHypothesis* link = &linkingHypotheses_.at(key);
+	LinkingHypothesis* lastLink = &(linkingHypotheses_.end() - 1)->second;
+	replaceInAdjacency(*link, link, nullptr);
+	linkingHypotheses_.erase(key);
+	// the last link took the place of the erased one, which also changes the order of its component
+	if(lastLink != link)
+		replaceInAdjacency(*link, lastLink, link);
+}
+
+void Model::eraseDivisionHypothesis(const DivisionHypothesis::IdType& key)
+{
+	DivisionHypothesis* division = &divisionHypotheses_.at(key);
+	DivisionHypothesis* lastDivision = &(divisionHypotheses_.end() - 1)->second;
+	replaceInAdjacency(*division, division, nullptr);
+	divisionHypotheses_.erase(key);
+	if(lastDivision != division)
+		replaceInAdjacency(*division, lastDivision, division);
+}
+
+Solution Model::getStartAfterEdits(const std::vector<ValueType>& weights)
+{
+	if(!hasPreviousStates_)
+		return Solution();
+
+	computeNumWeights();
+	Telemetry::ScopedPhase phase(telemetry_, "rounding");
+	std::vector< std::vector<double> > stateValues(assignOpenGMVariableIds());
+	forEachVariable(*this, [&](const Variable& var)
+	{
+		if(var.getOpenGMVariableId() < 0)
+			return;
+		// fixed states win where they conflict with the previous solution
+		std::vector<double>& values = stateValues[var.getOpenGMVariableId()];
+		values.assign(var.getNumStates(), 0.0);
+		if(var.isFixed())
+			values[var.getFixedState()] = 1.0;
+		else
+			values[std::min(var.getPreviousState(), values.size() - 1)] = 0.5;
+	});
+
+	double energy = 0.0;
+	Solution start = roundStateValues(computeStateEnergies(weights), stateValues, energy);
+	// the repair does not know about fixed states
+	if(!start.empty() && !verifySolution(start))
+		start.clear();
+
+	if(start.empty())
+		std::cout << "Found no valid start from the solution before the edits" << std::endl;
+	else
+		std::cout << "Starting from the solution before the edits, repaired to energy " << energy << std::endl;
+	return start;
+}
+
+void Model::addSegmentationHypothesis(const SegmentationHypothesis& segmentation)
+{
+	if(segmentationHypotheses_.count(segmentation.getId()) > 0)
+		throw std::runtime_error(describeIds("Cannot add segmentation hypothesis, it exists already:", {segmentation.getId()}));
+
+	// the adjacency of the other segmentations moves with them, the new one has no links yet
+	beginEdit({segmentation.getId()});
+	segmentationHypotheses_.emplace(segmentation.getId(), segmentation);
+	updateAdjacency(segmentation.getId(), [](AdjacencyLists& lists) { lists = AdjacencyLists(); });
+}
+
+void Model::addLinkingHypothesis(const LinkingHypothesis& link)
+{
+	std::vector<IdLabelType> ids = {link.getSrcId(), link.getDestId()};
+	for(auto& id : ids)
+		if(segmentationHypotheses_.count(id) == 0)
+			throw std::runtime_error(describeIds("Cannot add link to a missing segmentation hypothesis:", {id}));
+	if(linkingHypotheses_.count(std::make_pair(link.getSrcId(), link.getDestId())) > 0)
+		throw std::runtime_error(describeIds("Cannot add link, it exists already:", ids));
+
+	beginEdit(ids);
+	// only when the storage grows do all links move, which needs all adjacency again
+	const bool isMoving = linkingHypotheses_.size() == linkingHypotheses_.capacity();
+	LinkingHypothesis& added = linkingHypotheses_.emplace(std::make_pair(link.getSrcId(), link.getDestId()), link).first->second;
+	if(isMoving)
+	{
+		forEachVariable(*this, [](Variable& var) { var.resetOpenGMVariableId(); });
+		buildAdjacency();
+	}
+	else
+		replaceInAdjacency(added, nullptr, &added);
+}
+
+void Model::addDivisionHypothesis(const DivisionHypothesis& division)
+{
+	std::vector<IdLabelType> ids = division.getChildrenIds();
+	DivisionHypothesis::IdType key = getDivisionKey(division.getParentId(), ids);
+	ids.push_back(division.getParentId());
+	for(auto& id : ids)
+		if(segmentationHypotheses_.count(id) == 0)
+			throw std::runtime_error(describeIds("Cannot add division with a missing segmentation hypothesis:", {id}));
+	if(divisionHypotheses_.count(key) > 0)
+		throw std::runtime_error(describeIds("Cannot add division, it exists already:", ids));
+
+	// the children of the stored division are sorted like those of the key, see the DivisionHypothesis constructor
+	beginEdit(ids);
+	const bool isMoving = divisionHypotheses_.size() == divisionHypotheses_.capacity();
+	DivisionHypothesis& added = divisionHypotheses_.emplace(key, division).first->second;
+	if(isMoving)
+	{
+		forEachVariable(*this, [](Variable& var) { var.resetOpenGMVariableId(); });
+		buildAdjacency();
+	}
+	else
+		replaceInAdjacency(added, nullptr, &added);
+}
+
+void Model::addExclusionConstraint(const std::vector<IdLabelType>& ids)
+{
+	if(ids.size() < 2)
+		throw std::runtime_error("Exclusion constraints need at least two segmentation hypotheses");
+	for(auto& id : ids)
+		if(segmentationHypotheses_.count(id) == 0)
+			throw std::runtime_error(describeIds("Cannot add exclusion constraint with a missing segmentation hypothesis:", {id}));
+
+	beginEdit(ids);
+	exclusionConstraints_.push_back(ExclusionConstraint(ids));
+	hasMergedExclusionConstraints_ = false;
+}
+
+void Model::removeSegmentationHypothesis(const IdLabelType& id)
+{
+	auto iter = segmentationHypotheses_.find(id);
+	if(iter == segmentationHypotheses_.end())
+		throw std::runtime_error(describeIds("Cannot remove missing segmentation hypothesis", {id}));
+
+	// collect the keys first, erasing moves the hypotheses
+	const SegmentationHypothesis& segmentation = iter->second;
+	std::vector<IdLabelType> touchedIds = {id};
+	std::vector< std::pair<IdLabelType, IdLabelType> > links;
+	for(auto& adjacentLinks : {segmentation.getIncomingLinks(), segmentation.getOutgoingLinks()})
+	{
+		for(auto link : adjacentLinks)
+		{
+			links.push_back(std::make_pair(link->getSrcId(), link->getDestId()));
+			touchedIds.push_back(link->getSrcId());
+			touchedIds.push_back(link->getDestId());
+		}
+	}
+	std::vector<DivisionHypothesis::IdType> divisions;
+	for(auto& adjacentDivisions : {segmentation.getIncomingDivisions(), segmentation.getOutgoingDivisions()})
+	{
+		for(auto division : adjacentDivisions)
+		{
+			divisions.push_back(getDivisionKey(division->getParentId(), division->getChildrenIds()));
+			touchedIds.push_back(division->getParentId());
+			touchedIds.insert(touchedIds.end(), division->getChildrenIds().begin(), division->getChildrenIds().end());
+		}
+	}
+
+	std::vector<ExclusionConstraint> exclusions;
+	for(auto& exclusion : exclusionConstraints_)
+	{
+		const std::vector<IdLabelType>& ids = exclusion.getIds();
+		if(std::find(ids.begin(), ids.end(), id) == ids.end())
+		{
+			exclusions.push_back(exclusion);
+			continue;
+		}
+		touchedIds.insert(touchedIds.end(), ids.begin(), ids.end());
+		std::vector<IdLabelType> remaining;
+		std::remove_copy(ids.begin(), ids.end(), std::back_inserter(remaining), id);
+		if(remaining.size() > 1)
+			exclusions.push_back(ExclusionConstraint(remaining));
+	}
+
+	beginEdit(touchedIds);
+	for(auto& key : links)
+		eraseLinkingHypothesis(key);
+	for(auto& key : divisions)
+		eraseDivisionHypothesis(key);
+	exclusionConstraints_.swap(exclusions);
+	hasMergedExclusionConstraints_ = false;
+
+	// the last segmentation takes the place of the erased one, with its adjacency, but the order of its component changes
+	editedSegmentations_.insert((segmentationHypotheses_.end() - 1)->first);
+	segmentationHypotheses_.erase(id);
+	editedAdjacency_.erase(id);
+}
+
+void Model::removeLinkingHypothesis(const IdLabelType& srcId, const IdLabelType& destId)
+{
+	if(linkingHypotheses_.count(std::make_pair(srcId, destId)) == 0)
+		throw std::runtime_error(describeIds("Cannot remove missing link", {srcId, destId}));
+
+	beginEdit({srcId, destId});
+	eraseLinkingHypothesis(std::make_pair(srcId, destId));
+}
+
+void Model::removeDivisionHypothesis(const IdLabelType& parentId, const std::vector<IdLabelType>& childrenIds)
+{
+	DivisionHypothesis::IdType key = getDivisionKey(parentId, childrenIds);
+	std::vector<IdLabelType> ids = childrenIds;
+	ids.push_back(parentId);
+	if(divisionHypotheses_.count(key) == 0)
+		throw std::runtime_error(describeIds("Cannot remove missing division", ids));
+
+	beginEdit(ids);
+	eraseDivisionHypothesis(key);
+}
+
+void Model::removeExclusionConstraint(const std::vector<IdLabelType>& ids)
+{
+	// a constraint that contains several of the ids is split into one constraint per contained id,
+	// together with all members that are not among the ids, which keeps all other pairs
+	std::vector<ExclusionConstraint> exclusions;
+	bool found = false;
+	for(auto& exclusion : exclusionConstraints_)
+	{
+		std::vector<IdLabelType> released, remaining;
+		for(auto& id : exclusion.getIds())
+		{
+			if(std::find(ids.begin(), ids.end(), id) != ids.end())
+				released.push_back(id);
+			else
+				remaining.push_back(id);
+		}
+		if(released.size() < 2)
+		{
+			exclusions.push_back(exclusion);
+			continue;
+		}
+
+		found = true;
+		for(auto& id : released)
+		{
+			std::vector<IdLabelType> split = remaining;
+			split.push_back(id);
+			if(split.size() > 1)
+				exclusions.push_back(ExclusionConstraint(split));
+		}
+	}
+	if(!found)
+		throw std::runtime_error(describeIds("Cannot remove exclusion, no constraint contains two of", ids));
+
+	beginEdit(ids);
+	exclusionConstraints_.swap(exclusions);
+	hasMergedExclusionConstraints_ = false;
+}
+
+void Model::fixVariable(Variable& variable, int state, const std::vector<IdLabelType>& touchedIds)
+{
+	if(state >= 0 && (!variable.hasFeatures() || (size_t)state >= variable.getNumStates()))
+		throw std::runtime_error(describeIds("Cannot fix variable to state " + std::to_string(state) + ", it does not have it, at", touchedIds));
+
+	beginEdit(touchedIds);
+	variable.setFixedState(state);
+}
+
+void Model::fixDetection(const IdLabelType& id, int state)
+{
+	auto iter = segmentationHypotheses_.find(id);
+	if(iter == segmentationHypotheses_.end())
+		throw std::runtime_error(describeIds("Cannot fix missing segmentation hypothesis", {id}));
+	fixVariable(iter->second.getDetectionVariable(), state, {id});
+}
+
+void Model::fixDivision(const IdLabelType& id, int state)
+{
+	auto iter = segmentationHypotheses_.find(id);
+	if(iter == segmentationHypotheses_.end())
+		throw std::runtime_error(describeIds("Cannot fix missing segmentation hypothesis", {id}));
+	fixVariable(iter->second.getDivisionVariable(), state, {id});
+}
+
+void Model::fixLink(const IdLabelType& srcId, const IdLabelType& destId, int state)
+{
+	auto iter = linkingHypotheses_.find(std::make_pair(srcId, destId));
+	if(iter == linkingHypotheses_.end())
+		throw std::runtime_error(describeIds("Cannot fix missing link", {srcId, destId}));
+	fixVariable(iter->second.getVariable(), state, {srcId, destId});
+}
+
+void Model::fixExternalDivision(const IdLabelType& parentId, const std::vector<IdLabelType>& childrenIds, int state)
+{
+	std::vector<IdLabelType> ids = childrenIds;
+	ids.push_back(parentId);
+	auto iter = divisionHypotheses_.find(getDivisionKey(parentId, childrenIds));
+	if(iter == divisionHypotheses_.end())
+		throw std::runtime_error(describeIds("Cannot fix missing division", ids));
+	fixVariable(iter->second.getVariable(), state, ids);
+}
+
+bool Model::hasFixedStates() const
+{
+	bool isFixed = false;
+	forEachVariable(*this, [&](const Variable& var) { isFixed = isFixed || var.isFixed(); });
+	return isFixed;
+}
+
+} // end namespace mht
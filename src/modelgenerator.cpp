@@ -0,0 +1,371 @@
+#include "modelgenerator.h"
+
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace helpers;
+
+namespace mht
+{
+
+// average distance between neighboring objects, in units of the generated plane
+static const double objectSpacing = 10.0;
+// energy of disappearing or appearing somewhere else than at the borders of the movie
+static const double appearanceEnergy = 5.0;
+// energy per squared deviation of the state from the observed number of objects in a detection
+static const double detectionEnergyScale = 4.0;
+
+ModelGenerator::ModelGenerator(const Parameters& parameters):
+	parameters_(parameters),
+	numDivisions_(0)
+{
+	if(parameters_.numFrames == 0 || parameters_.detectionsPerFrame == 0)
+		throw std::runtime_error("Generated models need at least one frame and one detection per frame");
+	if(parameters_.maxNumObjects == 0)
+		throw std::runtime_error("Generated models need maxNumObjects >= 1");
+	if(parameters_.numFeatures == 0)
+		throw std::runtime_error("Generated models need at least one feature");
+
+	gridSize_ = std::max<size_t>(1, std::ceil(std::sqrt(double(parameters_.detectionsPerFrame))));
+	fieldSize_ = objectSpacing * gridSize_;
+	motionSigma_ = 0.3 * objectSpacing;
+}
+
+void ModelGenerator::generate()
+{
+	randomGenerator_.seed(parameters_.seed);
+	std::uniform_real_distribution<double> unit(0.0, 1.0);
+	std::uniform_real_distribution<double> position(0.0, fieldSize_);
+	std::normal_distribution<double> motion(0.0, motionSigma_);
+	std::uniform_int_distribution<size_t> mergerCount(2, std::max<size_t>(2, parameters_.maxNumObjects));
+
+	const size_t numFrames = parameters_.numFrames;
+	const size_t perFrame = parameters_.detectionsPerFrame;
+
+	detections_.clear();
+	links_.clear();
+	exclusions_.clear();
+	detections_.reserve(numFrames * perFrame);
+	links_.reserve(numFrames * perFrame * parameters_.linkFanOut);
+	gridOffsets_.assign(numFrames, std::vector<size_t>());
+	gridEntries_.assign(numFrames, std::vector<size_t>());
+
+	// keep moving objects inside the field by reflecting them at its borders
+	auto reflect = [&](double value)
+	{
+		if(value < 0.0)
+			value = -value;
+		if(value > fieldSize_)
+			value = 2.0 * fieldSize_ - value;
+		return std::min(std::max(value, 0.0), fieldSize_);
+	};
+
+	auto cellOf = [&](double value)
+	{
+		return std::min(gridSize_ - 1, size_t(value / fieldSize_ * gridSize_));
+	};
+
+	for(size_t frame = 0; frame < numFrames; ++frame)
+	{
+		for(size_t i = 0; i < perFrame; ++i)
+		{
+			Detection detection;
+			bool isFalsePositive = unit(randomGenerator_) < parameters_.falsePositiveRate;
+			if(frame > 0 && !isFalsePositive)
+			{
+				// the same object as in the previous frame, moved a bit
+				const Detection& previous = detections_[(frame - 1) * perFrame + i];
+				detection.x = reflect(previous.x + motion(randomGenerator_));
+				detection.y = reflect(previous.y + motion(randomGenerator_));
+			}
+			else
+			{
+				detection.x = position(randomGenerator_);
+				detection.y = position(randomGenerator_);
+			}
+
+			detection.count = isFalsePositive ? 0 : 1;
+			if(!isFalsePositive && parameters_.maxNumObjects > 1 && unit(randomGenerator_) < parameters_.mergerRate)
+				detection.count = mergerCount(randomGenerator_);
+
+			detection.canDivide = !isFalsePositive && frame + 1 < numFrames && unit(randomGenerator_) < parameters_.divisionRate;
+			detections_.push_back(detection);
+		}
+
+		// sort the detections of this frame into grid cells
+		std::vector<size_t>& offsets = gridOffsets_[frame];
+		std::vector<size_t>& entries = gridEntries_[frame];
+		offsets.assign(gridSize_ * gridSize_ + 1, 0);
+		entries.resize(perFrame);
+		std::vector<size_t> cells(perFrame);
+		for(size_t i = 0; i < perFrame; ++i)
+		{
+			const Detection& detection = detections_[frame * perFrame + i];
+			cells[i] = cellOf(detection.y) * gridSize_ + cellOf(detection.x);
+			offsets[cells[i] + 1]++;
+		}
+		for(size_t c = 0; c < gridSize_ * gridSize_; ++c)
+			offsets[c + 1] += offsets[c];
+		std::vector<size_t> positions(offsets.begin(), offsets.end() - 1);
+		for(size_t i = 0; i < perFrame; ++i)
+			entries[positions[cells[i]]++] = frame * perFrame + i;
+	}
+
+	// links to the nearest detections of the next frame, divisions use the two closest ones
+	numDivisions_ = 0;
+	for(size_t frame = 0; frame + 1 < numFrames; ++frame)
+	{
+		for(size_t i = 0; i < perFrame; ++i)
+		{
+			size_t index = frame * perFrame + i;
+			Detection& detection = detections_[index];
+			std::vector<size_t> nearest = findNearest(frame + 1, detection.x, detection.y, parameters_.linkFanOut, detections_.size());
+			for(size_t dest : nearest)
+			{
+				double dx = detections_[dest].x - detection.x;
+				double dy = detections_[dest].y - detection.y;
+				links_.push_back({index, dest, std::sqrt(dx * dx + dy * dy)});
+			}
+
+			// division variables are only used for detections with at least two outgoing links
+			detection.canDivide = detection.canDivide && nearest.size() > 1;
+			if(detection.canDivide)
+				numDivisions_++;
+		}
+	}
+
+	// exclusions between overlapping detections, which are modelled as nearest neighbors within a frame
+	if(parameters_.exclusionRate > 0.0 && perFrame > 1)
+	{
+		for(size_t index = 0; index < detections_.size(); ++index)
+		{
+			if(unit(randomGenerator_) >= parameters_.exclusionRate)
+				continue;
+			const Detection& detection = detections_[index];
+			std::vector<size_t> nearest = findNearest(index / perFrame, detection.x, detection.y, 1, index);
+			if(!nearest.empty())
+				exclusions_.push_back(std::make_pair(std::min(index, nearest[0]), std::max(index, nearest[0])));
+		}
+		std::sort(exclusions_.begin(), exclusions_.end());
+		exclusions_.erase(std::unique(exclusions_.begin(), exclusions_.end()), exclusions_.end());
+	}
+}
+
+std::vector<size_t> ModelGenerator::findNearest(size_t frame, double x, double y, size_t k, size_t except)
+{
+	std::vector< std::pair<double, size_t> > candidates;
+	if(k == 0)
+		return std::vector<size_t>();
+
+	const double cellSize = fieldSize_ / gridSize_;
+	const long cx = std::min<long>(gridSize_ - 1, long(x / cellSize));
+	const long cy = std::min<long>(gridSize_ - 1, long(y / cellSize));
+	const std::vector<size_t>& offsets = gridOffsets_[frame];
+	const std::vector<size_t>& entries = gridEntries_[frame];
+
+	// scan rings of grid cells around the position, until the k-th candidate is closer than any unscanned cell
+	for(long ring = 0; ring <= long(gridSize_); ++ring)
+	{
+		for(long gy = cy - ring; gy <= cy + ring; ++gy)
+		{
+			for(long gx = cx - ring; gx <= cx + ring; ++gx)
+			{
+				if(std::max(std::abs(gx - cx), std::abs(gy - cy)) != ring)
+					continue;
+				if(gx < 0 || gy < 0 || gx >= long(gridSize_) || gy >= long(gridSize_))
+					continue;
+
+				size_t cell = gy * gridSize_ + gx;
+				for(size_t e = offsets[cell]; e < offsets[cell + 1]; ++e)
+				{
+					size_t index = entries[e];
+					if(index == except)
+						continue;
+					double dx = detections_[index].x - x;
+					double dy = detections_[index].y - y;
+					candidates.push_back(std::make_pair(dx * dx + dy * dy, index));
+				}
+			}
+		}
+
+		if(candidates.size() >= k)
+		{
+			std::partial_sort(candidates.begin(), candidates.begin() + k, candidates.end());
+			double scannedRadius = ring * cellSize;
+			if(candidates[k - 1].first <= scannedRadius * scannedRadius)
+				break;
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end());
+	std::vector<size_t> nearest;
+	for(size_t i = 0; i < std::min(k, candidates.size()); ++i)
+		nearest.push_back(candidates[i].second);
+	return nearest;
+}
+
+void ModelGenerator::writeId(std::ostream& stream, size_t index) const
+{
+#ifdef USE_STRING_IDS
+	stream << "\"" << index << "\"";
+#else
+	stream << index;
+#endif
+}
+
+void ModelGenerator::writeFeatures(std::ostream& stream, const std::vector<double>& firstFeatures)
+{
+	std::uniform_real_distribution<double> noise(0.0, 1.0);
+	stream << "[";
+	for(size_t state = 0; state < firstFeatures.size(); ++state)
+	{
+		if(state > 0)
+			stream << ", ";
+		stream << "[" << firstFeatures[state];
+		for(size_t f = 1; f < parameters_.numFeatures; ++f)
+			stream << ", " << noise(randomGenerator_);
+		stream << "]";
+	}
+	stream << "]";
+}
+
+void ModelGenerator::saveModelToJson(const std::string& filename)
+{
+	std::ofstream output(filename.c_str());
+	if(!output.good())
+		throw std::runtime_error("Could not open JSON model file for saving: " + filename);
+	writeModel(output);
+	if(!output.good())
+		throw std::runtime_error("Could not write JSON model file: " + filename);
+}
+
+void ModelGenerator::writeModel(std::ostream& stream)
+{
+	generate();
+
+	std::normal_distribution<double> observationNoise(0.0, 0.25);
+	std::uniform_real_distribution<double> divisionProbability(0.6, 0.95);
+	const size_t numStates = parameters_.maxNumObjects + 1;
+	const size_t perFrame = parameters_.detectionsPerFrame;
+	const size_t lastFrame = parameters_.numFrames - 1;
+
+	stream << "{\n";
+	stream << "\t\"settings\" : {\"statesShareWeights\" : true, \"optimizerVerbose\" : false},\n";
+
+	stream << "\t\"" << JsonTypeNames[JsonTypes::Segmentations] << "\" : [\n";
+	std::vector<double> energies(numStates);
+	for(size_t index = 0; index < detections_.size(); ++index)
+	{
+		const Detection& detection = detections_[index];
+		size_t frame = index / perFrame;
+		stream << (index > 0 ? ",\n" : "") << "\t\t{\"" << JsonTypeNames[JsonTypes::Id] << "\" : ";
+		writeId(stream, index);
+		stream << ", \"" << JsonTypeNames[JsonTypes::Timestep] << "\" : " << frame;
+
+		// the classifier sees the number of objects with some noise
+		double observedCount = std::max(0.0, detection.count + observationNoise(randomGenerator_));
+		for(size_t state = 0; state < numStates; ++state)
+			energies[state] = detectionEnergyScale * (state - observedCount) * (state - observedCount);
+		stream << ", \"" << JsonTypeNames[JsonTypes::Features] << "\" : ";
+		writeFeatures(stream, energies);
+
+		if(detection.canDivide && !parameters_.externalDivisions)
+		{
+			double p = divisionProbability(randomGenerator_);
+			stream << ", \"" << JsonTypeNames[JsonTypes::DivisionFeatures] << "\" : ";
+			writeFeatures(stream, {-std::log(1.0 - p), -std::log(p)});
+		}
+
+		// objects can enter and leave for free at the first and last frame
+		for(size_t state = 0; state < numStates; ++state)
+			energies[state] = (state == 0 || frame == 0) ? 0.0 : appearanceEnergy;
+		stream << ", \"" << JsonTypeNames[JsonTypes::AppearanceFeatures] << "\" : ";
+		writeFeatures(stream, energies);
+
+		for(size_t state = 0; state < numStates; ++state)
+			energies[state] = (state == 0 || frame == lastFrame) ? 0.0 : appearanceEnergy;
+		stream << ", \"" << JsonTypeNames[JsonTypes::DisappearanceFeatures] << "\" : ";
+		writeFeatures(stream, energies);
+		stream << "}";
+	}
+	stream << "\n\t],\n";
+
+	// moving n objects along a link costs n times the negative log likelihood of the distance under the motion model
+	stream << "\t\"" << JsonTypeNames[JsonTypes::Links] << "\" : [\n";
+	for(size_t i = 0; i < links_.size(); ++i)
+	{
+		const Link& link = links_[i];
+		double energy = 0.5 * (link.distance / motionSigma_) * (link.distance / motionSigma_);
+		for(size_t state = 0; state < numStates; ++state)
+			energies[state] = state * energy;
+
+		stream << (i > 0 ? ",\n" : "") << "\t\t{\"" << JsonTypeNames[JsonTypes::SrcId] << "\" : ";
+		writeId(stream, link.src);
+		stream << ", \"" << JsonTypeNames[JsonTypes::DestId] << "\" : ";
+		writeId(stream, link.dest);
+		stream << ", \"" << JsonTypeNames[JsonTypes::Features] << "\" : ";
+		writeFeatures(stream, energies);
+		stream << "}";
+	}
+	stream << "\n\t]";
+
+	if(parameters_.externalDivisions)
+	{
+		// links are ordered by source and distance, so the first two links of a detection go to its closest children
+		stream << ",\n\t\"" << JsonTypeNames[JsonTypes::Divisions] << "\" : [\n";
+		bool first = true;
+		for(size_t i = 0; i + 1 < links_.size(); ++i)
+		{
+			const Link& link = links_[i];
+			if(!detections_[link.src].canDivide || (i > 0 && links_[i - 1].src == link.src))
+				continue;
+
+			double p = divisionProbability(randomGenerator_);
+			stream << (first ? "" : ",\n") << "\t\t{\"" << JsonTypeNames[JsonTypes::Parent] << "\" : ";
+			writeId(stream, link.src);
+			stream << ", \"" << JsonTypeNames[JsonTypes::Children] << "\" : [";
+			writeId(stream, link.dest);
+			stream << ", ";
+			writeId(stream, links_[i + 1].dest);
+			stream << "], \"" << JsonTypeNames[JsonTypes::Features] << "\" : ";
+			writeFeatures(stream, {-std::log(1.0 - p), -std::log(p)});
+			stream << "}";
+			first = false;
+		}
+		stream << "\n\t]";
+	}
+
+	if(!exclusions_.empty())
+	{
+		stream << ",\n\t\"" << JsonTypeNames[JsonTypes::Exclusions] << "\" : [\n";
+		for(size_t i = 0; i < exclusions_.size(); ++i)
+		{
+			stream << (i > 0 ? ",\n" : "") << "\t\t[";
+			writeId(stream, exclusions_[i].first);
+			stream << ", ";
+			writeId(stream, exclusions_[i].second);
+			stream << "]";
+		}
+		stream << "\n\t]";
+	}
+
+	stream << "\n}\n";
+}
+
+std::vector<ValueType> ModelGenerator::getWeights() const
+{
+	// link, detection, division, appearance and disappearance weights, see Model::computeNumWeights()
+	size_t numTypes = numDivisions_ > 0 ? 5 : 4;
+	std::vector<ValueType> weights;
+	for(size_t type = 0; type < numTypes; ++type)
+	{
+		weights.push_back(1.0);
+		for(size_t f = 1; f < parameters_.numFeatures; ++f)
+			weights.push_back(0.1);
+	}
+	return weights;
+}
+
+} // end namespace mht
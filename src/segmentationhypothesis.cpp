@@ -4,26 +4,29 @@
 #include "settings.h"
 
 #include <stdexcept>
+#include <algorithm>
 
 using namespace helpers;
 
 namespace mht
 {
 
-SegmentationHypothesis::SegmentationHypothesis()
+SegmentationHypothesis::SegmentationHypothesis():
+	timestep_(-1)
 {}
 
 SegmentationHypothesis::SegmentationHypothesis(
 	helpers::IdLabelType id, 
-	const helpers::StateFeatureVector& detectionFeatures, 
-	const helpers::StateFeatureVector& divisionFeatures,
-	const helpers::StateFeatureVector& appearanceFeatures,
-	const helpers::StateFeatureVector& disappearanceFeatures):
+	helpers::StateFeatureVector detectionFeatures, 
+	helpers::StateFeatureVector divisionFeatures,
+	helpers::StateFeatureVector appearanceFeatures,
+	helpers::StateFeatureVector disappearanceFeatures):
 	id_(id),
-	detection_(detectionFeatures),
-	division_(divisionFeatures),
-	appearance_(appearanceFeatures),
-	disappearance_(disappearanceFeatures)
+	timestep_(-1),
+	detection_(std::move(detectionFeatures)),
+	division_(std::move(divisionFeatures)),
+	appearance_(std::move(appearanceFeatures)),
+	disappearance_(std::move(disappearanceFeatures))
 {}
 
 void SegmentationHypothesis::toDot(std::ostream& stream, const Solution* sol) const
@@ -51,94 +54,102 @@ void SegmentationHypothesis::toDot(std::ostream& stream, const Solution* sol) co
 	stream <<  "]; \n" << std::flush;
 }
 
-void SegmentationHypothesis::addIncomingConstraintToOpenGM(GraphicalModelType& model)
+void SegmentationHypothesis::addIncomingConstraintToOpenGM(FactorBuffer& buffer)
 {
 	// add constraint for sum of incoming = this label
 	LinearConstraintFunctionType::LinearConstraintType incomingConsistencyConstraint;
 	std::vector<LabelType> factorVariables;
 	std::vector<LabelType> constraintShape;
     
-    // add all incoming transition variables with positive coefficient
+    // add all incoming transition variables with positive coefficient, pruned ones are fixed to zero
     for(size_t i = 0; i < incomingLinks_.size(); ++i)
     {
+    	if(incomingLinks_[i]->getVariable().getOpenGMVariableId() < 0)
+    		continue;
     	// indicator variable references the i+1'th argument of the constraint function, and its state 1
     	addOpenGMVariableStateToConstraint(incomingConsistencyConstraint, incomingLinks_[i]->getVariable().getOpenGMVariableId(),
-    		1.0, constraintShape, factorVariables, model);
+    		1.0, constraintShape, factorVariables, buffer);
     }
 
     // add all incoming division variables with positive coefficient
     for(size_t i = 0; i < incomingDivisions_.size(); ++i)
     {
+    	if(incomingDivisions_[i]->getVariable().getOpenGMVariableId() < 0)
+    		continue;
     	// indicator variable references the i+1'th argument of the constraint function, and its state 1
     	addOpenGMVariableStateToConstraint(incomingConsistencyConstraint, incomingDivisions_[i]->getVariable().getOpenGMVariableId(),
-    		1.0, constraintShape, factorVariables, model);
+    		1.0, constraintShape, factorVariables, buffer);
     }
 
     // add this variable's state with negative coefficient
 	addOpenGMVariableStateToConstraint(incomingConsistencyConstraint, detection_.getOpenGMVariableId(),
-		-1.0, constraintShape, factorVariables, model);
+		-1.0, constraintShape, factorVariables, buffer);
 
     // add appearance with positive coefficient, if any
     if(appearance_.getOpenGMVariableId() >= 0)
     {
     	addOpenGMVariableStateToConstraint(incomingConsistencyConstraint, appearance_.getOpenGMVariableId(),
-    		1.0, constraintShape, factorVariables, model);
+    		1.0, constraintShape, factorVariables, buffer);
     }
 
     incomingConsistencyConstraint.setBound( 0 );
     incomingConsistencyConstraint.setConstraintOperator(LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::Equal);
 
-    addConstraintToOpenGMModel(incomingConsistencyConstraint, constraintShape, factorVariables, model);
+    addConstraintToOpenGMModel(incomingConsistencyConstraint, constraintShape, factorVariables, buffer);
 }
 
-void SegmentationHypothesis::addOutgoingConstraintToOpenGM(GraphicalModelType& model)
+void SegmentationHypothesis::addOutgoingConstraintToOpenGM(FactorBuffer& buffer)
 {
 	// add constraint for sum of ougoing = this label + division
 	LinearConstraintFunctionType::LinearConstraintType outgoingConsistencyConstraint;
 	std::vector<LabelType> factorVariables;
 	std::vector<LabelType> constraintShape;
    
-    // add all outgoing transition variables with positive coefficient
+    // add all outgoing transition variables with positive coefficient, pruned ones are fixed to zero
     for(size_t i = 0; i < outgoingLinks_.size(); ++i)
     {
+    	if(outgoingLinks_[i]->getVariable().getOpenGMVariableId() < 0)
+    		continue;
     	// indicator variable references the i+2'nd argument of the constraint function, and its state 1
         addOpenGMVariableStateToConstraint(outgoingConsistencyConstraint, outgoingLinks_[i]->getVariable().getOpenGMVariableId(),
-    		1.0, constraintShape, factorVariables, model);
+    		1.0, constraintShape, factorVariables, buffer);
     }
 
     // outgoing division variables take one unit of flow as well
     for(size_t i = 0; i < outgoingDivisions_.size(); ++i)
     {
+    	if(outgoingDivisions_[i]->getVariable().getOpenGMVariableId() < 0)
+    		continue;
     	// indicator variable references the i+1'th argument of the constraint function, and its state 1
     	addOpenGMVariableStateToConstraint(outgoingConsistencyConstraint, outgoingDivisions_[i]->getVariable().getOpenGMVariableId(),
-    		1.0, constraintShape, factorVariables, model);
+    		1.0, constraintShape, factorVariables, buffer);
     }
 
     // add this variable's state with negative coefficient
     addOpenGMVariableStateToConstraint(outgoingConsistencyConstraint, detection_.getOpenGMVariableId(),
-		-1.0, constraintShape, factorVariables, model);
+		-1.0, constraintShape, factorVariables, buffer);
 
 	// also the division node, if any
     if(division_.getOpenGMVariableId() >= 0)
     {
     	addOpenGMVariableStateToConstraint(outgoingConsistencyConstraint, division_.getOpenGMVariableId(),
-    		-1.0, constraintShape, factorVariables, model);
+    		-1.0, constraintShape, factorVariables, buffer);
     }
 
     // add appearance with positive coefficient, if any
     if(disappearance_.getOpenGMVariableId() >= 0)
     {
     	addOpenGMVariableStateToConstraint(outgoingConsistencyConstraint, disappearance_.getOpenGMVariableId(),
-    		1.0, constraintShape, factorVariables, model);
+    		1.0, constraintShape, factorVariables, buffer);
     }
 
     outgoingConsistencyConstraint.setBound( 0 );
     outgoingConsistencyConstraint.setConstraintOperator(LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::Equal);
 
-    addConstraintToOpenGMModel(outgoingConsistencyConstraint, constraintShape, factorVariables, model);
+    addConstraintToOpenGMModel(outgoingConsistencyConstraint, constraintShape, factorVariables, buffer);
 }
 
-void SegmentationHypothesis::addDivisionConstraintToOpenGM(GraphicalModelType& model, bool requireSeparateChildren)
+void SegmentationHypothesis::addDivisionConstraintToOpenGM(FactorBuffer& buffer, bool requireSeparateChildren)
 {
 	if(division_.getOpenGMVariableId() < 0)
 		return;
@@ -150,15 +161,15 @@ void SegmentationHypothesis::addDivisionConstraintToOpenGM(GraphicalModelType& m
 
 	// add this variable's state with negative coefficient
 	addOpenGMVariableToConstraint(divisionConstraint, detection_.getOpenGMVariableId(),
-		1, -1.0, constraintShape, factorVariables, model);
+		1, -1.0, constraintShape, factorVariables, buffer);
 
 	addOpenGMVariableToConstraint(divisionConstraint, division_.getOpenGMVariableId(),
-		1, 1.0, constraintShape, factorVariables, model);
+		1, 1.0, constraintShape, factorVariables, buffer);
 
     divisionConstraint.setBound( 0 );
     divisionConstraint.setConstraintOperator(LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::LessEqual);
 
-    addConstraintToOpenGMModel(divisionConstraint, constraintShape, factorVariables, model);
+    addConstraintToOpenGMModel(divisionConstraint, constraintShape, factorVariables, buffer);
     
     if(requireSeparateChildren)
     {
@@ -187,21 +198,23 @@ void SegmentationHypothesis::addDivisionConstraintToOpenGM(GraphicalModelType& m
 
 		for(auto link : outgoingLinks_)
 	    {
+	    	if(link->getVariable().getOpenGMVariableId() < 0)
+	    		continue;
 	    	addOpenGMVariableToConstraint(divisionConstraint2, link->getVariable().getOpenGMVariableId(),
-				1, -1.0, constraintShape2, factorVariables2, model);
+				1, -1.0, constraintShape2, factorVariables2, buffer);
 	    }
 
 		addOpenGMVariableToConstraint(divisionConstraint2, division_.getOpenGMVariableId(),
-			1, 2.0, constraintShape2, factorVariables2, model);
+			1, 2.0, constraintShape2, factorVariables2, buffer);
 
 	    divisionConstraint2.setBound( 0 );
 	    divisionConstraint2.setConstraintOperator(LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::LessEqual);
 
-	    addConstraintToOpenGMModel(divisionConstraint2, constraintShape2, factorVariables2, model);
+	    addConstraintToOpenGMModel(divisionConstraint2, constraintShape2, factorVariables2, buffer);
 	}
 }
 
-void SegmentationHypothesis::addExternalDivisionConstraintToOpenGM(GraphicalModelType& model)
+void SegmentationHypothesis::addExternalDivisionConstraintToOpenGM(FactorBuffer& buffer)
 {
 	LinearConstraintFunctionType::LinearConstraintType onlyOneDivisionConstraint;
 	std::vector<LabelType> onlyOneFactorVariables;
@@ -209,6 +222,9 @@ void SegmentationHypothesis::addExternalDivisionConstraintToOpenGM(GraphicalMode
 
 	for(auto division : outgoingDivisions_)
 	{
+		if(division->getVariable().getOpenGMVariableId() < 0)
+			continue;
+
 		// add constraint for sum of ougoing = this label + division
 		LinearConstraintFunctionType::LinearConstraintType divisionConstraint;
 		std::vector<LabelType> factorVariables;
@@ -216,36 +232,77 @@ void SegmentationHypothesis::addExternalDivisionConstraintToOpenGM(GraphicalMode
 
 		// add this variable's state with negative coefficient
 		addOpenGMVariableToConstraint(divisionConstraint, division->getVariable().getOpenGMVariableId(),
-			1, 1.0, constraintShape, factorVariables, model);
+			1, 1.0, constraintShape, factorVariables, buffer);
 
 		addOpenGMVariableToConstraint(divisionConstraint, detection_.getOpenGMVariableId(),
-			1, -1.0, constraintShape, factorVariables, model);
+			1, -1.0, constraintShape, factorVariables, buffer);
 
 	    divisionConstraint.setBound( 0 );
 	    divisionConstraint.setConstraintOperator(LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::LessEqual);
 
-	    addConstraintToOpenGMModel(divisionConstraint, constraintShape, factorVariables, model);
+	    addConstraintToOpenGMModel(divisionConstraint, constraintShape, factorVariables, buffer);
 
 	    // save variable reference for overall constraint
 	    addOpenGMVariableToConstraint(onlyOneDivisionConstraint, division->getVariable().getOpenGMVariableId(),
-			1, 1.0, onlyOneConstraintShape, onlyOneFactorVariables, model);
+			1, 1.0, onlyOneConstraintShape, onlyOneFactorVariables, buffer);
 	}
 
 	if(onlyOneFactorVariables.size() > 0)
 	{
 		onlyOneDivisionConstraint.setBound(1);
 		onlyOneDivisionConstraint.setConstraintOperator(LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::LessEqual);
-		addConstraintToOpenGMModel(onlyOneDivisionConstraint, onlyOneConstraintShape, onlyOneFactorVariables, model);
+		addConstraintToOpenGMModel(onlyOneDivisionConstraint, onlyOneConstraintShape, onlyOneFactorVariables, buffer);
 	}
 }
 
-void SegmentationHypothesis::addExclusionConstraintToOpenGM(GraphicalModelType& model, int openGMVarA, int openGMVarB)
+void SegmentationHypothesis::addExclusionConstraintToOpenGM(FactorBuffer& buffer, int openGMVarA, int openGMVarB)
+{
+	addConstraintToOpenGM(buffer, openGMVarA, openGMVarB, 0, 0, 1, LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::GreaterEqual);
+}
+
+void SegmentationHypothesis::addTransitionExclusionConstraintToOpenGM(
+	FactorBuffer& buffer, 
+	const Variable& variable, 
+	const PointerRange<LinkingHypothesis>& links, 
+	size_t maxObjects)
 {
-	addConstraintToOpenGM(model, openGMVarA, openGMVarB, 0, 0, 1, LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::GreaterEqual);
+	if(variable.getOpenGMVariableId() < 0)
+		return;
+
+	// maxObjects * variable[>0] + sum of link states <= maxObjects, one constraint instead of one per link.
+	// If the links can only carry a single object this is the clique of the variable and all links.
+	LinearConstraintFunctionType::LinearConstraintType transitionConstraint;
+	std::vector<LabelType> factorVariables;
+	std::vector<LabelType> constraintShape;
+
+	// the links are sorted and have smaller OpenGM ids than the variables of the detection
+	for(auto link : links)
+	{
+		if(link->getVariable().getOpenGMVariableId() < 0)
+			continue;
+		addOpenGMVariableStateToConstraint(transitionConstraint, link->getVariable().getOpenGMVariableId(),
+			1.0, constraintShape, factorVariables, buffer);
+	}
+	if(factorVariables.empty())
+		return;
+
+	size_t numStates = buffer.numberOfLabels(variable.getOpenGMVariableId());
+	for(size_t state = 1; state < numStates; ++state)
+	{
+		IndicatorVariableType indicatorVariable(constraintShape.size(), LabelType(state));
+		transitionConstraint.add(indicatorVariable, double(maxObjects));
+	}
+	factorVariables.push_back(variable.getOpenGMVariableId());
+	constraintShape.push_back(numStates);
+
+    transitionConstraint.setBound( maxObjects );
+    transitionConstraint.setConstraintOperator(LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::LessEqual);
+
+    addConstraintToOpenGMModel(transitionConstraint, constraintShape, factorVariables, buffer);
 }
 
 void SegmentationHypothesis::addConstraintToOpenGM(
-	GraphicalModelType& model, 
+	FactorBuffer& buffer, 
 	int openGMVarA, 
 	int openGMVarB, 
 	size_t stateA, 
@@ -269,21 +326,37 @@ void SegmentationHypothesis::addConstraintToOpenGM(
 	std::vector<LabelType> constraintShape;
 
 	addOpenGMVariableToConstraint(exclusionConstraint, openGMVarA,
-		stateA, 1.0, constraintShape, factorVariables, model);
+		stateA, 1.0, constraintShape, factorVariables, buffer);
 
 	addOpenGMVariableToConstraint(exclusionConstraint, openGMVarB,
-		stateB, 1.0, constraintShape, factorVariables, model);
+		stateB, 1.0, constraintShape, factorVariables, buffer);
 
     exclusionConstraint.setBound( bound );
     exclusionConstraint.setConstraintOperator(op);
 
-    addConstraintToOpenGMModel(exclusionConstraint, constraintShape, factorVariables, model);
+    addConstraintToOpenGMModel(exclusionConstraint, constraintShape, factorVariables, buffer);
+}
+
+void SegmentationHypothesis::addToOpenGMModel(GraphicalModelType& model)
+{
+	detection_.addToOpenGM(model);
+	if(detection_.getOpenGMVariableId() < 0 && !detection_.isPruned())
+		throw std::runtime_error("Detection variable must have some features!");
+
+	// only add division node if there are outgoing links
+	if(outgoingLinks_.size() > 1)
+		division_.addToOpenGM(model);
+	else
+		division_.resetOpenGMVariableId();
+
+	appearance_.addToOpenGM(model);
+	disappearance_.addToOpenGM(model);
 }
 
-void SegmentationHypothesis::addToOpenGMModel(
-	GraphicalModelType& model, 
+void SegmentationHypothesis::addFactorsToOpenGMModel(
+	FactorBuffer& buffer, 
 	WeightsType& weights, 
-	std::shared_ptr<Settings> settings,
+	const std::shared_ptr<Settings>& settings,
 	const std::vector<size_t>& detectionWeightIds,
 	const std::vector<size_t>& divisionWeightIds,
 	const std::vector<size_t>& appearanceWeightIds,
@@ -292,87 +365,81 @@ void SegmentationHypothesis::addToOpenGMModel(
 	if(!settings)
 		throw std::runtime_error("Settings object cannot be nullptr");
 
-	detection_.addToOpenGM(model, settings->statesShareWeights_, weights, detectionWeightIds);
-	if(detection_.getOpenGMVariableId() < 0)
-		throw std::runtime_error("Detection variable must have some features!");
-
-	// only add division node if there are outgoing links
-	if(outgoingLinks_.size() > 1)
-		division_.addToOpenGM(model, settings->statesShareWeights_, weights, divisionWeightIds);
+	// Model::presolve() prunes the other variables, links and divisions of a pruned detection as well
+	if(detection_.isPruned())
+		return;
 
-	appearance_.addToOpenGM(model, settings->statesShareWeights_, weights, appearanceWeightIds);
-	disappearance_.addToOpenGM(model, settings->statesShareWeights_, weights, disappearanceWeightIds);
+	detection_.addUnaryToOpenGM(buffer, settings->statesShareWeights_, weights, detectionWeightIds);
+	division_.addUnaryToOpenGM(buffer, settings->statesShareWeights_, weights, divisionWeightIds);
+	appearance_.addUnaryToOpenGM(buffer, settings->statesShareWeights_, weights, appearanceWeightIds);
+	disappearance_.addUnaryToOpenGM(buffer, settings->statesShareWeights_, weights, disappearanceWeightIds);
 
 	sortByOpenGMVariableId(incomingLinks_);
 	sortByOpenGMVariableId(outgoingLinks_);
 	sortByOpenGMVariableId(incomingDivisions_);
 	sortByOpenGMVariableId(outgoingDivisions_);
 
-	addIncomingConstraintToOpenGM(model);
-	addOutgoingConstraintToOpenGM(model);
-	addDivisionConstraintToOpenGM(model, settings->requireSeparateChildrenOfDivision_);
-	addExternalDivisionConstraintToOpenGM(model);
+	addIncomingConstraintToOpenGM(buffer);
+	addOutgoingConstraintToOpenGM(buffer);
+	addDivisionConstraintToOpenGM(buffer, settings->requireSeparateChildrenOfDivision_);
+	addExternalDivisionConstraintToOpenGM(buffer);
 
 	if(!settings->allowLengthOneTracks_)
 	{
-		addConstraintToOpenGM(model, appearance_.getOpenGMVariableId(), disappearance_.getOpenGMVariableId(), 0, 0, 1, 
+		addConstraintToOpenGM(buffer, appearance_.getOpenGMVariableId(), disappearance_.getOpenGMVariableId(), 0, 0, 1, 
 							  LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::GreaterEqual);
 	}
 
 	// add transition exclusion constraints in the multilabel case:
 	if(detection_.getNumStates() > 1)
 	{
-		if(appearance_.getOpenGMVariableId() >= 0 && settings->allowPartialMergerAppearance_ == false)
+		// the links carry at most as many objects as the detection holds, or two for a division
+		size_t maxObjects = detection_.getNumStates() - 1;
+		if(settings->allowPartialMergerAppearance_ == false)
 		{
-			for(auto link : incomingLinks_)
-				addExclusionConstraintToOpenGM(model, appearance_.getOpenGMVariableId(), link->getVariable().getOpenGMVariableId());
+			addTransitionExclusionConstraintToOpenGM(buffer, appearance_, incomingLinks_, maxObjects);
+			addTransitionExclusionConstraintToOpenGM(buffer, disappearance_, outgoingLinks_, 
+				division_.getOpenGMVariableId() >= 0 ? std::max(maxObjects, size_t(2)) : maxObjects);
 		}
 
 		if(disappearance_.getOpenGMVariableId() >= 0)
 		{
-			if(settings->allowPartialMergerAppearance_ == false)
-			{
-				for(auto link : outgoingLinks_)
-					addExclusionConstraintToOpenGM(model, disappearance_.getOpenGMVariableId(), link->getVariable().getOpenGMVariableId());
-			}
 
 			if(division_.getOpenGMVariableId() >= 0)
-				addExclusionConstraintToOpenGM(model, disappearance_.getOpenGMVariableId(), division_.getOpenGMVariableId());
+				addExclusionConstraintToOpenGM(buffer, disappearance_.getOpenGMVariableId(), division_.getOpenGMVariableId());
 		}
 	}
 }
 
-void SegmentationHypothesis::addIncomingLink(std::shared_ptr<LinkingHypothesis> link)
+void SegmentationHypothesis::assignOpenGMVariableIds(int& nextId)
 {
-	if(detection_.getOpenGMVariableId() >= 0)
-		throw std::runtime_error("Links must be added before the segmentation hypothesis is added to the OpenGM model");
-	if(link)
-		incomingLinks_.push_back(link);
+	detection_.assignOpenGMVariableId(nextId);
+
+	// division node is only present if there are outgoing links, see addToOpenGMModel()
+	if(outgoingLinks_.size() > 1)
+		division_.assignOpenGMVariableId(nextId);
+	else
+		division_.resetOpenGMVariableId();
 
+	appearance_.assignOpenGMVariableId(nextId);
+	disappearance_.assignOpenGMVariableId(nextId);
 }
 
-void SegmentationHypothesis::addOutgoingLink(std::shared_ptr<LinkingHypothesis> link)
+void SegmentationHypothesis::setAdjacency(
+	PointerRange<LinkingHypothesis> incomingLinks,
+	PointerRange<LinkingHypothesis> outgoingLinks,
+	PointerRange<DivisionHypothesis> incomingDivisions,
+	PointerRange<DivisionHypothesis> outgoingDivisions)
 {
 	if(detection_.getOpenGMVariableId() >= 0)
 		throw std::runtime_error("Links must be added before the segmentation hypothesis is added to the OpenGM model");
-	if(link)
-		outgoingLinks_.push_back(link);
-}
-
-void SegmentationHypothesis::addIncomingDivision(std::shared_ptr<DivisionHypothesis> division)
-{
-	if(division_.getOpenGMVariableId() >= 0)
+	if(division_.getOpenGMVariableId() >= 0 && (!incomingDivisions.empty() || !outgoingDivisions.empty()))
 		throw std::runtime_error("Cannot add external division hypothesis if it is included in detection already!");
-	if(division)
-		incomingDivisions_.push_back(division);
-}
 
-void SegmentationHypothesis::addOutgoingDivision(std::shared_ptr<DivisionHypothesis> division)
-{
-	if(division_.getOpenGMVariableId() >= 0)
-		throw std::runtime_error("Cannot add external division hypothesis if it is included in detection already!");
-	if(division)
-		outgoingDivisions_.push_back(division);
+	incomingLinks_ = incomingLinks;
+	outgoingLinks_ = outgoingLinks;
+	incomingDivisions_ = incomingDivisions;
+	outgoingDivisions_ = outgoingDivisions;
 }
 
 size_t SegmentationHypothesis::getNumActiveIncomingLinks(const Solution& sol) const
@@ -465,7 +532,7 @@ bool SegmentationHypothesis::verifySolution(const Solution& sol, const std::shar
 
 	//--------------------------------
 	// check no length one tracks
-	if(settings->allowLengthOneTracks_)
+	if(!settings->allowLengthOneTracks_ && appearance_.getOpenGMVariableId() >= 0 && disappearance_.getOpenGMVariableId() >= 0)
 	{
 		if(sol[appearance_.getOpenGMVariableId()] > 0 && sol[disappearance_.getOpenGMVariableId()] > 0)
 		{
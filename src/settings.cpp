@@ -3,6 +3,12 @@
 namespace helpers
 {
 
+#ifdef WITH_GUROBI
+static const std::string defaultSolverBackend = "gurobi";
+#else
+static const std::string defaultSolverBackend = "highs";
+#endif
+
 Settings::Settings():
 	statesShareWeights_(false),
 	allowPartialMergerAppearance_(true),
@@ -11,7 +17,20 @@ Settings::Settings():
 	optimizerEpGap_(0.01),
 	optimizerVerbose_(true),
 	optimizerNumThreads_(1),
-	nonNegativeWeightsOnly_(false)
+	nonNegativeWeightsOnly_(false),
+	decomposeIntoComponents_(false),
+	componentNumThreads_(0),
+	useFlowSolver_(true),
+	slidingWindowSize_(0),
+	slidingWindowStep_(1),
+	dualDecompositionChunkSize_(0),
+	dualDecompositionOverlap_(0),
+	dualDecompositionIterations_(50),
+	greedyWarmStart_(false),
+	presolve_(false),
+	buildNumThreads_(0),
+	solverBackend_(defaultSolverBackend),
+	solutionCacheSize_(0)
 {}
 
 Settings::Settings(const Json::Value& entry)
@@ -55,6 +74,76 @@ Settings::Settings(const Json::Value& entry)
 		nonNegativeWeightsOnly_ = entry[JsonTypeNames[JsonTypes::NonNegativeWeightsOnly]].asBool();
 	else 
 		nonNegativeWeightsOnly_ = false;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::DecomposeIntoComponents]))
+		decomposeIntoComponents_ = entry[JsonTypeNames[JsonTypes::DecomposeIntoComponents]].asBool();
+	else 
+		decomposeIntoComponents_ = false;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::ComponentNumThreads]))
+		componentNumThreads_ = entry[JsonTypeNames[JsonTypes::ComponentNumThreads]].asUInt();
+	else 
+		componentNumThreads_ = 0;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::UseFlowSolver]))
+		useFlowSolver_ = entry[JsonTypeNames[JsonTypes::UseFlowSolver]].asBool();
+	else 
+		useFlowSolver_ = true;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::SlidingWindowSize]))
+		slidingWindowSize_ = entry[JsonTypeNames[JsonTypes::SlidingWindowSize]].asUInt();
+	else 
+		slidingWindowSize_ = 0;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::SlidingWindowStep]))
+		slidingWindowStep_ = entry[JsonTypeNames[JsonTypes::SlidingWindowStep]].asUInt();
+	else 
+		slidingWindowStep_ = 1;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::DualDecompositionChunkSize]))
+		dualDecompositionChunkSize_ = entry[JsonTypeNames[JsonTypes::DualDecompositionChunkSize]].asUInt();
+	else 
+		dualDecompositionChunkSize_ = 0;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::DualDecompositionOverlap]))
+		dualDecompositionOverlap_ = entry[JsonTypeNames[JsonTypes::DualDecompositionOverlap]].asUInt();
+	else 
+		dualDecompositionOverlap_ = 0;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::DualDecompositionIterations]))
+		dualDecompositionIterations_ = entry[JsonTypeNames[JsonTypes::DualDecompositionIterations]].asUInt();
+	else 
+		dualDecompositionIterations_ = 50;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::GreedyWarmStart]))
+		greedyWarmStart_ = entry[JsonTypeNames[JsonTypes::GreedyWarmStart]].asBool();
+	else 
+		greedyWarmStart_ = false;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::Presolve]))
+		presolve_ = entry[JsonTypeNames[JsonTypes::Presolve]].asBool();
+	else 
+		presolve_ = false;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::BuildNumThreads]))
+		buildNumThreads_ = entry[JsonTypeNames[JsonTypes::BuildNumThreads]].asUInt();
+	else 
+		buildNumThreads_ = 0;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::SolverBackend]))
+		solverBackend_ = entry[JsonTypeNames[JsonTypes::SolverBackend]].asString();
+	else 
+		solverBackend_ = defaultSolverBackend;
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::SolutionCacheDirectory]))
+		solutionCacheDirectory_ = entry[JsonTypeNames[JsonTypes::SolutionCacheDirectory]].asString();
+	else 
+		solutionCacheDirectory_ = "";
+
+	if(entry.isMember(JsonTypeNames[JsonTypes::SolutionCacheSize]))
+		solutionCacheSize_ = entry[JsonTypeNames[JsonTypes::SolutionCacheSize]].asUInt();
+	else 
+		solutionCacheSize_ = 0;
 }
 
 void Settings::saveToJson(Json::Value& entry)
@@ -67,6 +156,20 @@ void Settings::saveToJson(Json::Value& entry)
 	entry[JsonTypeNames[JsonTypes::OptimizerEpGap]] = Json::Value(optimizerEpGap_);
 	entry[JsonTypeNames[JsonTypes::OptimizerVerbose]] = Json::Value(optimizerVerbose_);
 	entry[JsonTypeNames[JsonTypes::OptimizerNumThreads]] = Json::Value((int)optimizerNumThreads_);
+	entry[JsonTypeNames[JsonTypes::DecomposeIntoComponents]] = Json::Value(decomposeIntoComponents_);
+	entry[JsonTypeNames[JsonTypes::ComponentNumThreads]] = Json::Value((int)componentNumThreads_);
+	entry[JsonTypeNames[JsonTypes::UseFlowSolver]] = Json::Value(useFlowSolver_);
+	entry[JsonTypeNames[JsonTypes::SlidingWindowSize]] = Json::Value((int)slidingWindowSize_);
+	entry[JsonTypeNames[JsonTypes::SlidingWindowStep]] = Json::Value((int)slidingWindowStep_);
+	entry[JsonTypeNames[JsonTypes::DualDecompositionChunkSize]] = Json::Value((int)dualDecompositionChunkSize_);
+	entry[JsonTypeNames[JsonTypes::DualDecompositionOverlap]] = Json::Value((int)dualDecompositionOverlap_);
+	entry[JsonTypeNames[JsonTypes::DualDecompositionIterations]] = Json::Value((int)dualDecompositionIterations_);
+	entry[JsonTypeNames[JsonTypes::GreedyWarmStart]] = Json::Value(greedyWarmStart_);
+	entry[JsonTypeNames[JsonTypes::Presolve]] = Json::Value(presolve_);
+	entry[JsonTypeNames[JsonTypes::BuildNumThreads]] = Json::Value((int)buildNumThreads_);
+	entry[JsonTypeNames[JsonTypes::SolverBackend]] = Json::Value(solverBackend_);
+	entry[JsonTypeNames[JsonTypes::SolutionCacheDirectory]] = Json::Value(solutionCacheDirectory_);
+	entry[JsonTypeNames[JsonTypes::SolutionCacheSize]] = Json::Value((int)solutionCacheSize_);
 }
 
 void Settings::print()
@@ -81,6 +184,20 @@ void Settings::print()
 		<< "\n\tOptimizerEpGap: " << optimizerEpGap_
 		<< "\n\tOptimizerVerbose: " << (optimizerVerbose_ ? "true" : "false")
 		<< "\n\tOptimizerNumThreads: " << optimizerNumThreads_
+		<< "\n\tDecomposeIntoComponents: " << (decomposeIntoComponents_ ? "true" : "false")
+		<< "\n\tComponentNumThreads: " << componentNumThreads_
+		<< "\n\tUseFlowSolver: " << (useFlowSolver_ ? "true" : "false")
+		<< "\n\tSlidingWindowSize: " << slidingWindowSize_
+		<< "\n\tSlidingWindowStep: " << slidingWindowStep_
+		<< "\n\tDualDecompositionChunkSize: " << dualDecompositionChunkSize_
+		<< "\n\tDualDecompositionOverlap: " << dualDecompositionOverlap_
+		<< "\n\tDualDecompositionIterations: " << dualDecompositionIterations_
+		<< "\n\tGreedyWarmStart: " << (greedyWarmStart_ ? "true" : "false")
+		<< "\n\tPresolve: " << (presolve_ ? "true" : "false")
+		<< "\n\tBuildNumThreads: " << buildNumThreads_
+		<< "\n\tSolverBackend: " << solverBackend_
+		<< "\n\tSolutionCacheDirectory: " << solutionCacheDirectory_
+		<< "\n\tSolutionCacheSize: " << solutionCacheSize_
 		<< "\n************************"
 		<< std::endl;
 }
@@ -0,0 +1,231 @@
+#include "solutioncache.h"
+
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+using namespace helpers;
+
+namespace mht
+{
+
+namespace
+{
+
+const std::string cacheFileExtension = ".mhtsol";
+const std::string cacheFileHeader = "mht-solution 1";
+
+uint64_t rotateLeft(uint64_t value, int bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+// finalizer of splitmix64, which spreads every input bit over the whole word
+uint64_t mix(uint64_t value)
+{
+	value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+	return value ^ (value >> 31);
+}
+
+void makeDirectory(const std::string& directory)
+{
+	// create all missing parents as well
+	for(size_t pos = directory.find('/', 1); ; pos = directory.find('/', pos + 1))
+	{
+		std::string path = directory.substr(0, pos);
+#ifdef _WIN32
+		int result = _mkdir(path.c_str());
+#else
+		int result = mkdir(path.c_str(), 0777);
+#endif
+		if(result != 0 && errno != EEXIST)
+			throw std::runtime_error("Could not create solution cache directory " + path + ": " + std::strerror(errno));
+		if(pos == std::string::npos)
+			break;
+	}
+}
+
+} // end anonymous namespace
+
+void ContentHash::add(const void* data, size_t size)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	size_t i = 0;
+	for(; i + 8 <= size; i += 8)
+	{
+		uint64_t word;
+		std::memcpy(&word, bytes + i, 8);
+		addWord(word);
+	}
+	if(i < size)
+	{
+		uint64_t word = 0;
+		std::memcpy(&word, bytes + i, size - i);
+		addWord(word ^ ((uint64_t)(size - i) << 56));
+	}
+}
+
+void ContentHash::add(const std::string& value)
+{
+	add(value.size());
+	add(value.data(), value.size());
+}
+
+void ContentHash::addWord(uint64_t word)
+{
+	lanes_[0] = rotateLeft((lanes_[0] ^ word) * 0x100000001b3ULL, 29);
+	lanes_[1] = rotateLeft(lanes_[1] + word * 0xc2b2ae3d27d4eb4fULL, 31) * 0x9e3779b97f4a7c15ULL;
+	++length_;
+}
+
+std::string ContentHash::hexDigest() const
+{
+	std::stringstream stream;
+	stream << std::hex << std::setfill('0')
+		<< std::setw(16) << mix(lanes_[0] ^ length_)
+		<< std::setw(16) << mix(lanes_[1] + length_);
+	return stream.str();
+}
+
+SolutionCache::SolutionCache(const std::string& directory, size_t maxEntries):
+	directory_(directory),
+	maxEntries_(maxEntries)
+{
+	if(directory_.empty())
+		throw std::runtime_error("The solution cache needs a directory");
+	makeDirectory(directory_);
+}
+
+std::string SolutionCache::getFilename(const std::string& key) const
+{
+	return directory_ + "/" + key + cacheFileExtension;
+}
+
+bool SolutionCache::load(const std::string& key, Solution& solution, double& energy) const
+{
+	std::string filename = getFilename(key);
+	std::ifstream stream(filename.c_str());
+	if(!stream.good())
+		return false;
+
+	std::string header;
+	size_t numVariables = 0;
+	std::getline(stream, header);
+	stream >> energy >> numVariables;
+	if(header != cacheFileHeader || !stream.good())
+	{
+		std::cout << "Ignoring invalid solution cache file " << filename << std::endl;
+		return false;
+	}
+
+	solution.resize(numVariables);
+	for(size_t i = 0; i < numVariables; ++i)
+		stream >> solution[i];
+	if(stream.fail())
+	{
+		std::cout << "Ignoring truncated solution cache file " << filename << std::endl;
+		return false;
+	}
+
+#ifndef _WIN32
+	// mark as recently used for evict()
+	utime(filename.c_str(), nullptr);
+#endif
+	return true;
+}
+
+void SolutionCache::store(const std::string& key, const Solution& solution, double energy) const
+{
+	static std::atomic<size_t> numWritten(0);
+	std::string filename = getFilename(key);
+#ifdef _WIN32
+	std::string temporaryFilename = filename + ".tmp" + std::to_string(_getpid()) + "_" + std::to_string(numWritten++);
+#else
+	std::string temporaryFilename = filename + ".tmp" + std::to_string(getpid()) + "_" + std::to_string(numWritten++);
+#endif
+
+	{
+		std::ofstream stream(temporaryFilename.c_str());
+		stream.precision(std::numeric_limits<double>::max_digits10);
+		stream << cacheFileHeader << "\n" << energy << "\n" << solution.size() << "\n";
+		for(size_t i = 0; i < solution.size(); ++i)
+			stream << solution[i] << (i + 1 < solution.size() ? ' ' : '\n');
+		if(!stream.good())
+		{
+			std::cout << "Could not write solution cache file " << temporaryFilename << std::endl;
+			std::remove(temporaryFilename.c_str());
+			return;
+		}
+	}
+
+#ifdef _WIN32
+	// rename does not replace existing files on Windows
+	std::remove(filename.c_str());
+#endif
+	if(std::rename(temporaryFilename.c_str(), filename.c_str()) != 0)
+	{
+		std::cout << "Could not move solution cache file to " << filename << std::endl;
+		std::remove(temporaryFilename.c_str());
+		return;
+	}
+
+	if(maxEntries_ > 0)
+		evict(filename);
+}
+
+void SolutionCache::evict(const std::string& keptFilename) const
+{
+#ifndef _WIN32
+	DIR* dir = opendir(directory_.c_str());
+	if(dir == nullptr)
+		return;
+
+	std::vector< std::pair<time_t, std::string> > entries;
+	while(struct dirent* entry = readdir(dir))
+	{
+		std::string name = entry->d_name;
+		if(name.size() <= cacheFileExtension.size()
+			|| name.compare(name.size() - cacheFileExtension.size(), cacheFileExtension.size(), cacheFileExtension) != 0)
+			continue;
+
+		std::string filename = directory_ + "/" + name;
+		if(filename == keptFilename)
+			continue;
+		struct stat fileStat;
+		if(stat(filename.c_str(), &fileStat) == 0)
+			entries.push_back(std::make_pair(fileStat.st_mtime, filename));
+	}
+	closedir(dir);
+
+	// the kept file is one of the entries as well
+	if(entries.size() + 1 <= maxEntries_)
+		return;
+
+	// oldest first, files that are used at the same time are removed by name so that all processes agree
+	std::sort(entries.begin(), entries.end());
+	for(size_t i = 0; i < entries.size() + 1 - maxEntries_; ++i)
+		std::remove(entries[i].second.c_str());
+#endif
+}
+
+} // end namespace mht
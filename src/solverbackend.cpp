@@ -0,0 +1,296 @@
+#include "solverbackend.h"
+#include "telemetry.h"
+
+#include <stdexcept>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+
+#ifdef WITH_GUROBI
+#include <gurobi_c++.h>
+#endif
+
+#ifdef WITH_HIGHS
+#include <Highs.h>
+#endif
+
+namespace mht
+{
+
+void LinearProgram::closeRow(double lower, double upper, const std::string& name)
+{
+	rowOffsets_.push_back(columns_.size());
+	rowLower_.push_back(lower);
+	rowUpper_.push_back(upper);
+	if(!name.empty())
+		rowNames_.push_back(name);
+}
+
+void SolverResult::addToTelemetry(helpers::Telemetry& telemetry) const
+{
+	telemetry.addToCounter("solver.nodes", numNodes);
+	telemetry.addToCounter("solver.presolveRemovedRows", presolveRemovedRows);
+	telemetry.addToCounter("solver.presolveRemovedColumns", presolveRemovedColumns);
+}
+
+namespace
+{
+
+#ifdef WITH_GUROBI
+/// records the reductions of Gurobi's presolve, which are not available as attributes after the solve
+class GurobiPresolveCallback : public GRBCallback
+{
+public:
+	size_t removedRows = 0;
+	size_t removedColumns = 0;
+
+protected:
+	virtual void callback()
+	{
+		if(where == GRB_CB_PRESOLVE)
+		{
+			removedRows = getIntInfo(GRB_CB_PRE_ROWDEL);
+			removedColumns = getIntInfo(GRB_CB_PRE_COLDEL);
+		}
+	}
+};
+
+class GurobiBackend : public SolverBackend
+{
+public:
+	virtual std::string name() const { return "gurobi"; }
+
+	virtual SolverResult solve(const LinearProgram& program,
+							   const SolverParameters& parameters,
+							   const std::vector<double>& start)
+	{
+		try
+		{
+			// starting an environment checks the license, so it is only done once per backend
+			if(!environment_)
+			{
+				// an empty environment does not print the license banner before the output flag is set
+				environment_.reset(new GRBEnv(true));
+				environment_->set(GRB_IntParam_OutputFlag, 0);
+				environment_->start();
+			}
+
+			GRBModel model(*environment_);
+			model.set(GRB_IntParam_OutputFlag, parameters.verbose ? 1 : 0);
+			model.set(GRB_DoubleParam_MIPGap, parameters.epGap);
+			model.set(GRB_IntParam_Threads, (int)parameters.numThreads);
+			GurobiPresolveCallback presolveCallback;
+			model.setCallback(&presolveCallback);
+
+			const size_t numColumns = program.numColumns();
+			std::vector<double> lower(numColumns, 0.0);
+			std::vector<double> upper(numColumns, 1.0);
+			std::vector<char> types(numColumns, parameters.integer ? GRB_BINARY : GRB_CONTINUOUS);
+			std::unique_ptr<GRBVar[]> variables(model.addVars(lower.data(), upper.data(), program.objective_.data(),
+				types.data(), nullptr, (int)numColumns));
+
+			std::vector<GRBVar> rowVariables;
+			for(size_t r = 0; r < program.numRows(); ++r)
+			{
+				size_t begin = program.rowOffsets_[r];
+				size_t end = program.rowOffsets_[r + 1];
+				rowVariables.clear();
+				for(size_t i = begin; i < end; ++i)
+					rowVariables.push_back(variables[program.columns_[i]]);
+
+				GRBLinExpr expression;
+				expression.addTerms(program.coefficients_.data() + begin, rowVariables.data(), (int)(end - begin));
+
+				if(program.rowLower_[r] == program.rowUpper_[r])
+					model.addConstr(expression, GRB_EQUAL, program.rowLower_[r]);
+				else
+				{
+					if(std::isfinite(program.rowLower_[r]))
+						model.addConstr(expression, GRB_GREATER_EQUAL, program.rowLower_[r]);
+					if(std::isfinite(program.rowUpper_[r]))
+						model.addConstr(expression, GRB_LESS_EQUAL, program.rowUpper_[r]);
+				}
+			}
+
+			if(parameters.integer && start.size() == numColumns)
+			{
+				for(size_t c = 0; c < numColumns; ++c)
+					variables[c].set(GRB_DoubleAttr_Start, start[c]);
+			}
+
+			model.optimize();
+			if(model.get(GRB_IntAttr_SolCount) == 0)
+				throw std::runtime_error("Gurobi did not find a feasible solution, status " + std::to_string(model.get(GRB_IntAttr_Status)));
+
+			SolverResult result;
+			result.columnValues.resize(numColumns);
+			for(size_t c = 0; c < numColumns; ++c)
+				result.columnValues[c] = variables[c].get(GRB_DoubleAttr_X);
+			result.value = model.get(GRB_DoubleAttr_ObjVal) + program.objectiveOffset_;
+			result.bound = parameters.integer ? model.get(GRB_DoubleAttr_ObjBound) + program.objectiveOffset_ : result.value;
+			result.numNodes = parameters.integer ? (size_t)model.get(GRB_DoubleAttr_NodeCount) : 0;
+			result.presolveRemovedRows = presolveCallback.removedRows;
+			result.presolveRemovedColumns = presolveCallback.removedColumns;
+			return result;
+		}
+		catch(GRBException& e)
+		{
+			throw std::runtime_error("Gurobi error " + std::to_string(e.getErrorCode()) + ": " + e.getMessage());
+		}
+	}
+
+private:
+	std::unique_ptr<GRBEnv> environment_;
+};
+#endif // WITH_GUROBI
+
+#ifdef WITH_HIGHS
+class HighsBackend : public SolverBackend
+{
+public:
+	virtual std::string name() const { return "highs"; }
+
+	virtual SolverResult solve(const LinearProgram& program,
+							   const SolverParameters& parameters,
+							   const std::vector<double>& start)
+	{
+		const size_t numColumns = program.numColumns();
+		HighsLp lp;
+		lp.num_col_ = numColumns;
+		lp.num_row_ = program.numRows();
+		lp.sense_ = ObjSense::kMinimize;
+		lp.col_cost_ = program.objective_;
+		lp.col_lower_.assign(numColumns, 0.0);
+		lp.col_upper_.assign(numColumns, 1.0);
+		lp.row_lower_ = program.rowLower_;
+		lp.row_upper_ = program.rowUpper_;
+		lp.a_matrix_.format_ = MatrixFormat::kRowwise;
+		lp.a_matrix_.num_col_ = lp.num_col_;
+		lp.a_matrix_.num_row_ = lp.num_row_;
+		lp.a_matrix_.start_.assign(program.rowOffsets_.begin(), program.rowOffsets_.end());
+		lp.a_matrix_.index_.assign(program.columns_.begin(), program.columns_.end());
+		lp.a_matrix_.value_ = program.coefficients_;
+		if(parameters.integer)
+			lp.integrality_.assign(numColumns, HighsVarType::kInteger);
+
+		// holds the scheduler at this number of threads until the solve is done
+		SchedulerLease schedulerLease(parameters.numThreads);
+		Highs highs;
+		highs.setOptionValue("output_flag", parameters.verbose);
+		highs.setOptionValue("mip_rel_gap", parameters.epGap);
+		highs.setOptionValue("threads", (HighsInt)schedulerLease.numThreads());
+		if(highs.passModel(lp) == HighsStatus::kError)
+			throw std::runtime_error("HiGHS rejected the linear program");
+
+		if(parameters.integer && start.size() == numColumns)
+		{
+			HighsSolution startSolution;
+			startSolution.col_value = start;
+			startSolution.value_valid = true;
+			highs.setSolution(startSolution);
+		}
+
+		if(highs.run() == HighsStatus::kError)
+			throw std::runtime_error("HiGHS failed to solve the linear program");
+
+		const HighsInfo& info = highs.getInfo();
+		if(info.primal_solution_status != kSolutionStatusFeasible)
+			throw std::runtime_error("HiGHS did not find a feasible solution, status: "
+				+ highs.modelStatusToString(highs.getModelStatus()));
+
+		// run() does not report the reductions of its presolve, which would take another presolve to count, so they stay 0
+		SolverResult result;
+		result.columnValues = highs.getSolution().col_value;
+		result.value = info.objective_function_value + program.objectiveOffset_;
+		result.bound = parameters.integer ? info.mip_dual_bound + program.objectiveOffset_ : result.value;
+		result.numNodes = parameters.integer ? (size_t)std::max((int64_t)0, (int64_t)info.mip_node_count) : 0;
+		return result;
+	}
+
+private:
+	/**
+	 * @brief HiGHS runs all instances of a process on one global scheduler, whose size is fixed when it starts
+	 * @details A solve that needs another number of threads waits until all running solves are done,
+	 *          and then restarts the scheduler with its own number of threads.
+	 */
+	class SchedulerLease
+	{
+	public:
+		SchedulerLease(size_t requested)
+		{
+			// HiGHS would use half of the CPU cores for 0, the setting means all of them
+			numThreads_ = requested == 0 ? std::max(1u, std::thread::hardware_concurrency()) : requested;
+
+			std::unique_lock<std::mutex> lock(mutex());
+			condition().wait(lock, [&]{ return activeSolves() == 0 || schedulerThreads() == numThreads_; });
+			if(schedulerThreads() != numThreads_)
+			{
+				if(schedulerThreads() != 0)
+				{
+					std::cout << "Restarting the HiGHS scheduler with " << numThreads_ << " instead of " 
+							  << schedulerThreads() << " threads" << std::endl;
+					Highs::resetGlobalScheduler(true);
+				}
+				schedulerThreads() = numThreads_;
+			}
+			activeSolves()++;
+		}
+
+		~SchedulerLease()
+		{
+			std::lock_guard<std::mutex> lock(mutex());
+			activeSolves()--;
+			condition().notify_all();
+		}
+
+		size_t numThreads() const { return numThreads_; }
+
+	private:
+		size_t numThreads_;
+
+		static std::mutex& mutex() { static std::mutex mutex; return mutex; }
+		static std::condition_variable& condition() { static std::condition_variable condition; return condition; }
+		static size_t& schedulerThreads() { static size_t threads = 0; return threads; }
+		static size_t& activeSolves() { static size_t solves = 0; return solves; }
+	};
+};
+#endif // WITH_HIGHS
+
+} // end anonymous namespace
+
+std::unique_ptr<SolverBackend> SolverBackend::create(const std::string& name)
+{
+#ifdef WITH_GUROBI
+	if(name == "gurobi")
+		return std::unique_ptr<SolverBackend>(new GurobiBackend());
+#endif
+#ifdef WITH_HIGHS
+	if(name == "highs")
+		return std::unique_ptr<SolverBackend>(new HighsBackend());
+#endif
+
+	std::string available;
+	for(const std::string& backend : availableNames())
+		available += " " + backend;
+	throw std::runtime_error("Solver backend '" + name + "' is not available, this library was compiled with:"
+		+ (available.empty() ? std::string(" none") : available));
+}
+
+std::vector<std::string> SolverBackend::availableNames()
+{
+	std::vector<std::string> names;
+#ifdef WITH_GUROBI
+	names.push_back("gurobi");
+#endif
+#ifdef WITH_HIGHS
+	names.push_back("highs");
+#endif
+	return names;
+}
+
+} // end namespace mht
@@ -0,0 +1,244 @@
+#include "telemetry.h"
+
+#include <iostream>
+#include <algorithm>
+#include <ctime>
+#include <time.h>
+
+namespace helpers
+{
+
+Telemetry::ScopedPhase::ScopedPhase(Telemetry& telemetry, const std::string& name):
+	telemetry_(telemetry),
+	name_(name),
+	wallStart_(std::chrono::steady_clock::now()),
+	processCpuStart_(Telemetry::getProcessCpuTime()),
+	threadCpuStart_(Telemetry::getThreadCpuTime()),
+	overlapsAtStart_(0),
+	running_(true)
+{
+	overlappedAtStart_ = telemetry_.startPhase(name_, overlapsAtStart_);
+}
+
+Telemetry::ScopedPhase::~ScopedPhase()
+{
+	stop();
+}
+
+void Telemetry::ScopedPhase::stop()
+{
+	if(!running_)
+		return;
+	running_ = false;
+
+	telemetry_.stopPhase(name_, wallStart_, overlappedAtStart_, overlapsAtStart_, 
+		Telemetry::getProcessCpuTime() - processCpuStart_, Telemetry::getThreadCpuTime() - threadCpuStart_);
+}
+
+double Telemetry::getThreadCpuTime()
+{
+#ifdef CLOCK_THREAD_CPUTIME_ID
+	timespec time;
+	if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) == 0)
+		return time.tv_sec + 1e-9 * time.tv_nsec;
+#endif
+	// process time as fallback, which includes all threads
+	return getProcessCpuTime();
+}
+
+double Telemetry::getProcessCpuTime()
+{
+#ifdef CLOCK_PROCESS_CPUTIME_ID
+	timespec time;
+	if(clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) == 0)
+		return time.tv_sec + 1e-9 * time.tv_nsec;
+#endif
+	return double(std::clock()) / CLOCKS_PER_SEC;
+}
+
+bool Telemetry::startPhase(const std::string& name, size_t& overlaps)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	RunningPhase& running = runningPhases_[name];
+	if(running.calls == 0)
+	{
+		running.start = std::chrono::steady_clock::now();
+		running.overlapped = false;
+	}
+	else
+	{
+		running.overlaps++;
+		running.overlapped = true;
+	}
+	running.calls++;
+	overlaps = running.overlaps;
+	return running.calls > 1;
+}
+
+void Telemetry::stopPhase(const std::string& name, 
+						  std::chrono::steady_clock::time_point wallStart, 
+						  bool overlappedAtStart, 
+						  size_t overlapsAtStart, 
+						  double processCpuTime, 
+						  double threadCpuTime)
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	std::chrono::duration<double> wallTime = now - wallStart;
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	RunningPhase& running = runningPhases_[name];
+	running.calls--;
+
+	// a call that started alone overlapped if another one started before it ended
+	if(overlappedAtStart || running.overlaps != overlapsAtStart)
+	{
+		// the process CPU time would count the other calls as well
+		Phase& phase = concurrentPhases_[name];
+		phase.busyTime += wallTime.count();
+		phase.cpuTime += threadCpuTime;
+		phase.calls++;
+	}
+	else
+	{
+		Phase& phase = phases_[name];
+		phase.wallTime += wallTime.count();
+		phase.cpuTime += processCpuTime;
+		phase.calls++;
+	}
+
+	// the wall time of overlapping calls is the time during which any of them was running
+	if(running.calls == 0 && running.overlapped)
+	{
+		std::chrono::duration<double> groupTime = now - running.start;
+		concurrentPhases_[name].wallTime += groupTime.count();
+	}
+}
+
+void Telemetry::addPhaseTime(const std::string& name, double wallTime, double cpuTime)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	Phase& phase = phases_[name];
+	phase.wallTime += wallTime;
+	phase.cpuTime += cpuTime;
+	phase.calls++;
+}
+
+void Telemetry::setCounter(const std::string& name, double value)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	counters_[name] = value;
+}
+
+void Telemetry::addToCounter(const std::string& name, double value)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	counters_[name] += value;
+}
+
+void Telemetry::setCounterToMax(const std::string& name, double value)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = counters_.find(name);
+	if(it == counters_.end())
+		counters_[name] = value;
+	else
+		it->second = std::max(it->second, value);
+}
+
+Telemetry::Phase Telemetry::getPhase(const std::string& name) const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = phases_.find(name);
+	return it == phases_.end() ? Phase() : it->second;
+}
+
+Telemetry::Phase Telemetry::getConcurrentPhase(const std::string& name) const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = concurrentPhases_.find(name);
+	return it == concurrentPhases_.end() ? Phase() : it->second;
+}
+
+double Telemetry::getCounter(const std::string& name) const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = counters_.find(name);
+	return it == counters_.end() ? 0.0 : it->second;
+}
+
+std::map<std::string, Telemetry::Phase> Telemetry::getPhases() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return phases_;
+}
+
+std::map<std::string, Telemetry::Phase> Telemetry::getConcurrentPhases() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return concurrentPhases_;
+}
+
+std::map<std::string, double> Telemetry::getCounters() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return counters_;
+}
+
+void Telemetry::clear()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	phases_.clear();
+	concurrentPhases_.clear();
+	counters_.clear();
+}
+
+void Telemetry::toJson(Json::Value& root) const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	Json::Value& phases = root["phases"];
+	phases = Json::Value(Json::objectValue);
+	for(auto& phase : phases_)
+	{
+		Json::Value& entry = phases[phase.first];
+		entry["wallTime"] = phase.second.wallTime;
+		entry["cpuTime"] = phase.second.cpuTime;
+		entry["calls"] = (Json::UInt64)phase.second.calls;
+	}
+
+	Json::Value& concurrentPhases = root["concurrentPhases"];
+	concurrentPhases = Json::Value(Json::objectValue);
+	for(auto& phase : concurrentPhases_)
+	{
+		Json::Value& entry = concurrentPhases[phase.first];
+		entry["wallTime"] = phase.second.wallTime;
+		entry["busyTime"] = phase.second.busyTime;
+		entry["cpuTime"] = phase.second.cpuTime;
+		entry["calls"] = (Json::UInt64)phase.second.calls;
+	}
+
+	Json::Value& counters = root["counters"];
+	counters = Json::Value(Json::objectValue);
+	for(auto& counter : counters_)
+		counters[counter.first] = counter.second;
+}
+
+void Telemetry::print() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	std::cout << "Telemetry:" << std::endl;
+	for(auto& phase : phases_)
+	{
+		std::cout << "\t" << phase.first << ": " << phase.second.wallTime << "s wall, "
+				  << phase.second.cpuTime << "s cpu in " << phase.second.calls << " calls" << std::endl;
+	}
+	for(auto& phase : concurrentPhases_)
+	{
+		std::cout << "\t" << phase.first << " (concurrent): " << phase.second.wallTime << "s wall, " 
+				  << phase.second.busyTime << "s busy, " << phase.second.cpuTime << "s cpu in " 
+				  << phase.second.calls << " calls" << std::endl;
+	}
+	for(auto& counter : counters_)
+		std::cout << "\t" << counter.first << " = " << counter.second << std::endl;
+}
+
+} // end namespace helpers
@@ -8,20 +8,29 @@ using namespace helpers;
 namespace mht
 {
 
-void Variable::addToOpenGM(
-	GraphicalModelType& model, 
+void Variable::addToOpenGM(GraphicalModelType& model)
+{
+	// only add variable if there are any features and it has not been pruned
+	if(!hasFeatures() || pruned_)
+	{
+		openGMVariableId_ = -1;
+		return;
+	}
+
+	model.addVariable(getNumStates());
+	openGMVariableId_ = model.numberOfVariables() - 1;
+}
+
+void Variable::addUnaryToOpenGM(
+	FactorBuffer& buffer, 
 	bool statesShareWeights,
 	WeightsType& weights, 
-	const std::vector<size_t>& weightIds)
+	const std::vector<size_t>& weightIds) const
 {
-	// only add variable if there are any features
-	if(features_.size() == 0 || features_[0].size() == 0)
+	if(openGMVariableId_ < 0)
 		return;
 
-	// Add variable to model. All Variables are binary!
 	size_t numStates = getNumStates();
-	model.addVariable(numStates);
-	openGMVariableId_ = model.numberOfVariables() - 1;
 	assert((int)weightIds.size() == getNumWeights(statesShareWeights));
 
 	if(statesShareWeights)
@@ -47,8 +56,7 @@ void Variable::addToOpenGM(
 
 	    std::vector<size_t> functionShape(1, numStates);
 	    LearnableWeightedSumOfFuncType unary(functionShape, weights, weightIds, features);
-		GraphicalModelType::FunctionIdentifier fid = model.addFunction(unary);
-		model.addFactor(fid, &openGMVariableId_, &openGMVariableId_+1);
+		buffer.addFactor(std::move(unary), openGMVariableId_);
 	}
 	else
 	{
@@ -72,9 +80,55 @@ void Variable::addToOpenGM(
 		}
 
 		LearnableUnaryFuncType unary(weights, featuresAndWeightsPerLabel);
-		GraphicalModelType::FunctionIdentifier fid = model.addFunction(unary);
-		model.addFactor(fid, &openGMVariableId_, &openGMVariableId_+1);
+		buffer.addFactor(std::move(unary), openGMVariableId_);
+	}
+
+	// the indicator of the fixed state must be one
+	if(fixedState_ >= 0)
+	{
+		if((size_t)fixedState_ >= numStates)
+			throw std::runtime_error("Variable is fixed to a state it does not have");
+		LinearConstraintFunctionType::LinearConstraintType fixedConstraint;
+		std::vector<LabelType> factorVariables;
+		std::vector<LabelType> constraintShape;
+		addOpenGMVariableToConstraint(fixedConstraint, openGMVariableId_, fixedState_, 1.0, constraintShape, factorVariables, buffer);
+		fixedConstraint.setBound(1);
+		fixedConstraint.setConstraintOperator(LinearConstraintFunctionType::LinearConstraintType::LinearConstraintOperatorType::Equal);
+		addConstraintToOpenGMModel(fixedConstraint, constraintShape, factorVariables, buffer);
+	}
+}
+
+void Variable::assignOpenGMVariableId(int& nextId)
+{
+	if(!hasFeatures())
+		return;
+	openGMVariableId_ = nextId++;
+}
+
+std::vector<ValueType> Variable::getStateEnergies(
+	bool statesShareWeights, 
+	const std::vector<ValueType>& weights, 
+	const std::vector<size_t>& weightIds) const
+{
+	std::vector<ValueType> energies;
+	if(!hasFeatures())
+		return energies;
+	assert((int)weightIds.size() == getNumWeights(statesShareWeights));
+
+	// weights are indexed the same way as in addToOpenGM()
+	size_t weightIdx = 0;
+	for(size_t state = 0; state < getNumStates(); ++state)
+	{
+		if(statesShareWeights)
+			weightIdx = 0;
+
+		ValueType energy = 0.0;
+		for(size_t i = 0; i < features_[state].size(); ++i)
+			energy += weights.at(weightIds.at(weightIdx++)) * features_[state][i];
+		energies.push_back(energy);
 	}
+
+	return energies;
 }
 
 const int Variable::getNumWeights(bool statesShareWeights) const
@@ -0,0 +1,110 @@
+#define BOOST_TEST_MODULE approximate_inference
+
+#include <iostream>
+
+#include "jsonmodel.h"
+#include "test_helpers.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace mht;
+using namespace helpers;
+
+BOOST_AUTO_TEST_CASE( ApproximateSolutionIsValidAndBounded )
+{
+	GeneratedModel generated;
+	std::string filename = generated.write();
+	JsonModel model;
+	model.readFromJson(filename);
+	std::vector<ValueType> weights(model.computeNumWeights(), 1.0);
+
+	Solution approximate = model.inferApproximate(weights, true);
+	BOOST_CHECK_CLOSE(model.evaluateSolution(approximate), model.getLastSolutionValue(), 1e-6);
+	checkBoundedSolution(filename, weights, approximate, model.getLastSolutionValue(), model.getLastLowerBound());
+}
+
+// With all weights at 1, the energy of a state is its feature. Every detection saves 5, appearing and disappearing
+// cost 3 each and every link costs 1, so the optimum joins the chain 1 -> 2 -> 3 -> 4 into a single track of energy -11.
+static const char* chainModel = R"({
+	"settings": {"statesShareWeights": true, "optimizerEpGap": 0.0, "useFlowSolver": false},
+	"segmentationHypotheses": [
+		{"id": 1, "timestep": 1, "features": [[0], [-5]], "appearanceFeatures": [[0], [3]], "disappearanceFeatures": [[0], [3]]},
+		{"id": 2, "timestep": 2, "features": [[0], [-5]], "appearanceFeatures": [[0], [3]], "disappearanceFeatures": [[0], [3]]},
+		{"id": 3, "timestep": 3, "features": [[0], [-5]], "appearanceFeatures": [[0], [3]], "disappearanceFeatures": [[0], [3]]},
+		{"id": 4, "timestep": 4, "features": [[0], [-5]], "appearanceFeatures": [[0], [3]], "disappearanceFeatures": [[0], [3]]}
+	],
+	"linkingHypotheses": [
+		{"src": 1, "dest": 2, "features": [[0], [1]]},
+		{"src": 2, "dest": 3, "features": [[0], [1]]},
+		{"src": 3, "dest": 4, "features": [[0], [1]]}
+	]
+})";
+
+BOOST_AUTO_TEST_CASE( ApproximateInferenceJoinsPaths )
+{
+	TemporaryJsonFile file(chainModel);
+	InspectableJsonModel model;
+	model.readFromJson(file.filename());
+	std::vector<ValueType> weights(model.computeNumWeights(), 1.0);
+
+	Solution solution = model.inferApproximate(weights, true);
+	BOOST_CHECK_CLOSE(model.getLastSolutionValue(), -11.0, 1e-6);
+	for(IdLabelType id : {1, 2, 3, 4})
+		BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.detection(id)), 1);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.link(1, 2)), 1);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.link(2, 3)), 1);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.link(3, 4)), 1);
+	// one track, which appears at its first and disappears at its last detection only
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.appearance(1)), 1);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.disappearance(4)), 1);
+	for(IdLabelType id : {2, 3, 4})
+		BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.appearance(id)), 0);
+	for(IdLabelType id : {1, 2, 3})
+		BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.disappearance(id)), 0);
+
+	double optimum = checkBoundedSolution(file.filename(), weights, solution, model.getLastSolutionValue(), model.getLastLowerBound());
+	BOOST_CHECK_CLOSE(optimum, -11.0, 1e-6);
+}
+
+// Detection 1 can divide into 2 and 3, which are followed by 4 and 5. Only 1 appears and only 4 and 5 disappear for free.
+// Without the division, one of the children appears at a cost of 3; dividing costs 1, so the optimum of -24 divides.
+static const char* divisionModel = R"({
+	"settings": {"statesShareWeights": true, "optimizerEpGap": 0.0, "useFlowSolver": false},
+	"segmentationHypotheses": [
+		{"id": 1, "timestep": 1, "features": [[0], [-5]], "divisionFeatures": [[0], [1]], "appearanceFeatures": [[0], [0]], "disappearanceFeatures": [[0], [3]]},
+		{"id": 2, "timestep": 2, "features": [[0], [-5]], "appearanceFeatures": [[0], [3]], "disappearanceFeatures": [[0], [3]]},
+		{"id": 3, "timestep": 2, "features": [[0], [-5]], "appearanceFeatures": [[0], [3]], "disappearanceFeatures": [[0], [3]]},
+		{"id": 4, "timestep": 3, "features": [[0], [-5]], "appearanceFeatures": [[0], [3]], "disappearanceFeatures": [[0], [0]]},
+		{"id": 5, "timestep": 3, "features": [[0], [-5]], "appearanceFeatures": [[0], [3]], "disappearanceFeatures": [[0], [0]]}
+	],
+	"linkingHypotheses": [
+		{"src": 1, "dest": 2, "features": [[0], [0]]},
+		{"src": 1, "dest": 3, "features": [[0], [0]]},
+		{"src": 2, "dest": 4, "features": [[0], [0]]},
+		{"src": 3, "dest": 5, "features": [[0], [0]]}
+	]
+})";
+
+BOOST_AUTO_TEST_CASE( ApproximateInferenceAddsDivisions )
+{
+	TemporaryJsonFile file(divisionModel);
+	InspectableJsonModel model;
+	model.readFromJson(file.filename());
+	std::vector<ValueType> weights(model.computeNumWeights(), 1.0);
+
+	// the paths 1 -> 2 -> 4 and 3 -> 5 are found first, then 1 divides and takes over 3 instead of letting it appear
+	Solution solution = model.inferApproximate(weights, true);
+	BOOST_CHECK_CLOSE(model.getLastSolutionValue(), -24.0, 1e-6);
+	for(IdLabelType id : {1, 2, 3, 4, 5})
+		BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.detection(id)), 1);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.division(1)), 1);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.link(1, 2)), 1);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.link(1, 3)), 1);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.link(2, 4)), 1);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.link(3, 5)), 1);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.appearance(2)), 0);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.appearance(3)), 0);
+
+	double optimum = checkBoundedSolution(file.filename(), weights, solution, model.getLastSolutionValue(), model.getLastLowerBound());
+	BOOST_CHECK_CLOSE(optimum, -24.0, 1e-6);
+}
@@ -0,0 +1,94 @@
+#define BOOST_TEST_MODULE dense_storage
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <random>
+#include <algorithm>
+
+#include <boost/test/unit_test.hpp>
+
+#include "densestorage.h"
+
+using namespace helpers;
+
+typedef std::pair<int, int> LinkId;
+
+// every entry must be found at the position where iteration visits it, with the value of the reference
+static void checkConsistency(const DenseMap<LinkId, int>& map, const std::vector<LinkId>& order, const std::map<LinkId, int>& reference)
+{
+	BOOST_REQUIRE_EQUAL(map.size(), order.size());
+	BOOST_REQUIRE_EQUAL(map.size(), reference.size());
+
+	size_t position = 0;
+	for(auto iter = map.begin(); iter != map.end(); ++iter, ++position)
+	{
+		BOOST_CHECK(iter->first == order[position]);
+		BOOST_CHECK_EQUAL(map.indexOf(iter->first), position);
+		BOOST_CHECK(map.find(iter->first) == iter);
+		BOOST_CHECK_EQUAL(map.count(iter->first), 1);
+		BOOST_CHECK_EQUAL(map.at(iter->first), reference.at(iter->first));
+	}
+}
+
+BOOST_AUTO_TEST_CASE( InsertionOrderAndLookup )
+{
+	DenseMap<LinkId, int> map;
+	BOOST_CHECK(map.empty());
+	BOOST_CHECK(map.emplace(LinkId(3, 4), 1).second);
+	BOOST_CHECK(map.emplace(LinkId(1, 2), 2).second);
+	map[LinkId(2, 3)] = 3;
+
+	// an existing key is neither inserted again nor overwritten
+	auto inserted = map.emplace(LinkId(3, 4), 10);
+	BOOST_CHECK(!inserted.second);
+	BOOST_CHECK_EQUAL(inserted.first->second, 1);
+
+	std::vector<LinkId> order = {LinkId(3, 4), LinkId(1, 2), LinkId(2, 3)};
+	std::map<LinkId, int> reference = {{LinkId(3, 4), 1}, {LinkId(1, 2), 2}, {LinkId(2, 3), 3}};
+	checkConsistency(map, order, reference);
+
+	BOOST_CHECK_EQUAL(map.indexOf(LinkId(4, 5)), (DenseMap<LinkId, int>::npos));
+	BOOST_CHECK(map.find(LinkId(4, 5)) == map.end());
+	BOOST_CHECK_THROW(map.at(LinkId(4, 5)), std::out_of_range);
+	BOOST_CHECK_EQUAL(map.erase(LinkId(4, 5)), 0);
+}
+
+BOOST_AUTO_TEST_CASE( RandomInsertionsAndRemovals )
+{
+	DenseMap<LinkId, int> map;
+	std::vector<LinkId> order;
+	std::map<LinkId, int> reference;
+	std::mt19937 random(42);
+	std::uniform_int_distribution<int> idDistribution(0, 30);
+
+	for(int step = 0; step < 2000; ++step)
+	{
+		LinkId key(idDistribution(random), idDistribution(random));
+		if(random() % 3 == 0)
+		{
+			size_t removed = map.erase(key);
+			BOOST_CHECK_EQUAL(removed, reference.erase(key));
+			// the last entry takes the place of the erased one
+			auto position = std::find(order.begin(), order.end(), key);
+			if(position != order.end())
+			{
+				*position = order.back();
+				order.pop_back();
+			}
+		}
+		else if(map.emplace(key, step).second)
+		{
+			order.push_back(key);
+			reference[key] = step;
+		}
+
+		if(step % 100 == 0)
+			checkConsistency(map, order, reference);
+	}
+	checkConsistency(map, order, reference);
+
+	map.clear();
+	BOOST_CHECK(map.empty());
+	BOOST_CHECK_EQUAL(map.count(order.front()), 0);
+}
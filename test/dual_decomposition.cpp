@@ -0,0 +1,66 @@
+#define BOOST_TEST_MODULE dual_decomposition
+
+#include <iostream>
+
+#include "jsonmodel.h"
+#include "test_helpers.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace mht;
+using namespace helpers;
+
+BOOST_AUTO_TEST_CASE( DualDecompositionIsValidAndBounded )
+{
+	GeneratedModel generated;
+	std::string filename = generated.write();
+	JsonModel model;
+	model.readFromJson(filename);
+	std::vector<ValueType> weights(model.computeNumWeights(), 1.0);
+
+	// the solution is evaluated on an independent full model, its energy must be the one dual decomposition reports
+	Solution solution = model.inferDualDecomposition(weights, 2, 1);
+	checkBoundedSolution(filename, weights, solution, model.getLastSolutionValue(), model.getLastLowerBound());
+}
+
+// With all weights at 1, the energy of a state is its feature. The link 1 -> 2 joins two timesteps, which are solved 
+// in different chunks, and each chunk gets half of its cost of 2. On its own, the first chunk rather lets 1 disappear
+// for 0.25 and the second one takes the link instead of letting 2 appear for 3, so the multipliers of the link have
+// to move until both agree on the track 1 -> 2 of energy -8.
+static const char* chunkBoundaryModel = R"({
+	"settings": {"statesShareWeights": true, "optimizerEpGap": 0.0, "useFlowSolver": false, "allowLengthOneTracks": true},
+	"segmentationHypotheses": [
+		{"id": 1, "timestep": 1, "features": [[0], [-5]], "appearanceFeatures": [[0], [0]], "disappearanceFeatures": [[0], [0.25]]},
+		{"id": 2, "timestep": 2, "features": [[0], [-5]], "appearanceFeatures": [[0], [3]], "disappearanceFeatures": [[0], [0]]}
+	],
+	"linkingHypotheses": [
+		{"src": 1, "dest": 2, "features": [[0], [2]]}
+	]
+})";
+
+BOOST_AUTO_TEST_CASE( ChunksAgreeOnLinkAcrossBoundary )
+{
+	TemporaryJsonFile file(chunkBoundaryModel);
+	InspectableJsonModel model;
+	model.readFromJson(file.filename());
+	std::vector<ValueType> weights(model.computeNumWeights(), 1.0);
+
+	Solution solution = model.inferDualDecomposition(weights, 1, 0);
+	BOOST_CHECK_EQUAL(model.getTelemetry().getCounter("dualDecomposition.chunks"), 2);
+	BOOST_CHECK_EQUAL(model.getTelemetry().getCounter("dualDecomposition.sharedColumns"), 1);
+	// the copies of the link disagree at first, so the multipliers are updated at least once
+	BOOST_CHECK(model.getTelemetry().getCounter("dualDecomposition.iterations") >= 2);
+	BOOST_CHECK_CLOSE(model.getLastLowerBound(), -8.0, 1e-4);
+	BOOST_CHECK_CLOSE(model.getLastSolutionValue(), -8.0, 1e-6);
+
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.link(1, 2)), 1);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.detection(1)), 1);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.detection(2)), 1);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.appearance(1)), 1);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.disappearance(1)), 0);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.appearance(2)), 0);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.disappearance(2)), 1);
+
+	double optimum = checkBoundedSolution(file.filename(), weights, solution, model.getLastSolutionValue(), model.getLastLowerBound());
+	BOOST_CHECK_CLOSE(optimum, -8.0, 1e-6);
+}
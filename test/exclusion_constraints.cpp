@@ -0,0 +1,109 @@
+#define BOOST_TEST_MODULE exclusion_constraints
+
+#include <iostream>
+#include <cmath>
+#include <map>
+#include <algorithm>
+
+#include "jsonmodel.h"
+#include "solverbackend.h"
+#include "test_helpers.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace mht;
+using namespace helpers;
+
+static bool startsWith(const std::string& name, const std::string& prefix)
+{
+	return name.compare(0, prefix.size(), prefix) == 0;
+}
+
+// Replace every transition exclusion row "sum of link values + maxObjects * active(app or dis) <= maxObjects"
+// by one pairwise row "active(app or dis) + active(link) <= 1" per link. Columns belong to the variable of their columnStates entry.
+static LinearProgram splitTransitionExclusions(const LinearProgram& program, const std::vector< std::pair<size_t, LabelType> >& columnStates)
+{
+	LinearProgram pairwise = program;
+	pairwise.rowOffsets_ = {0};
+	pairwise.columns_.clear();
+	pairwise.coefficients_.clear();
+	pairwise.rowLower_.clear();
+	pairwise.rowUpper_.clear();
+	pairwise.rowNames_.clear();
+
+	for(size_t r = 0; r < program.numRows(); ++r)
+	{
+		const std::string& name = program.rowNames_[r];
+		if(!startsWith(name, "appearance_") && !startsWith(name, "disappearance_"))
+		{
+			for(size_t i = program.rowOffsets_[r]; i < program.rowOffsets_[r + 1]; ++i)
+			{
+				pairwise.columns_.push_back(program.columns_[i]);
+				pairwise.coefficients_.push_back(program.coefficients_[i]);
+			}
+			pairwise.closeRow(program.rowLower_[r], program.rowUpper_[r], name);
+			continue;
+		}
+
+		std::vector<size_t> transitionColumns;
+		std::map< size_t, std::vector<size_t> > linkColumns;
+		for(size_t i = program.rowOffsets_[r]; i < program.rowOffsets_[r + 1]; ++i)
+		{
+			size_t column = program.columns_[i];
+			if(startsWith(program.columnNames_[column], "link_"))
+				linkColumns[columnStates[column].first].push_back(column);
+			else
+				transitionColumns.push_back(column);
+		}
+		BOOST_REQUIRE(!transitionColumns.empty());
+
+		for(auto& link : linkColumns)
+		{
+			for(size_t column : transitionColumns)
+			{
+				pairwise.columns_.push_back(column);
+				pairwise.coefficients_.push_back(1.0);
+			}
+			for(size_t column : link.second)
+			{
+				pairwise.columns_.push_back(column);
+				pairwise.coefficients_.push_back(1.0);
+			}
+			pairwise.closeRow(program.rowLower_[r], 1.0, name + "_" + std::to_string(link.first));
+		}
+	}
+	return pairwise;
+}
+
+BOOST_AUTO_TEST_CASE( TransitionExclusionsMatchPairwiseExclusions )
+{
+	ModelGenerator::Parameters parameters = GeneratedModel::defaultParameters();
+	parameters.maxNumObjects = 3;
+	GeneratedModel generated(parameters);
+	generated.setSetting(JsonTypes::AllowPartialMergerAppearance, false);
+	JsonModel model;
+	model.readFromJson(generated.write());
+	std::vector<ValueType> weights = generated.getWeights();
+
+	// the OpenGM model uses SegmentationHypothesis::addTransitionExclusionConstraintToOpenGM()
+	model.infer(weights);
+	double energy = model.getLastSolutionValue();
+
+	std::vector< std::pair<size_t, LabelType> > columnStates;
+	LinearProgram program = model.buildLinearProgram(weights, &columnStates);
+	size_t numTransitionRows = std::count_if(program.rowNames_.begin(), program.rowNames_.end(), [](const std::string& name) {
+		return startsWith(name, "appearance_") || startsWith(name, "disappearance_");
+	});
+	BOOST_REQUIRE(numTransitionRows > 0);
+	LinearProgram pairwise = splitTransitionExclusions(program, columnStates);
+	BOOST_CHECK(pairwise.numRows() > program.numRows());
+
+	SolverParameters solverParameters;
+	solverParameters.epGap = 0.0;
+	std::unique_ptr<SolverBackend> backend = SolverBackend::create(SolverBackend::availableNames().front());
+	const double tolerance = 1e-6 * std::max(1.0, std::abs(energy));
+	double transitionValue = backend->solve(program, solverParameters, std::vector<double>()).value;
+	double pairwiseValue = backend->solve(pairwise, solverParameters, std::vector<double>()).value;
+	BOOST_CHECK(std::abs(transitionValue - energy) < tolerance);
+	BOOST_CHECK(std::abs(pairwiseValue - energy) < tolerance);
+}
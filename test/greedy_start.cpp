@@ -0,0 +1,97 @@
+#define BOOST_TEST_MODULE greedy_start
+
+#include <iostream>
+#include <algorithm>
+
+#include "jsonmodel.h"
+#include "test_helpers.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace mht;
+using namespace helpers;
+
+BOOST_AUTO_TEST_CASE( GreedyStartIsValid )
+{
+	GeneratedModel generated;
+	JsonModel model;
+	model.readFromJson(generated.write());
+	std::vector<ValueType> weights(model.computeNumWeights(), 1.0);
+
+	Solution start = model.constructGreedySolution(weights);
+	BOOST_CHECK(model.verifySolution(start));
+	BOOST_CHECK(std::count(start.begin(), start.end(), 1) > 0);
+
+	// the greedy start can only be worse than the optimum
+	Solution solution = model.infer(weights, start);
+	BOOST_CHECK(model.verifySolution(solution));
+	BOOST_CHECK(model.evaluateSolution(solution) <= model.evaluateSolution(start) + 1e-6);
+
+	// starts that violate constraints are ignored
+	Solution invalid(start.size(), 1);
+	Solution other = model.infer(weights, invalid);
+	BOOST_CHECK(model.verifySolution(other));
+}
+
+// With all weights at 1, the energy of a state is its feature. Appearing and disappearing cost 3 each. The greedy start
+// takes the link 1 -> 2, which saves the most, for a track of energy -1, but the optimal track 1 -> 3 has energy -2.
+static const char* greedyModel = R"({
+	"settings": {"statesShareWeights": true, "optimizerEpGap": 0.0, "useFlowSolver": false},
+	"segmentationHypotheses": [
+		{"id": 1, "timestep": 1, "features": [[0], [-5]], "appearanceFeatures": [[0], [3]], "disappearanceFeatures": [[0], [3]]},
+		{"id": 2, "timestep": 2, "features": [[0], [-2]], "appearanceFeatures": [[0], [3]], "disappearanceFeatures": [[0], [3]]},
+		{"id": 3, "timestep": 2, "features": [[0], [-5]], "appearanceFeatures": [[0], [3]], "disappearanceFeatures": [[0], [3]]}
+	],
+	"linkingHypotheses": [
+		{"src": 1, "dest": 2, "features": [[0], [0]]},
+		{"src": 1, "dest": 3, "features": [[0], [2]]}
+	]
+})";
+
+static void checkOptimalTrack(const InspectableJsonModel& model, const Solution& solution)
+{
+	BOOST_CHECK_CLOSE(model.getLastSolutionValue(), -2.0, 1e-6);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.link(1, 3)), 1);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.link(1, 2)), 0);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(solution, model.detection(2)), 0);
+}
+
+BOOST_AUTO_TEST_CASE( ValidStartIsUsed )
+{
+	TemporaryJsonFile file(greedyModel);
+	InspectableJsonModel model;
+	model.readFromJson(file.filename());
+	std::vector<ValueType> weights(model.computeNumWeights(), 1.0);
+
+	Solution start = model.constructGreedySolution(weights);
+	BOOST_CHECK(model.verifySolution(start));
+	BOOST_CHECK_CLOSE(model.evaluateSolution(start), -1.0, 1e-6);
+	for(const Variable* variable : {&model.detection(1), &model.detection(2), &model.link(1, 2), &model.appearance(1), &model.disappearance(2)})
+		BOOST_CHECK_EQUAL(InspectableJsonModel::getState(start, *variable), 1);
+	for(const Variable* variable : {&model.detection(3), &model.link(1, 3), &model.disappearance(1), &model.appearance(2)})
+		BOOST_CHECK_EQUAL(InspectableJsonModel::getState(start, *variable), 0);
+
+	// the solver starts from the greedy tracking and improves on it
+	Solution solution = model.infer(weights, start);
+	BOOST_CHECK_EQUAL(model.getTelemetry().getCounter("start.ignored"), 0);
+	BOOST_CHECK_EQUAL(model.getTelemetry().getCounter("solver.startingPoints"), 1);
+	checkOptimalTrack(model, solution);
+}
+
+BOOST_AUTO_TEST_CASE( InfeasibleStartIsRejected )
+{
+	TemporaryJsonFile file(greedyModel);
+	InspectableJsonModel model;
+	model.readFromJson(file.filename());
+	std::vector<ValueType> weights(model.computeNumWeights(), 1.0);
+
+	// without the link, detection 2 neither appears nor has a predecessor
+	Solution start = model.constructGreedySolution(weights);
+	start[model.link(1, 2).getOpenGMVariableId()] = 0;
+	BOOST_CHECK(!model.verifySolution(start));
+
+	Solution solution = model.infer(weights, start);
+	BOOST_CHECK_EQUAL(model.getTelemetry().getCounter("start.ignored"), 1);
+	BOOST_CHECK_EQUAL(model.getTelemetry().getCounter("solver.startingPoints"), 0);
+	checkOptimalTrack(model, solution);
+}
@@ -4,6 +4,8 @@
 #include <fstream>
 #include <json/json.h>
 
+#include "jsonstreamreader.h"
+
 #include <boost/test/unit_test.hpp>
 
 BOOST_AUTO_TEST_CASE( json_test )
@@ -61,4 +63,73 @@ BOOST_AUTO_TEST_CASE( json_test )
 		BOOST_CHECK_EQUAL(hyp[0].asInt(), 7);
 		BOOST_CHECK_EQUAL(hyp[1].asInt(), 9);
 	}
-}
\ No newline at end of file
+}
+
+BOOST_AUTO_TEST_CASE( json_stream_test )
+{
+	std::ifstream doc("example.json");
+	BOOST_CHECK(doc.good());
+	helpers::JsonStreamReader reader(doc);
+
+	std::string key;
+	std::string author;
+	size_t numSegmentations = 0;
+	std::vector<double> linkFeatures;
+	std::vector<unsigned int> exclusion;
+
+	BOOST_CHECK(reader.peek() == helpers::JsonStreamReader::TokenType::Object);
+	reader.beginObject();
+	while(reader.nextMember(key))
+	{
+		if(key == "author")
+			author = reader.readString();
+		else if(key == "segmentation-hypotheses")
+		{
+			reader.beginArray();
+			while(reader.nextElement())
+			{
+				reader.skipValue();
+				numSegmentations++;
+			}
+		}
+		else if(key == "linking-hypotheses")
+		{
+			reader.beginArray();
+			while(reader.nextElement())
+			{
+				std::string linkKey;
+				reader.beginObject();
+				while(reader.nextMember(linkKey))
+				{
+					if(linkKey == "features")
+					{
+						reader.beginArray();
+						while(reader.nextElement())
+							linkFeatures.push_back(reader.readDouble());
+					}
+					else
+						reader.skipValue();
+				}
+			}
+		}
+		else if(key == "exclusions")
+		{
+			Json::Value exclusions = reader.readValue();
+			BOOST_CHECK(exclusions.isArray());
+			for(int i = 0; i < (int)exclusions[0].size(); i++)
+				exclusion.push_back(exclusions[0][i].asUInt());
+		}
+		else
+			reader.skipValue();
+	}
+	BOOST_CHECK(reader.peek() == helpers::JsonStreamReader::TokenType::EndOfInput);
+
+	BOOST_CHECK_EQUAL(author, "carsten");
+	BOOST_CHECK_EQUAL(numSegmentations, 3);
+	BOOST_CHECK_EQUAL(linkFeatures.size(), 2);
+	BOOST_CHECK_CLOSE(linkFeatures[0], 0.9, 0.0001);
+	BOOST_CHECK_CLOSE(linkFeatures[1], 0.3, 0.0001);
+	BOOST_CHECK_EQUAL(exclusion.size(), 2);
+	BOOST_CHECK_EQUAL(exclusion[0], 7);
+	BOOST_CHECK_EQUAL(exclusion[1], 9);
+}
@@ -0,0 +1,96 @@
+#define BOOST_TEST_MODULE learning
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <algorithm>
+
+#include "jsonmodel.h"
+#include "test_helpers.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace mht;
+using namespace helpers;
+
+// small models of the same kind that differ by their seed, so they have the same weights
+static ModelGenerator::Parameters getInstanceParameters(unsigned int seed)
+{
+	ModelGenerator::Parameters parameters = GeneratedModel::defaultParameters();
+	parameters.numFrames = 3;
+	parameters.detectionsPerFrame = 10;
+	parameters.divisionRate = 0.3;
+	parameters.seed = seed;
+	return parameters;
+}
+
+BOOST_AUTO_TEST_CASE( LearningRecoversTheGroundTruthOfEveryInstance )
+{
+	// the ground truth of every instance is its optimum for the weights of the generator, so weights exist that reproduce all of them
+	std::vector< std::unique_ptr<GeneratedModel> > generated;
+	std::vector< std::unique_ptr<JsonModel> > models;
+	std::vector<Model*> instances;
+	for(unsigned int seed : {1, 2, 3})
+	{
+		generated.emplace_back(new GeneratedModel(getInstanceParameters(seed)));
+		std::string filename = generated.back()->write();
+		std::string gtFilename = generated.back()->getTemporaryFilename(".json");
+		{
+			JsonModel model;
+			model.readFromJson(filename);
+			model.saveResultToJson(gtFilename, model.infer(generated.back()->getWeights()));
+		}
+
+		models.emplace_back(new JsonModel());
+		models.back()->readFromJson(filename);
+		models.back()->setJsonGtFile(gtFilename);
+		instances.push_back(models.back().get());
+	}
+
+	std::vector<ValueType> weights = Model::learnFromInstances(instances, std::vector<ValueType>(models.front()->computeNumWeights(), 0));
+	BOOST_REQUIRE_EQUAL(weights.size(), models.front()->computeNumWeights());
+
+	// the ground truth of every instance is an optimal solution for the learned weights, up to ties with other solutions
+	for(auto& model : models)
+	{
+		model->infer(weights);
+		double optimum = model->getLastSolutionValue();
+		Solution gt = model->getGroundTruth();
+		BOOST_CHECK(model->verifySolution(gt));
+		BOOST_CHECK(model->evaluateSolution(gt) <= optimum + 1e-6 * std::max(1.0, std::abs(optimum)));
+	}
+}
+
+BOOST_AUTO_TEST_CASE( ConcurrentLossAugmentedInferenceLearnsTheSameWeights )
+{
+	// the components are the instances of the dataset, whose loss augmented inference runs on componentNumThreads threads.
+	// A single link per detection and no exclusions make many small components
+	ModelGenerator::Parameters parameters = getInstanceParameters(1);
+	parameters.linkFanOut = 1;
+	parameters.exclusionRate = 0.0;
+	std::vector< std::vector<ValueType> > learnedWeights;
+	for(size_t numThreads : {1, 4})
+	{
+		GeneratedModel generated(parameters);
+		generated.setSetting(JsonTypes::DecomposeIntoComponents, true);
+		generated.setSetting(JsonTypes::ComponentNumThreads, Json::UInt64(numThreads));
+		std::string filename = generated.write();
+		std::string gtFilename = generated.getTemporaryFilename(".json");
+		{
+			JsonModel model;
+			model.readFromJson(filename);
+			model.saveResultToJson(gtFilename, model.infer(generated.getWeights()));
+		}
+
+		JsonModel model;
+		model.readFromJson(filename);
+		model.setJsonGtFile(gtFilename);
+		learnedWeights.push_back(model.learn());
+	}
+
+	// the gradients are summed in the order of the instances, so the weights are exactly the same
+	BOOST_REQUIRE_EQUAL(learnedWeights[0].size(), learnedWeights[1].size());
+	for(size_t i = 0; i < learnedWeights[0].size(); ++i)
+		BOOST_CHECK_EQUAL(learnedWeights[0][i], learnedWeights[1][i]);
+}
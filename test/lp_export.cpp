@@ -0,0 +1,49 @@
+#define BOOST_TEST_MODULE lp_export
+
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <algorithm>
+
+#include "jsonmodel.h"
+#include "solverbackend.h"
+#include "lpfile.h"
+#include "test_helpers.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace mht;
+using namespace helpers;
+
+BOOST_AUTO_TEST_CASE( ExportedProgramHasTheSameOptimum )
+{
+	GeneratedModel generated;
+	JsonModel model;
+	model.readFromJson(generated.write());
+	std::vector<ValueType> weights(model.computeNumWeights(), 1.0);
+	Solution solution = model.infer(weights);
+	double energy = model.getLastSolutionValue();
+
+	// the compact program is solved to the same energy, including its offset
+	LinearProgram program = model.buildLinearProgram(weights);
+	SolverParameters parameters;
+	parameters.epGap = 0.0;
+	SolverResult result = SolverBackend::create(SolverBackend::availableNames().front())->solve(program, parameters, std::vector<double>());
+	BOOST_CHECK(std::abs(result.value - energy) < 1e-6 * std::max(1.0, std::abs(energy)));
+
+	// write the program, and read a solution file of it back into the solution of infer()
+	model.exportLinearProgram(weights, generated.getTemporaryFilename(".lp"));
+	model.exportLinearProgram(weights, generated.getTemporaryFilename(".mps"));
+	std::vector< std::pair<size_t, LabelType> > columnStates;
+	program = model.buildLinearProgram(weights, &columnStates);
+	std::string solutionFilename = generated.getTemporaryFilename(".sol");
+	{
+		std::ofstream file(solutionFilename.c_str());
+		file << "# Objective value = " << energy << std::endl;
+		for(size_t c = 0; c < program.numColumns(); ++c)
+			file << program.columnNames_[c] << " " << (solution[columnStates[c].first] == columnStates[c].second ? 1 : 0) << std::endl;
+	}
+	Solution readSolution = model.readLinearProgramSolution(weights, solutionFilename);
+	BOOST_CHECK(readSolution == solution);
+	BOOST_CHECK_CLOSE(model.getLastSolutionValue(), energy, 1e-6);
+}
@@ -0,0 +1,117 @@
+#define BOOST_TEST_MODULE mincostflow
+
+#include <iostream>
+
+#include <boost/test/unit_test.hpp>
+
+#include "mincostflow.h"
+#include "jsonmodel.h"
+#include "test_helpers.h"
+
+using namespace mht;
+using namespace helpers;
+
+BOOST_AUTO_TEST_CASE( TwoTracks )
+{
+	// source 0, sink 1, two detections per frame in two frames: (2,3) (4,5) in frame 0, (6,7) (8,9) in frame 1
+	MinCostFlow flow(10);
+	size_t app0 = flow.addArc(0, 2, 1.0);
+	size_t app1 = flow.addArc(0, 4, 1.0);
+	size_t det0 = flow.addArc(2, 3, -5.0);
+	size_t det1 = flow.addArc(4, 5, -5.0);
+	size_t det2 = flow.addArc(6, 7, -5.0);
+	size_t det3 = flow.addArc(8, 9, 2.0);
+	size_t link02 = flow.addArc(3, 6, 1.0);
+	size_t link03 = flow.addArc(3, 8, 0.5);
+	size_t link12 = flow.addArc(5, 6, 0.5);
+	size_t dis0 = flow.addArc(3, 1, 3.0);
+	size_t dis1 = flow.addArc(5, 1, 3.0);
+	size_t dis2 = flow.addArc(7, 1, 1.0);
+	size_t dis3 = flow.addArc(9, 1, 1.0);
+
+	BOOST_CHECK(flow.solve(0, 1));
+
+	// the cheapest first path goes through link12, then detection 0 forms a track on its own
+	BOOST_CHECK_EQUAL(flow.getNumPaths(), 2);
+	BOOST_CHECK_CLOSE(flow.getCost(), -8.5, 1e-8);
+	BOOST_CHECK(flow.hasFlow(app0));
+	BOOST_CHECK(flow.hasFlow(app1));
+	BOOST_CHECK(flow.hasFlow(det0));
+	BOOST_CHECK(flow.hasFlow(det1));
+	BOOST_CHECK(flow.hasFlow(det2));
+	BOOST_CHECK(!flow.hasFlow(det3));
+	BOOST_CHECK(!flow.hasFlow(link02));
+	BOOST_CHECK(!flow.hasFlow(link03));
+	BOOST_CHECK(flow.hasFlow(link12));
+	BOOST_CHECK(flow.hasFlow(dis0));
+	BOOST_CHECK(!flow.hasFlow(dis1));
+	BOOST_CHECK(flow.hasFlow(dis2));
+	BOOST_CHECK(!flow.hasFlow(dis3));
+}
+
+BOOST_AUTO_TEST_CASE( ReroutePreviousPath )
+{
+	// the second path must push flow back along the reverse of an arc used by the first path
+	MinCostFlow flow(6);
+	size_t a = flow.addArc(0, 2, -2.0);
+	size_t b = flow.addArc(2, 3, 1.0);
+	size_t c = flow.addArc(3, 1, -2.0);
+	size_t d = flow.addArc(0, 3, 0.0);
+	size_t e = flow.addArc(2, 4, 0.0);
+	size_t f = flow.addArc(4, 1, 0.0);
+
+	BOOST_CHECK(flow.solve(0, 1));
+	BOOST_CHECK_EQUAL(flow.getNumPaths(), 2);
+	BOOST_CHECK_CLOSE(flow.getCost(), -4.0, 1e-8);
+	BOOST_CHECK(flow.hasFlow(a));
+	BOOST_CHECK(!flow.hasFlow(b));
+	BOOST_CHECK(flow.hasFlow(c));
+	BOOST_CHECK(flow.hasFlow(d));
+	BOOST_CHECK(flow.hasFlow(e));
+	BOOST_CHECK(flow.hasFlow(f));
+}
+
+BOOST_AUTO_TEST_CASE( NegativeCycle )
+{
+	MinCostFlow flow(4);
+	flow.addArc(0, 2, 1.0);
+	flow.addArc(2, 3, -1.0);
+	flow.addArc(3, 2, -1.0);
+	flow.addArc(3, 1, 1.0);
+	BOOST_CHECK(!flow.solve(0, 1));
+}
+
+// solve a generated model without divisions, exclusions and mergers, with or without the min-cost-flow solver
+static Solution solveFlowProblem(bool useFlowSolver, double& energy, double& flowPaths)
+{
+	ModelGenerator::Parameters parameters;
+	parameters.numFrames = 5;
+	parameters.detectionsPerFrame = 20;
+	parameters.maxNumObjects = 1;
+	parameters.divisionRate = 0.0;
+	parameters.exclusionRate = 0.0;
+	GeneratedModel generated(parameters);
+	generated.setSetting(JsonTypes::UseFlowSolver, useFlowSolver);
+
+	JsonModel model;
+	model.readFromJson(generated.write());
+	Solution solution = model.infer(generated.getWeights());
+	BOOST_CHECK(model.verifySolution(solution));
+	BOOST_CHECK_CLOSE(model.evaluateSolution(solution), model.getLastSolutionValue(), 1e-6);
+	energy = model.getLastSolutionValue();
+	flowPaths = model.getTelemetry().getCounter("solver.flowPaths");
+	return solution;
+}
+
+BOOST_AUTO_TEST_CASE( FlowPathMatchesILP )
+{
+	double flowEnergy, ilpEnergy, flowPaths, ilpFlowPaths;
+	Solution flowSolution = solveFlowProblem(true, flowEnergy, flowPaths);
+	Solution ilpSolution = solveFlowProblem(false, ilpEnergy, ilpFlowPaths);
+
+	// only the first model may have been solved as min-cost-flow, and it must reach the optimum of the ILP
+	BOOST_CHECK(flowPaths > 0);
+	BOOST_CHECK_EQUAL(ilpFlowPaths, 0);
+	BOOST_CHECK_EQUAL(flowSolution.size(), ilpSolution.size());
+	BOOST_CHECK_CLOSE(flowEnergy, ilpEnergy, 1e-6);
+}
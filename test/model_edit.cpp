@@ -0,0 +1,79 @@
+#define BOOST_TEST_MODULE model_edit
+
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+#include "jsonmodel.h"
+#include "test_helpers.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace mht;
+using namespace helpers;
+
+BOOST_AUTO_TEST_CASE( EditedModelMatchesRebuiltModel )
+{
+	GeneratedModel generated;
+	generated.setSetting(JsonTypes::DecomposeIntoComponents, true);
+	std::string editedFilename = generated.write();
+	Json::Value& root = generated.root();
+
+	// the same graph without one detection and everything that refers to it, as if it had been read after proofreading
+	Json::Value& segmentations = root[JsonTypeNames[JsonTypes::Segmentations]];
+	IdLabelType removedId = segmentations[segmentations.size() / 2][JsonTypeNames[JsonTypes::Id]].asLabelType();
+	IdLabelType fixedId = segmentations[0][JsonTypeNames[JsonTypes::Id]].asLabelType();
+	auto refersToRemoved = [&](const Json::Value& entry)
+	{
+		for(auto type : {JsonTypes::Id, JsonTypes::SrcId, JsonTypes::DestId, JsonTypes::Parent})
+			if(entry.isMember(JsonTypeNames[type]) && entry[JsonTypeNames[type]].asLabelType() == removedId)
+				return true;
+		for(auto& child : entry[JsonTypeNames[JsonTypes::Children]])
+			if(child.asLabelType() == removedId)
+				return true;
+		return false;
+	};
+	for(auto type : {JsonTypes::Segmentations, JsonTypes::Links, JsonTypes::Divisions})
+	{
+		Json::Value kept(Json::arrayValue);
+		for(auto& entry : root[JsonTypeNames[type]])
+			if(!refersToRemoved(entry))
+				kept.append(entry);
+		root[JsonTypeNames[type]] = kept;
+	}
+	Json::Value exclusions(Json::arrayValue);
+	for(auto& exclusion : root[JsonTypeNames[JsonTypes::Exclusions]])
+	{
+		Json::Value ids(Json::arrayValue);
+		for(auto& id : exclusion)
+			if(id.asLabelType() != removedId)
+				ids.append(id);
+		if(ids.size() > 1)
+			exclusions.append(ids);
+	}
+	root[JsonTypeNames[JsonTypes::Exclusions]] = exclusions;
+
+	JsonModel editedModel, rebuiltModel;
+	editedModel.readFromJson(editedFilename);
+	rebuiltModel.readFromJson(generated.write());
+	std::vector<ValueType> weights(editedModel.computeNumWeights(), 1.0);
+	editedModel.infer(weights);
+
+	editedModel.removeSegmentationHypothesis(removedId);
+	Solution solution = editedModel.infer(weights);
+	rebuiltModel.infer(weights);
+	BOOST_CHECK(rebuiltModel.verifySolution(solution));
+	double optimum = rebuiltModel.getLastSolutionValue();
+	BOOST_CHECK(std::abs(editedModel.getLastSolutionValue() - optimum) < 1e-6 * std::max(1.0, std::abs(optimum)));
+
+	// a fixed detection cannot lower the energy, and releasing it finds the optimum again
+	// only the component of the fixed detection is solved again
+	editedModel.fixDetection(fixedId, 0);
+	solution = editedModel.infer(weights);
+	BOOST_CHECK_EQUAL(editedModel.getTelemetry().getCounter("opengm.solvedComponents"), 1);
+	BOOST_CHECK(editedModel.verifySolution(solution));
+	BOOST_CHECK(editedModel.getLastSolutionValue() >= optimum - 1e-6 * std::max(1.0, std::abs(optimum)));
+	editedModel.fixDetection(fixedId, -1);
+	editedModel.infer(weights);
+	BOOST_CHECK(std::abs(editedModel.getLastSolutionValue() - optimum) < 1e-6 * std::max(1.0, std::abs(optimum)));
+}
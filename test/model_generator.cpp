@@ -0,0 +1,55 @@
+#define BOOST_TEST_MODULE model_generator
+
+#include <iostream>
+#include <sstream>
+
+#include "modelgenerator.h"
+#include "jsonmodel.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace mht;
+using namespace helpers;
+
+BOOST_AUTO_TEST_CASE( GeneratedModelIsReadable )
+{
+	ModelGenerator::Parameters parameters;
+	parameters.numFrames = 5;
+	parameters.detectionsPerFrame = 20;
+	parameters.maxNumObjects = 2;
+	parameters.divisionRate = 0.2;
+	parameters.exclusionRate = 0.2;
+	parameters.numFeatures = 3;
+
+	ModelGenerator generator(parameters);
+	generator.saveModelToJson("generated.json");
+	BOOST_CHECK_EQUAL(generator.getNumSegmentations(), 100);
+	BOOST_CHECK_EQUAL(generator.getNumLinks(), 4 * 20 * parameters.linkFanOut);
+	BOOST_CHECK(generator.getNumDivisions() > 0);
+	BOOST_CHECK(generator.getNumExclusions() > 0);
+
+	JsonModel model;
+	model.readFromJson("generated.json");
+	BOOST_CHECK_EQUAL(model.computeNumWeights(), generator.getWeights().size());
+
+	Solution solution = model.infer(generator.getWeights());
+	BOOST_CHECK(model.verifySolution(solution));
+	BOOST_CHECK_EQUAL(model.getTelemetry().getCounter("variables.links"), generator.getNumLinks());
+}
+
+BOOST_AUTO_TEST_CASE( GeneratorIsDeterministic )
+{
+	ModelGenerator::Parameters parameters;
+	parameters.exclusionRate = 0.1;
+	parameters.externalDivisions = true;
+
+	std::stringstream first, second;
+	ModelGenerator(parameters).writeModel(first);
+	ModelGenerator(parameters).writeModel(second);
+	BOOST_CHECK(first.str() == second.str());
+
+	parameters.seed++;
+	std::stringstream third;
+	ModelGenerator(parameters).writeModel(third);
+	BOOST_CHECK(first.str() != third.str());
+}
@@ -0,0 +1,65 @@
+#define BOOST_TEST_MODULE parallel_build
+
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+#include "jsonmodel.h"
+#include "test_helpers.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace mht;
+using namespace helpers;
+
+// gives access to the OpenGM model that infer() builds
+class InspectableModel : public JsonModel
+{
+public:
+	const GraphicalModelType& getOpenGMModel() const { return model_; }
+};
+
+BOOST_AUTO_TEST_CASE( ParallelBuildIsDeterministic )
+{
+	// enough hypotheses for several chunks of factors
+	ModelGenerator::Parameters parameters;
+	parameters.numFrames = 4;
+	parameters.detectionsPerFrame = 400;
+	parameters.exclusionRate = 0.1;
+	GeneratedModel generated(parameters);
+	generated.setSetting(JsonTypes::BuildNumThreads, 1);
+	InspectableModel sequentialModel;
+	sequentialModel.readFromJson(generated.write());
+	generated.setSetting(JsonTypes::BuildNumThreads, 4);
+	InspectableModel parallelModel;
+	parallelModel.readFromJson(generated.write());
+
+	std::vector<ValueType> weights = generated.getWeights();
+	sequentialModel.infer(weights);
+	parallelModel.infer(weights);
+	BOOST_CHECK(std::abs(sequentialModel.getLastSolutionValue() - parallelModel.getLastSolutionValue())
+		< 1e-6 * std::max(1.0, std::abs(sequentialModel.getLastSolutionValue())));
+
+	// the factors must be the same and in the same order, no matter which thread built them
+	const GraphicalModelType& sequential = sequentialModel.getOpenGMModel();
+	const GraphicalModelType& parallel = parallelModel.getOpenGMModel();
+	BOOST_REQUIRE_EQUAL(sequential.numberOfVariables(), parallel.numberOfVariables());
+	BOOST_REQUIRE_EQUAL(sequential.numberOfFactors(), parallel.numberOfFactors());
+	BOOST_CHECK(sequential.numberOfFactors() > 2 * 1024);
+	size_t numMismatches = 0;
+	for(size_t f = 0; f < sequential.numberOfFactors(); ++f)
+	{
+		bool same = sequential[f].functionType() == parallel[f].functionType()
+			&& sequential[f].numberOfVariables() == parallel[f].numberOfVariables();
+		for(size_t v = 0; same && v < sequential[f].numberOfVariables(); ++v)
+			same = sequential[f].variableIndex(v) == parallel[f].variableIndex(v);
+		if(same && sequential[f].numberOfVariables() == 1)
+		{
+			for(LabelType label = 0; label < sequential[f].numberOfLabels(0); ++label)
+				same = same && sequential[f](&label) == parallel[f](&label);
+		}
+		if(!same)
+			numMismatches++;
+	}
+	BOOST_CHECK_EQUAL(numMismatches, 0);
+}
@@ -0,0 +1,121 @@
+#define BOOST_TEST_MODULE presolve
+
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+#include "jsonmodel.h"
+#include "test_helpers.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace mht;
+using namespace helpers;
+
+// gives access to presolve() and to the variables it prunes
+class PresolvedModel : public JsonModel
+{
+public:
+	using Model::presolve;
+	using Model::clearPresolve;
+
+	const Variable& detection(IdLabelType id) const { return segmentationHypotheses_.at(id).getDetectionVariable(); }
+	const Variable& appearance(IdLabelType id) const { return segmentationHypotheses_.at(id).getAppearanceVariable(); }
+	const Variable& disappearance(IdLabelType id) const { return segmentationHypotheses_.at(id).getDisappearanceVariable(); }
+	const Variable& link(IdLabelType srcId, IdLabelType destId) const { return linkingHypotheses_.at(std::make_pair(srcId, destId)).getVariable(); }
+};
+
+// With all weights at 1, the energy of a state is its feature. The only path of negative cost is the track 1 -> 3:
+// appearing at 1, the two detections and the link cost 0 - 5 + 1 - 5 and disappearing at 3 costs 0.
+// Detection 2 costs 8 and can only reach 3, which makes every path through it cost at least 4,
+// and the cheapest path through detection 4 or the link 1 -> 4 costs 4 as well. Appearing at 3 costs 10 and
+// disappearing at 1 costs 10, both more than the best path they are part of saves.
+static const char* dominatedHypothesesModel = R"({
+	"settings": {"statesShareWeights": true, "optimizerEpGap": 0.0, "useFlowSolver": false, "presolve": true},
+	"segmentationHypotheses": [
+		{"id": 1, "features": [[0], [-5]], "appearanceFeatures": [[0], [0]], "disappearanceFeatures": [[0], [10]]},
+		{"id": 2, "features": [[1], [9]], "appearanceFeatures": [[0], [0]], "disappearanceFeatures": [[0], [10]]},
+		{"id": 3, "features": [[0], [-5]], "appearanceFeatures": [[0], [10]], "disappearanceFeatures": [[0], [0]]},
+		{"id": 4, "features": [[0], [-1]], "appearanceFeatures": [[0], [3]], "disappearanceFeatures": [[0], [3]]}
+	],
+	"linkingHypotheses": [
+		{"src": 1, "dest": 3, "features": [[0], [1]]},
+		{"src": 2, "dest": 3, "features": [[0], [1]]},
+		{"src": 1, "dest": 4, "features": [[0], [7]]}
+	]
+})";
+
+BOOST_AUTO_TEST_CASE( PresolvePrunesDominatedHypotheses )
+{
+	TemporaryJsonFile file(dominatedHypothesesModel);
+	PresolvedModel model;
+	model.readFromJson(file.filename());
+	std::vector<ValueType> weights(model.computeNumWeights(), 1.0);
+
+	double fixedEnergy = 0.0;
+	BOOST_CHECK_EQUAL(model.presolve(weights, fixedEnergy), 10);
+	BOOST_CHECK_EQUAL(model.getTelemetry().getCounter("presolve.prunedDetections"), 2);
+	BOOST_CHECK_EQUAL(model.getTelemetry().getCounter("presolve.prunedLinks"), 2);
+	// state 0 of detection 2 is the only one with nonzero energy
+	BOOST_CHECK_CLOSE(fixedEnergy, 1.0, 1e-6);
+
+	for(IdLabelType id : {2, 4})
+	{
+		BOOST_CHECK(model.detection(id).isPruned());
+		BOOST_CHECK(model.appearance(id).isPruned());
+		BOOST_CHECK(model.disappearance(id).isPruned());
+	}
+	BOOST_CHECK(model.link(2, 3).isPruned());
+	BOOST_CHECK(model.link(1, 4).isPruned());
+	BOOST_CHECK(model.disappearance(1).isPruned());
+	BOOST_CHECK(model.appearance(3).isPruned());
+
+	BOOST_CHECK(!model.detection(1).isPruned());
+	BOOST_CHECK(!model.detection(3).isPruned());
+	BOOST_CHECK(!model.link(1, 3).isPruned());
+	BOOST_CHECK(!model.appearance(1).isPruned());
+	BOOST_CHECK(!model.disappearance(3).isPruned());
+	model.clearPresolve();
+
+	// the presolved model finds the track 1 -> 3, with the same energy as the full model
+	Solution solution = model.infer(weights);
+	BOOST_CHECK_CLOSE(model.getLastSolutionValue(), -8.0, 1e-6);
+	BOOST_CHECK_EQUAL(solution[model.detection(1).getOpenGMVariableId()], 1);
+	BOOST_CHECK_EQUAL(solution[model.detection(3).getOpenGMVariableId()], 1);
+	BOOST_CHECK_EQUAL(solution[model.link(1, 3).getOpenGMVariableId()], 1);
+	BOOST_CHECK_EQUAL(solution[model.detection(2).getOpenGMVariableId()], 0);
+	BOOST_CHECK_EQUAL(solution[model.detection(4).getOpenGMVariableId()], 0);
+
+	Json::Value root;
+	std::ifstream input(file.filename().c_str());
+	input >> root;
+	root[JsonTypeNames[JsonTypes::Settings]][JsonTypeNames[JsonTypes::Presolve]] = false;
+	std::stringstream fullModelText;
+	fullModelText << root;
+	TemporaryJsonFile fullFile(fullModelText.str());
+	JsonModel fullModel;
+	fullModel.readFromJson(fullFile.filename());
+	fullModel.infer(weights);
+	BOOST_CHECK_CLOSE(fullModel.getLastSolutionValue(), model.getLastSolutionValue(), 1e-6);
+	BOOST_CHECK(fullModel.verifySolution(solution));
+}
+
+BOOST_AUTO_TEST_CASE( PresolveKeepsTheOptimum )
+{
+	GeneratedModel generated;
+	JsonModel fullModel, presolvedModel;
+	fullModel.readFromJson(generated.write());
+	generated.setSetting(JsonTypes::Presolve, true);
+	presolvedModel.readFromJson(generated.write());
+	std::vector<ValueType> weights(fullModel.computeNumWeights(), 1.0);
+
+	fullModel.infer(weights);
+	Solution solution = presolvedModel.infer(weights);
+
+	// the presolved solution has the layout of the full model, and the energy of the pruned variables is included
+	BOOST_CHECK(fullModel.verifySolution(solution));
+	BOOST_CHECK_CLOSE(fullModel.evaluateSolution(solution), presolvedModel.getLastSolutionValue(), 1e-6);
+	BOOST_CHECK_CLOSE(presolvedModel.evaluateSolution(solution), presolvedModel.getLastSolutionValue(), 1e-6);
+	BOOST_CHECK(std::abs(fullModel.getLastSolutionValue() - presolvedModel.getLastSolutionValue())
+		< 1e-6 * std::max(1.0, std::abs(fullModel.getLastSolutionValue())));
+}
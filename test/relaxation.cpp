@@ -0,0 +1,65 @@
+#define BOOST_TEST_MODULE relaxation
+
+#include <iostream>
+
+#include "jsonmodel.h"
+#include "test_helpers.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace mht;
+using namespace helpers;
+
+BOOST_AUTO_TEST_CASE( RoundedRelaxationIsValidAndBounded )
+{
+	GeneratedModel generated;
+	std::string filename = generated.write();
+	JsonModel model;
+	model.readFromJson(filename);
+	std::vector<ValueType> weights(model.computeNumWeights(), 1.0);
+
+	Relaxation relaxation = model.inferRelaxation(weights);
+	BOOST_REQUIRE(!relaxation.rounded_.empty());
+	BOOST_CHECK_EQUAL(relaxation.numFractional_ == 0, relaxation.maxFractionality_ < 1e-6);
+	checkBoundedSolution(filename, weights, relaxation.rounded_, relaxation.roundedEnergy_, relaxation.lowerBound_);
+}
+
+// With all weights at 1, the energy of a state is its feature. Each detection alone is a track of energy -4, -3 or -2,
+// and any two of them exclude each other. The LP relaxation takes half of every track instead, with energy -4.5, 
+// which rounding has to repair to the optimal tracking that only takes detection 1.
+static const char* oddExclusionCycleModel = R"({
+	"settings": {"statesShareWeights": true, "optimizerEpGap": 0.0, "useFlowSolver": false, "allowLengthOneTracks": true},
+	"segmentationHypotheses": [
+		{"id": 1, "timestep": 1, "features": [[0], [-6]], "appearanceFeatures": [[0], [1]], "disappearanceFeatures": [[0], [1]]},
+		{"id": 2, "timestep": 1, "features": [[0], [-5]], "appearanceFeatures": [[0], [1]], "disappearanceFeatures": [[0], [1]]},
+		{"id": 3, "timestep": 1, "features": [[0], [-4]], "appearanceFeatures": [[0], [1]], "disappearanceFeatures": [[0], [1]]}
+	],
+	"linkingHypotheses": [],
+	"exclusions": [[1, 2], [2, 3], [1, 3]]
+})";
+
+BOOST_AUTO_TEST_CASE( RoundingRepairsFractionalRelaxation )
+{
+	TemporaryJsonFile file(oddExclusionCycleModel);
+	InspectableJsonModel model;
+	model.readFromJson(file.filename());
+	std::vector<ValueType> weights(model.computeNumWeights(), 1.0);
+
+	Relaxation relaxation = model.inferRelaxation(weights);
+	BOOST_CHECK_CLOSE(relaxation.lowerBound_, -4.5, 1e-4);
+	BOOST_CHECK_EQUAL(relaxation.numFractional_, 9);
+	BOOST_CHECK_CLOSE(relaxation.maxFractionality_, 0.5, 1e-2);
+	for(IdLabelType id : {1, 2, 3})
+		BOOST_CHECK_CLOSE(relaxation.values_[model.detection(id).getOpenGMVariableId()], 0.5, 1e-2);
+
+	BOOST_REQUIRE(!relaxation.rounded_.empty());
+	BOOST_CHECK_CLOSE(relaxation.roundedEnergy_, -4.0, 1e-6);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(relaxation.rounded_, model.detection(1)), 1);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(relaxation.rounded_, model.appearance(1)), 1);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(relaxation.rounded_, model.disappearance(1)), 1);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(relaxation.rounded_, model.detection(2)), 0);
+	BOOST_CHECK_EQUAL(InspectableJsonModel::getState(relaxation.rounded_, model.detection(3)), 0);
+
+	double optimum = checkBoundedSolution(file.filename(), weights, relaxation.rounded_, relaxation.roundedEnergy_, relaxation.lowerBound_);
+	BOOST_CHECK_CLOSE(optimum, -4.0, 1e-6);
+}
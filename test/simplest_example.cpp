@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <cstdio>
+#include <fstream>
 
 #include <boost/test/unit_test.hpp>
 
@@ -9,6 +10,7 @@
 #include "segmentationhypothesis.h"
 #include "linkinghypothesis.h"
 #include "jsonmodel.h"
+#include "binarymodel.h"
 
 using namespace mht;
 using namespace helpers;
@@ -40,3 +42,160 @@ BOOST_AUTO_TEST_CASE( OpenGMInference )
 	BOOST_CHECK_EQUAL(numWeights, 5);
 }
 
+
+BOOST_AUTO_TEST_CASE( LearnFromSeveralInstances )
+{
+	JsonModel model;
+	model.readFromJson("constrackingmodel.json");
+	model.setJsonGtFile("constrackinggt.json");
+	JsonModel otherModel;
+	otherModel.readFromJson("constrackingmodel.json");
+	otherModel.setJsonGtFile("constrackinggt.json");
+
+	std::vector<Model*> instances = {&model, &otherModel};
+	std::vector<double> weights = Model::learnFromInstances(instances, std::vector<double>(model.computeNumWeights(), 0));
+	BOOST_CHECK_EQUAL(weights.size(), model.computeNumWeights());
+
+	JsonModel model2;
+	model2.readFromJson("constrackingmodel.json");
+	Solution sol = model2.infer(weights);
+	BOOST_CHECK(model2.verifySolution(sol));
+}
+
+BOOST_AUTO_TEST_CASE( WeightSequence )
+{
+	JsonModel model;
+	model.readFromJson("constrackingmodel.json");
+	std::vector<double> weights(model.computeNumWeights(), 1.0);
+	std::vector<double> otherWeights(model.computeNumWeights(), 0.5);
+	otherWeights[0] = 10.0;
+
+	std::vector< std::vector<double> > weightSequence = {weights, otherWeights, weights};
+	std::vector<double> energies;
+	std::vector<Solution> solutions = model.inferWithWeightSequence(weightSequence, energies);
+	BOOST_CHECK_EQUAL(solutions.size(), 3);
+	BOOST_CHECK_EQUAL(energies.size(), 3);
+
+	// the reused model must give the same results as models that are built from scratch
+	for(size_t s = 0; s < weightSequence.size(); s++)
+	{
+		JsonModel freshModel;
+		freshModel.readFromJson("constrackingmodel.json");
+		Solution sol = freshModel.infer(weightSequence[s]);
+		BOOST_CHECK_CLOSE(energies[s], freshModel.getLastSolutionValue(), 0.0001);
+		BOOST_CHECK(model.verifySolution(solutions[s]));
+	}
+	BOOST_CHECK_CLOSE(energies[0], energies[2], 0.0001);
+}
+
+BOOST_AUTO_TEST_CASE( SlidingWindow )
+{
+	JsonModel model;
+	model.readFromJson("slidingwindowmodel.json");
+	std::vector<double> weights(model.computeNumWeights(), 1.0);
+	Solution sol = model.infer(weights);
+	double energy = model.getLastSolutionValue();
+
+	JsonModel windowModel;
+	windowModel.readFromJson("slidingwindowmodel.json");
+	std::vector<int> committedTimesteps;
+	Solution windowSol = windowModel.inferSlidingWindow(weights, 2, 1, [&](int timestep, const Solution&){
+		committedTimesteps.push_back(timestep);
+	});
+
+	BOOST_CHECK_EQUAL(windowSol.size(), sol.size());
+	BOOST_CHECK(windowModel.verifySolution(windowSol));
+	BOOST_CHECK_EQUAL(committedTimesteps.size(), 3);
+	for(size_t t = 0; t < committedTimesteps.size(); t++)
+		BOOST_CHECK_EQUAL(committedTimesteps[t], t);
+
+	// the windowed solution is feasible for the full model, so it cannot be better than the global optimum
+	BOOST_CHECK(windowModel.getLastSolutionValue() >= energy - 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE( ConnectedComponents )
+{
+	JsonModel model;
+	model.readFromJson("constrackingmodel.json");
+	std::vector<Subgraph> components = model.findConnectedComponents();
+
+	// the model contains two independent lineage trees
+	BOOST_CHECK_EQUAL(components.size(), 2);
+	for(auto& component : components)
+	{
+		BOOST_CHECK_EQUAL(component.segmentations_.size(), 4);
+		BOOST_CHECK_EQUAL(component.links_.size(), 3);
+		BOOST_CHECK_EQUAL(component.divisions_.size(), 0);
+		BOOST_CHECK_EQUAL(component.exclusions_.size(), 0);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( ComponentwiseInference )
+{
+	JsonModel model;
+	model.readFromJson("constrackingmodel.json");
+	std::vector<double> weights(model.computeNumWeights(), 1.0);
+	Solution sol = model.infer(weights);
+
+	Json::Value root;
+	std::ifstream input("constrackingmodel.json");
+	input >> root;
+	root[JsonTypeNames[JsonTypes::Settings]][JsonTypeNames[JsonTypes::DecomposeIntoComponents]] = true;
+	std::ofstream output("constrackingmodel-components.json");
+	output << root;
+	output.close();
+
+	// the two lineage trees are solved separately, which must find the optimum of the whole model
+	JsonModel componentModel;
+	componentModel.readFromJson("constrackingmodel-components.json");
+	std::remove("constrackingmodel-components.json");
+	Solution componentSol = componentModel.infer(weights);
+	BOOST_CHECK(componentModel.verifySolution(componentSol));
+	BOOST_CHECK_EQUAL(componentSol.size(), sol.size());
+	BOOST_CHECK_CLOSE(componentModel.getLastSolutionValue(), model.getLastSolutionValue(), 1e-6);
+	BOOST_CHECK_CLOSE(componentModel.evaluateSolution(componentSol), componentModel.getLastSolutionValue(), 1e-6);
+	BOOST_CHECK_CLOSE(model.evaluateSolution(componentSol), model.getLastSolutionValue(), 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE( BinaryModelRoundTrip )
+{
+	JsonModel model;
+	model.readFromJson("constrackingmodel-new-divs.json");
+	model.setJsonGtFile("constrackinggt-new-divs.json");
+	Solution gt = model.getGroundTruth();
+	model.saveToBinary("constrackingmodel-new-divs.mhtb", &gt);
+
+	BinaryModel binaryModel;
+	binaryModel.read("constrackingmodel-new-divs.mhtb");
+	BOOST_CHECK(binaryModel.hasEmbeddedGroundTruth());
+	BOOST_CHECK_EQUAL(binaryModel.computeNumWeights(), model.computeNumWeights());
+
+	Solution binaryGt = binaryModel.getGroundTruth();
+	BOOST_CHECK_EQUAL(binaryGt.size(), gt.size());
+	for(size_t i = 0; i < gt.size(); i++)
+		BOOST_CHECK_EQUAL(binaryGt[i], gt[i]);
+}
+
+BOOST_AUTO_TEST_CASE( TelemetryRecordsPhases )
+{
+	JsonModel model;
+	model.readFromJson("constrackingmodel.json");
+	std::vector<double> weights(model.computeNumWeights(), 1.0);
+	Solution sol = model.infer(weights);
+	model.saveResultToJson("telemetry-result.json", sol);
+
+	const Telemetry& telemetry = model.getTelemetry();
+	BOOST_CHECK_EQUAL(telemetry.getPhase("parse").calls, 1);
+	BOOST_CHECK_EQUAL(telemetry.getPhase("buildAdjacency").calls, 1);
+	BOOST_CHECK(telemetry.getPhase("solve").calls >= 1);
+	BOOST_CHECK_EQUAL(telemetry.getPhase("export").calls, 1);
+	BOOST_CHECK_EQUAL(telemetry.getCounter("variables.detections"), 8);
+	BOOST_CHECK_EQUAL(telemetry.getCounter("variables.links"), 6);
+
+	Json::Value result;
+	std::ifstream input("telemetry-result.json");
+	input >> result;
+	BOOST_CHECK(result["telemetry"]["phases"].isMember("parse"));
+	BOOST_CHECK(result["telemetry"].isMember("concurrentPhases"));
+	BOOST_CHECK(result["telemetry"]["counters"].isMember("variables.links"));
+}
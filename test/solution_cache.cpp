@@ -0,0 +1,44 @@
+#define BOOST_TEST_MODULE solution_cache
+
+#include <iostream>
+#include <vector>
+
+#include "jsonmodel.h"
+#include "test_helpers.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace mht;
+using namespace helpers;
+
+BOOST_AUTO_TEST_CASE( SolutionCacheReturnsTheSameSolution )
+{
+	GeneratedModel generated;
+	TemporaryDirectory cacheDirectory;
+	std::string filename = generated.write();
+	std::vector<ValueType> weights;
+	Solution solution;
+	double energy;
+	{
+		JsonModel model;
+		model.readFromJson(filename);
+		model.setSolutionCache(cacheDirectory.path(), 2);
+		weights.assign(model.computeNumWeights(), 1.0);
+		solution = model.infer(weights);
+		energy = model.getLastSolutionValue();
+		BOOST_CHECK_EQUAL(model.getTelemetry().getCounter("cache.misses"), 1);
+	}
+
+	// another model of the same graph does not need to solve anything
+	JsonModel model;
+	model.readFromJson(filename);
+	model.setSolutionCache(cacheDirectory.path(), 2);
+	BOOST_CHECK(model.infer(weights) == solution);
+	BOOST_CHECK_EQUAL(model.getLastSolutionValue(), energy);
+	BOOST_CHECK_EQUAL(model.getTelemetry().getCounter("cache.hits"), 1);
+
+	// other weights are solved again
+	weights[0] += 1.0;
+	model.infer(weights);
+	BOOST_CHECK_EQUAL(model.getTelemetry().getCounter("cache.misses"), 1);
+}
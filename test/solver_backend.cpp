@@ -0,0 +1,51 @@
+#define BOOST_TEST_MODULE solver_backend
+
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <cmath>
+#include <algorithm>
+
+#include "modelgenerator.h"
+#include "jsonmodel.h"
+#include "solverbackend.h"
+#include "lpfile.h"
+#include "test_helpers.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace mht;
+using namespace helpers;
+
+BOOST_AUTO_TEST_CASE( AllBackendsFindTheSameOptimum )
+{
+	std::vector<std::string> backends = SolverBackend::availableNames();
+	BOOST_REQUIRE(!backends.empty());
+
+	std::vector<double> energies;
+	for(const std::string& backend : backends)
+	{
+		GeneratedModel generated(GeneratedModel::defaultParameters(), backend);
+		JsonModel model;
+		model.readFromJson(generated.write());
+
+		Solution solution = model.infer(std::vector<ValueType>(model.computeNumWeights(), 1.0));
+		BOOST_CHECK(model.verifySolution(solution));
+		BOOST_CHECK_CLOSE(model.evaluateSolution(solution), model.getLastSolutionValue(), 1e-6);
+		energies.push_back(model.getLastSolutionValue());
+		std::cout << "Backend " << backend << " found energy " << energies.back() << std::endl;
+	}
+
+	for(size_t i = 1; i < energies.size(); i++)
+		BOOST_CHECK(std::abs(energies[i] - energies[0]) < 1e-6 * std::max(1.0, std::abs(energies[0])));
+}
+
+BOOST_AUTO_TEST_CASE( UnknownBackendThrows )
+{
+	BOOST_CHECK_THROW(SolverBackend::create("no-such-solver"), std::runtime_error);
+
+	GeneratedModel generated(GeneratedModel::defaultParameters(), "no-such-solver");
+	JsonModel model;
+	model.readFromJson(generated.write());
+	BOOST_CHECK_THROW(model.infer(std::vector<ValueType>(model.computeNumWeights(), 1.0)), std::runtime_error);
+}
@@ -1,4 +1,5 @@
 # run this as test? https://cmake.org/pipermail/cmake/2010-August/039174.html
+import numpy as np
 import multiHypoTracking_with_gurobi as mht
 
 
@@ -57,8 +58,81 @@ expectedResult = {'detectionResults': [{'id': 2, 'value': 1},
 # test tracking
 res = mht.track(graph, weights)
 del res['resultEnergy']
+assert('parse' in res['telemetry']['phases'])
+del res['telemetry']
 assert(res == expectedResult)
 
+# test tracking with the same graph given as arrays, rows of NaN mean that a detection cannot divide
+nan = np.nan
+arrayGraph = {
+    "settings": graph["settings"],
+    "segmentationHypotheses": {
+        "id": np.array([2, 3, 4, 5, 6]),
+        "timestep": np.array([1, 1, 2, 2, 2]),
+        "features": np.array([[[1.0], [0.0]]] * 5),
+        "divisionFeatures": np.array([[[0.0], [-5.0]], [[0.0], [-5.0]], [[nan], [nan]], [[nan], [nan]], [[nan], [nan]]]),
+        "appearanceFeatures": np.array([[[0], [0]], [[0], [0]], [[0], [50]], [[0], [50]], [[0], [50]]], dtype=np.float64),
+        "disappearanceFeatures": np.array([[[0], [50]], [[0], [50]], [[0], [-2]], [[0], [-2]], [[0], [-4]]], dtype=np.float64)
+    },
+    "linkingHypotheses": {
+        "src": np.array([2, 2, 3, 3], dtype=np.uint32),
+        "dest": np.array([4, 5, 5, 6], dtype=np.uint32),
+        "features": np.array([[[0], [-4]], [[0], [-3]], [[0], [-1]], [[0], [-4]]], dtype=np.float64)
+    }
+}
+res = mht.track(arrayGraph, weights)
+del res['resultEnergy']
+del res['telemetry']
+assert(res == expectedResult)
+
+# test returning the result as arrays
+res = mht.track(graph, weights, arrays=True)
+assert(list(res['detectionResults']['id']) == [d['id'] for d in expectedResult['detectionResults']])
+assert(list(res['linkingResults']['src']) == [l['src'] for l in expectedResult['linkingResults']])
+assert(list(res['linkingResults']['dest']) == [l['dest'] for l in expectedResult['linkingResults']])
+assert(list(res['linkingResults']['value']) == [1, 1, 1])
+assert(list(res['divisionResults']['id']) == [2])
+assert(list(res['divisionResults']['parent']) == [2])
+assert(res['divisionResults']['children'].tolist() == [[4, 5]])
+
+# test the LP relaxation, which is integral for this graph
+relaxed = mht.trackRelaxed(graph, weights)
+assert(relaxed['numFractional'] == 0)
+assert(list(relaxed['detectionResults']['value']) == [1.0] * 5)
+rounded = relaxed['rounded']
+del rounded['resultEnergy']
+assert(rounded == expectedResult)
+
+# test tracking several graphs at once, the results come back in order
+results = mht.trackMany([graph, arrayGraph, graph], weights, numWorkers=2)
+assert(len(results) == 3)
+for res in results:
+    del res['resultEnergy']
+    del res['telemetry']
+    assert(res == expectedResult)
+
+# test editing a graph and solving it again
+session = mht.TrackingSession(graph, weights)
+res = session.track()
+del res['resultEnergy']
+del res['telemetry']
+assert(res == expectedResult)
+session.fixDetection(6, 0)
+res = session.track()
+assert(all(d['value'] == 0 for d in res['detectionResults'] if d['id'] == 6))
+session.fixDetection(6, -1)
+session.removeSegmentationHypothesis(4)
+res = session.track()
+assert(not any(d['id'] == 4 for d in res['detectionResults']))
+assert(not any(l['dest'] == 4 for l in res['linkingResults']))
+session.addSegmentationHypothesis({"id": 4, "timestep": [2, 2], "features": [[1.0], [0.0]], "appearanceFeatures": [
+    [0], [50]], "disappearanceFeatures": [[0], [-2]]})
+session.addLinkingHypothesis({"src": 2, "dest": 4, "features": [[0], [-4]]})
+res = session.track()
+# added hypotheses come last in the results
+for key in ['detectionResults', 'divisionResults', 'linkingResults']:
+    assert(sorted(res[key], key=str) == sorted(expectedResult[key], key=str))
+
 # test validation
 assert(mht.validate(graph, expectedResult))
 
@@ -0,0 +1,205 @@
+#ifndef TEST_HELPERS_H
+#define TEST_HELPERS_H
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "modelgenerator.h"
+#include "solverbackend.h"
+#include "jsonmodel.h"
+#include "helpers.h"
+
+/**
+ * @brief A generated model as JSON, which is written to files with unique names in the temporary directory
+ * @details The settings select the given solver backend (the preferred one by default) and solve to optimality,
+ *          so that the energies found by different inference paths can be compared. All files written by write()
+ *          or named by getTemporaryFilename() are removed when the object goes out of scope, so tests can run repeatedly and concurrently.
+ */
+class GeneratedModel
+{
+public:
+	/// small models with mergers, divisions and exclusions, which are solved in well below a second
+	static mht::ModelGenerator::Parameters defaultParameters()
+	{
+		mht::ModelGenerator::Parameters parameters;
+		parameters.numFrames = 4;
+		parameters.detectionsPerFrame = 15;
+		parameters.maxNumObjects = 2;
+		parameters.divisionRate = 0.2;
+		parameters.exclusionRate = 0.2;
+		return parameters;
+	}
+
+	GeneratedModel(const mht::ModelGenerator::Parameters& parameters = defaultParameters(),
+				   const std::string& backend = mht::SolverBackend::availableNames().front()):
+		generator_(parameters)
+	{
+		std::stringstream stream;
+		generator_.writeModel(stream);
+		stream >> root_;
+		setSetting(helpers::JsonTypes::SolverBackend, backend);
+		setSetting(helpers::JsonTypes::OptimizerEpGap, 0.0);
+	}
+
+	~GeneratedModel()
+	{
+		boost::system::error_code error;
+		for(const std::string& filename : filenames_)
+			boost::filesystem::remove(filename, error);
+	}
+
+	GeneratedModel(const GeneratedModel&) = delete;
+	GeneratedModel& operator=(const GeneratedModel&) = delete;
+
+	/// the JSON model, which may be edited before the next write()
+	Json::Value& root() { return root_; }
+
+	void setSetting(helpers::JsonTypes type, const Json::Value& value)
+	{
+		root_[helpers::JsonTypeNames[helpers::JsonTypes::Settings]][helpers::JsonTypeNames[type]] = value;
+	}
+
+	/// weights that fit the generated model, see ModelGenerator::getWeights()
+	std::vector<helpers::ValueType> getWeights() const { return generator_.getWeights(); }
+
+	/**
+	 * @brief Write the model as it is now into a new file in the temporary directory
+	 * @return the name of the file, which is removed together with this object
+	 */
+	std::string write()
+	{
+		std::string filename = getTemporaryFilename(".json");
+		std::ofstream file(filename.c_str());
+		file << root_;
+		return filename;
+	}
+
+	/**
+	 * @brief A unique name with the given extension in the temporary directory, e.g. for files exported from the model
+	 * @return the name of the file, which is removed together with this object if it is created
+	 */
+	std::string getTemporaryFilename(const std::string& extension)
+	{
+		boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("mht-test-%%%%-%%%%-%%%%" + extension);
+		filenames_.push_back(path.string());
+		return filenames_.back();
+	}
+
+private:
+	mht::ModelGenerator generator_;
+	Json::Value root_;
+	std::vector<std::string> filenames_;
+};
+
+/**
+ * @brief A new directory with a unique name in the temporary directory, which is removed with all its contents 
+ *        when the object goes out of scope
+ */
+class TemporaryDirectory
+{
+public:
+	TemporaryDirectory():
+		path_(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("mht-test-%%%%-%%%%-%%%%"))
+	{
+		boost::filesystem::create_directories(path_);
+	}
+
+	~TemporaryDirectory()
+	{
+		boost::system::error_code error;
+		boost::filesystem::remove_all(path_, error);
+	}
+
+	TemporaryDirectory(const TemporaryDirectory&) = delete;
+	TemporaryDirectory& operator=(const TemporaryDirectory&) = delete;
+
+	std::string path() const { return path_.string(); }
+
+private:
+	boost::filesystem::path path_;
+};
+
+/**
+ * @brief A small hand-written model, or any other JSON text, in a file with a unique name in the temporary directory,
+ *        which is removed when the object goes out of scope
+ */
+class TemporaryJsonFile
+{
+public:
+	TemporaryJsonFile(const std::string& contents):
+		filename_((boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("mht-test-%%%%-%%%%-%%%%.json")).string())
+	{
+		std::ofstream file(filename_.c_str());
+		file << contents;
+	}
+
+	~TemporaryJsonFile()
+	{
+		boost::system::error_code error;
+		boost::filesystem::remove(filename_, error);
+	}
+
+	TemporaryJsonFile(const TemporaryJsonFile&) = delete;
+	TemporaryJsonFile& operator=(const TemporaryJsonFile&) = delete;
+
+	const std::string& filename() const { return filename_; }
+
+private:
+	std::string filename_;
+};
+
+/**
+ * @brief A JSON model that gives tests access to the variables of its hypotheses by id, to check their states in a solution
+ */
+class InspectableJsonModel : public mht::JsonModel
+{
+public:
+	const mht::Variable& detection(helpers::IdLabelType id) const { return segmentationHypotheses_.at(id).getDetectionVariable(); }
+	const mht::Variable& division(helpers::IdLabelType id) const { return segmentationHypotheses_.at(id).getDivisionVariable(); }
+	const mht::Variable& appearance(helpers::IdLabelType id) const { return segmentationHypotheses_.at(id).getAppearanceVariable(); }
+	const mht::Variable& disappearance(helpers::IdLabelType id) const { return segmentationHypotheses_.at(id).getDisappearanceVariable(); }
+	const mht::Variable& link(helpers::IdLabelType srcId, helpers::IdLabelType destId) const 
+	{ 
+		return linkingHypotheses_.at(std::make_pair(srcId, destId)).getVariable(); 
+	}
+
+	/// state of the variable in a solution in the layout of the full model, 0 if it is not part of the model
+	static size_t getState(const helpers::Solution& solution, const mht::Variable& variable)
+	{
+		int id = variable.getOpenGMVariableId();
+		BOOST_REQUIRE(id < 0 || (size_t)id < solution.size());
+		return id < 0 ? 0 : solution[id];
+	}
+};
+
+/**
+ * @brief Check a solution that an inexact inference found together with a lower bound, against the optimum of the model
+ * @details The model is read from the file and solved anew, so neither the evaluation of the solution 
+ *          nor the optimum depend on the state that the inexact inference left in its model.
+ * @return the optimal energy
+ */
+inline double checkBoundedSolution(const std::string& filename, 
+								   const std::vector<helpers::ValueType>& weights, 
+								   const helpers::Solution& solution, 
+								   double energy, 
+								   double lowerBound)
+{
+	mht::JsonModel model;
+	model.readFromJson(filename);
+	model.infer(weights);
+	double optimum = model.getLastSolutionValue();
+
+	BOOST_CHECK(model.verifySolution(solution));
+	BOOST_CHECK_CLOSE(model.evaluateSolution(solution), energy, 1e-6);
+	// the optimum lies between the lower bound and the energy of the solution
+	BOOST_CHECK(lowerBound <= optimum + 1e-6);
+	BOOST_CHECK(optimum <= energy + 1e-6);
+	return optimum;
+}
+
+#endif // TEST_HELPERS_H